@@ -32,12 +32,13 @@ typedef uint64_t cycles_t;
 
 #define UNUSED(x) (void)(x)
 
+/* the counter is shared by all gbs instances, which may run in threads */
 #define WARN_N(n, ...) { \
 	static long ctr = n; \
-	if (ctr) { \
-		ctr--; \
+	long old_ctr = __atomic_load_n(&ctr, __ATOMIC_RELAXED); \
+	while (old_ctr > 0 && !__atomic_compare_exchange_n(&ctr, &old_ctr, old_ctr - 1, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED)); \
+	if (old_ctr > 0) \
 		fprintf(stderr, __VA_ARGS__); \
-	} \
 }
 #define WARN_ONCE(...) WARN_N(1, __VA_ARGS__)
 
@@ -16,6 +16,9 @@
 #include <assert.h>
 
 #include "gbcpu.h"
+#include "gbcpu_optable.h"
+#include "savestate.h"
+#include "test.h"
 
 #if DEBUG == 1
 static const char regnames[12] = "BCDEHLFASPGBS_PC";
@@ -56,27 +59,81 @@ static void none_put(void *priv, uint32_t addr, uint8_t val)
 	UNUSED(val);
 }
 
+static void icache_flush(struct gbcpu* const gbcpu)
+{
+#if GBCPU_ICACHE == 1
+	memset(gbcpu->icache, 0xff, sizeof(gbcpu->icache));
+	gbcpu->prefetch = NULL;
+	/* the statistics describe the current cache contents only */
+	gbcpu->icache_hits = 0;
+	gbcpu->icache_misses = 0;
+	gbcpu->icache_uncached = 0;
+#else
+	UNUSED(gbcpu);
+#endif
+}
+
 void gbcpu_init_struct(struct gbcpu* const gbcpu) {
 	for (uint16_t i = 0; i < GBCPU_LOOKUP_SIZE; i++) {
 		gbcpu->getlookup[i].get = &none_get;
 		gbcpu->putlookup[i].put = &none_put;
+		gbcpu->rdpage[i] = NULL;
+		gbcpu->wrpage[i] = NULL;
+		gbcpu->codebank[i] = -1;
 	}
+	icache_flush(gbcpu);
 }
 
-static inline uint32_t mem_get(struct gbcpu* const gbcpu, uint32_t addr)
+#if defined(__GNUC__)
+#define NOINLINE __attribute__((noinline))
+#else
+#define NOINLINE
+#endif
+
+/* accesses to pages with side effects, kept out of line */
+static NOINLINE uint32_t mem_get_cb(struct gbcpu* const gbcpu, uint32_t addr)
 {
 	struct get_entry *e = &gbcpu->getlookup[(addr >> 8) & 0xff];
-	gbcpu->cycles += 4;
 	return e->get(e->priv, addr);
 }
 
-static inline void mem_put(struct gbcpu* const gbcpu, uint32_t addr, uint32_t val)
+static NOINLINE void mem_put_cb(struct gbcpu* const gbcpu, uint32_t addr, uint32_t val)
 {
 	struct put_entry *e = &gbcpu->putlookup[(addr >> 8) & 0xff];
-	gbcpu->cycles += 4;
 	e->put(e->priv, addr, val);
 }
 
+static inline uint32_t mem_get(struct gbcpu* const gbcpu, uint32_t addr)
+{
+	const uint8_t *page = gbcpu->rdpage[(addr >> 8) & 0xff];
+
+	gbcpu->cycles += 4;
+	if (page)
+		return page[addr & 0xff];
+	return mem_get_cb(gbcpu, addr);
+}
+
+static inline void mem_put(struct gbcpu* const gbcpu, uint32_t addr, uint32_t val)
+{
+	uint8_t *page = gbcpu->wrpage[(addr >> 8) & 0xff];
+
+	gbcpu->cycles += 4;
+	if (page)
+		page[addr & 0xff] = val;
+	else
+		mem_put_cb(gbcpu, addr, val);
+}
+
+/* read without taking any cycles */
+static inline uint32_t mem_peek(struct gbcpu* const gbcpu, uint32_t addr)
+{
+	const uint8_t *page = gbcpu->rdpage[(addr >> 8) & 0xff];
+
+	if (page)
+		return page[addr & 0xff];
+	return mem_get_cb(gbcpu, addr);
+}
+
 uint8_t gbcpu_mem_get(struct gbcpu* const gbcpu, uint16_t addr)
 {
 	return mem_get(gbcpu, addr);
@@ -107,12 +164,24 @@ static uint32_t pop(struct gbcpu* const gbcpu)
 	return res;
 }
 
+/* instruction stream read, served from the decoded instruction cache if possible */
+static inline uint32_t fetch(struct gbcpu* const gbcpu, uint32_t addr)
+{
+#if GBCPU_ICACHE == 1
+	if (gbcpu->prefetch) {
+		gbcpu->cycles += 4;
+		return *gbcpu->prefetch++;
+	}
+#endif
+	return mem_get(gbcpu, addr);
+}
+
 static uint32_t get_imm8(struct gbcpu* const gbcpu)
 {
 	uint32_t pc = REGS16_R(gbcpu->regs, GBS_PC);
 	uint32_t res;
 	REGS16_W(gbcpu->regs, GBS_PC, pc + 1);
-	res = mem_get(gbcpu, pc);
+	res = fetch(gbcpu, pc);
 	DPRINTF("%02x", res);
 	return res;
 }
@@ -122,7 +191,8 @@ static uint32_t get_imm16(struct gbcpu* const gbcpu)
 	uint32_t pc = REGS16_R(gbcpu->regs, GBS_PC);
 	uint32_t res;
 	REGS16_W(gbcpu->regs, GBS_PC, pc + 2);
-	res = mem_get(gbcpu, pc) + (mem_get(gbcpu, pc+1) << 8);
+	res = fetch(gbcpu, pc);
+	res += fetch(gbcpu, pc+1) << 8;
 	DPRINTF("%02x%02x", res & 0xFF, res >> 8);
 	return res;
 }
@@ -147,6 +217,78 @@ static void put_reg(struct gbcpu* const gbcpu, long i, uint32_t val)
 	else REGS8_W(gbcpu->regs, i, val);
 }
 
+/*
+ * Flag updates of the generated handlers. flags_alu() takes the result
+ * with the carry in bit 8 and the half carry in bit 4 of hx,
+ * flags_keep_c() does the same but leaves CF alone.
+ */
+#if GBCPU_LAZY_FLAGS == 1
+static inline uint32_t flag_c(struct gbcpu* const gbcpu)
+{
+	if (gbcpu->lf_pending)
+		return (gbcpu->lf_res >> 8) & 1;
+	return (gbcpu->regs.rn.f & CF) >> 4;
+}
+
+static inline uint32_t flag_z(struct gbcpu* const gbcpu)
+{
+	if (gbcpu->lf_pending)
+		return (gbcpu->lf_res & 0xff) == 0;
+	return (gbcpu->regs.rn.f & ZF) != 0;
+}
+
+static inline void flags_alu(struct gbcpu* const gbcpu, uint32_t res, uint32_t hx, uint32_t n)
+{
+	gbcpu->lf_res = res;
+	gbcpu->lf_hx = hx;
+	gbcpu->lf_n = n;
+	gbcpu->lf_pending = 1;
+}
+
+static inline void flags_keep_c(struct gbcpu* const gbcpu, uint32_t res, uint32_t hx, uint32_t n)
+{
+	flags_alu(gbcpu, (res & 0xff) | flag_c(gbcpu) << 8, hx, n);
+}
+
+static inline void flags_sync(struct gbcpu* const gbcpu)
+{
+	if (gbcpu->lf_pending) {
+		gbcpu->regs.rn.f = (((gbcpu->lf_res & 0xff) == 0) << 7) |
+		                   gbcpu->lf_n |
+		                   ((gbcpu->lf_hx & 0x10) << 1) |
+		                   ((gbcpu->lf_res & 0x100) >> 4);
+		gbcpu->lf_pending = 0;
+	}
+}
+#else
+static inline uint32_t flag_c(struct gbcpu* const gbcpu)
+{
+	return (gbcpu->regs.rn.f & CF) >> 4;
+}
+
+static inline uint32_t flag_z(struct gbcpu* const gbcpu)
+{
+	return (gbcpu->regs.rn.f & ZF) != 0;
+}
+
+static inline void flags_alu(struct gbcpu* const gbcpu, uint32_t res, uint32_t hx, uint32_t n)
+{
+	gbcpu->regs.rn.f = (((res & 0xff) == 0) << 7) | n |
+	                   ((hx & 0x10) << 1) | ((res & 0x100) >> 4);
+}
+
+static inline void flags_keep_c(struct gbcpu* const gbcpu, uint32_t res, uint32_t hx, uint32_t n)
+{
+	gbcpu->regs.rn.f = (gbcpu->regs.rn.f & CF) | (((res & 0xff) == 0) << 7) |
+	                   n | ((hx & 0x10) << 1);
+}
+
+static inline void flags_sync(struct gbcpu* const gbcpu)
+{
+	UNUSED(gbcpu);
+}
+#endif
+
 static void op_unknown(struct gbcpu* const gbcpu, uint32_t op, const struct opinfo *oi)
 {
 	UNUSED(oi);
@@ -1276,263 +1418,11 @@ static void op_daa(struct gbcpu* const gbcpu, uint32_t op, const struct opinfo *
 	DPRINTF(" \t%s", oi->name);
 }
 
+#define OPTABLE_ENTRY(opc, name, fn, cycles_1, cycles_2) \
+	OPINFO(name, &fn, cycles_1, cycles_2),
+
 static const struct opinfo ops[256] = {
-	OPINFO("NOP",  &op_nop         , 1, 1),		/* opcode 00 */
-	OPINFO("LD",   &op_ld_reg16_imm, 3, 3),		/* opcode 01 */
-	OPINFO("LD",   &op_ld_reg16_a  , 2, 2),		/* opcode 02 */
-	OPINFO("INC",  &op_inc16       , 2, 2),		/* opcode 03 */
-	OPINFO("INC",  &op_inc         , 1, 1),		/* opcode 04 */
-	OPINFO("DEC",  &op_dec         , 1, 1),		/* opcode 05 */
-	OPINFO("LD",   &op_ld_reg8_imm , 2, 2),		/* opcode 06 */
-	OPINFO("RLCA", &op_rlca        , 1, 1),		/* opcode 07 */
-	OPINFO("LD",   &op_ld_ind16_sp , 5, 5),		/* opcode 08 */
-	OPINFO("ADD",  &op_add_hl      , 2, 2),		/* opcode 09 */
-	OPINFO("LD",   &op_ld_reg16_a  , 2, 2),		/* opcode 0a */
-	OPINFO("DEC",  &op_dec16       , 2, 2),		/* opcode 0b */
-	OPINFO("INC",  &op_inc         , 1, 1),		/* opcode 0c */
-	OPINFO("DEC",  &op_dec         , 1, 1),		/* opcode 0d */
-	OPINFO("LD",   &op_ld_reg8_imm , 2, 2),		/* opcode 0e */
-	OPINFO("RRCA", &op_rrca        , 1, 1),		/* opcode 0f */
-	OPINFO("STOP", &op_stop        , 0, 0),		/* opcode 10 */
-	OPINFO("LD",   &op_ld_reg16_imm, 3, 3),		/* opcode 11 */
-	OPINFO("LD",   &op_ld_reg16_a  , 2, 2),		/* opcode 12 */
-	OPINFO("INC",  &op_inc16       , 2, 2),		/* opcode 13 */
-	OPINFO("INC",  &op_inc         , 1, 1),		/* opcode 14 */
-	OPINFO("DEC",  &op_dec         , 1, 1),		/* opcode 15 */
-	OPINFO("LD",   &op_ld_reg8_imm , 2, 2),		/* opcode 16 */
-	OPINFO("RLA",  &op_rla         , 1, 1),		/* opcode 17 */
-	OPINFO("JR",   &op_jr          , 3, 3),		/* opcode 18 */
-	OPINFO("ADD",  &op_add_hl      , 2, 2),		/* opcode 19 */
-	OPINFO("LD",   &op_ld_reg16_a  , 2, 2),		/* opcode 1a */
-	OPINFO("DEC",  &op_dec16       , 2, 2),		/* opcode 1b */
-	OPINFO("INC",  &op_inc         , 1, 1),		/* opcode 1c */
-	OPINFO("DEC",  &op_dec         , 1, 1),		/* opcode 1d */
-	OPINFO("LD",   &op_ld_reg8_imm , 2, 2),		/* opcode 1e */
-	OPINFO("RRA",  &op_rra         , 1, 1),		/* opcode 1f */
-	OPINFO("JR",   &op_jr_cond     , 2, 3),		/* opcode 20 */
-	OPINFO("LD",   &op_ld_reg16_imm, 3, 3),		/* opcode 21 */
-	OPINFO("LDI",  &op_ld_reg16_a  , 2, 2),		/* opcode 22 */
-	OPINFO("INC",  &op_inc16       , 2, 2),		/* opcode 23 */
-	OPINFO("INC",  &op_inc         , 1, 1),		/* opcode 24 */
-	OPINFO("DEC",  &op_dec         , 1, 1),		/* opcode 25 */
-	OPINFO("LD",   &op_ld_reg8_imm , 2, 2),		/* opcode 26 */
-	OPINFO("DAA",  &op_daa         , 1, 1),		/* opcode 27 */
-	OPINFO("JR",   &op_jr_cond     , 2, 3),		/* opcode 28 */
-	OPINFO("ADD",  &op_add_hl      , 2, 2),		/* opcode 29 */
-	OPINFO("LDI",  &op_ld_reg16_a  , 2, 2),		/* opcode 2a */
-	OPINFO("DEC",  &op_dec16       , 2, 2),		/* opcode 2b */
-	OPINFO("INC",  &op_inc         , 1, 1),		/* opcode 2c */
-	OPINFO("DEC",  &op_dec         , 1, 1),		/* opcode 2d */
-	OPINFO("LD",   &op_ld_reg8_imm , 2, 2),		/* opcode 2e */
-	OPINFO("CPL",  &op_cpl         , 1, 1),		/* opcode 2f */
-	OPINFO("JR",   &op_jr_cond     , 2, 3),		/* opcode 30 */
-	OPINFO("LD",   &op_ld_reg16_imm, 3, 3),		/* opcode 31 */
-	OPINFO("LDD",  &op_ld_reg16_a  , 2, 2),		/* opcode 32 */
-	OPINFO("INC",  &op_inc16       , 2, 2),		/* opcode 33 */
-	OPINFO("INC",  &op_inc         , 3, 3),		/* opcode 34 */
-	OPINFO("DEC",  &op_dec         , 3, 3),		/* opcode 35 */
-	OPINFO("LD",   &op_ld_reg8_imm , 3, 3),		/* opcode 36 */
-	OPINFO("SCF",  &op_scf         , 1, 1),		/* opcode 37 */
-	OPINFO("JR",   &op_jr_cond     , 2, 3),		/* opcode 38 */
-	OPINFO("ADD",  &op_add_hl      , 2, 2),		/* opcode 39 */
-	OPINFO("LDD",  &op_ld_reg16_a  , 2, 2),		/* opcode 3a */
-	OPINFO("DEC",  &op_dec16       , 2, 2),		/* opcode 3b */
-	OPINFO("INC",  &op_inc         , 1, 1),		/* opcode 3c */
-	OPINFO("DEC",  &op_dec         , 1, 1),		/* opcode 3d */
-	OPINFO("LD",   &op_ld_reg8_imm , 2, 2),		/* opcode 3e */
-	OPINFO("CCF",  &op_ccf         , 1, 1),		/* opcode 3f */
-	OPINFO("LD",   &op_ld          , 1, 1),		/* opcode 40 */
-	OPINFO("LD",   &op_ld          , 1, 1),		/* opcode 41 */
-	OPINFO("LD",   &op_ld          , 1, 1),		/* opcode 42 */
-	OPINFO("LD",   &op_ld          , 1, 1),		/* opcode 43 */
-	OPINFO("LD",   &op_ld          , 1, 1),		/* opcode 44 */
-	OPINFO("LD",   &op_ld          , 1, 1),		/* opcode 45 */
-	OPINFO("LD",   &op_ld          , 2, 2),		/* opcode 46 */
-	OPINFO("LD",   &op_ld          , 1, 1),		/* opcode 47 */
-	OPINFO("LD",   &op_ld          , 1, 1),		/* opcode 48 */
-	OPINFO("LD",   &op_ld          , 1, 1),		/* opcode 49 */
-	OPINFO("LD",   &op_ld          , 1, 1),		/* opcode 4a */
-	OPINFO("LD",   &op_ld          , 1, 1),		/* opcode 4b */
-	OPINFO("LD",   &op_ld          , 1, 1),		/* opcode 4c */
-	OPINFO("LD",   &op_ld          , 1, 1),		/* opcode 4d */
-	OPINFO("LD",   &op_ld          , 2, 2),		/* opcode 4e */
-	OPINFO("LD",   &op_ld          , 1, 1),		/* opcode 4f */
-	OPINFO("LD",   &op_ld          , 1, 1),		/* opcode 50 */
-	OPINFO("LD",   &op_ld          , 1, 1),		/* opcode 51 */
-	OPINFO("LD",   &op_ld          , 1, 1),		/* opcode 52 */
-	OPINFO("LD",   &op_ld          , 1, 1),		/* opcode 53 */
-	OPINFO("LD",   &op_ld          , 1, 1),		/* opcode 54 */
-	OPINFO("LD",   &op_ld          , 1, 1),		/* opcode 55 */
-	OPINFO("LD",   &op_ld          , 2, 2),		/* opcode 56 */
-	OPINFO("LD",   &op_ld          , 1, 1),		/* opcode 57 */
-	OPINFO("LD",   &op_ld          , 1, 1),		/* opcode 58 */
-	OPINFO("LD",   &op_ld          , 1, 1),		/* opcode 59 */
-	OPINFO("LD",   &op_ld          , 1, 1),		/* opcode 5a */
-	OPINFO("LD",   &op_ld          , 1, 1),		/* opcode 5b */
-	OPINFO("LD",   &op_ld          , 1, 1),		/* opcode 5c */
-	OPINFO("LD",   &op_ld          , 1, 1),		/* opcode 5d */
-	OPINFO("LD",   &op_ld          , 2, 2),		/* opcode 5e */
-	OPINFO("LD",   &op_ld          , 1, 1),		/* opcode 5f */
-	OPINFO("LD",   &op_ld          , 1, 1),		/* opcode 60 */
-	OPINFO("LD",   &op_ld          , 1, 1),		/* opcode 61 */
-	OPINFO("LD",   &op_ld          , 1, 1),		/* opcode 62 */
-	OPINFO("LD",   &op_ld          , 1, 1),		/* opcode 63 */
-	OPINFO("LD",   &op_ld          , 1, 1),		/* opcode 64 */
-	OPINFO("LD",   &op_ld          , 1, 1),		/* opcode 65 */
-	OPINFO("LD",   &op_ld          , 2, 2),		/* opcode 66 */
-	OPINFO("LD",   &op_ld          , 1, 1),		/* opcode 67 */
-	OPINFO("LD",   &op_ld          , 1, 1),		/* opcode 68 */
-	OPINFO("LD",   &op_ld          , 1, 1),		/* opcode 69 */
-	OPINFO("LD",   &op_ld          , 1, 1),		/* opcode 6a */
-	OPINFO("LD",   &op_ld          , 1, 1),		/* opcode 6b */
-	OPINFO("LD",   &op_ld          , 1, 1),		/* opcode 6c */
-	OPINFO("LD",   &op_ld          , 1, 1),		/* opcode 6d */
-	OPINFO("LD",   &op_ld          , 2, 2),		/* opcode 6e */
-	OPINFO("LD",   &op_ld          , 1, 1),		/* opcode 6f */
-	OPINFO("LD",   &op_ld          , 2, 2),		/* opcode 70 */
-	OPINFO("LD",   &op_ld          , 2, 2),		/* opcode 71 */
-	OPINFO("LD",   &op_ld          , 2, 2),		/* opcode 72 */
-	OPINFO("LD",   &op_ld          , 2, 2),		/* opcode 73 */
-	OPINFO("LD",   &op_ld          , 2, 2),		/* opcode 74 */
-	OPINFO("LD",   &op_ld          , 2, 2),		/* opcode 75 */
-	OPINFO("HALT", &op_halt        , 0, 0),		/* opcode 76 */
-	OPINFO("LD",   &op_ld          , 2, 2),		/* opcode 77 */
-	OPINFO("LD",   &op_ld          , 1, 1),		/* opcode 78 */
-	OPINFO("LD",   &op_ld          , 1, 1),		/* opcode 79 */
-	OPINFO("LD",   &op_ld          , 1, 1),		/* opcode 7a */
-	OPINFO("LD",   &op_ld          , 1, 1),		/* opcode 7b */
-	OPINFO("LD",   &op_ld          , 1, 1),		/* opcode 7c */
-	OPINFO("LD",   &op_ld          , 1, 1),		/* opcode 7d */
-	OPINFO("LD",   &op_ld          , 2, 2),		/* opcode 7e */
-	OPINFO("LD",   &op_ld          , 1, 1),		/* opcode 7f */
-	OPINFO("ADD",  &op_add         , 1, 1),		/* opcode 80 */
-	OPINFO("ADD",  &op_add         , 1, 1),		/* opcode 81 */
-	OPINFO("ADD",  &op_add         , 1, 1),		/* opcode 82 */
-	OPINFO("ADD",  &op_add         , 1, 1),		/* opcode 83 */
-	OPINFO("ADD",  &op_add         , 1, 1),		/* opcode 84 */
-	OPINFO("ADD",  &op_add         , 1, 1),		/* opcode 85 */
-	OPINFO("ADD",  &op_add         , 2, 2),		/* opcode 86 */
-	OPINFO("ADD",  &op_add         , 1, 1),		/* opcode 87 */
-	OPINFO("ADC",  &op_adc         , 1, 1),		/* opcode 88 */
-	OPINFO("ADC",  &op_adc         , 1, 1),		/* opcode 89 */
-	OPINFO("ADC",  &op_adc         , 1, 1),		/* opcode 8a */
-	OPINFO("ADC",  &op_adc         , 1, 1),		/* opcode 8b */
-	OPINFO("ADC",  &op_adc         , 1, 1),		/* opcode 8c */
-	OPINFO("ADC",  &op_adc         , 1, 1),		/* opcode 8d */
-	OPINFO("ADC",  &op_adc         , 2, 2),		/* opcode 8e */
-	OPINFO("ADC",  &op_adc         , 1, 1),		/* opcode 8f */
-	OPINFO("SUB",  &op_sub         , 1, 1),		/* opcode 90 */
-	OPINFO("SUB",  &op_sub         , 1, 1),		/* opcode 91 */
-	OPINFO("SUB",  &op_sub         , 1, 1),		/* opcode 92 */
-	OPINFO("SUB",  &op_sub         , 1, 1),		/* opcode 93 */
-	OPINFO("SUB",  &op_sub         , 1, 1),		/* opcode 94 */
-	OPINFO("SUB",  &op_sub         , 1, 1),		/* opcode 95 */
-	OPINFO("SUB",  &op_sub         , 2, 2),		/* opcode 96 */
-	OPINFO("SUB",  &op_sub         , 1, 1),		/* opcode 97 */
-	OPINFO("SBC",  &op_sbc         , 1, 1),		/* opcode 98 */
-	OPINFO("SBC",  &op_sbc         , 1, 1),		/* opcode 99 */
-	OPINFO("SBC",  &op_sbc         , 1, 1),		/* opcode 9a */
-	OPINFO("SBC",  &op_sbc         , 1, 1),		/* opcode 9b */
-	OPINFO("SBC",  &op_sbc         , 1, 1),		/* opcode 9c */
-	OPINFO("SBC",  &op_sbc         , 1, 1),		/* opcode 9d */
-	OPINFO("SBC",  &op_sbc         , 2, 2),		/* opcode 9e */
-	OPINFO("SBC",  &op_sbc         , 1, 1),		/* opcode 9f */
-	OPINFO("AND",  &op_and         , 1, 1),		/* opcode a0 */
-	OPINFO("AND",  &op_and         , 1, 1),		/* opcode a1 */
-	OPINFO("AND",  &op_and         , 1, 1),		/* opcode a2 */
-	OPINFO("AND",  &op_and         , 1, 1),		/* opcode a3 */
-	OPINFO("AND",  &op_and         , 1, 1),		/* opcode a4 */
-	OPINFO("AND",  &op_and         , 1, 1),		/* opcode a5 */
-	OPINFO("AND",  &op_and         , 2, 2),		/* opcode a6 */
-	OPINFO("AND",  &op_and         , 1, 1),		/* opcode a7 */
-	OPINFO("XOR",  &op_xor         , 1, 1),		/* opcode a8 */
-	OPINFO("XOR",  &op_xor         , 1, 1),		/* opcode a9 */
-	OPINFO("XOR",  &op_xor         , 1, 1),		/* opcode aa */
-	OPINFO("XOR",  &op_xor         , 1, 1),		/* opcode ab */
-	OPINFO("XOR",  &op_xor         , 1, 1),		/* opcode ac */
-	OPINFO("XOR",  &op_xor         , 1, 1),		/* opcode ad */
-	OPINFO("XOR",  &op_xor         , 2, 2),		/* opcode ae */
-	OPINFO("XOR",  &op_xor         , 1, 1),		/* opcode af */
-	OPINFO("OR",   &op_or          , 1, 1),		/* opcode b0 */
-	OPINFO("OR",   &op_or          , 1, 1),		/* opcode b1 */
-	OPINFO("OR",   &op_or          , 1, 1),		/* opcode b2 */
-	OPINFO("OR",   &op_or          , 1, 1),		/* opcode b3 */
-	OPINFO("OR",   &op_or          , 1, 1),		/* opcode b4 */
-	OPINFO("OR",   &op_or          , 1, 1),		/* opcode b5 */
-	OPINFO("OR",   &op_or          , 2, 2),		/* opcode b6 */
-	OPINFO("OR",   &op_or          , 1, 1),		/* opcode b7 */
-	OPINFO("CP",   &op_cp          , 1, 1),		/* opcode b8 */
-	OPINFO("CP",   &op_cp          , 1, 1),		/* opcode b9 */
-	OPINFO("CP",   &op_cp          , 1, 1),		/* opcode ba */
-	OPINFO("CP",   &op_cp          , 1, 1),		/* opcode bb */
-	OPINFO("CP",   &op_cp          , 1, 1),		/* opcode bc */
-	OPINFO("CP",   &op_cp          , 1, 1),		/* opcode bd */
-	OPINFO("CP",   &op_cp          , 2, 2),		/* opcode be */
-	OPINFO("CP",   &op_cp          , 1, 1),		/* opcode bf */
-	OPINFO("RET",  &op_ret_cond    , 2, 5),		/* opcode c0 */
-	OPINFO("POP",  &op_pop         , 3, 3),		/* opcode c1 */
-	OPINFO("JP",   &op_jp_cond     , 3, 4),		/* opcode c2 */
-	OPINFO("JP",   &op_jp          , 4, 4),		/* opcode c3 */
-	OPINFO("CALL", &op_call_cond   , 3, 6),		/* opcode c4 */
-	OPINFO("PUSH", &op_push        , 4, 4),		/* opcode c5 */
-	OPINFO("ADD",  &op_add_imm     , 2, 2),		/* opcode c6 */
-	OPINFO("RST",  &op_rst         , 4, 4),		/* opcode c7 */
-	OPINFO("RET",  &op_ret_cond    , 2, 5),		/* opcode c8 */
-	OPINFO("RET",  &op_ret         , 4, 4),		/* opcode c9 */
-	OPINFO("JP",   &op_jp_cond     , 3, 4),		/* opcode ca */
-	OPINFO("CBPREFIX", &op_cbprefix, 0, 0),		/* opcode cb */
-	OPINFO("CALL", &op_call_cond   , 3, 6),		/* opcode cc */
-	OPINFO("CALL", &op_call        , 6, 6),		/* opcode cd */
-	OPINFO("ADC",  &op_adc_imm     , 2, 2),		/* opcode ce */
-	OPINFO("RST",  &op_rst         , 4, 4),		/* opcode cf */
-	OPINFO("RET",  &op_ret_cond    , 2, 5),		/* opcode d0 */
-	OPINFO("POP",  &op_pop         , 3, 3),		/* opcode d1 */
-	OPINFO("JP",   &op_jp_cond     , 3, 4),		/* opcode d2 */
-	OPINFO("UNKN", &op_unknown     , 0, 0),		/* opcode d3 */
-	OPINFO("CALL", &op_call_cond   , 3, 6),		/* opcode d4 */
-	OPINFO("PUSH", &op_push        , 4, 4),		/* opcode d5 */
-	OPINFO("SUB",  &op_sub_imm     , 2, 2),		/* opcode d6 */
-	OPINFO("RST",  &op_rst         , 4, 4),		/* opcode d7 */
-	OPINFO("RET",  &op_ret_cond    , 2, 5),		/* opcode d8 */
-	OPINFO("RETI", &op_reti        , 4, 4),		/* opcode d9 */
-	OPINFO("JP",   &op_jp_cond     , 3, 4),		/* opcode da */
-	OPINFO("UNKN", &op_unknown     , 0, 0),		/* opcode db */
-	OPINFO("CALL", &op_call_cond   , 3, 6),		/* opcode dc */
-	OPINFO("UNKN", &op_unknown     , 0, 0),		/* opcode dd */
-	OPINFO("SBC",  &op_sbc_imm     , 2, 2),		/* opcode de */
-	OPINFO("RST",  &op_rst         , 4, 4),		/* opcode df */
-	OPINFO("LDH",  &op_ldh         , 3, 3),		/* opcode e0 */
-	OPINFO("POP",  &op_pop         , 3, 3),		/* opcode e1 */
-	OPINFO("LDH",  &op_ldh         , 2, 2),		/* opcode e2 */
-	OPINFO("UNKN", &op_unknown     , 0, 0),		/* opcode e3 */
-	OPINFO("UNKN", &op_unknown     , 0, 0),		/* opcode e4 */
-	OPINFO("PUSH", &op_push        , 4, 4),		/* opcode e5 */
-	OPINFO("AND",  &op_and_imm     , 2, 2),		/* opcode e6 */
-	OPINFO("RST",  &op_rst         , 4, 4),		/* opcode e7 */
-	OPINFO("ADD",  &op_add_sp_imm  , 4, 4),		/* opcode e8 */
-	OPINFO("JP",   &op_jp_hl       , 1, 1),		/* opcode e9 */
-	OPINFO("LD",   &op_ld_ind16_a  , 4, 4),		/* opcode ea */
-	OPINFO("UNKN", &op_unknown     , 0, 0),		/* opcode eb */
-	OPINFO("UNKN", &op_unknown     , 0, 0),		/* opcode ec */
-	OPINFO("UNKN", &op_unknown     , 0, 0),		/* opcode ed */
-	OPINFO("XOR",  &op_xor_imm     , 2, 2),		/* opcode ee */
-	OPINFO("RST",  &op_rst         , 4, 4),		/* opcode ef */
-	OPINFO("LDH",  &op_ldh         , 3, 3),		/* opcode f0 */
-	OPINFO("POP",  &op_pop_af      , 3, 3),		/* opcode f1 */
-	OPINFO("LDH",  &op_ldh         , 2, 2),		/* opcode f2 */
-	OPINFO("DI",   &op_di          , 1, 1),		/* opcode f3 */
-	OPINFO("UNKN", &op_unknown     , 0, 0),		/* opcode f4 */
-	OPINFO("PUSH", &op_push_af     , 4, 4),		/* opcode f5 */
-	OPINFO("OR",   &op_or_imm      , 2, 2),		/* opcode f6 */
-	OPINFO("RST",  &op_rst         , 4, 4),		/* opcode f7 */
-	OPINFO("LD",   &op_ld_hlsp     , 3, 3),		/* opcode f8 */
-	OPINFO("LD",   &op_ld_sphl     , 2, 2),		/* opcode f9 */
-	OPINFO("LD",   &op_ld_imm      , 4, 4),		/* opcode fa */
-	OPINFO("EI",   &op_ei          , 1, 1),		/* opcode fb */
-	OPINFO("UNKN", &op_unknown     , 0, 0),		/* opcode fc */
-	OPINFO("UNKN", &op_unknown     , 0, 0),		/* opcode fd */
-	OPINFO("CP", &op_cp_imm        , 2, 2),		/* opcode fe */
-	OPINFO("RST", &op_rst          , 4, 4),		/* opcode ff */
+	OPTABLE(OPTABLE_ENTRY)
 };
 
 #if DEBUG == 1
@@ -1603,7 +1493,108 @@ void gbcpu_add_mem(struct gbcpu* const gbcpu, uint32_t start, uint32_t end, gbcp
 		gbcpu->putlookup[i].priv = priv;
 		gbcpu->getlookup[i].get = getfn;
 		gbcpu->getlookup[i].priv = priv;
+		gbcpu->rdpage[i] = NULL;
+		gbcpu->wrpage[i] = NULL;
+		gbcpu->codebank[i] = -1;
+	}
+	icache_flush(gbcpu);
+}
+
+/*
+ * Let reads (rdmem) and/or writes (wrmem) of pages start to end bypass
+ * the callbacks registered with gbcpu_add_mem() and access host memory
+ * directly.  Both point to the memory backing page start, the following
+ * pages are consecutive.  NULL restores the callback for that direction.
+ * Only for memory without side effects, mappers call this again on every
+ * bank switch.
+ */
+void gbcpu_map_direct(struct gbcpu* const gbcpu, uint32_t start, uint32_t end, const uint8_t *rdmem, uint8_t *wrmem)
+{
+	uint32_t i;
+
+	for (i=start; i<=end; i++) {
+		gbcpu->rdpage[i] = rdmem ? rdmem + ((i - start) << 8) : NULL;
+		gbcpu->wrpage[i] = wrmem ? wrmem + ((i - start) << 8) : NULL;
+	}
+}
+
+/*
+ * Declare pages start to end as read-only code from ROM bank "bank",
+ * so that instructions fetched from there may be cached.  bank is
+ * part of the cache tag, mappers call this again on every bank switch.
+ * bank -1 disables caching for the pages.
+ */
+void gbcpu_set_codebank(struct gbcpu* const gbcpu, uint32_t start, uint32_t end, long bank)
+{
+	uint32_t i;
+
+	for (i=start; i<=end; i++)
+		gbcpu->codebank[i] = bank;
+}
+
+/*
+ * Length of instructions whose only effects are register updates and
+ * memory reads, 0 for everything else (stores, stack, IME, HALT, ...).
+ */
+static long idle_oplen(uint32_t op, uint32_t cb)
+{
+	if (op >= 0x40 && op <= 0x7f)
+		return op >= 0x70 && op <= 0x77 ? 0 : 1;
+	if (op >= 0x80 && op <= 0xbf)
+		return 1;
+	switch (op) {
+	case 0x00: case 0x07: case 0x0f: case 0x17: case 0x1f:
+	case 0x27: case 0x2f: case 0x37: case 0x3f:
+	case 0x03: case 0x0b: case 0x13: case 0x1b:
+	case 0x23: case 0x2b: case 0x33: case 0x3b:
+	case 0x04: case 0x05: case 0x0c: case 0x0d:
+	case 0x14: case 0x15: case 0x1c: case 0x1d:
+	case 0x24: case 0x25: case 0x2c: case 0x2d:
+	case 0x3c: case 0x3d:
+	case 0x09: case 0x19: case 0x29: case 0x39:
+	case 0x0a: case 0x1a: case 0x2a: case 0x3a:
+	case 0xe9: case 0xf2:
+		return 1;
+	case 0x06: case 0x0e: case 0x16: case 0x1e:
+	case 0x26: case 0x2e: case 0x3e:
+	case 0x18: case 0x20: case 0x28: case 0x30: case 0x38:
+	case 0xc6: case 0xce: case 0xd6: case 0xde:
+	case 0xe6: case 0xee: case 0xf6: case 0xfe:
+	case 0xf0:
+		return 2;
+	case 0xcb:
+		/* bit n,r and (hl), rotate/res/set on registers only */
+		return (cb >= 0x40 && cb <= 0x7f) || (cb & 7) != 6 ? 2 : 0;
+	case 0x01: case 0x11: case 0x21: case 0x31:
+	case 0xc2: case 0xc3: case 0xca: case 0xd2: case 0xda:
+	case 0xfa:
+		return 3;
+	}
+	return 0;
+}
+
+/*
+ * Check whether the code from head up to and including the instruction
+ * at tail (usually a jump back to head) consists of instructions that
+ * only read memory and update registers.  As long as execution stays
+ * in that range and nothing external changes the memory it reads, such
+ * a loop cannot change any state but the registers.
+ */
+long gbcpu_idle_loop(struct gbcpu* const gbcpu, uint16_t head, uint16_t tail)
+{
+	uint32_t pc = head;
+
+	while (pc <= tail) {
+		uint32_t op = mem_peek(gbcpu, pc);
+		long len = idle_oplen(op, op == 0xcb ? mem_peek(gbcpu, pc + 1) : 0);
+
+		if (len == 0)
+			return 0;
+		if (pc == tail)
+			return 1;
+		pc += len;
 	}
+	return 0;
 }
 
 void gbcpu_init(struct gbcpu* const gbcpu)
@@ -1614,9 +1605,47 @@ void gbcpu_init(struct gbcpu* const gbcpu)
 	gbcpu->stopped = 0;
 	gbcpu->ime = 0;
 	gbcpu->halt_at_pc = -1;
+	gbcpu->run_cycles = 0;
+	gbcpu->run_break = 0;
+#if GBCPU_LAZY_FLAGS == 1
+	gbcpu->lf_pending = 0;
+#endif
 	DEB(dump_regs(gbcpu));
 }
 
+void gbcpu_sync_flags(struct gbcpu* const gbcpu)
+{
+	flags_sync(gbcpu);
+}
+
+void gbcpu_save_state(struct gbcpu* const gbcpu, struct savestate *s)
+{
+	long i;
+
+	flags_sync(gbcpu);
+	for (i = BC; i <= GBS_PC; i++)
+		state_put(s, REGS16_R(gbcpu->regs, i), 2);
+	state_put_long(s, gbcpu->halt_at_pc);
+	state_put(s, gbcpu->halted, 1);
+	state_put(s, gbcpu->ime, 1);
+	state_put(s, gbcpu->stopped, 1);
+}
+
+void gbcpu_load_state(struct gbcpu* const gbcpu, struct savestate *s)
+{
+	long i;
+
+	for (i = BC; i <= GBS_PC; i++)
+		REGS16_W(gbcpu->regs, i, state_get(s, 2));
+	gbcpu->halt_at_pc = state_get_long(s);
+	gbcpu->halted = state_get(s, 1);
+	gbcpu->ime = state_get(s, 1);
+	gbcpu->stopped = state_get(s, 1);
+#if GBCPU_LAZY_FLAGS == 1
+	gbcpu->lf_pending = 0;
+#endif
+}
+
 void gbcpu_intr(struct gbcpu* const gbcpu, long vec)
 {
 	DPRINTF("gbcpu_intr(%04lx)\n", vec);
@@ -1626,11 +1655,36 @@ void gbcpu_intr(struct gbcpu* const gbcpu, long vec)
 	REGS16_W(gbcpu->regs, GBS_PC, vec);
 }
 
-long gbcpu_step(struct gbcpu* const gbcpu)
+static inline long step_done(struct gbcpu* const gbcpu)
+{
+	if (gbcpu->halt_at_pc != -1 &&
+	    REGS16_R(gbcpu->regs, GBS_PC) == gbcpu->halt_at_pc) {
+		DPRINTF("halted at GBS_PC %04lx\n", gbcpu->halt_at_pc);
+		gbcpu->halted = 1;
+		gbcpu->ime = 1;
+	}
+	return gbcpu->cycles;
+}
+
+/*
+ * gbcpu_run() executes instructions until budget cycles have passed,
+ * the CPU halts, IME changes so that a pending interrupt may be taken,
+ * or a memory callback sets run_break.  It returns the cycles run,
+ * 0 if the CPU is halted.
+ */
+static inline long run_on(struct gbcpu* const gbcpu, long budget, long ime)
+{
+	return gbcpu->run_cycles < budget && !gbcpu->run_break &&
+	       !gbcpu->halted && gbcpu->ime == ime;
+}
+
+/* Reference core, always built: dispatch through the ops[] table. */
+long gbcpu_step_ref(struct gbcpu* const gbcpu)
 {
 	uint8_t op;
 
 	if (!gbcpu->halted) {
+		flags_sync(gbcpu);
 		op = mem_get(gbcpu, gbcpu->regs.rn.pc++);
 		gbcpu->cycles = 4;
 		DPRINTF("%04x: %02x", gbcpu->regs.rn.pc - 1, op);
@@ -1638,14 +1692,414 @@ long gbcpu_step(struct gbcpu* const gbcpu)
 
 		DEB(show_reg_diffs(gbcpu, &ops[op]));
 
-		if (gbcpu->halt_at_pc != -1 &&
-		    REGS16_R(gbcpu->regs, GBS_PC) == gbcpu->halt_at_pc) {
-			DPRINTF("halted at GBS_PC %04lx\n", gbcpu->halt_at_pc);
-			gbcpu->halted = 1;
-			gbcpu->ime = 1;
-		}
-		return gbcpu->cycles;
+		return step_done(gbcpu);
+	}
+	if (gbcpu->stopped) return -1;
+	return GBCPU_HALT_CYCLES;
+}
+
+#if GBCPU_THREADED == 1
+/*
+ * The threaded core jumps straight to a per-opcode label, either via
+ * a table of label addresses (GCC/Clang computed goto) or via a plain
+ * switch, and runs the specialized handler generated for that opcode
+ * by gen_gbcpu_ops_h, so no operands are decoded at runtime.
+ */
+#if defined(__GNUC__)
+#define DISPATCH_ADDR(l) &&l,
+#define DISPATCH_BEGIN(table, addrs, op) \
+	{ \
+		static const void* const table[256] = { addrs }; \
+		goto *table[op];
+#define DISPATCH_TARGET(l, opc) l
+#define DISPATCH_END }
+#else
+#define DISPATCH_ADDR(l)
+#define DISPATCH_BEGIN(table, addrs, op) switch (op) {
+#define DISPATCH_TARGET(l, opc) case opc
+#define DISPATCH_END }
+#endif
+
+#include "gbcpu_ops.h"
+
+#if GBCPU_ICACHE == 1
+/* Returns the cached instruction at pc, or NULL if it is not cacheable. */
+static inline const uint8_t *icache_fetch(struct gbcpu* const gbcpu, uint32_t pc)
+{
+	long bank = gbcpu->codebank[pc >> 8];
+	uint32_t tag = bank << 16 | pc;
+	struct gbcpu_icache_entry *e;
+	long i, len;
+
+	if (bank < 0) {
+		gbcpu->icache_uncached++;
+		return NULL;
+	}
+	e = &gbcpu->icache[(pc ^ bank << 7) & (GBCPU_ICACHE_SIZE - 1)];
+	if (e->tag == tag) {
+		gbcpu->icache_hits++;
+		return e->code;
+	}
+
+	e->code[0] = mem_peek(gbcpu, pc);
+	len = gen_oplen[e->code[0]];
+	/* the immediates must come from the same bank */
+	if (gbcpu->codebank[((pc + len - 1) >> 8) & 0xff] != bank) {
+		e->tag = ~0;
+		gbcpu->icache_uncached++;
+		return NULL;
+	}
+	for (i = 1; i < len; i++)
+		e->code[i] = mem_peek(gbcpu, pc + i);
+	e->len = len;
+	e->tag = tag;
+	gbcpu->icache_misses++;
+	return e->code;
+}
+#endif
+
+#define OP_ADDR(opc, name, fn, cycles_1, cycles_2) DISPATCH_ADDR(opc_##opc)
+#define OP_BODY(opc, name, fn, cycles_1, cycles_2) \
+	DISPATCH_TARGET(opc_##opc, 0x##opc): \
+		gen_op_##opc(gbcpu); goto done;
+
+/* Inline the generated handlers into their dispatch labels. */
+#if defined(__GNUC__)
+__attribute__((flatten))
+#endif
+long gbcpu_step(struct gbcpu* const gbcpu)
+{
+	uint8_t op;
+
+	if (!gbcpu->halted) {
+		uint16_t pc = gbcpu->regs.rn.pc++;
+#if GBCPU_ICACHE == 1
+		const uint8_t *code = icache_fetch(gbcpu, pc);
+
+		if (code) {
+			op = code[0];
+			gbcpu->prefetch = code + 1;
+		} else
+#endif
+		op = mem_get(gbcpu, pc);
+		gbcpu->cycles = 4;
+		DPRINTF("%04x: %02x", pc, op);
+		DISPATCH_BEGIN(dispatch, OPTABLE(OP_ADDR), op)
+		OPTABLE(OP_BODY)
+		DISPATCH_END
+done:
+#if GBCPU_ICACHE == 1
+		gbcpu->prefetch = NULL;
+#endif
+		DEB(show_reg_diffs(gbcpu, &ops[op]));
+
+		return step_done(gbcpu);
 	}
 	if (gbcpu->stopped) return -1;
-	return 16;
+	return GBCPU_HALT_CYCLES;
+}
+
+/* Same dispatch, but the loop stays inside one flattened function. */
+#if defined(__GNUC__)
+__attribute__((flatten))
+#endif
+long gbcpu_run(struct gbcpu* const gbcpu, long budget)
+{
+	long ime = gbcpu->ime;
+	uint8_t op;
+
+	gbcpu->run_cycles = 0;
+	gbcpu->run_break = 0;
+	if (gbcpu->halted)
+		return 0;
+	do {
+		uint16_t pc = gbcpu->regs.rn.pc++;
+#if GBCPU_ICACHE == 1
+		const uint8_t *code = icache_fetch(gbcpu, pc);
+
+		if (code) {
+			op = code[0];
+			gbcpu->prefetch = code + 1;
+		} else
+#endif
+		op = mem_get(gbcpu, pc);
+		gbcpu->cycles = 4;
+		DPRINTF("%04x: %02x", pc, op);
+		DISPATCH_BEGIN(dispatch, OPTABLE(OP_ADDR), op)
+		OPTABLE(OP_BODY)
+		DISPATCH_END
+done:
+#if GBCPU_ICACHE == 1
+		gbcpu->prefetch = NULL;
+#endif
+		DEB(show_reg_diffs(gbcpu, &ops[op]));
+
+		gbcpu->run_cycles += step_done(gbcpu);
+	} while (run_on(gbcpu, budget, ime));
+	return gbcpu->run_cycles;
+}
+#else
+long gbcpu_step(struct gbcpu* const gbcpu)
+{
+	return gbcpu_step_ref(gbcpu);
+}
+
+long gbcpu_run(struct gbcpu* const gbcpu, long budget)
+{
+	long ime = gbcpu->ime;
+
+	gbcpu->run_cycles = 0;
+	gbcpu->run_break = 0;
+	if (gbcpu->halted)
+		return 0;
+	do {
+		gbcpu->run_cycles += gbcpu_step_ref(gbcpu);
+	} while (run_on(gbcpu, budget, ime));
+	return gbcpu->run_cycles;
+}
+#endif
+
+static uint32_t test_mem_get(void *priv, uint32_t addr)
+{
+	uint8_t *mem = priv;
+	return mem[addr & 0xffff];
+}
+
+static void test_mem_put(void *priv, uint32_t addr, uint8_t val)
+{
+	uint8_t *mem = priv;
+	mem[addr & 0xffff] = val;
+}
+
+static void test_rom_put(void *priv, uint32_t addr, uint8_t val)
+{
+	UNUSED(priv);
+	UNUSED(addr);
+	UNUSED(val);
+}
+
+/* 32k of cacheable ROM, then RAM */
+static void test_add_mem(struct gbcpu* const gbcpu, uint8_t *mem)
+{
+	gbcpu_add_mem(gbcpu, 0x00, 0x7f, test_rom_put, test_mem_get, mem);
+	gbcpu_add_mem(gbcpu, 0x80, 0xff, test_mem_put, test_mem_get, mem);
+	gbcpu_set_codebank(gbcpu, 0x00, 0x7f, 1);
+}
+
+test void test_map_direct()
+{
+	static struct gbcpu gbcpu;
+	static uint8_t mem[0x10000], host[0x200];
+	long i;
+
+	gbcpu_init_struct(&gbcpu);
+	gbcpu_init(&gbcpu);
+	gbcpu_add_mem(&gbcpu, 0x00, 0xff, test_mem_put, test_mem_get, mem);
+	for (i = 0; i < 0x200; i++)
+		host[i] = i ^ 0x5a;
+
+	/* reads from host memory, writes still through the callback */
+	gbcpu_map_direct(&gbcpu, 0x40, 0x41, host, NULL);
+	ASSERT_EQUAL("%02x", gbcpu_mem_get(&gbcpu, 0x4000), 0x5a);
+	ASSERT_EQUAL("%02x", gbcpu_mem_get(&gbcpu, 0x41ff), 0xff ^ 0x5a);
+	ASSERT_EQUAL("%02x", gbcpu_mem_get(&gbcpu, 0x4200), 0x00);
+	gbcpu_mem_put(&gbcpu, 0x4110, 0x99);
+	ASSERT_EQUAL("%02x", mem[0x4110], 0x99);
+	ASSERT_EQUAL("%02x", host[0x110], 0x10 ^ 0x5a);
+
+	/* both directions */
+	gbcpu_map_direct(&gbcpu, 0xc0, 0xc0, host, host);
+	gbcpu_mem_put(&gbcpu, 0xc012, 0x77);
+	ASSERT_EQUAL("%02x", host[0x12], 0x77);
+	ASSERT_EQUAL("%02x", mem[0xc012], 0x00);
+	ASSERT_EQUAL("%02x", gbcpu_mem_get(&gbcpu, 0xc012), 0x77);
+
+	/* NULL and gbcpu_add_mem() restore the callbacks */
+	gbcpu_map_direct(&gbcpu, 0x40, 0x41, NULL, NULL);
+	ASSERT_EQUAL("%02x", gbcpu_mem_get(&gbcpu, 0x4110), 0x99);
+	gbcpu_add_mem(&gbcpu, 0xc0, 0xc0, test_mem_put, test_mem_get, mem);
+	ASSERT_EQUAL("%02x", gbcpu_mem_get(&gbcpu, 0xc012), 0x00);
+}
+
+test void test_idle_loop()
+{
+	static struct gbcpu gbcpu;
+	static uint8_t mem[0x10000];
+	/* ldh a,(44); cp 90; jr nz,-6 */
+	static const uint8_t poll_ly[] = { 0xf0, 0x44, 0xfe, 0x90, 0x20, 0xfa };
+	/* ldh a,(44); ldh (80),a; jr nz,-6 */
+	static const uint8_t store[] = { 0xf0, 0x44, 0xe0, 0x80, 0x20, 0xfa };
+	/* bit 0,(hl); jr z,-4 */
+	static const uint8_t bit_hl[] = { 0xcb, 0x46, 0x28, 0xfc };
+	/* res 0,(hl); jr -4 */
+	static const uint8_t res_hl[] = { 0xcb, 0x86, 0x18, 0xfc };
+
+	gbcpu_init_struct(&gbcpu);
+	gbcpu_init(&gbcpu);
+	test_add_mem(&gbcpu, mem);
+
+	memcpy(&mem[0x1000], poll_ly, sizeof(poll_ly));
+	ASSERT_EQUAL("%ld", gbcpu_idle_loop(&gbcpu, 0x1000, 0x1004), 1L);
+	/* tail must be an instruction boundary */
+	ASSERT_EQUAL("%ld", gbcpu_idle_loop(&gbcpu, 0x1000, 0x1005), 0L);
+	ASSERT_EQUAL("%ld", gbcpu_idle_loop(&gbcpu, 0x1000, 0x1003), 0L);
+	memcpy(&mem[0x1000], store, sizeof(store));
+	ASSERT_EQUAL("%ld", gbcpu_idle_loop(&gbcpu, 0x1000, 0x1004), 0L);
+	memcpy(&mem[0x1000], bit_hl, sizeof(bit_hl));
+	ASSERT_EQUAL("%ld", gbcpu_idle_loop(&gbcpu, 0x1000, 0x1002), 1L);
+	memcpy(&mem[0x1000], res_hl, sizeof(res_hl));
+	ASSERT_EQUAL("%ld", gbcpu_idle_loop(&gbcpu, 0x1000, 0x1002), 0L);
+
+#if GBCPU_THREADED == 1
+	{
+		long op;
+
+		for (op = 0; op < 256; op++) {
+			long len = idle_oplen(op, 0);
+			if (len)
+				ASSERT_EQUAL("%ld", len, (long)gen_oplen[op]);
+		}
+	}
+#endif
+}
+
+test void test_gbcpu_step()
+{
+	static uint8_t mem[0x10000], ref_mem[0x10000], cpu_mem[0x10000];
+	static struct gbcpu ref, cpu;
+	uint32_t seed = 1;
+	long op, i, j, ref_cycles, cpu_cycles;
+
+	for (j = 0; j < 0x10000; j++) {
+		seed = seed * 1103515245 + 12345;
+		mem[j] = seed >> 16;
+	}
+
+	/* every opcode and CB opcode against the ops[] reference core */
+	for (op = 0; op < 0x200; op++) {
+		for (i = 0; i < 32; i++) {
+			gbcpu_init_struct(&ref);
+			gbcpu_init(&ref);
+			for (j = 0; j < 6; j++) {
+				seed = seed * 1103515245 + 12345;
+				REGS16_W(ref.regs, j, seed >> 8);
+			}
+			ref.regs.rn.f &= 0xf0;
+			ref.ime = i & 1;
+			memcpy(ref_mem, mem, sizeof(mem));
+			if (op < 0x100) {
+				ref_mem[ref.regs.rn.pc] = op;
+			} else {
+				ref_mem[ref.regs.rn.pc] = 0xcb;
+				ref_mem[(ref.regs.rn.pc + 1) & 0xffff] = op;
+			}
+			memcpy(cpu_mem, ref_mem, sizeof(mem));
+			cpu = ref;
+			test_add_mem(&ref, ref_mem);
+			test_add_mem(&cpu, cpu_mem);
+
+			ref_cycles = gbcpu_step_ref(&ref);
+			cpu_cycles = gbcpu_step(&cpu);
+			gbcpu_sync_flags(&cpu);
+
+			ASSERT_EQUAL("%ld", cpu_cycles, ref_cycles);
+			for (j = 0; j < 6; j++)
+				ASSERT_EQUAL("%04x", REGS16_R(cpu.regs, j), REGS16_R(ref.regs, j));
+			ASSERT_EQUAL("%ld", cpu.halted, ref.halted);
+			ASSERT_EQUAL("%ld", cpu.ime, ref.ime);
+			ASSERT_EQUAL("%d", memcmp(cpu_mem, ref_mem, sizeof(mem)), 0);
+		}
+	}
+}
+
+test void test_gbcpu_step_sequence()
+{
+	static uint8_t ref_mem[0x10000], cpu_mem[0x10000];
+	static struct gbcpu ref, cpu, tmp;
+	uint32_t seed = 2;
+	long run, i, j, ref_cycles, cpu_cycles;
+
+	/* random instruction streams, so flags are carried across instructions */
+	for (run = 0; run < 64; run++) {
+		for (j = 0; j < 0x10000; j++) {
+			seed = seed * 1103515245 + 12345;
+			ref_mem[j] = seed >> 16;
+		}
+		memcpy(cpu_mem, ref_mem, sizeof(ref_mem));
+		gbcpu_init_struct(&ref);
+		gbcpu_init(&ref);
+		for (j = 0; j < 6; j++) {
+			seed = seed * 1103515245 + 12345;
+			REGS16_W(ref.regs, j, seed >> 8);
+		}
+		ref.regs.rn.f &= 0xf0;
+		cpu = ref;
+		test_add_mem(&ref, ref_mem);
+		test_add_mem(&cpu, cpu_mem);
+
+		for (i = 0; i < 256; i++) {
+			ref.halted = cpu.halted = 0;
+			ref_cycles = gbcpu_step_ref(&ref);
+			cpu_cycles = gbcpu_step(&cpu);
+			ASSERT_EQUAL("%ld", cpu_cycles, ref_cycles);
+			tmp = cpu;
+			gbcpu_sync_flags(&tmp);
+			for (j = 0; j < 6; j++)
+				ASSERT_EQUAL("%04x", REGS16_R(tmp.regs, j), REGS16_R(ref.regs, j));
+		}
+		ASSERT_EQUAL("%d", memcmp(cpu_mem, ref_mem, sizeof(ref_mem)), 0);
+	}
+}
+test void test_gbcpu_run()
+{
+	static uint8_t ref_mem[0x10000], cpu_mem[0x10000];
+	static struct gbcpu ref, cpu, tmp;
+	uint32_t seed = 3;
+	long run, i, j, ref_cycles, cpu_cycles;
+
+	/* a run must end on the instruction where single steps end up */
+	for (run = 0; run < 64; run++) {
+		for (j = 0; j < 0x10000; j++) {
+			seed = seed * 1103515245 + 12345;
+			ref_mem[j] = seed >> 16;
+		}
+		memcpy(cpu_mem, ref_mem, sizeof(ref_mem));
+		gbcpu_init_struct(&ref);
+		gbcpu_init(&ref);
+		for (j = 0; j < 6; j++) {
+			seed = seed * 1103515245 + 12345;
+			REGS16_W(ref.regs, j, seed >> 8);
+		}
+		ref.regs.rn.f &= 0xf0;
+		cpu = ref;
+		test_add_mem(&ref, ref_mem);
+		test_add_mem(&cpu, cpu_mem);
+
+		for (i = 0; i < 64; i++) {
+			long ime = ref.ime;
+
+			ref.halted = cpu.halted = 0;
+			cpu_cycles = gbcpu_run(&cpu, 64);
+			for (ref_cycles = 0; ref_cycles < cpu_cycles; ) {
+				/* only the last instruction may halt or flip IME */
+				ASSERT_EQUAL("%ld", ref.halted, 0L);
+				ASSERT_EQUAL("%ld", ref.ime, ime);
+				ref_cycles += gbcpu_step_ref(&ref);
+			}
+			ASSERT_EQUAL("%ld", cpu_cycles, ref_cycles);
+			tmp = cpu;
+			gbcpu_sync_flags(&tmp);
+			for (j = 0; j < 6; j++)
+				ASSERT_EQUAL("%04x", REGS16_R(tmp.regs, j), REGS16_R(ref.regs, j));
+			ASSERT_EQUAL("%ld", cpu.halted, ref.halted);
+			ASSERT_EQUAL("%ld", cpu.ime, ref.ime);
+		}
+		ASSERT_EQUAL("%d", memcmp(cpu_mem, ref_mem, sizeof(ref_mem)), 0);
+	}
 }
+TEST(test_map_direct);
+TEST(test_idle_loop);
+TEST(test_gbcpu_step);
+TEST(test_gbcpu_step_sequence);
+TEST(test_gbcpu_run);
+TEST_EOF;
@@ -28,6 +28,44 @@
 
 #define DEBUG 0
 
+/*
+ * Interpreter core:
+ * 0 = dispatch through the ops[] function table (reference core)
+ * 1 = threaded dispatch of the generated per-opcode handlers
+ *     (computed goto on GCC/Clang, switch otherwise)
+ * The disassembly trace of DEBUG builds lives in the ops[] handlers.
+ */
+#ifndef GBCPU_THREADED
+#if DEBUG == 1
+#define GBCPU_THREADED 0
+#else
+#define GBCPU_THREADED 1
+#endif
+#endif
+
+/*
+ * Flag evaluation of the threaded core:
+ * 0 = compute F after every ALU op
+ * 1 = keep the last ALU result and compute F only when an instruction
+ *     reads it, see gbcpu_sync_flags()
+ * Lazy evaluation measured no faster than eager on gbcpubench, so the
+ * default stays 0.
+ */
+#ifndef GBCPU_LAZY_FLAGS
+#define GBCPU_LAZY_FLAGS 0
+#endif
+
+/*
+ * Decoded instruction cache of the threaded core for code running
+ * from ROM, keyed by (bank, PC), see gbcpu_set_codebank().
+ * Off by default: with ROM mapped through gbcpu_map_direct() an
+ * uncached fetch is a plain load as well and the cache only adds
+ * the tag check.
+ */
+#ifndef GBCPU_ICACHE
+#define GBCPU_ICACHE 0
+#endif
+
 #if DEBUG == 1
 
 #define DPRINTF(...) printf(__VA_ARGS__)
@@ -111,6 +149,8 @@ typedef union {
 typedef void (*gbcpu_put_fn)(void *priv, uint32_t addr, uint8_t val);
 typedef uint32_t (*gbcpu_get_fn)(void *priv, uint32_t addr);
 
+struct savestate;
+
 struct get_entry {
 	void *priv;
 	gbcpu_get_fn get;
@@ -122,6 +162,15 @@ struct put_entry {
 };
 
 #define GBCPU_LOOKUP_SIZE 256
+/* cycles reported by gbcpu_step() per call while halted */
+#define GBCPU_HALT_CYCLES 16
+#define GBCPU_ICACHE_SIZE 4096
+
+struct gbcpu_icache_entry {
+	uint32_t tag;		/* bank << 16 | PC, ~0 when empty */
+	uint8_t code[3];	/* opcode and immediates */
+	uint8_t len;
+};
 
 struct gbcpu {
 	gbcpu_regs_u regs;
@@ -132,19 +181,59 @@ struct gbcpu {
 	long stopped;
 	cycles_t cycles;
 
+	/*
+	 * gbcpu_run(): cycles of the instructions completed so far, for
+	 * memory callbacks that need the time, and a flag they set to end
+	 * the run after the current instruction
+	 */
+	long run_cycles;
+	long run_break;
+
 #if DEBUG == 1
 	gbcpu_regs_u oldregs;
 #endif
+#if GBCPU_LAZY_FLAGS == 1
+	/* regs.rn.f is stale while lf_pending is set */
+	long lf_pending;
+	uint32_t lf_res;	/* result, bit 8 = carry */
+	uint32_t lf_hx;		/* bit 4 = half carry */
+	uint32_t lf_n;		/* NF */
+#endif
 	
 	struct get_entry getlookup[GBCPU_LOOKUP_SIZE];
 	struct put_entry putlookup[GBCPU_LOOKUP_SIZE];
+
+	/*
+	 * Host memory backing each page for accesses without side effects,
+	 * NULL to go through getlookup/putlookup, see gbcpu_map_direct()
+	 */
+	const uint8_t *rdpage[GBCPU_LOOKUP_SIZE];
+	uint8_t *wrpage[GBCPU_LOOKUP_SIZE];
+
+	/* ROM bank mapped at each page, -1 if the page may not be cached */
+	long codebank[GBCPU_LOOKUP_SIZE];
+#if GBCPU_ICACHE == 1
+	const uint8_t *prefetch;
+	long icache_hits;
+	long icache_misses;
+	long icache_uncached;
+	struct gbcpu_icache_entry icache[GBCPU_ICACHE_SIZE];
+#endif
 };
 
 void gbcpu_add_mem(struct gbcpu* const gbcpu, uint32_t start, uint32_t end, gbcpu_put_fn putfn, gbcpu_get_fn getfn, void *priv);
+void gbcpu_map_direct(struct gbcpu* const gbcpu, uint32_t start, uint32_t end, const uint8_t *rdmem, uint8_t *wrmem);
+void gbcpu_set_codebank(struct gbcpu* const gbcpu, uint32_t start, uint32_t end, long bank);
 void gbcpu_init(struct gbcpu* const gbcpu);
 void gbcpu_init_struct(struct gbcpu* const gbcpu);
 long gbcpu_step(struct gbcpu* const gbcpu);
+long gbcpu_step_ref(struct gbcpu* const gbcpu);
+long gbcpu_run(struct gbcpu* const gbcpu, long budget);
 void gbcpu_intr(struct gbcpu* const gbcpu, long vec);
+void gbcpu_sync_flags(struct gbcpu* const gbcpu);
+long gbcpu_idle_loop(struct gbcpu* const gbcpu, uint16_t head, uint16_t tail);
+void gbcpu_save_state(struct gbcpu* const gbcpu, struct savestate *s);
+void gbcpu_load_state(struct gbcpu* const gbcpu, struct savestate *s);
 uint8_t gbcpu_mem_get(struct gbcpu* const gbcpu, uint16_t addr);
 void gbcpu_mem_put(struct gbcpu* const gbcpu, uint16_t addr, uint8_t val);
 
@@ -0,0 +1,4167 @@
+/* Generated by gen_gbcpu_ops_h, do not edit. */
+
+static const uint8_t gen_oplen[256] = {
+	1, 3, 1, 1, 1, 1, 2, 1, 3, 1, 1, 1, 1, 1, 2, 1,
+	1, 3, 1, 1, 1, 1, 2, 1, 2, 1, 1, 1, 1, 1, 2, 1,
+	2, 3, 1, 1, 1, 1, 2, 1, 2, 1, 1, 1, 1, 1, 2, 1,
+	2, 3, 1, 1, 1, 1, 2, 1, 2, 1, 1, 1, 1, 1, 2, 1,
+	1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+	1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+	1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+	1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+	1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+	1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+	1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+	1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+	1, 1, 3, 3, 3, 1, 2, 1, 1, 1, 3, 2, 3, 3, 2, 1,
+	1, 1, 3, 1, 3, 1, 2, 1, 1, 1, 3, 1, 3, 1, 2, 1,
+	2, 1, 1, 1, 1, 1, 2, 1, 2, 1, 3, 1, 1, 1, 2, 1,
+	2, 1, 1, 1, 1, 1, 2, 1, 2, 1, 3, 1, 1, 1, 2, 1,
+};
+
+/* cb00 RLC B */
+static inline void gen_cb_00(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.b;
+	uint8_t res = (val << 1) | (val >> 7);
+
+	flags_alu(gbcpu, res | (val >> 7) << 8, 0, 0);
+	gbcpu->regs.rn.b = res;
+}
+
+/* cb01 RLC C */
+static inline void gen_cb_01(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.c;
+	uint8_t res = (val << 1) | (val >> 7);
+
+	flags_alu(gbcpu, res | (val >> 7) << 8, 0, 0);
+	gbcpu->regs.rn.c = res;
+}
+
+/* cb02 RLC D */
+static inline void gen_cb_02(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.d;
+	uint8_t res = (val << 1) | (val >> 7);
+
+	flags_alu(gbcpu, res | (val >> 7) << 8, 0, 0);
+	gbcpu->regs.rn.d = res;
+}
+
+/* cb03 RLC E */
+static inline void gen_cb_03(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.e;
+	uint8_t res = (val << 1) | (val >> 7);
+
+	flags_alu(gbcpu, res | (val >> 7) << 8, 0, 0);
+	gbcpu->regs.rn.e = res;
+}
+
+/* cb04 RLC H */
+static inline void gen_cb_04(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.h;
+	uint8_t res = (val << 1) | (val >> 7);
+
+	flags_alu(gbcpu, res | (val >> 7) << 8, 0, 0);
+	gbcpu->regs.rn.h = res;
+}
+
+/* cb05 RLC L */
+static inline void gen_cb_05(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.l;
+	uint8_t res = (val << 1) | (val >> 7);
+
+	flags_alu(gbcpu, res | (val >> 7) << 8, 0, 0);
+	gbcpu->regs.rn.l = res;
+}
+
+/* cb06 RLC [HL] */
+static inline void gen_cb_06(struct gbcpu* const gbcpu)
+{
+	uint8_t val = mem_get(gbcpu, REGS16_R(gbcpu->regs, HL));
+	uint8_t res = (val << 1) | (val >> 7);
+
+	flags_alu(gbcpu, res | (val >> 7) << 8, 0, 0);
+	mem_put(gbcpu, REGS16_R(gbcpu->regs, HL), res);
+}
+
+/* cb07 RLC A */
+static inline void gen_cb_07(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.a;
+	uint8_t res = (val << 1) | (val >> 7);
+
+	flags_alu(gbcpu, res | (val >> 7) << 8, 0, 0);
+	gbcpu->regs.rn.a = res;
+}
+
+/* cb08 RRC B */
+static inline void gen_cb_08(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.b;
+	uint8_t res = (val >> 1) | (val << 7);
+
+	flags_alu(gbcpu, res | (val & 1) << 8, 0, 0);
+	gbcpu->regs.rn.b = res;
+}
+
+/* cb09 RRC C */
+static inline void gen_cb_09(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.c;
+	uint8_t res = (val >> 1) | (val << 7);
+
+	flags_alu(gbcpu, res | (val & 1) << 8, 0, 0);
+	gbcpu->regs.rn.c = res;
+}
+
+/* cb0a RRC D */
+static inline void gen_cb_0a(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.d;
+	uint8_t res = (val >> 1) | (val << 7);
+
+	flags_alu(gbcpu, res | (val & 1) << 8, 0, 0);
+	gbcpu->regs.rn.d = res;
+}
+
+/* cb0b RRC E */
+static inline void gen_cb_0b(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.e;
+	uint8_t res = (val >> 1) | (val << 7);
+
+	flags_alu(gbcpu, res | (val & 1) << 8, 0, 0);
+	gbcpu->regs.rn.e = res;
+}
+
+/* cb0c RRC H */
+static inline void gen_cb_0c(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.h;
+	uint8_t res = (val >> 1) | (val << 7);
+
+	flags_alu(gbcpu, res | (val & 1) << 8, 0, 0);
+	gbcpu->regs.rn.h = res;
+}
+
+/* cb0d RRC L */
+static inline void gen_cb_0d(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.l;
+	uint8_t res = (val >> 1) | (val << 7);
+
+	flags_alu(gbcpu, res | (val & 1) << 8, 0, 0);
+	gbcpu->regs.rn.l = res;
+}
+
+/* cb0e RRC [HL] */
+static inline void gen_cb_0e(struct gbcpu* const gbcpu)
+{
+	uint8_t val = mem_get(gbcpu, REGS16_R(gbcpu->regs, HL));
+	uint8_t res = (val >> 1) | (val << 7);
+
+	flags_alu(gbcpu, res | (val & 1) << 8, 0, 0);
+	mem_put(gbcpu, REGS16_R(gbcpu->regs, HL), res);
+}
+
+/* cb0f RRC A */
+static inline void gen_cb_0f(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.a;
+	uint8_t res = (val >> 1) | (val << 7);
+
+	flags_alu(gbcpu, res | (val & 1) << 8, 0, 0);
+	gbcpu->regs.rn.a = res;
+}
+
+/* cb10 RL B */
+static inline void gen_cb_10(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.b;
+	uint8_t res = (val << 1) | flag_c(gbcpu);
+
+	flags_alu(gbcpu, res | (val >> 7) << 8, 0, 0);
+	gbcpu->regs.rn.b = res;
+}
+
+/* cb11 RL C */
+static inline void gen_cb_11(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.c;
+	uint8_t res = (val << 1) | flag_c(gbcpu);
+
+	flags_alu(gbcpu, res | (val >> 7) << 8, 0, 0);
+	gbcpu->regs.rn.c = res;
+}
+
+/* cb12 RL D */
+static inline void gen_cb_12(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.d;
+	uint8_t res = (val << 1) | flag_c(gbcpu);
+
+	flags_alu(gbcpu, res | (val >> 7) << 8, 0, 0);
+	gbcpu->regs.rn.d = res;
+}
+
+/* cb13 RL E */
+static inline void gen_cb_13(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.e;
+	uint8_t res = (val << 1) | flag_c(gbcpu);
+
+	flags_alu(gbcpu, res | (val >> 7) << 8, 0, 0);
+	gbcpu->regs.rn.e = res;
+}
+
+/* cb14 RL H */
+static inline void gen_cb_14(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.h;
+	uint8_t res = (val << 1) | flag_c(gbcpu);
+
+	flags_alu(gbcpu, res | (val >> 7) << 8, 0, 0);
+	gbcpu->regs.rn.h = res;
+}
+
+/* cb15 RL L */
+static inline void gen_cb_15(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.l;
+	uint8_t res = (val << 1) | flag_c(gbcpu);
+
+	flags_alu(gbcpu, res | (val >> 7) << 8, 0, 0);
+	gbcpu->regs.rn.l = res;
+}
+
+/* cb16 RL [HL] */
+static inline void gen_cb_16(struct gbcpu* const gbcpu)
+{
+	uint8_t val = mem_get(gbcpu, REGS16_R(gbcpu->regs, HL));
+	uint8_t res = (val << 1) | flag_c(gbcpu);
+
+	flags_alu(gbcpu, res | (val >> 7) << 8, 0, 0);
+	mem_put(gbcpu, REGS16_R(gbcpu->regs, HL), res);
+}
+
+/* cb17 RL A */
+static inline void gen_cb_17(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.a;
+	uint8_t res = (val << 1) | flag_c(gbcpu);
+
+	flags_alu(gbcpu, res | (val >> 7) << 8, 0, 0);
+	gbcpu->regs.rn.a = res;
+}
+
+/* cb18 RR B */
+static inline void gen_cb_18(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.b;
+	uint8_t res = (val >> 1) | (flag_c(gbcpu) << 7);
+
+	flags_alu(gbcpu, res | (val & 1) << 8, 0, 0);
+	gbcpu->regs.rn.b = res;
+}
+
+/* cb19 RR C */
+static inline void gen_cb_19(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.c;
+	uint8_t res = (val >> 1) | (flag_c(gbcpu) << 7);
+
+	flags_alu(gbcpu, res | (val & 1) << 8, 0, 0);
+	gbcpu->regs.rn.c = res;
+}
+
+/* cb1a RR D */
+static inline void gen_cb_1a(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.d;
+	uint8_t res = (val >> 1) | (flag_c(gbcpu) << 7);
+
+	flags_alu(gbcpu, res | (val & 1) << 8, 0, 0);
+	gbcpu->regs.rn.d = res;
+}
+
+/* cb1b RR E */
+static inline void gen_cb_1b(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.e;
+	uint8_t res = (val >> 1) | (flag_c(gbcpu) << 7);
+
+	flags_alu(gbcpu, res | (val & 1) << 8, 0, 0);
+	gbcpu->regs.rn.e = res;
+}
+
+/* cb1c RR H */
+static inline void gen_cb_1c(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.h;
+	uint8_t res = (val >> 1) | (flag_c(gbcpu) << 7);
+
+	flags_alu(gbcpu, res | (val & 1) << 8, 0, 0);
+	gbcpu->regs.rn.h = res;
+}
+
+/* cb1d RR L */
+static inline void gen_cb_1d(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.l;
+	uint8_t res = (val >> 1) | (flag_c(gbcpu) << 7);
+
+	flags_alu(gbcpu, res | (val & 1) << 8, 0, 0);
+	gbcpu->regs.rn.l = res;
+}
+
+/* cb1e RR [HL] */
+static inline void gen_cb_1e(struct gbcpu* const gbcpu)
+{
+	uint8_t val = mem_get(gbcpu, REGS16_R(gbcpu->regs, HL));
+	uint8_t res = (val >> 1) | (flag_c(gbcpu) << 7);
+
+	flags_alu(gbcpu, res | (val & 1) << 8, 0, 0);
+	mem_put(gbcpu, REGS16_R(gbcpu->regs, HL), res);
+}
+
+/* cb1f RR A */
+static inline void gen_cb_1f(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.a;
+	uint8_t res = (val >> 1) | (flag_c(gbcpu) << 7);
+
+	flags_alu(gbcpu, res | (val & 1) << 8, 0, 0);
+	gbcpu->regs.rn.a = res;
+}
+
+/* cb20 SLA B */
+static inline void gen_cb_20(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.b;
+	uint8_t res = val << 1;
+
+	flags_alu(gbcpu, res | (val >> 7) << 8, 0, 0);
+	gbcpu->regs.rn.b = res;
+}
+
+/* cb21 SLA C */
+static inline void gen_cb_21(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.c;
+	uint8_t res = val << 1;
+
+	flags_alu(gbcpu, res | (val >> 7) << 8, 0, 0);
+	gbcpu->regs.rn.c = res;
+}
+
+/* cb22 SLA D */
+static inline void gen_cb_22(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.d;
+	uint8_t res = val << 1;
+
+	flags_alu(gbcpu, res | (val >> 7) << 8, 0, 0);
+	gbcpu->regs.rn.d = res;
+}
+
+/* cb23 SLA E */
+static inline void gen_cb_23(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.e;
+	uint8_t res = val << 1;
+
+	flags_alu(gbcpu, res | (val >> 7) << 8, 0, 0);
+	gbcpu->regs.rn.e = res;
+}
+
+/* cb24 SLA H */
+static inline void gen_cb_24(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.h;
+	uint8_t res = val << 1;
+
+	flags_alu(gbcpu, res | (val >> 7) << 8, 0, 0);
+	gbcpu->regs.rn.h = res;
+}
+
+/* cb25 SLA L */
+static inline void gen_cb_25(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.l;
+	uint8_t res = val << 1;
+
+	flags_alu(gbcpu, res | (val >> 7) << 8, 0, 0);
+	gbcpu->regs.rn.l = res;
+}
+
+/* cb26 SLA [HL] */
+static inline void gen_cb_26(struct gbcpu* const gbcpu)
+{
+	uint8_t val = mem_get(gbcpu, REGS16_R(gbcpu->regs, HL));
+	uint8_t res = val << 1;
+
+	flags_alu(gbcpu, res | (val >> 7) << 8, 0, 0);
+	mem_put(gbcpu, REGS16_R(gbcpu->regs, HL), res);
+}
+
+/* cb27 SLA A */
+static inline void gen_cb_27(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.a;
+	uint8_t res = val << 1;
+
+	flags_alu(gbcpu, res | (val >> 7) << 8, 0, 0);
+	gbcpu->regs.rn.a = res;
+}
+
+/* cb28 SRA B */
+static inline void gen_cb_28(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.b;
+	uint8_t res = (val >> 1) | (val & 0x80);
+
+	flags_alu(gbcpu, res | (val & 1) << 8, 0, 0);
+	gbcpu->regs.rn.b = res;
+}
+
+/* cb29 SRA C */
+static inline void gen_cb_29(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.c;
+	uint8_t res = (val >> 1) | (val & 0x80);
+
+	flags_alu(gbcpu, res | (val & 1) << 8, 0, 0);
+	gbcpu->regs.rn.c = res;
+}
+
+/* cb2a SRA D */
+static inline void gen_cb_2a(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.d;
+	uint8_t res = (val >> 1) | (val & 0x80);
+
+	flags_alu(gbcpu, res | (val & 1) << 8, 0, 0);
+	gbcpu->regs.rn.d = res;
+}
+
+/* cb2b SRA E */
+static inline void gen_cb_2b(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.e;
+	uint8_t res = (val >> 1) | (val & 0x80);
+
+	flags_alu(gbcpu, res | (val & 1) << 8, 0, 0);
+	gbcpu->regs.rn.e = res;
+}
+
+/* cb2c SRA H */
+static inline void gen_cb_2c(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.h;
+	uint8_t res = (val >> 1) | (val & 0x80);
+
+	flags_alu(gbcpu, res | (val & 1) << 8, 0, 0);
+	gbcpu->regs.rn.h = res;
+}
+
+/* cb2d SRA L */
+static inline void gen_cb_2d(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.l;
+	uint8_t res = (val >> 1) | (val & 0x80);
+
+	flags_alu(gbcpu, res | (val & 1) << 8, 0, 0);
+	gbcpu->regs.rn.l = res;
+}
+
+/* cb2e SRA [HL] */
+static inline void gen_cb_2e(struct gbcpu* const gbcpu)
+{
+	uint8_t val = mem_get(gbcpu, REGS16_R(gbcpu->regs, HL));
+	uint8_t res = (val >> 1) | (val & 0x80);
+
+	flags_alu(gbcpu, res | (val & 1) << 8, 0, 0);
+	mem_put(gbcpu, REGS16_R(gbcpu->regs, HL), res);
+}
+
+/* cb2f SRA A */
+static inline void gen_cb_2f(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.a;
+	uint8_t res = (val >> 1) | (val & 0x80);
+
+	flags_alu(gbcpu, res | (val & 1) << 8, 0, 0);
+	gbcpu->regs.rn.a = res;
+}
+
+/* cb30 SWAP B */
+static inline void gen_cb_30(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.b;
+	uint8_t res = (val >> 4) | (val << 4);
+
+	flags_alu(gbcpu, res, 0, 0);
+	gbcpu->regs.rn.b = res;
+}
+
+/* cb31 SWAP C */
+static inline void gen_cb_31(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.c;
+	uint8_t res = (val >> 4) | (val << 4);
+
+	flags_alu(gbcpu, res, 0, 0);
+	gbcpu->regs.rn.c = res;
+}
+
+/* cb32 SWAP D */
+static inline void gen_cb_32(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.d;
+	uint8_t res = (val >> 4) | (val << 4);
+
+	flags_alu(gbcpu, res, 0, 0);
+	gbcpu->regs.rn.d = res;
+}
+
+/* cb33 SWAP E */
+static inline void gen_cb_33(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.e;
+	uint8_t res = (val >> 4) | (val << 4);
+
+	flags_alu(gbcpu, res, 0, 0);
+	gbcpu->regs.rn.e = res;
+}
+
+/* cb34 SWAP H */
+static inline void gen_cb_34(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.h;
+	uint8_t res = (val >> 4) | (val << 4);
+
+	flags_alu(gbcpu, res, 0, 0);
+	gbcpu->regs.rn.h = res;
+}
+
+/* cb35 SWAP L */
+static inline void gen_cb_35(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.l;
+	uint8_t res = (val >> 4) | (val << 4);
+
+	flags_alu(gbcpu, res, 0, 0);
+	gbcpu->regs.rn.l = res;
+}
+
+/* cb36 SWAP [HL] */
+static inline void gen_cb_36(struct gbcpu* const gbcpu)
+{
+	uint8_t val = mem_get(gbcpu, REGS16_R(gbcpu->regs, HL));
+	uint8_t res = (val >> 4) | (val << 4);
+
+	flags_alu(gbcpu, res, 0, 0);
+	mem_put(gbcpu, REGS16_R(gbcpu->regs, HL), res);
+}
+
+/* cb37 SWAP A */
+static inline void gen_cb_37(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.a;
+	uint8_t res = (val >> 4) | (val << 4);
+
+	flags_alu(gbcpu, res, 0, 0);
+	gbcpu->regs.rn.a = res;
+}
+
+/* cb38 SRL B */
+static inline void gen_cb_38(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.b;
+	uint8_t res = val >> 1;
+
+	flags_alu(gbcpu, res | (val & 1) << 8, 0, 0);
+	gbcpu->regs.rn.b = res;
+}
+
+/* cb39 SRL C */
+static inline void gen_cb_39(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.c;
+	uint8_t res = val >> 1;
+
+	flags_alu(gbcpu, res | (val & 1) << 8, 0, 0);
+	gbcpu->regs.rn.c = res;
+}
+
+/* cb3a SRL D */
+static inline void gen_cb_3a(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.d;
+	uint8_t res = val >> 1;
+
+	flags_alu(gbcpu, res | (val & 1) << 8, 0, 0);
+	gbcpu->regs.rn.d = res;
+}
+
+/* cb3b SRL E */
+static inline void gen_cb_3b(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.e;
+	uint8_t res = val >> 1;
+
+	flags_alu(gbcpu, res | (val & 1) << 8, 0, 0);
+	gbcpu->regs.rn.e = res;
+}
+
+/* cb3c SRL H */
+static inline void gen_cb_3c(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.h;
+	uint8_t res = val >> 1;
+
+	flags_alu(gbcpu, res | (val & 1) << 8, 0, 0);
+	gbcpu->regs.rn.h = res;
+}
+
+/* cb3d SRL L */
+static inline void gen_cb_3d(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.l;
+	uint8_t res = val >> 1;
+
+	flags_alu(gbcpu, res | (val & 1) << 8, 0, 0);
+	gbcpu->regs.rn.l = res;
+}
+
+/* cb3e SRL [HL] */
+static inline void gen_cb_3e(struct gbcpu* const gbcpu)
+{
+	uint8_t val = mem_get(gbcpu, REGS16_R(gbcpu->regs, HL));
+	uint8_t res = val >> 1;
+
+	flags_alu(gbcpu, res | (val & 1) << 8, 0, 0);
+	mem_put(gbcpu, REGS16_R(gbcpu->regs, HL), res);
+}
+
+/* cb3f SRL A */
+static inline void gen_cb_3f(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.a;
+	uint8_t res = val >> 1;
+
+	flags_alu(gbcpu, res | (val & 1) << 8, 0, 0);
+	gbcpu->regs.rn.a = res;
+}
+
+/* cb40 BIT 0, B */
+static inline void gen_cb_40(struct gbcpu* const gbcpu)
+{
+	flags_keep_c(gbcpu, gbcpu->regs.rn.b & 0x01, HF >> 1, 0);
+}
+
+/* cb41 BIT 0, C */
+static inline void gen_cb_41(struct gbcpu* const gbcpu)
+{
+	flags_keep_c(gbcpu, gbcpu->regs.rn.c & 0x01, HF >> 1, 0);
+}
+
+/* cb42 BIT 0, D */
+static inline void gen_cb_42(struct gbcpu* const gbcpu)
+{
+	flags_keep_c(gbcpu, gbcpu->regs.rn.d & 0x01, HF >> 1, 0);
+}
+
+/* cb43 BIT 0, E */
+static inline void gen_cb_43(struct gbcpu* const gbcpu)
+{
+	flags_keep_c(gbcpu, gbcpu->regs.rn.e & 0x01, HF >> 1, 0);
+}
+
+/* cb44 BIT 0, H */
+static inline void gen_cb_44(struct gbcpu* const gbcpu)
+{
+	flags_keep_c(gbcpu, gbcpu->regs.rn.h & 0x01, HF >> 1, 0);
+}
+
+/* cb45 BIT 0, L */
+static inline void gen_cb_45(struct gbcpu* const gbcpu)
+{
+	flags_keep_c(gbcpu, gbcpu->regs.rn.l & 0x01, HF >> 1, 0);
+}
+
+/* cb46 BIT 0, [HL] */
+static inline void gen_cb_46(struct gbcpu* const gbcpu)
+{
+	flags_keep_c(gbcpu, mem_get(gbcpu, REGS16_R(gbcpu->regs, HL)) & 0x01, HF >> 1, 0);
+}
+
+/* cb47 BIT 0, A */
+static inline void gen_cb_47(struct gbcpu* const gbcpu)
+{
+	flags_keep_c(gbcpu, gbcpu->regs.rn.a & 0x01, HF >> 1, 0);
+}
+
+/* cb48 BIT 1, B */
+static inline void gen_cb_48(struct gbcpu* const gbcpu)
+{
+	flags_keep_c(gbcpu, gbcpu->regs.rn.b & 0x02, HF >> 1, 0);
+}
+
+/* cb49 BIT 1, C */
+static inline void gen_cb_49(struct gbcpu* const gbcpu)
+{
+	flags_keep_c(gbcpu, gbcpu->regs.rn.c & 0x02, HF >> 1, 0);
+}
+
+/* cb4a BIT 1, D */
+static inline void gen_cb_4a(struct gbcpu* const gbcpu)
+{
+	flags_keep_c(gbcpu, gbcpu->regs.rn.d & 0x02, HF >> 1, 0);
+}
+
+/* cb4b BIT 1, E */
+static inline void gen_cb_4b(struct gbcpu* const gbcpu)
+{
+	flags_keep_c(gbcpu, gbcpu->regs.rn.e & 0x02, HF >> 1, 0);
+}
+
+/* cb4c BIT 1, H */
+static inline void gen_cb_4c(struct gbcpu* const gbcpu)
+{
+	flags_keep_c(gbcpu, gbcpu->regs.rn.h & 0x02, HF >> 1, 0);
+}
+
+/* cb4d BIT 1, L */
+static inline void gen_cb_4d(struct gbcpu* const gbcpu)
+{
+	flags_keep_c(gbcpu, gbcpu->regs.rn.l & 0x02, HF >> 1, 0);
+}
+
+/* cb4e BIT 1, [HL] */
+static inline void gen_cb_4e(struct gbcpu* const gbcpu)
+{
+	flags_keep_c(gbcpu, mem_get(gbcpu, REGS16_R(gbcpu->regs, HL)) & 0x02, HF >> 1, 0);
+}
+
+/* cb4f BIT 1, A */
+static inline void gen_cb_4f(struct gbcpu* const gbcpu)
+{
+	flags_keep_c(gbcpu, gbcpu->regs.rn.a & 0x02, HF >> 1, 0);
+}
+
+/* cb50 BIT 2, B */
+static inline void gen_cb_50(struct gbcpu* const gbcpu)
+{
+	flags_keep_c(gbcpu, gbcpu->regs.rn.b & 0x04, HF >> 1, 0);
+}
+
+/* cb51 BIT 2, C */
+static inline void gen_cb_51(struct gbcpu* const gbcpu)
+{
+	flags_keep_c(gbcpu, gbcpu->regs.rn.c & 0x04, HF >> 1, 0);
+}
+
+/* cb52 BIT 2, D */
+static inline void gen_cb_52(struct gbcpu* const gbcpu)
+{
+	flags_keep_c(gbcpu, gbcpu->regs.rn.d & 0x04, HF >> 1, 0);
+}
+
+/* cb53 BIT 2, E */
+static inline void gen_cb_53(struct gbcpu* const gbcpu)
+{
+	flags_keep_c(gbcpu, gbcpu->regs.rn.e & 0x04, HF >> 1, 0);
+}
+
+/* cb54 BIT 2, H */
+static inline void gen_cb_54(struct gbcpu* const gbcpu)
+{
+	flags_keep_c(gbcpu, gbcpu->regs.rn.h & 0x04, HF >> 1, 0);
+}
+
+/* cb55 BIT 2, L */
+static inline void gen_cb_55(struct gbcpu* const gbcpu)
+{
+	flags_keep_c(gbcpu, gbcpu->regs.rn.l & 0x04, HF >> 1, 0);
+}
+
+/* cb56 BIT 2, [HL] */
+static inline void gen_cb_56(struct gbcpu* const gbcpu)
+{
+	flags_keep_c(gbcpu, mem_get(gbcpu, REGS16_R(gbcpu->regs, HL)) & 0x04, HF >> 1, 0);
+}
+
+/* cb57 BIT 2, A */
+static inline void gen_cb_57(struct gbcpu* const gbcpu)
+{
+	flags_keep_c(gbcpu, gbcpu->regs.rn.a & 0x04, HF >> 1, 0);
+}
+
+/* cb58 BIT 3, B */
+static inline void gen_cb_58(struct gbcpu* const gbcpu)
+{
+	flags_keep_c(gbcpu, gbcpu->regs.rn.b & 0x08, HF >> 1, 0);
+}
+
+/* cb59 BIT 3, C */
+static inline void gen_cb_59(struct gbcpu* const gbcpu)
+{
+	flags_keep_c(gbcpu, gbcpu->regs.rn.c & 0x08, HF >> 1, 0);
+}
+
+/* cb5a BIT 3, D */
+static inline void gen_cb_5a(struct gbcpu* const gbcpu)
+{
+	flags_keep_c(gbcpu, gbcpu->regs.rn.d & 0x08, HF >> 1, 0);
+}
+
+/* cb5b BIT 3, E */
+static inline void gen_cb_5b(struct gbcpu* const gbcpu)
+{
+	flags_keep_c(gbcpu, gbcpu->regs.rn.e & 0x08, HF >> 1, 0);
+}
+
+/* cb5c BIT 3, H */
+static inline void gen_cb_5c(struct gbcpu* const gbcpu)
+{
+	flags_keep_c(gbcpu, gbcpu->regs.rn.h & 0x08, HF >> 1, 0);
+}
+
+/* cb5d BIT 3, L */
+static inline void gen_cb_5d(struct gbcpu* const gbcpu)
+{
+	flags_keep_c(gbcpu, gbcpu->regs.rn.l & 0x08, HF >> 1, 0);
+}
+
+/* cb5e BIT 3, [HL] */
+static inline void gen_cb_5e(struct gbcpu* const gbcpu)
+{
+	flags_keep_c(gbcpu, mem_get(gbcpu, REGS16_R(gbcpu->regs, HL)) & 0x08, HF >> 1, 0);
+}
+
+/* cb5f BIT 3, A */
+static inline void gen_cb_5f(struct gbcpu* const gbcpu)
+{
+	flags_keep_c(gbcpu, gbcpu->regs.rn.a & 0x08, HF >> 1, 0);
+}
+
+/* cb60 BIT 4, B */
+static inline void gen_cb_60(struct gbcpu* const gbcpu)
+{
+	flags_keep_c(gbcpu, gbcpu->regs.rn.b & 0x10, HF >> 1, 0);
+}
+
+/* cb61 BIT 4, C */
+static inline void gen_cb_61(struct gbcpu* const gbcpu)
+{
+	flags_keep_c(gbcpu, gbcpu->regs.rn.c & 0x10, HF >> 1, 0);
+}
+
+/* cb62 BIT 4, D */
+static inline void gen_cb_62(struct gbcpu* const gbcpu)
+{
+	flags_keep_c(gbcpu, gbcpu->regs.rn.d & 0x10, HF >> 1, 0);
+}
+
+/* cb63 BIT 4, E */
+static inline void gen_cb_63(struct gbcpu* const gbcpu)
+{
+	flags_keep_c(gbcpu, gbcpu->regs.rn.e & 0x10, HF >> 1, 0);
+}
+
+/* cb64 BIT 4, H */
+static inline void gen_cb_64(struct gbcpu* const gbcpu)
+{
+	flags_keep_c(gbcpu, gbcpu->regs.rn.h & 0x10, HF >> 1, 0);
+}
+
+/* cb65 BIT 4, L */
+static inline void gen_cb_65(struct gbcpu* const gbcpu)
+{
+	flags_keep_c(gbcpu, gbcpu->regs.rn.l & 0x10, HF >> 1, 0);
+}
+
+/* cb66 BIT 4, [HL] */
+static inline void gen_cb_66(struct gbcpu* const gbcpu)
+{
+	flags_keep_c(gbcpu, mem_get(gbcpu, REGS16_R(gbcpu->regs, HL)) & 0x10, HF >> 1, 0);
+}
+
+/* cb67 BIT 4, A */
+static inline void gen_cb_67(struct gbcpu* const gbcpu)
+{
+	flags_keep_c(gbcpu, gbcpu->regs.rn.a & 0x10, HF >> 1, 0);
+}
+
+/* cb68 BIT 5, B */
+static inline void gen_cb_68(struct gbcpu* const gbcpu)
+{
+	flags_keep_c(gbcpu, gbcpu->regs.rn.b & 0x20, HF >> 1, 0);
+}
+
+/* cb69 BIT 5, C */
+static inline void gen_cb_69(struct gbcpu* const gbcpu)
+{
+	flags_keep_c(gbcpu, gbcpu->regs.rn.c & 0x20, HF >> 1, 0);
+}
+
+/* cb6a BIT 5, D */
+static inline void gen_cb_6a(struct gbcpu* const gbcpu)
+{
+	flags_keep_c(gbcpu, gbcpu->regs.rn.d & 0x20, HF >> 1, 0);
+}
+
+/* cb6b BIT 5, E */
+static inline void gen_cb_6b(struct gbcpu* const gbcpu)
+{
+	flags_keep_c(gbcpu, gbcpu->regs.rn.e & 0x20, HF >> 1, 0);
+}
+
+/* cb6c BIT 5, H */
+static inline void gen_cb_6c(struct gbcpu* const gbcpu)
+{
+	flags_keep_c(gbcpu, gbcpu->regs.rn.h & 0x20, HF >> 1, 0);
+}
+
+/* cb6d BIT 5, L */
+static inline void gen_cb_6d(struct gbcpu* const gbcpu)
+{
+	flags_keep_c(gbcpu, gbcpu->regs.rn.l & 0x20, HF >> 1, 0);
+}
+
+/* cb6e BIT 5, [HL] */
+static inline void gen_cb_6e(struct gbcpu* const gbcpu)
+{
+	flags_keep_c(gbcpu, mem_get(gbcpu, REGS16_R(gbcpu->regs, HL)) & 0x20, HF >> 1, 0);
+}
+
+/* cb6f BIT 5, A */
+static inline void gen_cb_6f(struct gbcpu* const gbcpu)
+{
+	flags_keep_c(gbcpu, gbcpu->regs.rn.a & 0x20, HF >> 1, 0);
+}
+
+/* cb70 BIT 6, B */
+static inline void gen_cb_70(struct gbcpu* const gbcpu)
+{
+	flags_keep_c(gbcpu, gbcpu->regs.rn.b & 0x40, HF >> 1, 0);
+}
+
+/* cb71 BIT 6, C */
+static inline void gen_cb_71(struct gbcpu* const gbcpu)
+{
+	flags_keep_c(gbcpu, gbcpu->regs.rn.c & 0x40, HF >> 1, 0);
+}
+
+/* cb72 BIT 6, D */
+static inline void gen_cb_72(struct gbcpu* const gbcpu)
+{
+	flags_keep_c(gbcpu, gbcpu->regs.rn.d & 0x40, HF >> 1, 0);
+}
+
+/* cb73 BIT 6, E */
+static inline void gen_cb_73(struct gbcpu* const gbcpu)
+{
+	flags_keep_c(gbcpu, gbcpu->regs.rn.e & 0x40, HF >> 1, 0);
+}
+
+/* cb74 BIT 6, H */
+static inline void gen_cb_74(struct gbcpu* const gbcpu)
+{
+	flags_keep_c(gbcpu, gbcpu->regs.rn.h & 0x40, HF >> 1, 0);
+}
+
+/* cb75 BIT 6, L */
+static inline void gen_cb_75(struct gbcpu* const gbcpu)
+{
+	flags_keep_c(gbcpu, gbcpu->regs.rn.l & 0x40, HF >> 1, 0);
+}
+
+/* cb76 BIT 6, [HL] */
+static inline void gen_cb_76(struct gbcpu* const gbcpu)
+{
+	flags_keep_c(gbcpu, mem_get(gbcpu, REGS16_R(gbcpu->regs, HL)) & 0x40, HF >> 1, 0);
+}
+
+/* cb77 BIT 6, A */
+static inline void gen_cb_77(struct gbcpu* const gbcpu)
+{
+	flags_keep_c(gbcpu, gbcpu->regs.rn.a & 0x40, HF >> 1, 0);
+}
+
+/* cb78 BIT 7, B */
+static inline void gen_cb_78(struct gbcpu* const gbcpu)
+{
+	flags_keep_c(gbcpu, gbcpu->regs.rn.b & 0x80, HF >> 1, 0);
+}
+
+/* cb79 BIT 7, C */
+static inline void gen_cb_79(struct gbcpu* const gbcpu)
+{
+	flags_keep_c(gbcpu, gbcpu->regs.rn.c & 0x80, HF >> 1, 0);
+}
+
+/* cb7a BIT 7, D */
+static inline void gen_cb_7a(struct gbcpu* const gbcpu)
+{
+	flags_keep_c(gbcpu, gbcpu->regs.rn.d & 0x80, HF >> 1, 0);
+}
+
+/* cb7b BIT 7, E */
+static inline void gen_cb_7b(struct gbcpu* const gbcpu)
+{
+	flags_keep_c(gbcpu, gbcpu->regs.rn.e & 0x80, HF >> 1, 0);
+}
+
+/* cb7c BIT 7, H */
+static inline void gen_cb_7c(struct gbcpu* const gbcpu)
+{
+	flags_keep_c(gbcpu, gbcpu->regs.rn.h & 0x80, HF >> 1, 0);
+}
+
+/* cb7d BIT 7, L */
+static inline void gen_cb_7d(struct gbcpu* const gbcpu)
+{
+	flags_keep_c(gbcpu, gbcpu->regs.rn.l & 0x80, HF >> 1, 0);
+}
+
+/* cb7e BIT 7, [HL] */
+static inline void gen_cb_7e(struct gbcpu* const gbcpu)
+{
+	flags_keep_c(gbcpu, mem_get(gbcpu, REGS16_R(gbcpu->regs, HL)) & 0x80, HF >> 1, 0);
+}
+
+/* cb7f BIT 7, A */
+static inline void gen_cb_7f(struct gbcpu* const gbcpu)
+{
+	flags_keep_c(gbcpu, gbcpu->regs.rn.a & 0x80, HF >> 1, 0);
+}
+
+/* cb80 RES 0, B */
+static inline void gen_cb_80(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.b &= 0xfe;
+}
+
+/* cb81 RES 0, C */
+static inline void gen_cb_81(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.c &= 0xfe;
+}
+
+/* cb82 RES 0, D */
+static inline void gen_cb_82(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.d &= 0xfe;
+}
+
+/* cb83 RES 0, E */
+static inline void gen_cb_83(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.e &= 0xfe;
+}
+
+/* cb84 RES 0, H */
+static inline void gen_cb_84(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.h &= 0xfe;
+}
+
+/* cb85 RES 0, L */
+static inline void gen_cb_85(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.l &= 0xfe;
+}
+
+/* cb86 RES 0, [HL] */
+static inline void gen_cb_86(struct gbcpu* const gbcpu)
+{
+	uint16_t hl = REGS16_R(gbcpu->regs, HL);
+
+	mem_put(gbcpu, hl, mem_get(gbcpu, hl) & 0xfe);
+}
+
+/* cb87 RES 0, A */
+static inline void gen_cb_87(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.a &= 0xfe;
+}
+
+/* cb88 RES 1, B */
+static inline void gen_cb_88(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.b &= 0xfd;
+}
+
+/* cb89 RES 1, C */
+static inline void gen_cb_89(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.c &= 0xfd;
+}
+
+/* cb8a RES 1, D */
+static inline void gen_cb_8a(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.d &= 0xfd;
+}
+
+/* cb8b RES 1, E */
+static inline void gen_cb_8b(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.e &= 0xfd;
+}
+
+/* cb8c RES 1, H */
+static inline void gen_cb_8c(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.h &= 0xfd;
+}
+
+/* cb8d RES 1, L */
+static inline void gen_cb_8d(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.l &= 0xfd;
+}
+
+/* cb8e RES 1, [HL] */
+static inline void gen_cb_8e(struct gbcpu* const gbcpu)
+{
+	uint16_t hl = REGS16_R(gbcpu->regs, HL);
+
+	mem_put(gbcpu, hl, mem_get(gbcpu, hl) & 0xfd);
+}
+
+/* cb8f RES 1, A */
+static inline void gen_cb_8f(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.a &= 0xfd;
+}
+
+/* cb90 RES 2, B */
+static inline void gen_cb_90(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.b &= 0xfb;
+}
+
+/* cb91 RES 2, C */
+static inline void gen_cb_91(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.c &= 0xfb;
+}
+
+/* cb92 RES 2, D */
+static inline void gen_cb_92(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.d &= 0xfb;
+}
+
+/* cb93 RES 2, E */
+static inline void gen_cb_93(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.e &= 0xfb;
+}
+
+/* cb94 RES 2, H */
+static inline void gen_cb_94(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.h &= 0xfb;
+}
+
+/* cb95 RES 2, L */
+static inline void gen_cb_95(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.l &= 0xfb;
+}
+
+/* cb96 RES 2, [HL] */
+static inline void gen_cb_96(struct gbcpu* const gbcpu)
+{
+	uint16_t hl = REGS16_R(gbcpu->regs, HL);
+
+	mem_put(gbcpu, hl, mem_get(gbcpu, hl) & 0xfb);
+}
+
+/* cb97 RES 2, A */
+static inline void gen_cb_97(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.a &= 0xfb;
+}
+
+/* cb98 RES 3, B */
+static inline void gen_cb_98(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.b &= 0xf7;
+}
+
+/* cb99 RES 3, C */
+static inline void gen_cb_99(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.c &= 0xf7;
+}
+
+/* cb9a RES 3, D */
+static inline void gen_cb_9a(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.d &= 0xf7;
+}
+
+/* cb9b RES 3, E */
+static inline void gen_cb_9b(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.e &= 0xf7;
+}
+
+/* cb9c RES 3, H */
+static inline void gen_cb_9c(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.h &= 0xf7;
+}
+
+/* cb9d RES 3, L */
+static inline void gen_cb_9d(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.l &= 0xf7;
+}
+
+/* cb9e RES 3, [HL] */
+static inline void gen_cb_9e(struct gbcpu* const gbcpu)
+{
+	uint16_t hl = REGS16_R(gbcpu->regs, HL);
+
+	mem_put(gbcpu, hl, mem_get(gbcpu, hl) & 0xf7);
+}
+
+/* cb9f RES 3, A */
+static inline void gen_cb_9f(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.a &= 0xf7;
+}
+
+/* cba0 RES 4, B */
+static inline void gen_cb_a0(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.b &= 0xef;
+}
+
+/* cba1 RES 4, C */
+static inline void gen_cb_a1(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.c &= 0xef;
+}
+
+/* cba2 RES 4, D */
+static inline void gen_cb_a2(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.d &= 0xef;
+}
+
+/* cba3 RES 4, E */
+static inline void gen_cb_a3(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.e &= 0xef;
+}
+
+/* cba4 RES 4, H */
+static inline void gen_cb_a4(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.h &= 0xef;
+}
+
+/* cba5 RES 4, L */
+static inline void gen_cb_a5(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.l &= 0xef;
+}
+
+/* cba6 RES 4, [HL] */
+static inline void gen_cb_a6(struct gbcpu* const gbcpu)
+{
+	uint16_t hl = REGS16_R(gbcpu->regs, HL);
+
+	mem_put(gbcpu, hl, mem_get(gbcpu, hl) & 0xef);
+}
+
+/* cba7 RES 4, A */
+static inline void gen_cb_a7(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.a &= 0xef;
+}
+
+/* cba8 RES 5, B */
+static inline void gen_cb_a8(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.b &= 0xdf;
+}
+
+/* cba9 RES 5, C */
+static inline void gen_cb_a9(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.c &= 0xdf;
+}
+
+/* cbaa RES 5, D */
+static inline void gen_cb_aa(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.d &= 0xdf;
+}
+
+/* cbab RES 5, E */
+static inline void gen_cb_ab(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.e &= 0xdf;
+}
+
+/* cbac RES 5, H */
+static inline void gen_cb_ac(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.h &= 0xdf;
+}
+
+/* cbad RES 5, L */
+static inline void gen_cb_ad(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.l &= 0xdf;
+}
+
+/* cbae RES 5, [HL] */
+static inline void gen_cb_ae(struct gbcpu* const gbcpu)
+{
+	uint16_t hl = REGS16_R(gbcpu->regs, HL);
+
+	mem_put(gbcpu, hl, mem_get(gbcpu, hl) & 0xdf);
+}
+
+/* cbaf RES 5, A */
+static inline void gen_cb_af(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.a &= 0xdf;
+}
+
+/* cbb0 RES 6, B */
+static inline void gen_cb_b0(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.b &= 0xbf;
+}
+
+/* cbb1 RES 6, C */
+static inline void gen_cb_b1(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.c &= 0xbf;
+}
+
+/* cbb2 RES 6, D */
+static inline void gen_cb_b2(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.d &= 0xbf;
+}
+
+/* cbb3 RES 6, E */
+static inline void gen_cb_b3(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.e &= 0xbf;
+}
+
+/* cbb4 RES 6, H */
+static inline void gen_cb_b4(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.h &= 0xbf;
+}
+
+/* cbb5 RES 6, L */
+static inline void gen_cb_b5(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.l &= 0xbf;
+}
+
+/* cbb6 RES 6, [HL] */
+static inline void gen_cb_b6(struct gbcpu* const gbcpu)
+{
+	uint16_t hl = REGS16_R(gbcpu->regs, HL);
+
+	mem_put(gbcpu, hl, mem_get(gbcpu, hl) & 0xbf);
+}
+
+/* cbb7 RES 6, A */
+static inline void gen_cb_b7(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.a &= 0xbf;
+}
+
+/* cbb8 RES 7, B */
+static inline void gen_cb_b8(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.b &= 0x7f;
+}
+
+/* cbb9 RES 7, C */
+static inline void gen_cb_b9(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.c &= 0x7f;
+}
+
+/* cbba RES 7, D */
+static inline void gen_cb_ba(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.d &= 0x7f;
+}
+
+/* cbbb RES 7, E */
+static inline void gen_cb_bb(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.e &= 0x7f;
+}
+
+/* cbbc RES 7, H */
+static inline void gen_cb_bc(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.h &= 0x7f;
+}
+
+/* cbbd RES 7, L */
+static inline void gen_cb_bd(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.l &= 0x7f;
+}
+
+/* cbbe RES 7, [HL] */
+static inline void gen_cb_be(struct gbcpu* const gbcpu)
+{
+	uint16_t hl = REGS16_R(gbcpu->regs, HL);
+
+	mem_put(gbcpu, hl, mem_get(gbcpu, hl) & 0x7f);
+}
+
+/* cbbf RES 7, A */
+static inline void gen_cb_bf(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.a &= 0x7f;
+}
+
+/* cbc0 SET 0, B */
+static inline void gen_cb_c0(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.b |= 0x01;
+}
+
+/* cbc1 SET 0, C */
+static inline void gen_cb_c1(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.c |= 0x01;
+}
+
+/* cbc2 SET 0, D */
+static inline void gen_cb_c2(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.d |= 0x01;
+}
+
+/* cbc3 SET 0, E */
+static inline void gen_cb_c3(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.e |= 0x01;
+}
+
+/* cbc4 SET 0, H */
+static inline void gen_cb_c4(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.h |= 0x01;
+}
+
+/* cbc5 SET 0, L */
+static inline void gen_cb_c5(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.l |= 0x01;
+}
+
+/* cbc6 SET 0, [HL] */
+static inline void gen_cb_c6(struct gbcpu* const gbcpu)
+{
+	uint16_t hl = REGS16_R(gbcpu->regs, HL);
+
+	mem_put(gbcpu, hl, mem_get(gbcpu, hl) | 0x01);
+}
+
+/* cbc7 SET 0, A */
+static inline void gen_cb_c7(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.a |= 0x01;
+}
+
+/* cbc8 SET 1, B */
+static inline void gen_cb_c8(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.b |= 0x02;
+}
+
+/* cbc9 SET 1, C */
+static inline void gen_cb_c9(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.c |= 0x02;
+}
+
+/* cbca SET 1, D */
+static inline void gen_cb_ca(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.d |= 0x02;
+}
+
+/* cbcb SET 1, E */
+static inline void gen_cb_cb(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.e |= 0x02;
+}
+
+/* cbcc SET 1, H */
+static inline void gen_cb_cc(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.h |= 0x02;
+}
+
+/* cbcd SET 1, L */
+static inline void gen_cb_cd(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.l |= 0x02;
+}
+
+/* cbce SET 1, [HL] */
+static inline void gen_cb_ce(struct gbcpu* const gbcpu)
+{
+	uint16_t hl = REGS16_R(gbcpu->regs, HL);
+
+	mem_put(gbcpu, hl, mem_get(gbcpu, hl) | 0x02);
+}
+
+/* cbcf SET 1, A */
+static inline void gen_cb_cf(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.a |= 0x02;
+}
+
+/* cbd0 SET 2, B */
+static inline void gen_cb_d0(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.b |= 0x04;
+}
+
+/* cbd1 SET 2, C */
+static inline void gen_cb_d1(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.c |= 0x04;
+}
+
+/* cbd2 SET 2, D */
+static inline void gen_cb_d2(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.d |= 0x04;
+}
+
+/* cbd3 SET 2, E */
+static inline void gen_cb_d3(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.e |= 0x04;
+}
+
+/* cbd4 SET 2, H */
+static inline void gen_cb_d4(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.h |= 0x04;
+}
+
+/* cbd5 SET 2, L */
+static inline void gen_cb_d5(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.l |= 0x04;
+}
+
+/* cbd6 SET 2, [HL] */
+static inline void gen_cb_d6(struct gbcpu* const gbcpu)
+{
+	uint16_t hl = REGS16_R(gbcpu->regs, HL);
+
+	mem_put(gbcpu, hl, mem_get(gbcpu, hl) | 0x04);
+}
+
+/* cbd7 SET 2, A */
+static inline void gen_cb_d7(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.a |= 0x04;
+}
+
+/* cbd8 SET 3, B */
+static inline void gen_cb_d8(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.b |= 0x08;
+}
+
+/* cbd9 SET 3, C */
+static inline void gen_cb_d9(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.c |= 0x08;
+}
+
+/* cbda SET 3, D */
+static inline void gen_cb_da(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.d |= 0x08;
+}
+
+/* cbdb SET 3, E */
+static inline void gen_cb_db(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.e |= 0x08;
+}
+
+/* cbdc SET 3, H */
+static inline void gen_cb_dc(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.h |= 0x08;
+}
+
+/* cbdd SET 3, L */
+static inline void gen_cb_dd(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.l |= 0x08;
+}
+
+/* cbde SET 3, [HL] */
+static inline void gen_cb_de(struct gbcpu* const gbcpu)
+{
+	uint16_t hl = REGS16_R(gbcpu->regs, HL);
+
+	mem_put(gbcpu, hl, mem_get(gbcpu, hl) | 0x08);
+}
+
+/* cbdf SET 3, A */
+static inline void gen_cb_df(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.a |= 0x08;
+}
+
+/* cbe0 SET 4, B */
+static inline void gen_cb_e0(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.b |= 0x10;
+}
+
+/* cbe1 SET 4, C */
+static inline void gen_cb_e1(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.c |= 0x10;
+}
+
+/* cbe2 SET 4, D */
+static inline void gen_cb_e2(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.d |= 0x10;
+}
+
+/* cbe3 SET 4, E */
+static inline void gen_cb_e3(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.e |= 0x10;
+}
+
+/* cbe4 SET 4, H */
+static inline void gen_cb_e4(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.h |= 0x10;
+}
+
+/* cbe5 SET 4, L */
+static inline void gen_cb_e5(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.l |= 0x10;
+}
+
+/* cbe6 SET 4, [HL] */
+static inline void gen_cb_e6(struct gbcpu* const gbcpu)
+{
+	uint16_t hl = REGS16_R(gbcpu->regs, HL);
+
+	mem_put(gbcpu, hl, mem_get(gbcpu, hl) | 0x10);
+}
+
+/* cbe7 SET 4, A */
+static inline void gen_cb_e7(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.a |= 0x10;
+}
+
+/* cbe8 SET 5, B */
+static inline void gen_cb_e8(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.b |= 0x20;
+}
+
+/* cbe9 SET 5, C */
+static inline void gen_cb_e9(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.c |= 0x20;
+}
+
+/* cbea SET 5, D */
+static inline void gen_cb_ea(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.d |= 0x20;
+}
+
+/* cbeb SET 5, E */
+static inline void gen_cb_eb(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.e |= 0x20;
+}
+
+/* cbec SET 5, H */
+static inline void gen_cb_ec(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.h |= 0x20;
+}
+
+/* cbed SET 5, L */
+static inline void gen_cb_ed(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.l |= 0x20;
+}
+
+/* cbee SET 5, [HL] */
+static inline void gen_cb_ee(struct gbcpu* const gbcpu)
+{
+	uint16_t hl = REGS16_R(gbcpu->regs, HL);
+
+	mem_put(gbcpu, hl, mem_get(gbcpu, hl) | 0x20);
+}
+
+/* cbef SET 5, A */
+static inline void gen_cb_ef(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.a |= 0x20;
+}
+
+/* cbf0 SET 6, B */
+static inline void gen_cb_f0(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.b |= 0x40;
+}
+
+/* cbf1 SET 6, C */
+static inline void gen_cb_f1(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.c |= 0x40;
+}
+
+/* cbf2 SET 6, D */
+static inline void gen_cb_f2(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.d |= 0x40;
+}
+
+/* cbf3 SET 6, E */
+static inline void gen_cb_f3(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.e |= 0x40;
+}
+
+/* cbf4 SET 6, H */
+static inline void gen_cb_f4(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.h |= 0x40;
+}
+
+/* cbf5 SET 6, L */
+static inline void gen_cb_f5(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.l |= 0x40;
+}
+
+/* cbf6 SET 6, [HL] */
+static inline void gen_cb_f6(struct gbcpu* const gbcpu)
+{
+	uint16_t hl = REGS16_R(gbcpu->regs, HL);
+
+	mem_put(gbcpu, hl, mem_get(gbcpu, hl) | 0x40);
+}
+
+/* cbf7 SET 6, A */
+static inline void gen_cb_f7(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.a |= 0x40;
+}
+
+/* cbf8 SET 7, B */
+static inline void gen_cb_f8(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.b |= 0x80;
+}
+
+/* cbf9 SET 7, C */
+static inline void gen_cb_f9(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.c |= 0x80;
+}
+
+/* cbfa SET 7, D */
+static inline void gen_cb_fa(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.d |= 0x80;
+}
+
+/* cbfb SET 7, E */
+static inline void gen_cb_fb(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.e |= 0x80;
+}
+
+/* cbfc SET 7, H */
+static inline void gen_cb_fc(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.h |= 0x80;
+}
+
+/* cbfd SET 7, L */
+static inline void gen_cb_fd(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.l |= 0x80;
+}
+
+/* cbfe SET 7, [HL] */
+static inline void gen_cb_fe(struct gbcpu* const gbcpu)
+{
+	uint16_t hl = REGS16_R(gbcpu->regs, HL);
+
+	mem_put(gbcpu, hl, mem_get(gbcpu, hl) | 0x80);
+}
+
+/* cbff SET 7, A */
+static inline void gen_cb_ff(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.a |= 0x80;
+}
+
+/* 00 NOP */
+static inline void gen_op_00(struct gbcpu* const gbcpu)
+{
+	op_nop(gbcpu, 0x00, &ops[0x00]);
+}
+
+/* 01 LD BC, imm16 */
+static inline void gen_op_01(struct gbcpu* const gbcpu)
+{
+	REGS16_W(gbcpu->regs, BC, get_imm16(gbcpu));
+}
+
+/* 02 LD [BC], A */
+static inline void gen_op_02(struct gbcpu* const gbcpu)
+{
+	uint16_t addr = REGS16_R(gbcpu->regs, BC);
+
+	mem_put(gbcpu, addr, gbcpu->regs.rn.a);
+}
+
+/* 03 INC BC */
+static inline void gen_op_03(struct gbcpu* const gbcpu)
+{
+	REGS16_W(gbcpu->regs, BC, REGS16_R(gbcpu->regs, BC) + 1);
+	gbcpu->cycles += 4;
+}
+
+/* 04 INC B */
+static inline void gen_op_04(struct gbcpu* const gbcpu)
+{
+	uint8_t old = gbcpu->regs.rn.b;
+	uint8_t res = old + 1;
+
+	gbcpu->regs.rn.b = res;
+	flags_keep_c(gbcpu, res, old ^ 1 ^ res, 0);
+}
+
+/* 05 DEC B */
+static inline void gen_op_05(struct gbcpu* const gbcpu)
+{
+	uint8_t old = gbcpu->regs.rn.b;
+	uint8_t res = old - 1;
+
+	gbcpu->regs.rn.b = res;
+	flags_keep_c(gbcpu, res, old ^ 1 ^ res, NF);
+}
+
+/* 06 LD B, imm8 */
+static inline void gen_op_06(struct gbcpu* const gbcpu)
+{
+	uint8_t val = get_imm8(gbcpu);
+
+	gbcpu->regs.rn.b = val;
+}
+
+/* 07 RLCA */
+static inline void gen_op_07(struct gbcpu* const gbcpu)
+{
+	flags_sync(gbcpu);
+	op_rlca(gbcpu, 0x07, &ops[0x07]);
+}
+
+/* 08 LD */
+static inline void gen_op_08(struct gbcpu* const gbcpu)
+{
+	op_ld_ind16_sp(gbcpu, 0x08, &ops[0x08]);
+}
+
+/* 09 ADD HL, BC */
+static inline void gen_op_09(struct gbcpu* const gbcpu)
+{
+	uint16_t old = REGS16_R(gbcpu->regs, HL);
+	uint16_t new = old + REGS16_R(gbcpu->regs, BC);
+
+	REGS16_W(gbcpu->regs, HL, new);
+	flags_sync(gbcpu);
+	gbcpu->regs.rn.f &= ~(NF | CF | HF);
+	if (old > new) gbcpu->regs.rn.f |= CF;
+	if ((old & 0xfff) > (new & 0xfff)) gbcpu->regs.rn.f |= HF;
+	gbcpu->cycles += 4;
+}
+
+/* 0a LD A, [BC] */
+static inline void gen_op_0a(struct gbcpu* const gbcpu)
+{
+	uint16_t addr = REGS16_R(gbcpu->regs, BC);
+
+	gbcpu->regs.rn.a = mem_get(gbcpu, addr);
+}
+
+/* 0b DEC BC */
+static inline void gen_op_0b(struct gbcpu* const gbcpu)
+{
+	REGS16_W(gbcpu->regs, BC, REGS16_R(gbcpu->regs, BC) - 1);
+	gbcpu->cycles += 4;
+}
+
+/* 0c INC C */
+static inline void gen_op_0c(struct gbcpu* const gbcpu)
+{
+	uint8_t old = gbcpu->regs.rn.c;
+	uint8_t res = old + 1;
+
+	gbcpu->regs.rn.c = res;
+	flags_keep_c(gbcpu, res, old ^ 1 ^ res, 0);
+}
+
+/* 0d DEC C */
+static inline void gen_op_0d(struct gbcpu* const gbcpu)
+{
+	uint8_t old = gbcpu->regs.rn.c;
+	uint8_t res = old - 1;
+
+	gbcpu->regs.rn.c = res;
+	flags_keep_c(gbcpu, res, old ^ 1 ^ res, NF);
+}
+
+/* 0e LD C, imm8 */
+static inline void gen_op_0e(struct gbcpu* const gbcpu)
+{
+	uint8_t val = get_imm8(gbcpu);
+
+	gbcpu->regs.rn.c = val;
+}
+
+/* 0f RRCA */
+static inline void gen_op_0f(struct gbcpu* const gbcpu)
+{
+	flags_sync(gbcpu);
+	op_rrca(gbcpu, 0x0f, &ops[0x0f]);
+}
+
+/* 10 STOP */
+static inline void gen_op_10(struct gbcpu* const gbcpu)
+{
+	op_stop(gbcpu, 0x10, &ops[0x10]);
+}
+
+/* 11 LD DE, imm16 */
+static inline void gen_op_11(struct gbcpu* const gbcpu)
+{
+	REGS16_W(gbcpu->regs, DE, get_imm16(gbcpu));
+}
+
+/* 12 LD [DE], A */
+static inline void gen_op_12(struct gbcpu* const gbcpu)
+{
+	uint16_t addr = REGS16_R(gbcpu->regs, DE);
+
+	mem_put(gbcpu, addr, gbcpu->regs.rn.a);
+}
+
+/* 13 INC DE */
+static inline void gen_op_13(struct gbcpu* const gbcpu)
+{
+	REGS16_W(gbcpu->regs, DE, REGS16_R(gbcpu->regs, DE) + 1);
+	gbcpu->cycles += 4;
+}
+
+/* 14 INC D */
+static inline void gen_op_14(struct gbcpu* const gbcpu)
+{
+	uint8_t old = gbcpu->regs.rn.d;
+	uint8_t res = old + 1;
+
+	gbcpu->regs.rn.d = res;
+	flags_keep_c(gbcpu, res, old ^ 1 ^ res, 0);
+}
+
+/* 15 DEC D */
+static inline void gen_op_15(struct gbcpu* const gbcpu)
+{
+	uint8_t old = gbcpu->regs.rn.d;
+	uint8_t res = old - 1;
+
+	gbcpu->regs.rn.d = res;
+	flags_keep_c(gbcpu, res, old ^ 1 ^ res, NF);
+}
+
+/* 16 LD D, imm8 */
+static inline void gen_op_16(struct gbcpu* const gbcpu)
+{
+	uint8_t val = get_imm8(gbcpu);
+
+	gbcpu->regs.rn.d = val;
+}
+
+/* 17 RLA */
+static inline void gen_op_17(struct gbcpu* const gbcpu)
+{
+	flags_sync(gbcpu);
+	op_rla(gbcpu, 0x17, &ops[0x17]);
+}
+
+/* 18 JR */
+static inline void gen_op_18(struct gbcpu* const gbcpu)
+{
+	op_jr(gbcpu, 0x18, &ops[0x18]);
+}
+
+/* 19 ADD HL, DE */
+static inline void gen_op_19(struct gbcpu* const gbcpu)
+{
+	uint16_t old = REGS16_R(gbcpu->regs, HL);
+	uint16_t new = old + REGS16_R(gbcpu->regs, DE);
+
+	REGS16_W(gbcpu->regs, HL, new);
+	flags_sync(gbcpu);
+	gbcpu->regs.rn.f &= ~(NF | CF | HF);
+	if (old > new) gbcpu->regs.rn.f |= CF;
+	if ((old & 0xfff) > (new & 0xfff)) gbcpu->regs.rn.f |= HF;
+	gbcpu->cycles += 4;
+}
+
+/* 1a LD A, [DE] */
+static inline void gen_op_1a(struct gbcpu* const gbcpu)
+{
+	uint16_t addr = REGS16_R(gbcpu->regs, DE);
+
+	gbcpu->regs.rn.a = mem_get(gbcpu, addr);
+}
+
+/* 1b DEC DE */
+static inline void gen_op_1b(struct gbcpu* const gbcpu)
+{
+	REGS16_W(gbcpu->regs, DE, REGS16_R(gbcpu->regs, DE) - 1);
+	gbcpu->cycles += 4;
+}
+
+/* 1c INC E */
+static inline void gen_op_1c(struct gbcpu* const gbcpu)
+{
+	uint8_t old = gbcpu->regs.rn.e;
+	uint8_t res = old + 1;
+
+	gbcpu->regs.rn.e = res;
+	flags_keep_c(gbcpu, res, old ^ 1 ^ res, 0);
+}
+
+/* 1d DEC E */
+static inline void gen_op_1d(struct gbcpu* const gbcpu)
+{
+	uint8_t old = gbcpu->regs.rn.e;
+	uint8_t res = old - 1;
+
+	gbcpu->regs.rn.e = res;
+	flags_keep_c(gbcpu, res, old ^ 1 ^ res, NF);
+}
+
+/* 1e LD E, imm8 */
+static inline void gen_op_1e(struct gbcpu* const gbcpu)
+{
+	uint8_t val = get_imm8(gbcpu);
+
+	gbcpu->regs.rn.e = val;
+}
+
+/* 1f RRA */
+static inline void gen_op_1f(struct gbcpu* const gbcpu)
+{
+	flags_sync(gbcpu);
+	op_rra(gbcpu, 0x1f, &ops[0x1f]);
+}
+
+/* 20 JR NZ */
+static inline void gen_op_20(struct gbcpu* const gbcpu)
+{
+	int16_t ofs = (int8_t) get_imm8(gbcpu);
+
+	if (flag_z(gbcpu)) return;
+	gbcpu->cycles += 4;
+	REGS16_W(gbcpu->regs, GBS_PC, REGS16_R(gbcpu->regs, GBS_PC) + ofs);
+}
+
+/* 21 LD HL, imm16 */
+static inline void gen_op_21(struct gbcpu* const gbcpu)
+{
+	REGS16_W(gbcpu->regs, HL, get_imm16(gbcpu));
+}
+
+/* 22 LDI [HL], A */
+static inline void gen_op_22(struct gbcpu* const gbcpu)
+{
+	uint16_t addr = REGS16_R(gbcpu->regs, HL);
+
+	mem_put(gbcpu, addr, gbcpu->regs.rn.a);
+	REGS16_W(gbcpu->regs, HL, addr + 1);
+}
+
+/* 23 INC HL */
+static inline void gen_op_23(struct gbcpu* const gbcpu)
+{
+	REGS16_W(gbcpu->regs, HL, REGS16_R(gbcpu->regs, HL) + 1);
+	gbcpu->cycles += 4;
+}
+
+/* 24 INC H */
+static inline void gen_op_24(struct gbcpu* const gbcpu)
+{
+	uint8_t old = gbcpu->regs.rn.h;
+	uint8_t res = old + 1;
+
+	gbcpu->regs.rn.h = res;
+	flags_keep_c(gbcpu, res, old ^ 1 ^ res, 0);
+}
+
+/* 25 DEC H */
+static inline void gen_op_25(struct gbcpu* const gbcpu)
+{
+	uint8_t old = gbcpu->regs.rn.h;
+	uint8_t res = old - 1;
+
+	gbcpu->regs.rn.h = res;
+	flags_keep_c(gbcpu, res, old ^ 1 ^ res, NF);
+}
+
+/* 26 LD H, imm8 */
+static inline void gen_op_26(struct gbcpu* const gbcpu)
+{
+	uint8_t val = get_imm8(gbcpu);
+
+	gbcpu->regs.rn.h = val;
+}
+
+/* 27 DAA */
+static inline void gen_op_27(struct gbcpu* const gbcpu)
+{
+	flags_sync(gbcpu);
+	op_daa(gbcpu, 0x27, &ops[0x27]);
+}
+
+/* 28 JR Z */
+static inline void gen_op_28(struct gbcpu* const gbcpu)
+{
+	int16_t ofs = (int8_t) get_imm8(gbcpu);
+
+	if (!flag_z(gbcpu)) return;
+	gbcpu->cycles += 4;
+	REGS16_W(gbcpu->regs, GBS_PC, REGS16_R(gbcpu->regs, GBS_PC) + ofs);
+}
+
+/* 29 ADD HL, HL */
+static inline void gen_op_29(struct gbcpu* const gbcpu)
+{
+	uint16_t old = REGS16_R(gbcpu->regs, HL);
+	uint16_t new = old + REGS16_R(gbcpu->regs, HL);
+
+	REGS16_W(gbcpu->regs, HL, new);
+	flags_sync(gbcpu);
+	gbcpu->regs.rn.f &= ~(NF | CF | HF);
+	if (old > new) gbcpu->regs.rn.f |= CF;
+	if ((old & 0xfff) > (new & 0xfff)) gbcpu->regs.rn.f |= HF;
+	gbcpu->cycles += 4;
+}
+
+/* 2a LDI A, [HL] */
+static inline void gen_op_2a(struct gbcpu* const gbcpu)
+{
+	uint16_t addr = REGS16_R(gbcpu->regs, HL);
+
+	gbcpu->regs.rn.a = mem_get(gbcpu, addr);
+	REGS16_W(gbcpu->regs, HL, addr + 1);
+}
+
+/* 2b DEC HL */
+static inline void gen_op_2b(struct gbcpu* const gbcpu)
+{
+	REGS16_W(gbcpu->regs, HL, REGS16_R(gbcpu->regs, HL) - 1);
+	gbcpu->cycles += 4;
+}
+
+/* 2c INC L */
+static inline void gen_op_2c(struct gbcpu* const gbcpu)
+{
+	uint8_t old = gbcpu->regs.rn.l;
+	uint8_t res = old + 1;
+
+	gbcpu->regs.rn.l = res;
+	flags_keep_c(gbcpu, res, old ^ 1 ^ res, 0);
+}
+
+/* 2d DEC L */
+static inline void gen_op_2d(struct gbcpu* const gbcpu)
+{
+	uint8_t old = gbcpu->regs.rn.l;
+	uint8_t res = old - 1;
+
+	gbcpu->regs.rn.l = res;
+	flags_keep_c(gbcpu, res, old ^ 1 ^ res, NF);
+}
+
+/* 2e LD L, imm8 */
+static inline void gen_op_2e(struct gbcpu* const gbcpu)
+{
+	uint8_t val = get_imm8(gbcpu);
+
+	gbcpu->regs.rn.l = val;
+}
+
+/* 2f CPL */
+static inline void gen_op_2f(struct gbcpu* const gbcpu)
+{
+	flags_sync(gbcpu);
+	op_cpl(gbcpu, 0x2f, &ops[0x2f]);
+}
+
+/* 30 JR NC */
+static inline void gen_op_30(struct gbcpu* const gbcpu)
+{
+	int16_t ofs = (int8_t) get_imm8(gbcpu);
+
+	if (flag_c(gbcpu)) return;
+	gbcpu->cycles += 4;
+	REGS16_W(gbcpu->regs, GBS_PC, REGS16_R(gbcpu->regs, GBS_PC) + ofs);
+}
+
+/* 31 LD SP, imm16 */
+static inline void gen_op_31(struct gbcpu* const gbcpu)
+{
+	REGS16_W(gbcpu->regs, SP, get_imm16(gbcpu));
+}
+
+/* 32 LDD [HL], A */
+static inline void gen_op_32(struct gbcpu* const gbcpu)
+{
+	uint16_t addr = REGS16_R(gbcpu->regs, HL);
+
+	mem_put(gbcpu, addr, gbcpu->regs.rn.a);
+	REGS16_W(gbcpu->regs, HL, addr - 1);
+}
+
+/* 33 INC SP */
+static inline void gen_op_33(struct gbcpu* const gbcpu)
+{
+	REGS16_W(gbcpu->regs, SP, REGS16_R(gbcpu->regs, SP) + 1);
+	gbcpu->cycles += 4;
+}
+
+/* 34 INC [HL] */
+static inline void gen_op_34(struct gbcpu* const gbcpu)
+{
+	uint8_t old = mem_get(gbcpu, REGS16_R(gbcpu->regs, HL));
+	uint8_t res = old + 1;
+
+	mem_put(gbcpu, REGS16_R(gbcpu->regs, HL), res);
+	flags_keep_c(gbcpu, res, old ^ 1 ^ res, 0);
+}
+
+/* 35 DEC [HL] */
+static inline void gen_op_35(struct gbcpu* const gbcpu)
+{
+	uint8_t old = mem_get(gbcpu, REGS16_R(gbcpu->regs, HL));
+	uint8_t res = old - 1;
+
+	mem_put(gbcpu, REGS16_R(gbcpu->regs, HL), res);
+	flags_keep_c(gbcpu, res, old ^ 1 ^ res, NF);
+}
+
+/* 36 LD [HL], imm8 */
+static inline void gen_op_36(struct gbcpu* const gbcpu)
+{
+	uint8_t val = get_imm8(gbcpu);
+
+	mem_put(gbcpu, REGS16_R(gbcpu->regs, HL), val);
+}
+
+/* 37 SCF */
+static inline void gen_op_37(struct gbcpu* const gbcpu)
+{
+	flags_sync(gbcpu);
+	op_scf(gbcpu, 0x37, &ops[0x37]);
+}
+
+/* 38 JR C */
+static inline void gen_op_38(struct gbcpu* const gbcpu)
+{
+	int16_t ofs = (int8_t) get_imm8(gbcpu);
+
+	if (!flag_c(gbcpu)) return;
+	gbcpu->cycles += 4;
+	REGS16_W(gbcpu->regs, GBS_PC, REGS16_R(gbcpu->regs, GBS_PC) + ofs);
+}
+
+/* 39 ADD HL, SP */
+static inline void gen_op_39(struct gbcpu* const gbcpu)
+{
+	uint16_t old = REGS16_R(gbcpu->regs, HL);
+	uint16_t new = old + REGS16_R(gbcpu->regs, SP);
+
+	REGS16_W(gbcpu->regs, HL, new);
+	flags_sync(gbcpu);
+	gbcpu->regs.rn.f &= ~(NF | CF | HF);
+	if (old > new) gbcpu->regs.rn.f |= CF;
+	if ((old & 0xfff) > (new & 0xfff)) gbcpu->regs.rn.f |= HF;
+	gbcpu->cycles += 4;
+}
+
+/* 3a LDD A, [HL] */
+static inline void gen_op_3a(struct gbcpu* const gbcpu)
+{
+	uint16_t addr = REGS16_R(gbcpu->regs, HL);
+
+	gbcpu->regs.rn.a = mem_get(gbcpu, addr);
+	REGS16_W(gbcpu->regs, HL, addr - 1);
+}
+
+/* 3b DEC SP */
+static inline void gen_op_3b(struct gbcpu* const gbcpu)
+{
+	REGS16_W(gbcpu->regs, SP, REGS16_R(gbcpu->regs, SP) - 1);
+	gbcpu->cycles += 4;
+}
+
+/* 3c INC A */
+static inline void gen_op_3c(struct gbcpu* const gbcpu)
+{
+	uint8_t old = gbcpu->regs.rn.a;
+	uint8_t res = old + 1;
+
+	gbcpu->regs.rn.a = res;
+	flags_keep_c(gbcpu, res, old ^ 1 ^ res, 0);
+}
+
+/* 3d DEC A */
+static inline void gen_op_3d(struct gbcpu* const gbcpu)
+{
+	uint8_t old = gbcpu->regs.rn.a;
+	uint8_t res = old - 1;
+
+	gbcpu->regs.rn.a = res;
+	flags_keep_c(gbcpu, res, old ^ 1 ^ res, NF);
+}
+
+/* 3e LD A, imm8 */
+static inline void gen_op_3e(struct gbcpu* const gbcpu)
+{
+	uint8_t val = get_imm8(gbcpu);
+
+	gbcpu->regs.rn.a = val;
+}
+
+/* 3f CCF */
+static inline void gen_op_3f(struct gbcpu* const gbcpu)
+{
+	flags_sync(gbcpu);
+	op_ccf(gbcpu, 0x3f, &ops[0x3f]);
+}
+
+/* 40 LD B, B */
+static inline void gen_op_40(struct gbcpu* const gbcpu)
+{
+	UNUSED(gbcpu);
+}
+
+/* 41 LD B, C */
+static inline void gen_op_41(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.b = gbcpu->regs.rn.c;
+}
+
+/* 42 LD B, D */
+static inline void gen_op_42(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.b = gbcpu->regs.rn.d;
+}
+
+/* 43 LD B, E */
+static inline void gen_op_43(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.b = gbcpu->regs.rn.e;
+}
+
+/* 44 LD B, H */
+static inline void gen_op_44(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.b = gbcpu->regs.rn.h;
+}
+
+/* 45 LD B, L */
+static inline void gen_op_45(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.b = gbcpu->regs.rn.l;
+}
+
+/* 46 LD B, [HL] */
+static inline void gen_op_46(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.b = mem_get(gbcpu, REGS16_R(gbcpu->regs, HL));
+}
+
+/* 47 LD B, A */
+static inline void gen_op_47(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.b = gbcpu->regs.rn.a;
+}
+
+/* 48 LD C, B */
+static inline void gen_op_48(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.c = gbcpu->regs.rn.b;
+}
+
+/* 49 LD C, C */
+static inline void gen_op_49(struct gbcpu* const gbcpu)
+{
+	UNUSED(gbcpu);
+}
+
+/* 4a LD C, D */
+static inline void gen_op_4a(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.c = gbcpu->regs.rn.d;
+}
+
+/* 4b LD C, E */
+static inline void gen_op_4b(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.c = gbcpu->regs.rn.e;
+}
+
+/* 4c LD C, H */
+static inline void gen_op_4c(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.c = gbcpu->regs.rn.h;
+}
+
+/* 4d LD C, L */
+static inline void gen_op_4d(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.c = gbcpu->regs.rn.l;
+}
+
+/* 4e LD C, [HL] */
+static inline void gen_op_4e(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.c = mem_get(gbcpu, REGS16_R(gbcpu->regs, HL));
+}
+
+/* 4f LD C, A */
+static inline void gen_op_4f(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.c = gbcpu->regs.rn.a;
+}
+
+/* 50 LD D, B */
+static inline void gen_op_50(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.d = gbcpu->regs.rn.b;
+}
+
+/* 51 LD D, C */
+static inline void gen_op_51(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.d = gbcpu->regs.rn.c;
+}
+
+/* 52 LD D, D */
+static inline void gen_op_52(struct gbcpu* const gbcpu)
+{
+	UNUSED(gbcpu);
+}
+
+/* 53 LD D, E */
+static inline void gen_op_53(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.d = gbcpu->regs.rn.e;
+}
+
+/* 54 LD D, H */
+static inline void gen_op_54(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.d = gbcpu->regs.rn.h;
+}
+
+/* 55 LD D, L */
+static inline void gen_op_55(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.d = gbcpu->regs.rn.l;
+}
+
+/* 56 LD D, [HL] */
+static inline void gen_op_56(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.d = mem_get(gbcpu, REGS16_R(gbcpu->regs, HL));
+}
+
+/* 57 LD D, A */
+static inline void gen_op_57(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.d = gbcpu->regs.rn.a;
+}
+
+/* 58 LD E, B */
+static inline void gen_op_58(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.e = gbcpu->regs.rn.b;
+}
+
+/* 59 LD E, C */
+static inline void gen_op_59(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.e = gbcpu->regs.rn.c;
+}
+
+/* 5a LD E, D */
+static inline void gen_op_5a(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.e = gbcpu->regs.rn.d;
+}
+
+/* 5b LD E, E */
+static inline void gen_op_5b(struct gbcpu* const gbcpu)
+{
+	UNUSED(gbcpu);
+}
+
+/* 5c LD E, H */
+static inline void gen_op_5c(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.e = gbcpu->regs.rn.h;
+}
+
+/* 5d LD E, L */
+static inline void gen_op_5d(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.e = gbcpu->regs.rn.l;
+}
+
+/* 5e LD E, [HL] */
+static inline void gen_op_5e(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.e = mem_get(gbcpu, REGS16_R(gbcpu->regs, HL));
+}
+
+/* 5f LD E, A */
+static inline void gen_op_5f(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.e = gbcpu->regs.rn.a;
+}
+
+/* 60 LD H, B */
+static inline void gen_op_60(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.h = gbcpu->regs.rn.b;
+}
+
+/* 61 LD H, C */
+static inline void gen_op_61(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.h = gbcpu->regs.rn.c;
+}
+
+/* 62 LD H, D */
+static inline void gen_op_62(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.h = gbcpu->regs.rn.d;
+}
+
+/* 63 LD H, E */
+static inline void gen_op_63(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.h = gbcpu->regs.rn.e;
+}
+
+/* 64 LD H, H */
+static inline void gen_op_64(struct gbcpu* const gbcpu)
+{
+	UNUSED(gbcpu);
+}
+
+/* 65 LD H, L */
+static inline void gen_op_65(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.h = gbcpu->regs.rn.l;
+}
+
+/* 66 LD H, [HL] */
+static inline void gen_op_66(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.h = mem_get(gbcpu, REGS16_R(gbcpu->regs, HL));
+}
+
+/* 67 LD H, A */
+static inline void gen_op_67(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.h = gbcpu->regs.rn.a;
+}
+
+/* 68 LD L, B */
+static inline void gen_op_68(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.l = gbcpu->regs.rn.b;
+}
+
+/* 69 LD L, C */
+static inline void gen_op_69(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.l = gbcpu->regs.rn.c;
+}
+
+/* 6a LD L, D */
+static inline void gen_op_6a(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.l = gbcpu->regs.rn.d;
+}
+
+/* 6b LD L, E */
+static inline void gen_op_6b(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.l = gbcpu->regs.rn.e;
+}
+
+/* 6c LD L, H */
+static inline void gen_op_6c(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.l = gbcpu->regs.rn.h;
+}
+
+/* 6d LD L, L */
+static inline void gen_op_6d(struct gbcpu* const gbcpu)
+{
+	UNUSED(gbcpu);
+}
+
+/* 6e LD L, [HL] */
+static inline void gen_op_6e(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.l = mem_get(gbcpu, REGS16_R(gbcpu->regs, HL));
+}
+
+/* 6f LD L, A */
+static inline void gen_op_6f(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.l = gbcpu->regs.rn.a;
+}
+
+/* 70 LD [HL], B */
+static inline void gen_op_70(struct gbcpu* const gbcpu)
+{
+	mem_put(gbcpu, REGS16_R(gbcpu->regs, HL), gbcpu->regs.rn.b);
+}
+
+/* 71 LD [HL], C */
+static inline void gen_op_71(struct gbcpu* const gbcpu)
+{
+	mem_put(gbcpu, REGS16_R(gbcpu->regs, HL), gbcpu->regs.rn.c);
+}
+
+/* 72 LD [HL], D */
+static inline void gen_op_72(struct gbcpu* const gbcpu)
+{
+	mem_put(gbcpu, REGS16_R(gbcpu->regs, HL), gbcpu->regs.rn.d);
+}
+
+/* 73 LD [HL], E */
+static inline void gen_op_73(struct gbcpu* const gbcpu)
+{
+	mem_put(gbcpu, REGS16_R(gbcpu->regs, HL), gbcpu->regs.rn.e);
+}
+
+/* 74 LD [HL], H */
+static inline void gen_op_74(struct gbcpu* const gbcpu)
+{
+	mem_put(gbcpu, REGS16_R(gbcpu->regs, HL), gbcpu->regs.rn.h);
+}
+
+/* 75 LD [HL], L */
+static inline void gen_op_75(struct gbcpu* const gbcpu)
+{
+	mem_put(gbcpu, REGS16_R(gbcpu->regs, HL), gbcpu->regs.rn.l);
+}
+
+/* 76 HALT */
+static inline void gen_op_76(struct gbcpu* const gbcpu)
+{
+	op_halt(gbcpu, 0x76, &ops[0x76]);
+}
+
+/* 77 LD [HL], A */
+static inline void gen_op_77(struct gbcpu* const gbcpu)
+{
+	mem_put(gbcpu, REGS16_R(gbcpu->regs, HL), gbcpu->regs.rn.a);
+}
+
+/* 78 LD A, B */
+static inline void gen_op_78(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.a = gbcpu->regs.rn.b;
+}
+
+/* 79 LD A, C */
+static inline void gen_op_79(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.a = gbcpu->regs.rn.c;
+}
+
+/* 7a LD A, D */
+static inline void gen_op_7a(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.a = gbcpu->regs.rn.d;
+}
+
+/* 7b LD A, E */
+static inline void gen_op_7b(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.a = gbcpu->regs.rn.e;
+}
+
+/* 7c LD A, H */
+static inline void gen_op_7c(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.a = gbcpu->regs.rn.h;
+}
+
+/* 7d LD A, L */
+static inline void gen_op_7d(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.a = gbcpu->regs.rn.l;
+}
+
+/* 7e LD A, [HL] */
+static inline void gen_op_7e(struct gbcpu* const gbcpu)
+{
+	gbcpu->regs.rn.a = mem_get(gbcpu, REGS16_R(gbcpu->regs, HL));
+}
+
+/* 7f LD A, A */
+static inline void gen_op_7f(struct gbcpu* const gbcpu)
+{
+	UNUSED(gbcpu);
+}
+
+/* 80 ADD A, B */
+static inline void gen_op_80(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.b;
+	uint32_t res = gbcpu->regs.rn.a + val;
+
+	flags_alu(gbcpu, res, gbcpu->regs.rn.a ^ val ^ res, 0);
+	gbcpu->regs.rn.a = res;
+}
+
+/* 81 ADD A, C */
+static inline void gen_op_81(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.c;
+	uint32_t res = gbcpu->regs.rn.a + val;
+
+	flags_alu(gbcpu, res, gbcpu->regs.rn.a ^ val ^ res, 0);
+	gbcpu->regs.rn.a = res;
+}
+
+/* 82 ADD A, D */
+static inline void gen_op_82(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.d;
+	uint32_t res = gbcpu->regs.rn.a + val;
+
+	flags_alu(gbcpu, res, gbcpu->regs.rn.a ^ val ^ res, 0);
+	gbcpu->regs.rn.a = res;
+}
+
+/* 83 ADD A, E */
+static inline void gen_op_83(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.e;
+	uint32_t res = gbcpu->regs.rn.a + val;
+
+	flags_alu(gbcpu, res, gbcpu->regs.rn.a ^ val ^ res, 0);
+	gbcpu->regs.rn.a = res;
+}
+
+/* 84 ADD A, H */
+static inline void gen_op_84(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.h;
+	uint32_t res = gbcpu->regs.rn.a + val;
+
+	flags_alu(gbcpu, res, gbcpu->regs.rn.a ^ val ^ res, 0);
+	gbcpu->regs.rn.a = res;
+}
+
+/* 85 ADD A, L */
+static inline void gen_op_85(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.l;
+	uint32_t res = gbcpu->regs.rn.a + val;
+
+	flags_alu(gbcpu, res, gbcpu->regs.rn.a ^ val ^ res, 0);
+	gbcpu->regs.rn.a = res;
+}
+
+/* 86 ADD A, [HL] */
+static inline void gen_op_86(struct gbcpu* const gbcpu)
+{
+	uint8_t val = mem_get(gbcpu, REGS16_R(gbcpu->regs, HL));
+	uint32_t res = gbcpu->regs.rn.a + val;
+
+	flags_alu(gbcpu, res, gbcpu->regs.rn.a ^ val ^ res, 0);
+	gbcpu->regs.rn.a = res;
+}
+
+/* 87 ADD A, A */
+static inline void gen_op_87(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.a;
+	uint32_t res = gbcpu->regs.rn.a + val;
+
+	flags_alu(gbcpu, res, gbcpu->regs.rn.a ^ val ^ res, 0);
+	gbcpu->regs.rn.a = res;
+}
+
+/* 88 ADC A, B */
+static inline void gen_op_88(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.b;
+	uint32_t res = gbcpu->regs.rn.a + val + flag_c(gbcpu);
+
+	flags_alu(gbcpu, res, gbcpu->regs.rn.a ^ val ^ res, 0);
+	gbcpu->regs.rn.a = res;
+}
+
+/* 89 ADC A, C */
+static inline void gen_op_89(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.c;
+	uint32_t res = gbcpu->regs.rn.a + val + flag_c(gbcpu);
+
+	flags_alu(gbcpu, res, gbcpu->regs.rn.a ^ val ^ res, 0);
+	gbcpu->regs.rn.a = res;
+}
+
+/* 8a ADC A, D */
+static inline void gen_op_8a(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.d;
+	uint32_t res = gbcpu->regs.rn.a + val + flag_c(gbcpu);
+
+	flags_alu(gbcpu, res, gbcpu->regs.rn.a ^ val ^ res, 0);
+	gbcpu->regs.rn.a = res;
+}
+
+/* 8b ADC A, E */
+static inline void gen_op_8b(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.e;
+	uint32_t res = gbcpu->regs.rn.a + val + flag_c(gbcpu);
+
+	flags_alu(gbcpu, res, gbcpu->regs.rn.a ^ val ^ res, 0);
+	gbcpu->regs.rn.a = res;
+}
+
+/* 8c ADC A, H */
+static inline void gen_op_8c(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.h;
+	uint32_t res = gbcpu->regs.rn.a + val + flag_c(gbcpu);
+
+	flags_alu(gbcpu, res, gbcpu->regs.rn.a ^ val ^ res, 0);
+	gbcpu->regs.rn.a = res;
+}
+
+/* 8d ADC A, L */
+static inline void gen_op_8d(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.l;
+	uint32_t res = gbcpu->regs.rn.a + val + flag_c(gbcpu);
+
+	flags_alu(gbcpu, res, gbcpu->regs.rn.a ^ val ^ res, 0);
+	gbcpu->regs.rn.a = res;
+}
+
+/* 8e ADC A, [HL] */
+static inline void gen_op_8e(struct gbcpu* const gbcpu)
+{
+	uint8_t val = mem_get(gbcpu, REGS16_R(gbcpu->regs, HL));
+	uint32_t res = gbcpu->regs.rn.a + val + flag_c(gbcpu);
+
+	flags_alu(gbcpu, res, gbcpu->regs.rn.a ^ val ^ res, 0);
+	gbcpu->regs.rn.a = res;
+}
+
+/* 8f ADC A, A */
+static inline void gen_op_8f(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.a;
+	uint32_t res = gbcpu->regs.rn.a + val + flag_c(gbcpu);
+
+	flags_alu(gbcpu, res, gbcpu->regs.rn.a ^ val ^ res, 0);
+	gbcpu->regs.rn.a = res;
+}
+
+/* 90 SUB A, B */
+static inline void gen_op_90(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.b;
+	uint32_t res = gbcpu->regs.rn.a - val;
+
+	flags_alu(gbcpu, res, gbcpu->regs.rn.a ^ val ^ res, NF);
+	gbcpu->regs.rn.a = res;
+}
+
+/* 91 SUB A, C */
+static inline void gen_op_91(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.c;
+	uint32_t res = gbcpu->regs.rn.a - val;
+
+	flags_alu(gbcpu, res, gbcpu->regs.rn.a ^ val ^ res, NF);
+	gbcpu->regs.rn.a = res;
+}
+
+/* 92 SUB A, D */
+static inline void gen_op_92(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.d;
+	uint32_t res = gbcpu->regs.rn.a - val;
+
+	flags_alu(gbcpu, res, gbcpu->regs.rn.a ^ val ^ res, NF);
+	gbcpu->regs.rn.a = res;
+}
+
+/* 93 SUB A, E */
+static inline void gen_op_93(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.e;
+	uint32_t res = gbcpu->regs.rn.a - val;
+
+	flags_alu(gbcpu, res, gbcpu->regs.rn.a ^ val ^ res, NF);
+	gbcpu->regs.rn.a = res;
+}
+
+/* 94 SUB A, H */
+static inline void gen_op_94(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.h;
+	uint32_t res = gbcpu->regs.rn.a - val;
+
+	flags_alu(gbcpu, res, gbcpu->regs.rn.a ^ val ^ res, NF);
+	gbcpu->regs.rn.a = res;
+}
+
+/* 95 SUB A, L */
+static inline void gen_op_95(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.l;
+	uint32_t res = gbcpu->regs.rn.a - val;
+
+	flags_alu(gbcpu, res, gbcpu->regs.rn.a ^ val ^ res, NF);
+	gbcpu->regs.rn.a = res;
+}
+
+/* 96 SUB A, [HL] */
+static inline void gen_op_96(struct gbcpu* const gbcpu)
+{
+	uint8_t val = mem_get(gbcpu, REGS16_R(gbcpu->regs, HL));
+	uint32_t res = gbcpu->regs.rn.a - val;
+
+	flags_alu(gbcpu, res, gbcpu->regs.rn.a ^ val ^ res, NF);
+	gbcpu->regs.rn.a = res;
+}
+
+/* 97 SUB A, A */
+static inline void gen_op_97(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.a;
+	uint32_t res = gbcpu->regs.rn.a - val;
+
+	flags_alu(gbcpu, res, gbcpu->regs.rn.a ^ val ^ res, NF);
+	gbcpu->regs.rn.a = res;
+}
+
+/* 98 SBC A, B */
+static inline void gen_op_98(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.b;
+	uint32_t res = gbcpu->regs.rn.a - val - flag_c(gbcpu);
+
+	flags_alu(gbcpu, res, gbcpu->regs.rn.a ^ val ^ res, NF);
+	gbcpu->regs.rn.a = res;
+}
+
+/* 99 SBC A, C */
+static inline void gen_op_99(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.c;
+	uint32_t res = gbcpu->regs.rn.a - val - flag_c(gbcpu);
+
+	flags_alu(gbcpu, res, gbcpu->regs.rn.a ^ val ^ res, NF);
+	gbcpu->regs.rn.a = res;
+}
+
+/* 9a SBC A, D */
+static inline void gen_op_9a(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.d;
+	uint32_t res = gbcpu->regs.rn.a - val - flag_c(gbcpu);
+
+	flags_alu(gbcpu, res, gbcpu->regs.rn.a ^ val ^ res, NF);
+	gbcpu->regs.rn.a = res;
+}
+
+/* 9b SBC A, E */
+static inline void gen_op_9b(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.e;
+	uint32_t res = gbcpu->regs.rn.a - val - flag_c(gbcpu);
+
+	flags_alu(gbcpu, res, gbcpu->regs.rn.a ^ val ^ res, NF);
+	gbcpu->regs.rn.a = res;
+}
+
+/* 9c SBC A, H */
+static inline void gen_op_9c(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.h;
+	uint32_t res = gbcpu->regs.rn.a - val - flag_c(gbcpu);
+
+	flags_alu(gbcpu, res, gbcpu->regs.rn.a ^ val ^ res, NF);
+	gbcpu->regs.rn.a = res;
+}
+
+/* 9d SBC A, L */
+static inline void gen_op_9d(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.l;
+	uint32_t res = gbcpu->regs.rn.a - val - flag_c(gbcpu);
+
+	flags_alu(gbcpu, res, gbcpu->regs.rn.a ^ val ^ res, NF);
+	gbcpu->regs.rn.a = res;
+}
+
+/* 9e SBC A, [HL] */
+static inline void gen_op_9e(struct gbcpu* const gbcpu)
+{
+	uint8_t val = mem_get(gbcpu, REGS16_R(gbcpu->regs, HL));
+	uint32_t res = gbcpu->regs.rn.a - val - flag_c(gbcpu);
+
+	flags_alu(gbcpu, res, gbcpu->regs.rn.a ^ val ^ res, NF);
+	gbcpu->regs.rn.a = res;
+}
+
+/* 9f SBC A, A */
+static inline void gen_op_9f(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.a;
+	uint32_t res = gbcpu->regs.rn.a - val - flag_c(gbcpu);
+
+	flags_alu(gbcpu, res, gbcpu->regs.rn.a ^ val ^ res, NF);
+	gbcpu->regs.rn.a = res;
+}
+
+/* a0 AND A, B */
+static inline void gen_op_a0(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.b;
+
+	gbcpu->regs.rn.a &= val;
+	flags_alu(gbcpu, gbcpu->regs.rn.a, HF >> 1, 0);
+}
+
+/* a1 AND A, C */
+static inline void gen_op_a1(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.c;
+
+	gbcpu->regs.rn.a &= val;
+	flags_alu(gbcpu, gbcpu->regs.rn.a, HF >> 1, 0);
+}
+
+/* a2 AND A, D */
+static inline void gen_op_a2(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.d;
+
+	gbcpu->regs.rn.a &= val;
+	flags_alu(gbcpu, gbcpu->regs.rn.a, HF >> 1, 0);
+}
+
+/* a3 AND A, E */
+static inline void gen_op_a3(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.e;
+
+	gbcpu->regs.rn.a &= val;
+	flags_alu(gbcpu, gbcpu->regs.rn.a, HF >> 1, 0);
+}
+
+/* a4 AND A, H */
+static inline void gen_op_a4(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.h;
+
+	gbcpu->regs.rn.a &= val;
+	flags_alu(gbcpu, gbcpu->regs.rn.a, HF >> 1, 0);
+}
+
+/* a5 AND A, L */
+static inline void gen_op_a5(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.l;
+
+	gbcpu->regs.rn.a &= val;
+	flags_alu(gbcpu, gbcpu->regs.rn.a, HF >> 1, 0);
+}
+
+/* a6 AND A, [HL] */
+static inline void gen_op_a6(struct gbcpu* const gbcpu)
+{
+	uint8_t val = mem_get(gbcpu, REGS16_R(gbcpu->regs, HL));
+
+	gbcpu->regs.rn.a &= val;
+	flags_alu(gbcpu, gbcpu->regs.rn.a, HF >> 1, 0);
+}
+
+/* a7 AND A, A */
+static inline void gen_op_a7(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.a;
+
+	gbcpu->regs.rn.a &= val;
+	flags_alu(gbcpu, gbcpu->regs.rn.a, HF >> 1, 0);
+}
+
+/* a8 XOR A, B */
+static inline void gen_op_a8(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.b;
+
+	gbcpu->regs.rn.a ^= val;
+	flags_alu(gbcpu, gbcpu->regs.rn.a, 0, 0);
+}
+
+/* a9 XOR A, C */
+static inline void gen_op_a9(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.c;
+
+	gbcpu->regs.rn.a ^= val;
+	flags_alu(gbcpu, gbcpu->regs.rn.a, 0, 0);
+}
+
+/* aa XOR A, D */
+static inline void gen_op_aa(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.d;
+
+	gbcpu->regs.rn.a ^= val;
+	flags_alu(gbcpu, gbcpu->regs.rn.a, 0, 0);
+}
+
+/* ab XOR A, E */
+static inline void gen_op_ab(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.e;
+
+	gbcpu->regs.rn.a ^= val;
+	flags_alu(gbcpu, gbcpu->regs.rn.a, 0, 0);
+}
+
+/* ac XOR A, H */
+static inline void gen_op_ac(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.h;
+
+	gbcpu->regs.rn.a ^= val;
+	flags_alu(gbcpu, gbcpu->regs.rn.a, 0, 0);
+}
+
+/* ad XOR A, L */
+static inline void gen_op_ad(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.l;
+
+	gbcpu->regs.rn.a ^= val;
+	flags_alu(gbcpu, gbcpu->regs.rn.a, 0, 0);
+}
+
+/* ae XOR A, [HL] */
+static inline void gen_op_ae(struct gbcpu* const gbcpu)
+{
+	uint8_t val = mem_get(gbcpu, REGS16_R(gbcpu->regs, HL));
+
+	gbcpu->regs.rn.a ^= val;
+	flags_alu(gbcpu, gbcpu->regs.rn.a, 0, 0);
+}
+
+/* af XOR A, A */
+static inline void gen_op_af(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.a;
+
+	gbcpu->regs.rn.a ^= val;
+	flags_alu(gbcpu, gbcpu->regs.rn.a, 0, 0);
+}
+
+/* b0 OR A, B */
+static inline void gen_op_b0(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.b;
+
+	gbcpu->regs.rn.a |= val;
+	flags_alu(gbcpu, gbcpu->regs.rn.a, 0, 0);
+}
+
+/* b1 OR A, C */
+static inline void gen_op_b1(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.c;
+
+	gbcpu->regs.rn.a |= val;
+	flags_alu(gbcpu, gbcpu->regs.rn.a, 0, 0);
+}
+
+/* b2 OR A, D */
+static inline void gen_op_b2(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.d;
+
+	gbcpu->regs.rn.a |= val;
+	flags_alu(gbcpu, gbcpu->regs.rn.a, 0, 0);
+}
+
+/* b3 OR A, E */
+static inline void gen_op_b3(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.e;
+
+	gbcpu->regs.rn.a |= val;
+	flags_alu(gbcpu, gbcpu->regs.rn.a, 0, 0);
+}
+
+/* b4 OR A, H */
+static inline void gen_op_b4(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.h;
+
+	gbcpu->regs.rn.a |= val;
+	flags_alu(gbcpu, gbcpu->regs.rn.a, 0, 0);
+}
+
+/* b5 OR A, L */
+static inline void gen_op_b5(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.l;
+
+	gbcpu->regs.rn.a |= val;
+	flags_alu(gbcpu, gbcpu->regs.rn.a, 0, 0);
+}
+
+/* b6 OR A, [HL] */
+static inline void gen_op_b6(struct gbcpu* const gbcpu)
+{
+	uint8_t val = mem_get(gbcpu, REGS16_R(gbcpu->regs, HL));
+
+	gbcpu->regs.rn.a |= val;
+	flags_alu(gbcpu, gbcpu->regs.rn.a, 0, 0);
+}
+
+/* b7 OR A, A */
+static inline void gen_op_b7(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.a;
+
+	gbcpu->regs.rn.a |= val;
+	flags_alu(gbcpu, gbcpu->regs.rn.a, 0, 0);
+}
+
+/* b8 CP A, B */
+static inline void gen_op_b8(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.b;
+	uint32_t res = gbcpu->regs.rn.a - val;
+
+	flags_alu(gbcpu, res, gbcpu->regs.rn.a ^ val ^ res, NF);
+}
+
+/* b9 CP A, C */
+static inline void gen_op_b9(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.c;
+	uint32_t res = gbcpu->regs.rn.a - val;
+
+	flags_alu(gbcpu, res, gbcpu->regs.rn.a ^ val ^ res, NF);
+}
+
+/* ba CP A, D */
+static inline void gen_op_ba(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.d;
+	uint32_t res = gbcpu->regs.rn.a - val;
+
+	flags_alu(gbcpu, res, gbcpu->regs.rn.a ^ val ^ res, NF);
+}
+
+/* bb CP A, E */
+static inline void gen_op_bb(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.e;
+	uint32_t res = gbcpu->regs.rn.a - val;
+
+	flags_alu(gbcpu, res, gbcpu->regs.rn.a ^ val ^ res, NF);
+}
+
+/* bc CP A, H */
+static inline void gen_op_bc(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.h;
+	uint32_t res = gbcpu->regs.rn.a - val;
+
+	flags_alu(gbcpu, res, gbcpu->regs.rn.a ^ val ^ res, NF);
+}
+
+/* bd CP A, L */
+static inline void gen_op_bd(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.l;
+	uint32_t res = gbcpu->regs.rn.a - val;
+
+	flags_alu(gbcpu, res, gbcpu->regs.rn.a ^ val ^ res, NF);
+}
+
+/* be CP A, [HL] */
+static inline void gen_op_be(struct gbcpu* const gbcpu)
+{
+	uint8_t val = mem_get(gbcpu, REGS16_R(gbcpu->regs, HL));
+	uint32_t res = gbcpu->regs.rn.a - val;
+
+	flags_alu(gbcpu, res, gbcpu->regs.rn.a ^ val ^ res, NF);
+}
+
+/* bf CP A, A */
+static inline void gen_op_bf(struct gbcpu* const gbcpu)
+{
+	uint8_t val = gbcpu->regs.rn.a;
+	uint32_t res = gbcpu->regs.rn.a - val;
+
+	flags_alu(gbcpu, res, gbcpu->regs.rn.a ^ val ^ res, NF);
+}
+
+/* c0 RET NZ */
+static inline void gen_op_c0(struct gbcpu* const gbcpu)
+{
+	gbcpu->cycles += 4;
+	if (flag_z(gbcpu)) return;
+	gbcpu->cycles += 4;
+	REGS16_W(gbcpu->regs, GBS_PC, pop(gbcpu));
+}
+
+/* c1 POP BC */
+static inline void gen_op_c1(struct gbcpu* const gbcpu)
+{
+	REGS16_W(gbcpu->regs, BC, pop(gbcpu));
+}
+
+/* c2 JP NZ */
+static inline void gen_op_c2(struct gbcpu* const gbcpu)
+{
+	uint16_t ofs = get_imm16(gbcpu);
+
+	if (flag_z(gbcpu)) return;
+	gbcpu->cycles += 4;
+	REGS16_W(gbcpu->regs, GBS_PC, ofs);
+}
+
+/* c3 JP */
+static inline void gen_op_c3(struct gbcpu* const gbcpu)
+{
+	op_jp(gbcpu, 0xc3, &ops[0xc3]);
+}
+
+/* c4 CALL NZ */
+static inline void gen_op_c4(struct gbcpu* const gbcpu)
+{
+	uint16_t ofs = get_imm16(gbcpu);
+
+	if (flag_z(gbcpu)) return;
+	gbcpu->cycles += 4;
+	push(gbcpu, REGS16_R(gbcpu->regs, GBS_PC));
+	REGS16_W(gbcpu->regs, GBS_PC, ofs);
+}
+
+/* c5 PUSH BC */
+static inline void gen_op_c5(struct gbcpu* const gbcpu)
+{
+	push(gbcpu, REGS16_R(gbcpu->regs, BC));
+	gbcpu->cycles += 4;
+}
+
+/* c6 ADD A, imm8 */
+static inline void gen_op_c6(struct gbcpu* const gbcpu)
+{
+	uint8_t val = get_imm8(gbcpu);
+	uint32_t res = gbcpu->regs.rn.a + val;
+
+	flags_alu(gbcpu, res, gbcpu->regs.rn.a ^ val ^ res, 0);
+	gbcpu->regs.rn.a = res;
+}
+
+/* c7 RST 0x00 */
+static inline void gen_op_c7(struct gbcpu* const gbcpu)
+{
+	push(gbcpu, REGS16_R(gbcpu->regs, GBS_PC));
+	REGS16_W(gbcpu->regs, GBS_PC, 0x00);
+	gbcpu->cycles += 4;
+}
+
+/* c8 RET Z */
+static inline void gen_op_c8(struct gbcpu* const gbcpu)
+{
+	gbcpu->cycles += 4;
+	if (!flag_z(gbcpu)) return;
+	gbcpu->cycles += 4;
+	REGS16_W(gbcpu->regs, GBS_PC, pop(gbcpu));
+}
+
+/* c9 RET */
+static inline void gen_op_c9(struct gbcpu* const gbcpu)
+{
+	op_ret(gbcpu, 0xc9, &ops[0xc9]);
+}
+
+/* ca JP Z */
+static inline void gen_op_ca(struct gbcpu* const gbcpu)
+{
+	uint16_t ofs = get_imm16(gbcpu);
+
+	if (!flag_z(gbcpu)) return;
+	gbcpu->cycles += 4;
+	REGS16_W(gbcpu->regs, GBS_PC, ofs);
+}
+
+/* cb CBPREFIX */
+static void gen_op_cb(struct gbcpu* const gbcpu)
+{
+	uint8_t op = get_imm8(gbcpu);
+
+	DISPATCH_BEGIN(cbdispatch,
+		DISPATCH_ADDR(cb_00) DISPATCH_ADDR(cb_01) DISPATCH_ADDR(cb_02) DISPATCH_ADDR(cb_03) DISPATCH_ADDR(cb_04) DISPATCH_ADDR(cb_05) DISPATCH_ADDR(cb_06) DISPATCH_ADDR(cb_07)
+		DISPATCH_ADDR(cb_08) DISPATCH_ADDR(cb_09) DISPATCH_ADDR(cb_0a) DISPATCH_ADDR(cb_0b) DISPATCH_ADDR(cb_0c) DISPATCH_ADDR(cb_0d) DISPATCH_ADDR(cb_0e) DISPATCH_ADDR(cb_0f)
+		DISPATCH_ADDR(cb_10) DISPATCH_ADDR(cb_11) DISPATCH_ADDR(cb_12) DISPATCH_ADDR(cb_13) DISPATCH_ADDR(cb_14) DISPATCH_ADDR(cb_15) DISPATCH_ADDR(cb_16) DISPATCH_ADDR(cb_17)
+		DISPATCH_ADDR(cb_18) DISPATCH_ADDR(cb_19) DISPATCH_ADDR(cb_1a) DISPATCH_ADDR(cb_1b) DISPATCH_ADDR(cb_1c) DISPATCH_ADDR(cb_1d) DISPATCH_ADDR(cb_1e) DISPATCH_ADDR(cb_1f)
+		DISPATCH_ADDR(cb_20) DISPATCH_ADDR(cb_21) DISPATCH_ADDR(cb_22) DISPATCH_ADDR(cb_23) DISPATCH_ADDR(cb_24) DISPATCH_ADDR(cb_25) DISPATCH_ADDR(cb_26) DISPATCH_ADDR(cb_27)
+		DISPATCH_ADDR(cb_28) DISPATCH_ADDR(cb_29) DISPATCH_ADDR(cb_2a) DISPATCH_ADDR(cb_2b) DISPATCH_ADDR(cb_2c) DISPATCH_ADDR(cb_2d) DISPATCH_ADDR(cb_2e) DISPATCH_ADDR(cb_2f)
+		DISPATCH_ADDR(cb_30) DISPATCH_ADDR(cb_31) DISPATCH_ADDR(cb_32) DISPATCH_ADDR(cb_33) DISPATCH_ADDR(cb_34) DISPATCH_ADDR(cb_35) DISPATCH_ADDR(cb_36) DISPATCH_ADDR(cb_37)
+		DISPATCH_ADDR(cb_38) DISPATCH_ADDR(cb_39) DISPATCH_ADDR(cb_3a) DISPATCH_ADDR(cb_3b) DISPATCH_ADDR(cb_3c) DISPATCH_ADDR(cb_3d) DISPATCH_ADDR(cb_3e) DISPATCH_ADDR(cb_3f)
+		DISPATCH_ADDR(cb_40) DISPATCH_ADDR(cb_41) DISPATCH_ADDR(cb_42) DISPATCH_ADDR(cb_43) DISPATCH_ADDR(cb_44) DISPATCH_ADDR(cb_45) DISPATCH_ADDR(cb_46) DISPATCH_ADDR(cb_47)
+		DISPATCH_ADDR(cb_48) DISPATCH_ADDR(cb_49) DISPATCH_ADDR(cb_4a) DISPATCH_ADDR(cb_4b) DISPATCH_ADDR(cb_4c) DISPATCH_ADDR(cb_4d) DISPATCH_ADDR(cb_4e) DISPATCH_ADDR(cb_4f)
+		DISPATCH_ADDR(cb_50) DISPATCH_ADDR(cb_51) DISPATCH_ADDR(cb_52) DISPATCH_ADDR(cb_53) DISPATCH_ADDR(cb_54) DISPATCH_ADDR(cb_55) DISPATCH_ADDR(cb_56) DISPATCH_ADDR(cb_57)
+		DISPATCH_ADDR(cb_58) DISPATCH_ADDR(cb_59) DISPATCH_ADDR(cb_5a) DISPATCH_ADDR(cb_5b) DISPATCH_ADDR(cb_5c) DISPATCH_ADDR(cb_5d) DISPATCH_ADDR(cb_5e) DISPATCH_ADDR(cb_5f)
+		DISPATCH_ADDR(cb_60) DISPATCH_ADDR(cb_61) DISPATCH_ADDR(cb_62) DISPATCH_ADDR(cb_63) DISPATCH_ADDR(cb_64) DISPATCH_ADDR(cb_65) DISPATCH_ADDR(cb_66) DISPATCH_ADDR(cb_67)
+		DISPATCH_ADDR(cb_68) DISPATCH_ADDR(cb_69) DISPATCH_ADDR(cb_6a) DISPATCH_ADDR(cb_6b) DISPATCH_ADDR(cb_6c) DISPATCH_ADDR(cb_6d) DISPATCH_ADDR(cb_6e) DISPATCH_ADDR(cb_6f)
+		DISPATCH_ADDR(cb_70) DISPATCH_ADDR(cb_71) DISPATCH_ADDR(cb_72) DISPATCH_ADDR(cb_73) DISPATCH_ADDR(cb_74) DISPATCH_ADDR(cb_75) DISPATCH_ADDR(cb_76) DISPATCH_ADDR(cb_77)
+		DISPATCH_ADDR(cb_78) DISPATCH_ADDR(cb_79) DISPATCH_ADDR(cb_7a) DISPATCH_ADDR(cb_7b) DISPATCH_ADDR(cb_7c) DISPATCH_ADDR(cb_7d) DISPATCH_ADDR(cb_7e) DISPATCH_ADDR(cb_7f)
+		DISPATCH_ADDR(cb_80) DISPATCH_ADDR(cb_81) DISPATCH_ADDR(cb_82) DISPATCH_ADDR(cb_83) DISPATCH_ADDR(cb_84) DISPATCH_ADDR(cb_85) DISPATCH_ADDR(cb_86) DISPATCH_ADDR(cb_87)
+		DISPATCH_ADDR(cb_88) DISPATCH_ADDR(cb_89) DISPATCH_ADDR(cb_8a) DISPATCH_ADDR(cb_8b) DISPATCH_ADDR(cb_8c) DISPATCH_ADDR(cb_8d) DISPATCH_ADDR(cb_8e) DISPATCH_ADDR(cb_8f)
+		DISPATCH_ADDR(cb_90) DISPATCH_ADDR(cb_91) DISPATCH_ADDR(cb_92) DISPATCH_ADDR(cb_93) DISPATCH_ADDR(cb_94) DISPATCH_ADDR(cb_95) DISPATCH_ADDR(cb_96) DISPATCH_ADDR(cb_97)
+		DISPATCH_ADDR(cb_98) DISPATCH_ADDR(cb_99) DISPATCH_ADDR(cb_9a) DISPATCH_ADDR(cb_9b) DISPATCH_ADDR(cb_9c) DISPATCH_ADDR(cb_9d) DISPATCH_ADDR(cb_9e) DISPATCH_ADDR(cb_9f)
+		DISPATCH_ADDR(cb_a0) DISPATCH_ADDR(cb_a1) DISPATCH_ADDR(cb_a2) DISPATCH_ADDR(cb_a3) DISPATCH_ADDR(cb_a4) DISPATCH_ADDR(cb_a5) DISPATCH_ADDR(cb_a6) DISPATCH_ADDR(cb_a7)
+		DISPATCH_ADDR(cb_a8) DISPATCH_ADDR(cb_a9) DISPATCH_ADDR(cb_aa) DISPATCH_ADDR(cb_ab) DISPATCH_ADDR(cb_ac) DISPATCH_ADDR(cb_ad) DISPATCH_ADDR(cb_ae) DISPATCH_ADDR(cb_af)
+		DISPATCH_ADDR(cb_b0) DISPATCH_ADDR(cb_b1) DISPATCH_ADDR(cb_b2) DISPATCH_ADDR(cb_b3) DISPATCH_ADDR(cb_b4) DISPATCH_ADDR(cb_b5) DISPATCH_ADDR(cb_b6) DISPATCH_ADDR(cb_b7)
+		DISPATCH_ADDR(cb_b8) DISPATCH_ADDR(cb_b9) DISPATCH_ADDR(cb_ba) DISPATCH_ADDR(cb_bb) DISPATCH_ADDR(cb_bc) DISPATCH_ADDR(cb_bd) DISPATCH_ADDR(cb_be) DISPATCH_ADDR(cb_bf)
+		DISPATCH_ADDR(cb_c0) DISPATCH_ADDR(cb_c1) DISPATCH_ADDR(cb_c2) DISPATCH_ADDR(cb_c3) DISPATCH_ADDR(cb_c4) DISPATCH_ADDR(cb_c5) DISPATCH_ADDR(cb_c6) DISPATCH_ADDR(cb_c7)
+		DISPATCH_ADDR(cb_c8) DISPATCH_ADDR(cb_c9) DISPATCH_ADDR(cb_ca) DISPATCH_ADDR(cb_cb) DISPATCH_ADDR(cb_cc) DISPATCH_ADDR(cb_cd) DISPATCH_ADDR(cb_ce) DISPATCH_ADDR(cb_cf)
+		DISPATCH_ADDR(cb_d0) DISPATCH_ADDR(cb_d1) DISPATCH_ADDR(cb_d2) DISPATCH_ADDR(cb_d3) DISPATCH_ADDR(cb_d4) DISPATCH_ADDR(cb_d5) DISPATCH_ADDR(cb_d6) DISPATCH_ADDR(cb_d7)
+		DISPATCH_ADDR(cb_d8) DISPATCH_ADDR(cb_d9) DISPATCH_ADDR(cb_da) DISPATCH_ADDR(cb_db) DISPATCH_ADDR(cb_dc) DISPATCH_ADDR(cb_dd) DISPATCH_ADDR(cb_de) DISPATCH_ADDR(cb_df)
+		DISPATCH_ADDR(cb_e0) DISPATCH_ADDR(cb_e1) DISPATCH_ADDR(cb_e2) DISPATCH_ADDR(cb_e3) DISPATCH_ADDR(cb_e4) DISPATCH_ADDR(cb_e5) DISPATCH_ADDR(cb_e6) DISPATCH_ADDR(cb_e7)
+		DISPATCH_ADDR(cb_e8) DISPATCH_ADDR(cb_e9) DISPATCH_ADDR(cb_ea) DISPATCH_ADDR(cb_eb) DISPATCH_ADDR(cb_ec) DISPATCH_ADDR(cb_ed) DISPATCH_ADDR(cb_ee) DISPATCH_ADDR(cb_ef)
+		DISPATCH_ADDR(cb_f0) DISPATCH_ADDR(cb_f1) DISPATCH_ADDR(cb_f2) DISPATCH_ADDR(cb_f3) DISPATCH_ADDR(cb_f4) DISPATCH_ADDR(cb_f5) DISPATCH_ADDR(cb_f6) DISPATCH_ADDR(cb_f7)
+		DISPATCH_ADDR(cb_f8) DISPATCH_ADDR(cb_f9) DISPATCH_ADDR(cb_fa) DISPATCH_ADDR(cb_fb) DISPATCH_ADDR(cb_fc) DISPATCH_ADDR(cb_fd) DISPATCH_ADDR(cb_fe) DISPATCH_ADDR(cb_ff), op)
+	DISPATCH_TARGET(cb_00, 0x00): gen_cb_00(gbcpu); return;
+	DISPATCH_TARGET(cb_01, 0x01): gen_cb_01(gbcpu); return;
+	DISPATCH_TARGET(cb_02, 0x02): gen_cb_02(gbcpu); return;
+	DISPATCH_TARGET(cb_03, 0x03): gen_cb_03(gbcpu); return;
+	DISPATCH_TARGET(cb_04, 0x04): gen_cb_04(gbcpu); return;
+	DISPATCH_TARGET(cb_05, 0x05): gen_cb_05(gbcpu); return;
+	DISPATCH_TARGET(cb_06, 0x06): gen_cb_06(gbcpu); return;
+	DISPATCH_TARGET(cb_07, 0x07): gen_cb_07(gbcpu); return;
+	DISPATCH_TARGET(cb_08, 0x08): gen_cb_08(gbcpu); return;
+	DISPATCH_TARGET(cb_09, 0x09): gen_cb_09(gbcpu); return;
+	DISPATCH_TARGET(cb_0a, 0x0a): gen_cb_0a(gbcpu); return;
+	DISPATCH_TARGET(cb_0b, 0x0b): gen_cb_0b(gbcpu); return;
+	DISPATCH_TARGET(cb_0c, 0x0c): gen_cb_0c(gbcpu); return;
+	DISPATCH_TARGET(cb_0d, 0x0d): gen_cb_0d(gbcpu); return;
+	DISPATCH_TARGET(cb_0e, 0x0e): gen_cb_0e(gbcpu); return;
+	DISPATCH_TARGET(cb_0f, 0x0f): gen_cb_0f(gbcpu); return;
+	DISPATCH_TARGET(cb_10, 0x10): gen_cb_10(gbcpu); return;
+	DISPATCH_TARGET(cb_11, 0x11): gen_cb_11(gbcpu); return;
+	DISPATCH_TARGET(cb_12, 0x12): gen_cb_12(gbcpu); return;
+	DISPATCH_TARGET(cb_13, 0x13): gen_cb_13(gbcpu); return;
+	DISPATCH_TARGET(cb_14, 0x14): gen_cb_14(gbcpu); return;
+	DISPATCH_TARGET(cb_15, 0x15): gen_cb_15(gbcpu); return;
+	DISPATCH_TARGET(cb_16, 0x16): gen_cb_16(gbcpu); return;
+	DISPATCH_TARGET(cb_17, 0x17): gen_cb_17(gbcpu); return;
+	DISPATCH_TARGET(cb_18, 0x18): gen_cb_18(gbcpu); return;
+	DISPATCH_TARGET(cb_19, 0x19): gen_cb_19(gbcpu); return;
+	DISPATCH_TARGET(cb_1a, 0x1a): gen_cb_1a(gbcpu); return;
+	DISPATCH_TARGET(cb_1b, 0x1b): gen_cb_1b(gbcpu); return;
+	DISPATCH_TARGET(cb_1c, 0x1c): gen_cb_1c(gbcpu); return;
+	DISPATCH_TARGET(cb_1d, 0x1d): gen_cb_1d(gbcpu); return;
+	DISPATCH_TARGET(cb_1e, 0x1e): gen_cb_1e(gbcpu); return;
+	DISPATCH_TARGET(cb_1f, 0x1f): gen_cb_1f(gbcpu); return;
+	DISPATCH_TARGET(cb_20, 0x20): gen_cb_20(gbcpu); return;
+	DISPATCH_TARGET(cb_21, 0x21): gen_cb_21(gbcpu); return;
+	DISPATCH_TARGET(cb_22, 0x22): gen_cb_22(gbcpu); return;
+	DISPATCH_TARGET(cb_23, 0x23): gen_cb_23(gbcpu); return;
+	DISPATCH_TARGET(cb_24, 0x24): gen_cb_24(gbcpu); return;
+	DISPATCH_TARGET(cb_25, 0x25): gen_cb_25(gbcpu); return;
+	DISPATCH_TARGET(cb_26, 0x26): gen_cb_26(gbcpu); return;
+	DISPATCH_TARGET(cb_27, 0x27): gen_cb_27(gbcpu); return;
+	DISPATCH_TARGET(cb_28, 0x28): gen_cb_28(gbcpu); return;
+	DISPATCH_TARGET(cb_29, 0x29): gen_cb_29(gbcpu); return;
+	DISPATCH_TARGET(cb_2a, 0x2a): gen_cb_2a(gbcpu); return;
+	DISPATCH_TARGET(cb_2b, 0x2b): gen_cb_2b(gbcpu); return;
+	DISPATCH_TARGET(cb_2c, 0x2c): gen_cb_2c(gbcpu); return;
+	DISPATCH_TARGET(cb_2d, 0x2d): gen_cb_2d(gbcpu); return;
+	DISPATCH_TARGET(cb_2e, 0x2e): gen_cb_2e(gbcpu); return;
+	DISPATCH_TARGET(cb_2f, 0x2f): gen_cb_2f(gbcpu); return;
+	DISPATCH_TARGET(cb_30, 0x30): gen_cb_30(gbcpu); return;
+	DISPATCH_TARGET(cb_31, 0x31): gen_cb_31(gbcpu); return;
+	DISPATCH_TARGET(cb_32, 0x32): gen_cb_32(gbcpu); return;
+	DISPATCH_TARGET(cb_33, 0x33): gen_cb_33(gbcpu); return;
+	DISPATCH_TARGET(cb_34, 0x34): gen_cb_34(gbcpu); return;
+	DISPATCH_TARGET(cb_35, 0x35): gen_cb_35(gbcpu); return;
+	DISPATCH_TARGET(cb_36, 0x36): gen_cb_36(gbcpu); return;
+	DISPATCH_TARGET(cb_37, 0x37): gen_cb_37(gbcpu); return;
+	DISPATCH_TARGET(cb_38, 0x38): gen_cb_38(gbcpu); return;
+	DISPATCH_TARGET(cb_39, 0x39): gen_cb_39(gbcpu); return;
+	DISPATCH_TARGET(cb_3a, 0x3a): gen_cb_3a(gbcpu); return;
+	DISPATCH_TARGET(cb_3b, 0x3b): gen_cb_3b(gbcpu); return;
+	DISPATCH_TARGET(cb_3c, 0x3c): gen_cb_3c(gbcpu); return;
+	DISPATCH_TARGET(cb_3d, 0x3d): gen_cb_3d(gbcpu); return;
+	DISPATCH_TARGET(cb_3e, 0x3e): gen_cb_3e(gbcpu); return;
+	DISPATCH_TARGET(cb_3f, 0x3f): gen_cb_3f(gbcpu); return;
+	DISPATCH_TARGET(cb_40, 0x40): gen_cb_40(gbcpu); return;
+	DISPATCH_TARGET(cb_41, 0x41): gen_cb_41(gbcpu); return;
+	DISPATCH_TARGET(cb_42, 0x42): gen_cb_42(gbcpu); return;
+	DISPATCH_TARGET(cb_43, 0x43): gen_cb_43(gbcpu); return;
+	DISPATCH_TARGET(cb_44, 0x44): gen_cb_44(gbcpu); return;
+	DISPATCH_TARGET(cb_45, 0x45): gen_cb_45(gbcpu); return;
+	DISPATCH_TARGET(cb_46, 0x46): gen_cb_46(gbcpu); return;
+	DISPATCH_TARGET(cb_47, 0x47): gen_cb_47(gbcpu); return;
+	DISPATCH_TARGET(cb_48, 0x48): gen_cb_48(gbcpu); return;
+	DISPATCH_TARGET(cb_49, 0x49): gen_cb_49(gbcpu); return;
+	DISPATCH_TARGET(cb_4a, 0x4a): gen_cb_4a(gbcpu); return;
+	DISPATCH_TARGET(cb_4b, 0x4b): gen_cb_4b(gbcpu); return;
+	DISPATCH_TARGET(cb_4c, 0x4c): gen_cb_4c(gbcpu); return;
+	DISPATCH_TARGET(cb_4d, 0x4d): gen_cb_4d(gbcpu); return;
+	DISPATCH_TARGET(cb_4e, 0x4e): gen_cb_4e(gbcpu); return;
+	DISPATCH_TARGET(cb_4f, 0x4f): gen_cb_4f(gbcpu); return;
+	DISPATCH_TARGET(cb_50, 0x50): gen_cb_50(gbcpu); return;
+	DISPATCH_TARGET(cb_51, 0x51): gen_cb_51(gbcpu); return;
+	DISPATCH_TARGET(cb_52, 0x52): gen_cb_52(gbcpu); return;
+	DISPATCH_TARGET(cb_53, 0x53): gen_cb_53(gbcpu); return;
+	DISPATCH_TARGET(cb_54, 0x54): gen_cb_54(gbcpu); return;
+	DISPATCH_TARGET(cb_55, 0x55): gen_cb_55(gbcpu); return;
+	DISPATCH_TARGET(cb_56, 0x56): gen_cb_56(gbcpu); return;
+	DISPATCH_TARGET(cb_57, 0x57): gen_cb_57(gbcpu); return;
+	DISPATCH_TARGET(cb_58, 0x58): gen_cb_58(gbcpu); return;
+	DISPATCH_TARGET(cb_59, 0x59): gen_cb_59(gbcpu); return;
+	DISPATCH_TARGET(cb_5a, 0x5a): gen_cb_5a(gbcpu); return;
+	DISPATCH_TARGET(cb_5b, 0x5b): gen_cb_5b(gbcpu); return;
+	DISPATCH_TARGET(cb_5c, 0x5c): gen_cb_5c(gbcpu); return;
+	DISPATCH_TARGET(cb_5d, 0x5d): gen_cb_5d(gbcpu); return;
+	DISPATCH_TARGET(cb_5e, 0x5e): gen_cb_5e(gbcpu); return;
+	DISPATCH_TARGET(cb_5f, 0x5f): gen_cb_5f(gbcpu); return;
+	DISPATCH_TARGET(cb_60, 0x60): gen_cb_60(gbcpu); return;
+	DISPATCH_TARGET(cb_61, 0x61): gen_cb_61(gbcpu); return;
+	DISPATCH_TARGET(cb_62, 0x62): gen_cb_62(gbcpu); return;
+	DISPATCH_TARGET(cb_63, 0x63): gen_cb_63(gbcpu); return;
+	DISPATCH_TARGET(cb_64, 0x64): gen_cb_64(gbcpu); return;
+	DISPATCH_TARGET(cb_65, 0x65): gen_cb_65(gbcpu); return;
+	DISPATCH_TARGET(cb_66, 0x66): gen_cb_66(gbcpu); return;
+	DISPATCH_TARGET(cb_67, 0x67): gen_cb_67(gbcpu); return;
+	DISPATCH_TARGET(cb_68, 0x68): gen_cb_68(gbcpu); return;
+	DISPATCH_TARGET(cb_69, 0x69): gen_cb_69(gbcpu); return;
+	DISPATCH_TARGET(cb_6a, 0x6a): gen_cb_6a(gbcpu); return;
+	DISPATCH_TARGET(cb_6b, 0x6b): gen_cb_6b(gbcpu); return;
+	DISPATCH_TARGET(cb_6c, 0x6c): gen_cb_6c(gbcpu); return;
+	DISPATCH_TARGET(cb_6d, 0x6d): gen_cb_6d(gbcpu); return;
+	DISPATCH_TARGET(cb_6e, 0x6e): gen_cb_6e(gbcpu); return;
+	DISPATCH_TARGET(cb_6f, 0x6f): gen_cb_6f(gbcpu); return;
+	DISPATCH_TARGET(cb_70, 0x70): gen_cb_70(gbcpu); return;
+	DISPATCH_TARGET(cb_71, 0x71): gen_cb_71(gbcpu); return;
+	DISPATCH_TARGET(cb_72, 0x72): gen_cb_72(gbcpu); return;
+	DISPATCH_TARGET(cb_73, 0x73): gen_cb_73(gbcpu); return;
+	DISPATCH_TARGET(cb_74, 0x74): gen_cb_74(gbcpu); return;
+	DISPATCH_TARGET(cb_75, 0x75): gen_cb_75(gbcpu); return;
+	DISPATCH_TARGET(cb_76, 0x76): gen_cb_76(gbcpu); return;
+	DISPATCH_TARGET(cb_77, 0x77): gen_cb_77(gbcpu); return;
+	DISPATCH_TARGET(cb_78, 0x78): gen_cb_78(gbcpu); return;
+	DISPATCH_TARGET(cb_79, 0x79): gen_cb_79(gbcpu); return;
+	DISPATCH_TARGET(cb_7a, 0x7a): gen_cb_7a(gbcpu); return;
+	DISPATCH_TARGET(cb_7b, 0x7b): gen_cb_7b(gbcpu); return;
+	DISPATCH_TARGET(cb_7c, 0x7c): gen_cb_7c(gbcpu); return;
+	DISPATCH_TARGET(cb_7d, 0x7d): gen_cb_7d(gbcpu); return;
+	DISPATCH_TARGET(cb_7e, 0x7e): gen_cb_7e(gbcpu); return;
+	DISPATCH_TARGET(cb_7f, 0x7f): gen_cb_7f(gbcpu); return;
+	DISPATCH_TARGET(cb_80, 0x80): gen_cb_80(gbcpu); return;
+	DISPATCH_TARGET(cb_81, 0x81): gen_cb_81(gbcpu); return;
+	DISPATCH_TARGET(cb_82, 0x82): gen_cb_82(gbcpu); return;
+	DISPATCH_TARGET(cb_83, 0x83): gen_cb_83(gbcpu); return;
+	DISPATCH_TARGET(cb_84, 0x84): gen_cb_84(gbcpu); return;
+	DISPATCH_TARGET(cb_85, 0x85): gen_cb_85(gbcpu); return;
+	DISPATCH_TARGET(cb_86, 0x86): gen_cb_86(gbcpu); return;
+	DISPATCH_TARGET(cb_87, 0x87): gen_cb_87(gbcpu); return;
+	DISPATCH_TARGET(cb_88, 0x88): gen_cb_88(gbcpu); return;
+	DISPATCH_TARGET(cb_89, 0x89): gen_cb_89(gbcpu); return;
+	DISPATCH_TARGET(cb_8a, 0x8a): gen_cb_8a(gbcpu); return;
+	DISPATCH_TARGET(cb_8b, 0x8b): gen_cb_8b(gbcpu); return;
+	DISPATCH_TARGET(cb_8c, 0x8c): gen_cb_8c(gbcpu); return;
+	DISPATCH_TARGET(cb_8d, 0x8d): gen_cb_8d(gbcpu); return;
+	DISPATCH_TARGET(cb_8e, 0x8e): gen_cb_8e(gbcpu); return;
+	DISPATCH_TARGET(cb_8f, 0x8f): gen_cb_8f(gbcpu); return;
+	DISPATCH_TARGET(cb_90, 0x90): gen_cb_90(gbcpu); return;
+	DISPATCH_TARGET(cb_91, 0x91): gen_cb_91(gbcpu); return;
+	DISPATCH_TARGET(cb_92, 0x92): gen_cb_92(gbcpu); return;
+	DISPATCH_TARGET(cb_93, 0x93): gen_cb_93(gbcpu); return;
+	DISPATCH_TARGET(cb_94, 0x94): gen_cb_94(gbcpu); return;
+	DISPATCH_TARGET(cb_95, 0x95): gen_cb_95(gbcpu); return;
+	DISPATCH_TARGET(cb_96, 0x96): gen_cb_96(gbcpu); return;
+	DISPATCH_TARGET(cb_97, 0x97): gen_cb_97(gbcpu); return;
+	DISPATCH_TARGET(cb_98, 0x98): gen_cb_98(gbcpu); return;
+	DISPATCH_TARGET(cb_99, 0x99): gen_cb_99(gbcpu); return;
+	DISPATCH_TARGET(cb_9a, 0x9a): gen_cb_9a(gbcpu); return;
+	DISPATCH_TARGET(cb_9b, 0x9b): gen_cb_9b(gbcpu); return;
+	DISPATCH_TARGET(cb_9c, 0x9c): gen_cb_9c(gbcpu); return;
+	DISPATCH_TARGET(cb_9d, 0x9d): gen_cb_9d(gbcpu); return;
+	DISPATCH_TARGET(cb_9e, 0x9e): gen_cb_9e(gbcpu); return;
+	DISPATCH_TARGET(cb_9f, 0x9f): gen_cb_9f(gbcpu); return;
+	DISPATCH_TARGET(cb_a0, 0xa0): gen_cb_a0(gbcpu); return;
+	DISPATCH_TARGET(cb_a1, 0xa1): gen_cb_a1(gbcpu); return;
+	DISPATCH_TARGET(cb_a2, 0xa2): gen_cb_a2(gbcpu); return;
+	DISPATCH_TARGET(cb_a3, 0xa3): gen_cb_a3(gbcpu); return;
+	DISPATCH_TARGET(cb_a4, 0xa4): gen_cb_a4(gbcpu); return;
+	DISPATCH_TARGET(cb_a5, 0xa5): gen_cb_a5(gbcpu); return;
+	DISPATCH_TARGET(cb_a6, 0xa6): gen_cb_a6(gbcpu); return;
+	DISPATCH_TARGET(cb_a7, 0xa7): gen_cb_a7(gbcpu); return;
+	DISPATCH_TARGET(cb_a8, 0xa8): gen_cb_a8(gbcpu); return;
+	DISPATCH_TARGET(cb_a9, 0xa9): gen_cb_a9(gbcpu); return;
+	DISPATCH_TARGET(cb_aa, 0xaa): gen_cb_aa(gbcpu); return;
+	DISPATCH_TARGET(cb_ab, 0xab): gen_cb_ab(gbcpu); return;
+	DISPATCH_TARGET(cb_ac, 0xac): gen_cb_ac(gbcpu); return;
+	DISPATCH_TARGET(cb_ad, 0xad): gen_cb_ad(gbcpu); return;
+	DISPATCH_TARGET(cb_ae, 0xae): gen_cb_ae(gbcpu); return;
+	DISPATCH_TARGET(cb_af, 0xaf): gen_cb_af(gbcpu); return;
+	DISPATCH_TARGET(cb_b0, 0xb0): gen_cb_b0(gbcpu); return;
+	DISPATCH_TARGET(cb_b1, 0xb1): gen_cb_b1(gbcpu); return;
+	DISPATCH_TARGET(cb_b2, 0xb2): gen_cb_b2(gbcpu); return;
+	DISPATCH_TARGET(cb_b3, 0xb3): gen_cb_b3(gbcpu); return;
+	DISPATCH_TARGET(cb_b4, 0xb4): gen_cb_b4(gbcpu); return;
+	DISPATCH_TARGET(cb_b5, 0xb5): gen_cb_b5(gbcpu); return;
+	DISPATCH_TARGET(cb_b6, 0xb6): gen_cb_b6(gbcpu); return;
+	DISPATCH_TARGET(cb_b7, 0xb7): gen_cb_b7(gbcpu); return;
+	DISPATCH_TARGET(cb_b8, 0xb8): gen_cb_b8(gbcpu); return;
+	DISPATCH_TARGET(cb_b9, 0xb9): gen_cb_b9(gbcpu); return;
+	DISPATCH_TARGET(cb_ba, 0xba): gen_cb_ba(gbcpu); return;
+	DISPATCH_TARGET(cb_bb, 0xbb): gen_cb_bb(gbcpu); return;
+	DISPATCH_TARGET(cb_bc, 0xbc): gen_cb_bc(gbcpu); return;
+	DISPATCH_TARGET(cb_bd, 0xbd): gen_cb_bd(gbcpu); return;
+	DISPATCH_TARGET(cb_be, 0xbe): gen_cb_be(gbcpu); return;
+	DISPATCH_TARGET(cb_bf, 0xbf): gen_cb_bf(gbcpu); return;
+	DISPATCH_TARGET(cb_c0, 0xc0): gen_cb_c0(gbcpu); return;
+	DISPATCH_TARGET(cb_c1, 0xc1): gen_cb_c1(gbcpu); return;
+	DISPATCH_TARGET(cb_c2, 0xc2): gen_cb_c2(gbcpu); return;
+	DISPATCH_TARGET(cb_c3, 0xc3): gen_cb_c3(gbcpu); return;
+	DISPATCH_TARGET(cb_c4, 0xc4): gen_cb_c4(gbcpu); return;
+	DISPATCH_TARGET(cb_c5, 0xc5): gen_cb_c5(gbcpu); return;
+	DISPATCH_TARGET(cb_c6, 0xc6): gen_cb_c6(gbcpu); return;
+	DISPATCH_TARGET(cb_c7, 0xc7): gen_cb_c7(gbcpu); return;
+	DISPATCH_TARGET(cb_c8, 0xc8): gen_cb_c8(gbcpu); return;
+	DISPATCH_TARGET(cb_c9, 0xc9): gen_cb_c9(gbcpu); return;
+	DISPATCH_TARGET(cb_ca, 0xca): gen_cb_ca(gbcpu); return;
+	DISPATCH_TARGET(cb_cb, 0xcb): gen_cb_cb(gbcpu); return;
+	DISPATCH_TARGET(cb_cc, 0xcc): gen_cb_cc(gbcpu); return;
+	DISPATCH_TARGET(cb_cd, 0xcd): gen_cb_cd(gbcpu); return;
+	DISPATCH_TARGET(cb_ce, 0xce): gen_cb_ce(gbcpu); return;
+	DISPATCH_TARGET(cb_cf, 0xcf): gen_cb_cf(gbcpu); return;
+	DISPATCH_TARGET(cb_d0, 0xd0): gen_cb_d0(gbcpu); return;
+	DISPATCH_TARGET(cb_d1, 0xd1): gen_cb_d1(gbcpu); return;
+	DISPATCH_TARGET(cb_d2, 0xd2): gen_cb_d2(gbcpu); return;
+	DISPATCH_TARGET(cb_d3, 0xd3): gen_cb_d3(gbcpu); return;
+	DISPATCH_TARGET(cb_d4, 0xd4): gen_cb_d4(gbcpu); return;
+	DISPATCH_TARGET(cb_d5, 0xd5): gen_cb_d5(gbcpu); return;
+	DISPATCH_TARGET(cb_d6, 0xd6): gen_cb_d6(gbcpu); return;
+	DISPATCH_TARGET(cb_d7, 0xd7): gen_cb_d7(gbcpu); return;
+	DISPATCH_TARGET(cb_d8, 0xd8): gen_cb_d8(gbcpu); return;
+	DISPATCH_TARGET(cb_d9, 0xd9): gen_cb_d9(gbcpu); return;
+	DISPATCH_TARGET(cb_da, 0xda): gen_cb_da(gbcpu); return;
+	DISPATCH_TARGET(cb_db, 0xdb): gen_cb_db(gbcpu); return;
+	DISPATCH_TARGET(cb_dc, 0xdc): gen_cb_dc(gbcpu); return;
+	DISPATCH_TARGET(cb_dd, 0xdd): gen_cb_dd(gbcpu); return;
+	DISPATCH_TARGET(cb_de, 0xde): gen_cb_de(gbcpu); return;
+	DISPATCH_TARGET(cb_df, 0xdf): gen_cb_df(gbcpu); return;
+	DISPATCH_TARGET(cb_e0, 0xe0): gen_cb_e0(gbcpu); return;
+	DISPATCH_TARGET(cb_e1, 0xe1): gen_cb_e1(gbcpu); return;
+	DISPATCH_TARGET(cb_e2, 0xe2): gen_cb_e2(gbcpu); return;
+	DISPATCH_TARGET(cb_e3, 0xe3): gen_cb_e3(gbcpu); return;
+	DISPATCH_TARGET(cb_e4, 0xe4): gen_cb_e4(gbcpu); return;
+	DISPATCH_TARGET(cb_e5, 0xe5): gen_cb_e5(gbcpu); return;
+	DISPATCH_TARGET(cb_e6, 0xe6): gen_cb_e6(gbcpu); return;
+	DISPATCH_TARGET(cb_e7, 0xe7): gen_cb_e7(gbcpu); return;
+	DISPATCH_TARGET(cb_e8, 0xe8): gen_cb_e8(gbcpu); return;
+	DISPATCH_TARGET(cb_e9, 0xe9): gen_cb_e9(gbcpu); return;
+	DISPATCH_TARGET(cb_ea, 0xea): gen_cb_ea(gbcpu); return;
+	DISPATCH_TARGET(cb_eb, 0xeb): gen_cb_eb(gbcpu); return;
+	DISPATCH_TARGET(cb_ec, 0xec): gen_cb_ec(gbcpu); return;
+	DISPATCH_TARGET(cb_ed, 0xed): gen_cb_ed(gbcpu); return;
+	DISPATCH_TARGET(cb_ee, 0xee): gen_cb_ee(gbcpu); return;
+	DISPATCH_TARGET(cb_ef, 0xef): gen_cb_ef(gbcpu); return;
+	DISPATCH_TARGET(cb_f0, 0xf0): gen_cb_f0(gbcpu); return;
+	DISPATCH_TARGET(cb_f1, 0xf1): gen_cb_f1(gbcpu); return;
+	DISPATCH_TARGET(cb_f2, 0xf2): gen_cb_f2(gbcpu); return;
+	DISPATCH_TARGET(cb_f3, 0xf3): gen_cb_f3(gbcpu); return;
+	DISPATCH_TARGET(cb_f4, 0xf4): gen_cb_f4(gbcpu); return;
+	DISPATCH_TARGET(cb_f5, 0xf5): gen_cb_f5(gbcpu); return;
+	DISPATCH_TARGET(cb_f6, 0xf6): gen_cb_f6(gbcpu); return;
+	DISPATCH_TARGET(cb_f7, 0xf7): gen_cb_f7(gbcpu); return;
+	DISPATCH_TARGET(cb_f8, 0xf8): gen_cb_f8(gbcpu); return;
+	DISPATCH_TARGET(cb_f9, 0xf9): gen_cb_f9(gbcpu); return;
+	DISPATCH_TARGET(cb_fa, 0xfa): gen_cb_fa(gbcpu); return;
+	DISPATCH_TARGET(cb_fb, 0xfb): gen_cb_fb(gbcpu); return;
+	DISPATCH_TARGET(cb_fc, 0xfc): gen_cb_fc(gbcpu); return;
+	DISPATCH_TARGET(cb_fd, 0xfd): gen_cb_fd(gbcpu); return;
+	DISPATCH_TARGET(cb_fe, 0xfe): gen_cb_fe(gbcpu); return;
+	DISPATCH_TARGET(cb_ff, 0xff): gen_cb_ff(gbcpu); return;
+	DISPATCH_END
+}
+
+/* cc CALL Z */
+static inline void gen_op_cc(struct gbcpu* const gbcpu)
+{
+	uint16_t ofs = get_imm16(gbcpu);
+
+	if (!flag_z(gbcpu)) return;
+	gbcpu->cycles += 4;
+	push(gbcpu, REGS16_R(gbcpu->regs, GBS_PC));
+	REGS16_W(gbcpu->regs, GBS_PC, ofs);
+}
+
+/* cd CALL */
+static inline void gen_op_cd(struct gbcpu* const gbcpu)
+{
+	op_call(gbcpu, 0xcd, &ops[0xcd]);
+}
+
+/* ce ADC A, imm8 */
+static inline void gen_op_ce(struct gbcpu* const gbcpu)
+{
+	uint8_t val = get_imm8(gbcpu);
+	uint32_t res = gbcpu->regs.rn.a + val + flag_c(gbcpu);
+
+	flags_alu(gbcpu, res, gbcpu->regs.rn.a ^ val ^ res, 0);
+	gbcpu->regs.rn.a = res;
+}
+
+/* cf RST 0x08 */
+static inline void gen_op_cf(struct gbcpu* const gbcpu)
+{
+	push(gbcpu, REGS16_R(gbcpu->regs, GBS_PC));
+	REGS16_W(gbcpu->regs, GBS_PC, 0x08);
+	gbcpu->cycles += 4;
+}
+
+/* d0 RET NC */
+static inline void gen_op_d0(struct gbcpu* const gbcpu)
+{
+	gbcpu->cycles += 4;
+	if (flag_c(gbcpu)) return;
+	gbcpu->cycles += 4;
+	REGS16_W(gbcpu->regs, GBS_PC, pop(gbcpu));
+}
+
+/* d1 POP DE */
+static inline void gen_op_d1(struct gbcpu* const gbcpu)
+{
+	REGS16_W(gbcpu->regs, DE, pop(gbcpu));
+}
+
+/* d2 JP NC */
+static inline void gen_op_d2(struct gbcpu* const gbcpu)
+{
+	uint16_t ofs = get_imm16(gbcpu);
+
+	if (flag_c(gbcpu)) return;
+	gbcpu->cycles += 4;
+	REGS16_W(gbcpu->regs, GBS_PC, ofs);
+}
+
+/* d3 UNKN */
+static inline void gen_op_d3(struct gbcpu* const gbcpu)
+{
+	op_unknown(gbcpu, 0xd3, &ops[0xd3]);
+}
+
+/* d4 CALL NC */
+static inline void gen_op_d4(struct gbcpu* const gbcpu)
+{
+	uint16_t ofs = get_imm16(gbcpu);
+
+	if (flag_c(gbcpu)) return;
+	gbcpu->cycles += 4;
+	push(gbcpu, REGS16_R(gbcpu->regs, GBS_PC));
+	REGS16_W(gbcpu->regs, GBS_PC, ofs);
+}
+
+/* d5 PUSH DE */
+static inline void gen_op_d5(struct gbcpu* const gbcpu)
+{
+	push(gbcpu, REGS16_R(gbcpu->regs, DE));
+	gbcpu->cycles += 4;
+}
+
+/* d6 SUB A, imm8 */
+static inline void gen_op_d6(struct gbcpu* const gbcpu)
+{
+	uint8_t val = get_imm8(gbcpu);
+	uint32_t res = gbcpu->regs.rn.a - val;
+
+	flags_alu(gbcpu, res, gbcpu->regs.rn.a ^ val ^ res, NF);
+	gbcpu->regs.rn.a = res;
+}
+
+/* d7 RST 0x10 */
+static inline void gen_op_d7(struct gbcpu* const gbcpu)
+{
+	push(gbcpu, REGS16_R(gbcpu->regs, GBS_PC));
+	REGS16_W(gbcpu->regs, GBS_PC, 0x10);
+	gbcpu->cycles += 4;
+}
+
+/* d8 RET C */
+static inline void gen_op_d8(struct gbcpu* const gbcpu)
+{
+	gbcpu->cycles += 4;
+	if (!flag_c(gbcpu)) return;
+	gbcpu->cycles += 4;
+	REGS16_W(gbcpu->regs, GBS_PC, pop(gbcpu));
+}
+
+/* d9 RETI */
+static inline void gen_op_d9(struct gbcpu* const gbcpu)
+{
+	op_reti(gbcpu, 0xd9, &ops[0xd9]);
+}
+
+/* da JP C */
+static inline void gen_op_da(struct gbcpu* const gbcpu)
+{
+	uint16_t ofs = get_imm16(gbcpu);
+
+	if (!flag_c(gbcpu)) return;
+	gbcpu->cycles += 4;
+	REGS16_W(gbcpu->regs, GBS_PC, ofs);
+}
+
+/* db UNKN */
+static inline void gen_op_db(struct gbcpu* const gbcpu)
+{
+	op_unknown(gbcpu, 0xdb, &ops[0xdb]);
+}
+
+/* dc CALL C */
+static inline void gen_op_dc(struct gbcpu* const gbcpu)
+{
+	uint16_t ofs = get_imm16(gbcpu);
+
+	if (!flag_c(gbcpu)) return;
+	gbcpu->cycles += 4;
+	push(gbcpu, REGS16_R(gbcpu->regs, GBS_PC));
+	REGS16_W(gbcpu->regs, GBS_PC, ofs);
+}
+
+/* dd UNKN */
+static inline void gen_op_dd(struct gbcpu* const gbcpu)
+{
+	op_unknown(gbcpu, 0xdd, &ops[0xdd]);
+}
+
+/* de SBC A, imm8 */
+static inline void gen_op_de(struct gbcpu* const gbcpu)
+{
+	uint8_t val = get_imm8(gbcpu);
+	uint32_t res = gbcpu->regs.rn.a - val - flag_c(gbcpu);
+
+	flags_alu(gbcpu, res, gbcpu->regs.rn.a ^ val ^ res, NF);
+	gbcpu->regs.rn.a = res;
+}
+
+/* df RST 0x18 */
+static inline void gen_op_df(struct gbcpu* const gbcpu)
+{
+	push(gbcpu, REGS16_R(gbcpu->regs, GBS_PC));
+	REGS16_W(gbcpu->regs, GBS_PC, 0x18);
+	gbcpu->cycles += 4;
+}
+
+/* e0 LDH [imm8], A */
+static inline void gen_op_e0(struct gbcpu* const gbcpu)
+{
+	uint32_t ofs = get_imm8(gbcpu);
+
+	mem_put(gbcpu, 0xff00 + ofs, gbcpu->regs.rn.a);
+}
+
+/* e1 POP HL */
+static inline void gen_op_e1(struct gbcpu* const gbcpu)
+{
+	REGS16_W(gbcpu->regs, HL, pop(gbcpu));
+}
+
+/* e2 LDH [C], A */
+static inline void gen_op_e2(struct gbcpu* const gbcpu)
+{
+	uint32_t ofs = gbcpu->regs.rn.c;
+
+	mem_put(gbcpu, 0xff00 + ofs, gbcpu->regs.rn.a);
+}
+
+/* e3 UNKN */
+static inline void gen_op_e3(struct gbcpu* const gbcpu)
+{
+	op_unknown(gbcpu, 0xe3, &ops[0xe3]);
+}
+
+/* e4 UNKN */
+static inline void gen_op_e4(struct gbcpu* const gbcpu)
+{
+	op_unknown(gbcpu, 0xe4, &ops[0xe4]);
+}
+
+/* e5 PUSH HL */
+static inline void gen_op_e5(struct gbcpu* const gbcpu)
+{
+	push(gbcpu, REGS16_R(gbcpu->regs, HL));
+	gbcpu->cycles += 4;
+}
+
+/* e6 AND A, imm8 */
+static inline void gen_op_e6(struct gbcpu* const gbcpu)
+{
+	uint8_t val = get_imm8(gbcpu);
+
+	gbcpu->regs.rn.a &= val;
+	flags_alu(gbcpu, gbcpu->regs.rn.a, HF >> 1, 0);
+}
+
+/* e7 RST 0x20 */
+static inline void gen_op_e7(struct gbcpu* const gbcpu)
+{
+	push(gbcpu, REGS16_R(gbcpu->regs, GBS_PC));
+	REGS16_W(gbcpu->regs, GBS_PC, 0x20);
+	gbcpu->cycles += 4;
+}
+
+/* e8 ADD */
+static inline void gen_op_e8(struct gbcpu* const gbcpu)
+{
+	flags_sync(gbcpu);
+	op_add_sp_imm(gbcpu, 0xe8, &ops[0xe8]);
+}
+
+/* e9 JP */
+static inline void gen_op_e9(struct gbcpu* const gbcpu)
+{
+	op_jp_hl(gbcpu, 0xe9, &ops[0xe9]);
+}
+
+/* ea LD */
+static inline void gen_op_ea(struct gbcpu* const gbcpu)
+{
+	op_ld_ind16_a(gbcpu, 0xea, &ops[0xea]);
+}
+
+/* eb UNKN */
+static inline void gen_op_eb(struct gbcpu* const gbcpu)
+{
+	op_unknown(gbcpu, 0xeb, &ops[0xeb]);
+}
+
+/* ec UNKN */
+static inline void gen_op_ec(struct gbcpu* const gbcpu)
+{
+	op_unknown(gbcpu, 0xec, &ops[0xec]);
+}
+
+/* ed UNKN */
+static inline void gen_op_ed(struct gbcpu* const gbcpu)
+{
+	op_unknown(gbcpu, 0xed, &ops[0xed]);
+}
+
+/* ee XOR A, imm8 */
+static inline void gen_op_ee(struct gbcpu* const gbcpu)
+{
+	uint8_t val = get_imm8(gbcpu);
+
+	gbcpu->regs.rn.a ^= val;
+	flags_alu(gbcpu, gbcpu->regs.rn.a, 0, 0);
+}
+
+/* ef RST 0x28 */
+static inline void gen_op_ef(struct gbcpu* const gbcpu)
+{
+	push(gbcpu, REGS16_R(gbcpu->regs, GBS_PC));
+	REGS16_W(gbcpu->regs, GBS_PC, 0x28);
+	gbcpu->cycles += 4;
+}
+
+/* f0 LDH A, [imm8] */
+static inline void gen_op_f0(struct gbcpu* const gbcpu)
+{
+	uint32_t ofs = get_imm8(gbcpu);
+
+	gbcpu->regs.rn.a = mem_get(gbcpu, 0xff00 + ofs);
+}
+
+/* f1 POP */
+static inline void gen_op_f1(struct gbcpu* const gbcpu)
+{
+	flags_sync(gbcpu);
+	op_pop_af(gbcpu, 0xf1, &ops[0xf1]);
+}
+
+/* f2 LDH A, [C] */
+static inline void gen_op_f2(struct gbcpu* const gbcpu)
+{
+	uint32_t ofs = gbcpu->regs.rn.c;
+
+	gbcpu->regs.rn.a = mem_get(gbcpu, 0xff00 + ofs);
+}
+
+/* f3 DI */
+static inline void gen_op_f3(struct gbcpu* const gbcpu)
+{
+	op_di(gbcpu, 0xf3, &ops[0xf3]);
+}
+
+/* f4 UNKN */
+static inline void gen_op_f4(struct gbcpu* const gbcpu)
+{
+	op_unknown(gbcpu, 0xf4, &ops[0xf4]);
+}
+
+/* f5 PUSH */
+static inline void gen_op_f5(struct gbcpu* const gbcpu)
+{
+	flags_sync(gbcpu);
+	op_push_af(gbcpu, 0xf5, &ops[0xf5]);
+}
+
+/* f6 OR A, imm8 */
+static inline void gen_op_f6(struct gbcpu* const gbcpu)
+{
+	uint8_t val = get_imm8(gbcpu);
+
+	gbcpu->regs.rn.a |= val;
+	flags_alu(gbcpu, gbcpu->regs.rn.a, 0, 0);
+}
+
+/* f7 RST 0x30 */
+static inline void gen_op_f7(struct gbcpu* const gbcpu)
+{
+	push(gbcpu, REGS16_R(gbcpu->regs, GBS_PC));
+	REGS16_W(gbcpu->regs, GBS_PC, 0x30);
+	gbcpu->cycles += 4;
+}
+
+/* f8 LD */
+static inline void gen_op_f8(struct gbcpu* const gbcpu)
+{
+	flags_sync(gbcpu);
+	op_ld_hlsp(gbcpu, 0xf8, &ops[0xf8]);
+}
+
+/* f9 LD */
+static inline void gen_op_f9(struct gbcpu* const gbcpu)
+{
+	op_ld_sphl(gbcpu, 0xf9, &ops[0xf9]);
+}
+
+/* fa LD */
+static inline void gen_op_fa(struct gbcpu* const gbcpu)
+{
+	op_ld_imm(gbcpu, 0xfa, &ops[0xfa]);
+}
+
+/* fb EI */
+static inline void gen_op_fb(struct gbcpu* const gbcpu)
+{
+	op_ei(gbcpu, 0xfb, &ops[0xfb]);
+}
+
+/* fc UNKN */
+static inline void gen_op_fc(struct gbcpu* const gbcpu)
+{
+	op_unknown(gbcpu, 0xfc, &ops[0xfc]);
+}
+
+/* fd UNKN */
+static inline void gen_op_fd(struct gbcpu* const gbcpu)
+{
+	op_unknown(gbcpu, 0xfd, &ops[0xfd]);
+}
+
+/* fe CP A, imm8 */
+static inline void gen_op_fe(struct gbcpu* const gbcpu)
+{
+	uint8_t val = get_imm8(gbcpu);
+	uint32_t res = gbcpu->regs.rn.a - val;
+
+	flags_alu(gbcpu, res, gbcpu->regs.rn.a ^ val ^ res, NF);
+}
+
+/* ff RST 0x38 */
+static inline void gen_op_ff(struct gbcpu* const gbcpu)
+{
+	push(gbcpu, REGS16_R(gbcpu->regs, GBS_PC));
+	REGS16_W(gbcpu->regs, GBS_PC, 0x38);
+	gbcpu->cycles += 4;
+}
+
@@ -0,0 +1,275 @@
+/*
+ * gbsplay is a Gameboy sound player
+ *
+ * SM83 opcode list shared by the CPU core and its handler generator
+ *
+ * 2026 (C) Licensed under GNU GPL v1 or, at your option, any later version.
+ */
+
+#ifndef _GBCPU_OPTABLE_H_
+#define _GBCPU_OPTABLE_H_
+
+/*
+ * Opcode list: X(opcode, name, handler, cycles_1, cycles_2).
+ * Expanded into the ops[] table and the threaded dispatch of gbcpu.c,
+ * and into the specialized handlers written by gen_gbcpu_ops_h.
+ */
+#define OPTABLE(X) \
+	X(00, "NOP",      op_nop         , 1, 1) \
+	X(01, "LD",       op_ld_reg16_imm, 3, 3) \
+	X(02, "LD",       op_ld_reg16_a  , 2, 2) \
+	X(03, "INC",      op_inc16       , 2, 2) \
+	X(04, "INC",      op_inc         , 1, 1) \
+	X(05, "DEC",      op_dec         , 1, 1) \
+	X(06, "LD",       op_ld_reg8_imm , 2, 2) \
+	X(07, "RLCA",     op_rlca        , 1, 1) \
+	X(08, "LD",       op_ld_ind16_sp , 5, 5) \
+	X(09, "ADD",      op_add_hl      , 2, 2) \
+	X(0a, "LD",       op_ld_reg16_a  , 2, 2) \
+	X(0b, "DEC",      op_dec16       , 2, 2) \
+	X(0c, "INC",      op_inc         , 1, 1) \
+	X(0d, "DEC",      op_dec         , 1, 1) \
+	X(0e, "LD",       op_ld_reg8_imm , 2, 2) \
+	X(0f, "RRCA",     op_rrca        , 1, 1) \
+	X(10, "STOP",     op_stop        , 0, 0) \
+	X(11, "LD",       op_ld_reg16_imm, 3, 3) \
+	X(12, "LD",       op_ld_reg16_a  , 2, 2) \
+	X(13, "INC",      op_inc16       , 2, 2) \
+	X(14, "INC",      op_inc         , 1, 1) \
+	X(15, "DEC",      op_dec         , 1, 1) \
+	X(16, "LD",       op_ld_reg8_imm , 2, 2) \
+	X(17, "RLA",      op_rla         , 1, 1) \
+	X(18, "JR",       op_jr          , 3, 3) \
+	X(19, "ADD",      op_add_hl      , 2, 2) \
+	X(1a, "LD",       op_ld_reg16_a  , 2, 2) \
+	X(1b, "DEC",      op_dec16       , 2, 2) \
+	X(1c, "INC",      op_inc         , 1, 1) \
+	X(1d, "DEC",      op_dec         , 1, 1) \
+	X(1e, "LD",       op_ld_reg8_imm , 2, 2) \
+	X(1f, "RRA",      op_rra         , 1, 1) \
+	X(20, "JR",       op_jr_cond     , 2, 3) \
+	X(21, "LD",       op_ld_reg16_imm, 3, 3) \
+	X(22, "LDI",      op_ld_reg16_a  , 2, 2) \
+	X(23, "INC",      op_inc16       , 2, 2) \
+	X(24, "INC",      op_inc         , 1, 1) \
+	X(25, "DEC",      op_dec         , 1, 1) \
+	X(26, "LD",       op_ld_reg8_imm , 2, 2) \
+	X(27, "DAA",      op_daa         , 1, 1) \
+	X(28, "JR",       op_jr_cond     , 2, 3) \
+	X(29, "ADD",      op_add_hl      , 2, 2) \
+	X(2a, "LDI",      op_ld_reg16_a  , 2, 2) \
+	X(2b, "DEC",      op_dec16       , 2, 2) \
+	X(2c, "INC",      op_inc         , 1, 1) \
+	X(2d, "DEC",      op_dec         , 1, 1) \
+	X(2e, "LD",       op_ld_reg8_imm , 2, 2) \
+	X(2f, "CPL",      op_cpl         , 1, 1) \
+	X(30, "JR",       op_jr_cond     , 2, 3) \
+	X(31, "LD",       op_ld_reg16_imm, 3, 3) \
+	X(32, "LDD",      op_ld_reg16_a  , 2, 2) \
+	X(33, "INC",      op_inc16       , 2, 2) \
+	X(34, "INC",      op_inc         , 3, 3) \
+	X(35, "DEC",      op_dec         , 3, 3) \
+	X(36, "LD",       op_ld_reg8_imm , 3, 3) \
+	X(37, "SCF",      op_scf         , 1, 1) \
+	X(38, "JR",       op_jr_cond     , 2, 3) \
+	X(39, "ADD",      op_add_hl      , 2, 2) \
+	X(3a, "LDD",      op_ld_reg16_a  , 2, 2) \
+	X(3b, "DEC",      op_dec16       , 2, 2) \
+	X(3c, "INC",      op_inc         , 1, 1) \
+	X(3d, "DEC",      op_dec         , 1, 1) \
+	X(3e, "LD",       op_ld_reg8_imm , 2, 2) \
+	X(3f, "CCF",      op_ccf         , 1, 1) \
+	X(40, "LD",       op_ld          , 1, 1) \
+	X(41, "LD",       op_ld          , 1, 1) \
+	X(42, "LD",       op_ld          , 1, 1) \
+	X(43, "LD",       op_ld          , 1, 1) \
+	X(44, "LD",       op_ld          , 1, 1) \
+	X(45, "LD",       op_ld          , 1, 1) \
+	X(46, "LD",       op_ld          , 2, 2) \
+	X(47, "LD",       op_ld          , 1, 1) \
+	X(48, "LD",       op_ld          , 1, 1) \
+	X(49, "LD",       op_ld          , 1, 1) \
+	X(4a, "LD",       op_ld          , 1, 1) \
+	X(4b, "LD",       op_ld          , 1, 1) \
+	X(4c, "LD",       op_ld          , 1, 1) \
+	X(4d, "LD",       op_ld          , 1, 1) \
+	X(4e, "LD",       op_ld          , 2, 2) \
+	X(4f, "LD",       op_ld          , 1, 1) \
+	X(50, "LD",       op_ld          , 1, 1) \
+	X(51, "LD",       op_ld          , 1, 1) \
+	X(52, "LD",       op_ld          , 1, 1) \
+	X(53, "LD",       op_ld          , 1, 1) \
+	X(54, "LD",       op_ld          , 1, 1) \
+	X(55, "LD",       op_ld          , 1, 1) \
+	X(56, "LD",       op_ld          , 2, 2) \
+	X(57, "LD",       op_ld          , 1, 1) \
+	X(58, "LD",       op_ld          , 1, 1) \
+	X(59, "LD",       op_ld          , 1, 1) \
+	X(5a, "LD",       op_ld          , 1, 1) \
+	X(5b, "LD",       op_ld          , 1, 1) \
+	X(5c, "LD",       op_ld          , 1, 1) \
+	X(5d, "LD",       op_ld          , 1, 1) \
+	X(5e, "LD",       op_ld          , 2, 2) \
+	X(5f, "LD",       op_ld          , 1, 1) \
+	X(60, "LD",       op_ld          , 1, 1) \
+	X(61, "LD",       op_ld          , 1, 1) \
+	X(62, "LD",       op_ld          , 1, 1) \
+	X(63, "LD",       op_ld          , 1, 1) \
+	X(64, "LD",       op_ld          , 1, 1) \
+	X(65, "LD",       op_ld          , 1, 1) \
+	X(66, "LD",       op_ld          , 2, 2) \
+	X(67, "LD",       op_ld          , 1, 1) \
+	X(68, "LD",       op_ld          , 1, 1) \
+	X(69, "LD",       op_ld          , 1, 1) \
+	X(6a, "LD",       op_ld          , 1, 1) \
+	X(6b, "LD",       op_ld          , 1, 1) \
+	X(6c, "LD",       op_ld          , 1, 1) \
+	X(6d, "LD",       op_ld          , 1, 1) \
+	X(6e, "LD",       op_ld          , 2, 2) \
+	X(6f, "LD",       op_ld          , 1, 1) \
+	X(70, "LD",       op_ld          , 2, 2) \
+	X(71, "LD",       op_ld          , 2, 2) \
+	X(72, "LD",       op_ld          , 2, 2) \
+	X(73, "LD",       op_ld          , 2, 2) \
+	X(74, "LD",       op_ld          , 2, 2) \
+	X(75, "LD",       op_ld          , 2, 2) \
+	X(76, "HALT",     op_halt        , 0, 0) \
+	X(77, "LD",       op_ld          , 2, 2) \
+	X(78, "LD",       op_ld          , 1, 1) \
+	X(79, "LD",       op_ld          , 1, 1) \
+	X(7a, "LD",       op_ld          , 1, 1) \
+	X(7b, "LD",       op_ld          , 1, 1) \
+	X(7c, "LD",       op_ld          , 1, 1) \
+	X(7d, "LD",       op_ld          , 1, 1) \
+	X(7e, "LD",       op_ld          , 2, 2) \
+	X(7f, "LD",       op_ld          , 1, 1) \
+	X(80, "ADD",      op_add         , 1, 1) \
+	X(81, "ADD",      op_add         , 1, 1) \
+	X(82, "ADD",      op_add         , 1, 1) \
+	X(83, "ADD",      op_add         , 1, 1) \
+	X(84, "ADD",      op_add         , 1, 1) \
+	X(85, "ADD",      op_add         , 1, 1) \
+	X(86, "ADD",      op_add         , 2, 2) \
+	X(87, "ADD",      op_add         , 1, 1) \
+	X(88, "ADC",      op_adc         , 1, 1) \
+	X(89, "ADC",      op_adc         , 1, 1) \
+	X(8a, "ADC",      op_adc         , 1, 1) \
+	X(8b, "ADC",      op_adc         , 1, 1) \
+	X(8c, "ADC",      op_adc         , 1, 1) \
+	X(8d, "ADC",      op_adc         , 1, 1) \
+	X(8e, "ADC",      op_adc         , 2, 2) \
+	X(8f, "ADC",      op_adc         , 1, 1) \
+	X(90, "SUB",      op_sub         , 1, 1) \
+	X(91, "SUB",      op_sub         , 1, 1) \
+	X(92, "SUB",      op_sub         , 1, 1) \
+	X(93, "SUB",      op_sub         , 1, 1) \
+	X(94, "SUB",      op_sub         , 1, 1) \
+	X(95, "SUB",      op_sub         , 1, 1) \
+	X(96, "SUB",      op_sub         , 2, 2) \
+	X(97, "SUB",      op_sub         , 1, 1) \
+	X(98, "SBC",      op_sbc         , 1, 1) \
+	X(99, "SBC",      op_sbc         , 1, 1) \
+	X(9a, "SBC",      op_sbc         , 1, 1) \
+	X(9b, "SBC",      op_sbc         , 1, 1) \
+	X(9c, "SBC",      op_sbc         , 1, 1) \
+	X(9d, "SBC",      op_sbc         , 1, 1) \
+	X(9e, "SBC",      op_sbc         , 2, 2) \
+	X(9f, "SBC",      op_sbc         , 1, 1) \
+	X(a0, "AND",      op_and         , 1, 1) \
+	X(a1, "AND",      op_and         , 1, 1) \
+	X(a2, "AND",      op_and         , 1, 1) \
+	X(a3, "AND",      op_and         , 1, 1) \
+	X(a4, "AND",      op_and         , 1, 1) \
+	X(a5, "AND",      op_and         , 1, 1) \
+	X(a6, "AND",      op_and         , 2, 2) \
+	X(a7, "AND",      op_and         , 1, 1) \
+	X(a8, "XOR",      op_xor         , 1, 1) \
+	X(a9, "XOR",      op_xor         , 1, 1) \
+	X(aa, "XOR",      op_xor         , 1, 1) \
+	X(ab, "XOR",      op_xor         , 1, 1) \
+	X(ac, "XOR",      op_xor         , 1, 1) \
+	X(ad, "XOR",      op_xor         , 1, 1) \
+	X(ae, "XOR",      op_xor         , 2, 2) \
+	X(af, "XOR",      op_xor         , 1, 1) \
+	X(b0, "OR",       op_or          , 1, 1) \
+	X(b1, "OR",       op_or          , 1, 1) \
+	X(b2, "OR",       op_or          , 1, 1) \
+	X(b3, "OR",       op_or          , 1, 1) \
+	X(b4, "OR",       op_or          , 1, 1) \
+	X(b5, "OR",       op_or          , 1, 1) \
+	X(b6, "OR",       op_or          , 2, 2) \
+	X(b7, "OR",       op_or          , 1, 1) \
+	X(b8, "CP",       op_cp          , 1, 1) \
+	X(b9, "CP",       op_cp          , 1, 1) \
+	X(ba, "CP",       op_cp          , 1, 1) \
+	X(bb, "CP",       op_cp          , 1, 1) \
+	X(bc, "CP",       op_cp          , 1, 1) \
+	X(bd, "CP",       op_cp          , 1, 1) \
+	X(be, "CP",       op_cp          , 2, 2) \
+	X(bf, "CP",       op_cp          , 1, 1) \
+	X(c0, "RET",      op_ret_cond    , 2, 5) \
+	X(c1, "POP",      op_pop         , 3, 3) \
+	X(c2, "JP",       op_jp_cond     , 3, 4) \
+	X(c3, "JP",       op_jp          , 4, 4) \
+	X(c4, "CALL",     op_call_cond   , 3, 6) \
+	X(c5, "PUSH",     op_push        , 4, 4) \
+	X(c6, "ADD",      op_add_imm     , 2, 2) \
+	X(c7, "RST",      op_rst         , 4, 4) \
+	X(c8, "RET",      op_ret_cond    , 2, 5) \
+	X(c9, "RET",      op_ret         , 4, 4) \
+	X(ca, "JP",       op_jp_cond     , 3, 4) \
+	X(cb, "CBPREFIX", op_cbprefix    , 0, 0) \
+	X(cc, "CALL",     op_call_cond   , 3, 6) \
+	X(cd, "CALL",     op_call        , 6, 6) \
+	X(ce, "ADC",      op_adc_imm     , 2, 2) \
+	X(cf, "RST",      op_rst         , 4, 4) \
+	X(d0, "RET",      op_ret_cond    , 2, 5) \
+	X(d1, "POP",      op_pop         , 3, 3) \
+	X(d2, "JP",       op_jp_cond     , 3, 4) \
+	X(d3, "UNKN",     op_unknown     , 0, 0) \
+	X(d4, "CALL",     op_call_cond   , 3, 6) \
+	X(d5, "PUSH",     op_push        , 4, 4) \
+	X(d6, "SUB",      op_sub_imm     , 2, 2) \
+	X(d7, "RST",      op_rst         , 4, 4) \
+	X(d8, "RET",      op_ret_cond    , 2, 5) \
+	X(d9, "RETI",     op_reti        , 4, 4) \
+	X(da, "JP",       op_jp_cond     , 3, 4) \
+	X(db, "UNKN",     op_unknown     , 0, 0) \
+	X(dc, "CALL",     op_call_cond   , 3, 6) \
+	X(dd, "UNKN",     op_unknown     , 0, 0) \
+	X(de, "SBC",      op_sbc_imm     , 2, 2) \
+	X(df, "RST",      op_rst         , 4, 4) \
+	X(e0, "LDH",      op_ldh         , 3, 3) \
+	X(e1, "POP",      op_pop         , 3, 3) \
+	X(e2, "LDH",      op_ldh         , 2, 2) \
+	X(e3, "UNKN",     op_unknown     , 0, 0) \
+	X(e4, "UNKN",     op_unknown     , 0, 0) \
+	X(e5, "PUSH",     op_push        , 4, 4) \
+	X(e6, "AND",      op_and_imm     , 2, 2) \
+	X(e7, "RST",      op_rst         , 4, 4) \
+	X(e8, "ADD",      op_add_sp_imm  , 4, 4) \
+	X(e9, "JP",       op_jp_hl       , 1, 1) \
+	X(ea, "LD",       op_ld_ind16_a  , 4, 4) \
+	X(eb, "UNKN",     op_unknown     , 0, 0) \
+	X(ec, "UNKN",     op_unknown     , 0, 0) \
+	X(ed, "UNKN",     op_unknown     , 0, 0) \
+	X(ee, "XOR",      op_xor_imm     , 2, 2) \
+	X(ef, "RST",      op_rst         , 4, 4) \
+	X(f0, "LDH",      op_ldh         , 3, 3) \
+	X(f1, "POP",      op_pop_af      , 3, 3) \
+	X(f2, "LDH",      op_ldh         , 2, 2) \
+	X(f3, "DI",       op_di          , 1, 1) \
+	X(f4, "UNKN",     op_unknown     , 0, 0) \
+	X(f5, "PUSH",     op_push_af     , 4, 4) \
+	X(f6, "OR",       op_or_imm      , 2, 2) \
+	X(f7, "RST",      op_rst         , 4, 4) \
+	X(f8, "LD",       op_ld_hlsp     , 3, 3) \
+	X(f9, "LD",       op_ld_sphl     , 2, 2) \
+	X(fa, "LD",       op_ld_imm      , 4, 4) \
+	X(fb, "EI",       op_ei          , 1, 1) \
+	X(fc, "UNKN",     op_unknown     , 0, 0) \
+	X(fd, "UNKN",     op_unknown     , 0, 0) \
+	X(fe, "CP",       op_cp_imm      , 2, 2) \
+	X(ff, "RST",      op_rst         , 4, 4)
+
+#endif
@@ -0,0 +1,237 @@
+/*
+ * gbsplay is a Gameboy sound player
+ *
+ * gbcpubench - SM83 interpreter core benchmark
+ *
+ * Runs the init and play routines of a GBS file on a bare CPU (no APU,
+ * no interrupts) once with the reference ops[] table core, once with
+ * the core selected at build time and once with that core running
+ * whole frames through gbcpu_run(), reports emulated MHz for each and
+ * checks that all produce the same register-write stream.  Every
+ * measurement plays the song repeatedly for at least a second.  The hit
+ * rate of the decoded instruction cache is shown for the built core
+ * when it is enabled (-DGBCPU_ICACHE=1).
+ *
+ * 2026 (C) Licensed under GNU GPL v1 or, at your option, any later version.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "common.h"
+#include "gbcpu.h"
+#include "mapper.h"
+
+#define HDR_LEN_GBS 0x70
+#define FRAME_CYCLES 70224
+#define MIN_PASS_TIME 1.0	/* seconds */
+
+typedef long (*step_fn)(struct gbcpu* const gbcpu);
+
+struct bench {
+	struct gbcpu gbcpu;
+	struct mapper *mapper;
+	uint8_t *rom;
+	size_t romsize;
+	uint16_t init, play, stack;
+
+	uint8_t wram[0x2000];
+	uint8_t ioram[0x100];
+
+	long long cycles;
+	uint64_t hash;
+	long writes;
+};
+
+static uint32_t wram_get(void *priv, uint32_t addr)
+{
+	struct bench *b = priv;
+	return b->wram[addr & 0x1fff];
+}
+
+static void wram_put(void *priv, uint32_t addr, uint8_t val)
+{
+	struct bench *b = priv;
+	b->wram[addr & 0x1fff] = val;
+}
+
+static uint32_t io_get(void *priv, uint32_t addr)
+{
+	struct bench *b = priv;
+	return b->ioram[addr & 0xff];
+}
+
+static void io_put(void *priv, uint32_t addr, uint8_t val)
+{
+	struct bench *b = priv;
+	b->ioram[addr & 0xff] = val;
+	if (addr >= 0xff80 && addr <= 0xfffe)
+		return;
+	/* FNV-1a over the timestamped register write stream */
+	b->hash = (b->hash ^ (b->cycles + b->gbcpu.run_cycles)) * 0x100000001b3ULL;
+	b->hash = (b->hash ^ ((addr & 0xff) << 8 | val)) * 0x100000001b3ULL;
+	b->writes++;
+}
+
+static void call(struct bench *b, uint16_t addr)
+{
+	struct gbcpu *gbcpu = &b->gbcpu;
+	uint16_t sp = REGS16_R(gbcpu->regs, SP) - 2;
+
+	/* return into the halt breakpoint */
+	REGS16_W(gbcpu->regs, SP, sp);
+	gbcpu_mem_put(gbcpu, sp, gbcpu->halt_at_pc & 0xff);
+	gbcpu_mem_put(gbcpu, sp + 1, gbcpu->halt_at_pc >> 8);
+	REGS16_W(gbcpu->regs, GBS_PC, addr);
+	gbcpu->halted = 0;
+}
+
+static long run_frame(struct bench *b, step_fn step)
+{
+	struct gbcpu *gbcpu = &b->gbcpu;
+	long cycles = 0;
+
+	while (cycles < FRAME_CYCLES && !gbcpu->halted) {
+		long c = step ? step(gbcpu) : gbcpu_run(gbcpu, FRAME_CYCLES - cycles);
+
+		gbcpu->run_cycles = 0;
+		if (c < 0)
+			break;
+		cycles += c;
+		b->cycles += c;
+	}
+	return cycles;
+}
+
+static void bench_reset(struct bench *b, long subsong)
+{
+	struct gbcpu *gbcpu = &b->gbcpu;
+
+	if (b->mapper)
+		mapper_free(b->mapper);
+	memset(b->wram, 0, sizeof(b->wram));
+	memset(b->ioram, 0, sizeof(b->ioram));
+	b->cycles = 0;
+	b->hash = 0xcbf29ce484222325ULL;
+	b->writes = 0;
+
+	gbcpu_init_struct(gbcpu);
+	gbcpu_init(gbcpu);
+	b->mapper = mapper_gbs(gbcpu, b->rom, b->romsize);
+	gbcpu_add_mem(gbcpu, 0xc0, 0xfe, wram_put, wram_get, b);
+	gbcpu_add_mem(gbcpu, 0xff, 0xff, io_put, io_get, b);
+	gbcpu_map_direct(gbcpu, 0xc0, 0xdf, b->wram, b->wram);
+	gbcpu_map_direct(gbcpu, 0xe0, 0xfe, b->wram, b->wram);
+
+	gbcpu->halt_at_pc = 0xffff;
+	REGS16_W(gbcpu->regs, SP, b->stack);
+	call(b, b->init);
+	gbcpu->regs.rn.a = subsong;
+}
+
+static double now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static uint64_t run(struct bench *b, const char *name, step_fn step, long subsong, long frames)
+{
+	double start, elapsed, best = 0;
+	long long cycles;
+	long i, pass, reps, best_reps = 0;
+
+	/* best of three passes, each at least MIN_PASS_TIME long */
+	for (pass = 0; pass < 3; pass++) {
+		elapsed = 0;
+		cycles = 0;
+		for (reps = 0; elapsed < MIN_PASS_TIME; reps++) {
+			bench_reset(b, subsong);
+			start = now();
+			run_frame(b, step);
+			for (i = 0; i < frames; i++) {
+				if (b->gbcpu.halted)
+					call(b, b->play);
+				run_frame(b, step);
+			}
+			elapsed += now() - start;
+			cycles += b->cycles;
+		}
+		if (cycles / elapsed > best) {
+			best = cycles / elapsed;
+			best_reps = reps;
+		}
+	}
+
+	printf("%-9s core: %8.2f MHz emulated (%ld x %lld cycles, %ld writes in %.3fs)\n",
+	       name, best / 1e6, best_reps, b->cycles, b->writes, best_reps * b->cycles / best);
+#if GBCPU_ICACHE == 1
+	if (step != gbcpu_step_ref) {
+		struct gbcpu *gbcpu = &b->gbcpu;
+		long fetches = gbcpu->icache_hits + gbcpu->icache_misses + gbcpu->icache_uncached;
+		printf("%-9s icache: %ld hits, %ld misses, %ld uncached (%.2f%% hit rate)\n",
+		       "", gbcpu->icache_hits, gbcpu->icache_misses, gbcpu->icache_uncached,
+		       fetches ? 100.0 * gbcpu->icache_hits / fetches : 0.0);
+	}
+#endif
+	return b->hash;
+}
+
+int main(int argc, char **argv)
+{
+	struct bench *b;
+	FILE *f;
+	long size, load, subsong = 0, frames = 60 * 600;
+	uint8_t *buf;
+	uint64_t ref_hash, hash, run_hash;
+
+	if (argc < 2) {
+		fprintf(stderr, "Usage: %s <gbsfile> [subsong] [frames]\n", argv[0]);
+		return 1;
+	}
+	if (argc > 2)
+		subsong = atol(argv[2]);
+	if (argc > 3)
+		frames = atol(argv[3]);
+
+	f = fopen(argv[1], "rb");
+	if (f == NULL) {
+		fprintf(stderr, "Could not open %s: %s\n", argv[1], strerror(errno));
+		return 1;
+	}
+	fseek(f, 0, SEEK_END);
+	size = ftell(f);
+	fseek(f, 0, SEEK_SET);
+	buf = malloc(size);
+	if (size < HDR_LEN_GBS || fread(buf, 1, size, f) != (size_t)size ||
+	    memcmp(buf, "GBS", 3) != 0) {
+		fprintf(stderr, "%s: not a GBS file\n", argv[1]);
+		return 1;
+	}
+	fclose(f);
+
+	b = calloc(1, sizeof(*b));
+	load = buf[0x06] | buf[0x07] << 8;
+	b->init = buf[0x08] | buf[0x09] << 8;
+	b->play = buf[0x0a] | buf[0x0b] << 8;
+	b->stack = buf[0x0c] | buf[0x0d] << 8;
+	b->romsize = ((size - HDR_LEN_GBS + load + 0x3fff) & ~0x3fff) + 0x4000;
+	b->rom = calloc(1, b->romsize);
+	memcpy(&b->rom[load], &buf[HDR_LEN_GBS], size - HDR_LEN_GBS);
+
+	ref_hash = run(b, "table", gbcpu_step_ref, subsong, frames);
+	hash = run(b, GBCPU_THREADED == 1 ? "threaded" : "table", gbcpu_step, subsong, frames);
+	run_hash = run(b, "batched", NULL, subsong, frames);
+
+	if (hash != ref_hash || run_hash != ref_hash) {
+		fprintf(stderr, "register write streams differ: %016llx, %016llx != %016llx\n",
+		        (unsigned long long)hash, (unsigned long long)run_hash,
+		        (unsigned long long)ref_hash);
+		return 2;
+	}
+	printf("register write streams identical (%016llx)\n", (unsigned long long)hash);
+	return 0;
+}
@@ -16,15 +16,12 @@
 #include <assert.h>
 #include <math.h>
 
-//TODO:  MODIZER changes start / YOYOFR
-#include "../../../src/ModizerVoicesData.h"
-extern int seek_needed;
-//TODO:  MODIZER changes end / YOYOFR
-
-
 #include "gbcpu.h"
 #include "gbhw.h"
 #include "impulse.h"
+#include "impulsegen.h"
+#include "savestate.h"
+#include "test.h"
 
 #define FILTER_CONST_OFF 1.0
 /* From blargg's "Game Boy Sound Operation" doc */
@@ -76,22 +73,46 @@ static const long len_mask[4] = {
 	0x3f, 0x3f, 0xff, 0x3f
 };
 
-#define MASTER_VOL_MIN	0
 #define MASTER_VOL_MAX	(256*256)
 
-static const long vblanktc = 70224; /* ~59.73 Hz (vblankctr)*/
+#define LIMIT8(a) ((a)<-128?-128:((a)>127?127:(a)))
+
+static const long vblanktc = 70224; /* ~59.73 Hz */
 static const long vblankclocks = 4560;
 
 static const long msec_cycles = GBHW_CLOCK/1000;
 
+/* idle loop detection states, see spin_track() */
+#define SPIN_NONE  0
+#define SPIN_PROBE 1  /* running one iteration, noting the polled IO registers */
+#define SPIN_ARMED 2  /* at the loop head in the same state as one iteration ago */
+#define SPIN_CHECK 3  /* IDLE_SKIP_VALIDATE: running what a skip would have covered */
+#define SPIN_MAXLEN 32  /* longest loop considered, in bytes */
+
 #define SOUND_DIV_MULT 0x10000LL
 
-#define IMPULSE_WIDTH (1 << IMPULSE_W_SHIFT)
-#define IMPULSE_N (1 << IMPULSE_N_SHIFT)
-#define IMPULSE_N_MASK (IMPULSE_N - 1)
+/*
+ * Impulse tables per quality level.  The default one is generated at
+ * build time into impulse.h, the others on first use and then shared
+ * by all instances.
+ */
+struct gbhw_impulse {
+	long w_shift;
+	long n_shift;
+	double cutoff;
+	const int32_t *tab;
+};
+
+static struct gbhw_impulse impulses[] = {
+	[QUALITY_DRAFT]   = { 3, 5, 1.0, NULL },
+	[QUALITY_DEFAULT] = { IMPULSE_W_SHIFT, IMPULSE_N_SHIFT, 1.0, base_impulse },
+	[QUALITY_HIGH]    = { 6, 8, 1.0, NULL },
+};
+
+#define IMPULSE_WIDTH(gbhw) (1L << (gbhw)->impulse->w_shift)
 
 static const long main_div_tc = 4;
-static const long sweep_div_tc = 2048;
+static const long sequencer_tc = 8192;  /* 512 Hz frame sequencer */
 
 static inline long timertc_from_tac(uint8_t tac)
 {
@@ -108,8 +129,11 @@ static inline long timertc_from_tac(uint8_t tac)
 }
 
 void gbhw_init_struct(struct gbhw *gbhw) {
+	long i;
+
 	gbhw->apu_on = 1;
-	gbhw->io_written = 0;
+	gbhw->reschedule = 0;
+	gbhw->in_run = 0;
 
 	gbhw->filter_constant = FILTER_CONST_DMG;
 	gbhw->filter_enabled = 1;
@@ -123,8 +147,22 @@ void gbhw_init_struct(struct gbhw *gbhw) {
 
 	gbhw->rom_lockout = 1;
 
+	gbhw->idle_skip = IDLE_SKIP_OFF;
+	gbhw->spin.state = SPIN_NONE;
+
 	gbhw->soundbuf = NULL; /* externally visible output buffer */
+	gbhw->render_out = NULL;
 	gbhw->impbuf = NULL;   /* internal impulse output buffer */
+	memset(&gbhw->evlog, 0, sizeof(gbhw->evlog));
+	gbhw->fade_gain = NULL;
+	gbhw->fade_start = gbhw->fade_end = 0;
+	gbhw->mix = gbmix_get();
+	gbhw->impulse = &impulses[QUALITY_DEFAULT];
+	gbhw->voices = 0;
+	memset(gbhw->voice_imp, 0, sizeof(gbhw->voice_imp));
+	memset(gbhw->voice_out, 0, sizeof(gbhw->voice_out));
+	memset(gbhw->stembuf, 0, sizeof(gbhw->stembuf));
+	memset(gbhw->stem_imp, 0, sizeof(gbhw->stem_imp));
 
 	gblfsr_reset(&gbhw->lfsr);
 
@@ -137,6 +175,8 @@ void gbhw_init_struct(struct gbhw *gbhw) {
     //YOYOFR
     for (int ii=0;ii<4;ii++) gbhw->ch[ii].last_lvl=0;
     //YOYOFR
+	for (i=0; i<4; i++)
+		gbhw->ch[i].stem_l = gbhw->ch[i].stem_r = 0;
 
 	gbcpu_init_struct(&gbhw->gbcpu);
 }
@@ -158,12 +198,110 @@ static void bootrom_put(void *priv, uint32_t addr, uint8_t val)
 		gbhw->boot_shadow_put.priv, addr, val);
 }
 
+static void gb_sound(struct gbhw *gbhw, long cycles);
+
+/* Let the clocks advance by the cycles of completed instructions. */
+static void cpu_advance(struct gbhw *gbhw, long cycles)
+{
+	gbhw->sum_cycles += cycles;
+	gb_sound(gbhw, cycles);
+}
+
+/*
+ * Within gbcpu_run() the clocks lag behind the CPU, catch them up
+ * before an IO register is read or written.
+ */
+static void cpu_sync(struct gbhw *gbhw)
+{
+	long cycles;
+
+	if (!gbhw->in_run)
+		return;
+	cycles = gbhw->gbcpu.run_cycles - gbhw->run_synced;
+	if (cycles > 0) {
+		gbhw->run_synced += cycles;
+		cpu_advance(gbhw, cycles);
+	}
+}
+
+/* Run until the end of the slice, returns the cycles not yet synced. */
+static long cpu_run(struct gbhw *gbhw, long budget)
+{
+	long cycles;
+
+	gbhw->in_run = 1;
+	gbhw->run_synced = 0;
+	cycles = gbcpu_run(&gbhw->gbcpu, budget);
+	gbhw->in_run = 0;
+	return cycles - gbhw->run_synced;
+}
+
+/* cycles until the next vblank */
+static inline long vblank_cycles(const struct gbhw *gbhw)
+{
+	return gbhw->event[GBHW_EV_VBLANK] - gbhw->sum_cycles;
+}
+
+/*
+ * While TAC runs the timer, event[GBHW_EV_TIMER] is the TIMA overflow
+ * and TIMA follows from the ticks left until then.  Only TAC and TIMA
+ * writes move the overflow, TMA is read when it happens.
+ */
+static inline long timer_running(const struct gbhw *gbhw)
+{
+	return gbhw->event[GBHW_EV_TIMER] != GBHW_NEVER;
+}
+
+/* cycles until the next TIMA tick of the running timer */
+static inline long timer_next_tick(const struct gbhw *gbhw)
+{
+	long left = gbhw->event[GBHW_EV_TIMER] - gbhw->sum_cycles;
+	return (left - 1) % gbhw->timertc + 1;
+}
+
+static inline uint8_t timer_tima(const struct gbhw *gbhw)
+{
+	long left = gbhw->event[GBHW_EV_TIMER] - gbhw->sum_cycles;
+	return 0x100 - (left + gbhw->timertc - 1) / gbhw->timertc;
+}
+
+/* cycles until the value io_get() returns for addr may change on its own */
+static long io_stable_cycles(struct gbhw *gbhw, uint32_t addr)
+{
+	long vblankctr = vblank_cycles(gbhw);
+	long t;
+
+	switch (addr) {
+	case 0xff04:  // DIV
+		return 0x100 - (gbhw->sum_cycles & 0xff);
+	case 0xff05:  // TIMA
+		return timer_running(gbhw) ? timer_next_tick(gbhw) : LONG_MAX;
+	case 0xff26:  // NR52 channel status, follows the APU
+		return 0;
+	case 0xff41:  // LCDC Status, see io_get()
+		if (vblankctr > vblanktc - vblankclocks)
+			return vblankctr - (vblanktc - vblankclocks);
+		t = (2 * vblanktc - vblankctr) % 456;
+		return t < 204 ? 204 - t : t < 284 ? 284 - t : 456 - t;
+	case 0xff44:  // LY
+		return 456 - (2 * vblanktc - vblankclocks - vblankctr) % 456;
+	}
+	/* HIRAM, stored registers and constants only change by writes or events */
+	return LONG_MAX;
+}
+
 static uint32_t io_get(void *priv, uint32_t addr)
 {
 	struct gbhw *gbhw = priv;
+	if (gbhw->spin.state == SPIN_PROBE) {
+		cycles_t stable = gbhw->sum_cycles + io_stable_cycles(gbhw, addr);
+		if (stable < gbhw->spin.stable)
+			gbhw->spin.stable = stable;
+	}
 	if (addr >= 0xff80 && addr <= 0xfffe) {
 		return gbhw->hiram[addr & GBHW_HIRAM_MASK];
 	}
+	cpu_sync(gbhw);
 	if (addr >= 0xff10 &&
 	           addr <= 0xff3f) {
 		uint8_t val = gbhw->ioregs[addr & GBHW_IOREGS_MASK];
@@ -187,16 +325,19 @@ static uint32_t io_get(void *priv, uint32_t addr)
 		// DIV increments at 16384Hz
 		return ((gbhw->sum_cycles >> 8) + gbhw->divoffset) & 0xff;
 	case 0xff05:  // TIMA
+		if (timer_running(gbhw))
+			return timer_tima(gbhw);
+		return gbhw->ioregs[REG_TIMA];
 	case 0xff06:  // TMA
 	case 0xff07:  // TAC
 	case 0xff0f:  // IF
 		return gbhw->ioregs[addr & GBHW_IOREGS_MASK];
 	case 0xff41: /* LCDC Status */
-		if (gbhw->vblankctr > vblanktc - vblankclocks) {
+		if (vblank_cycles(gbhw) > vblanktc - vblankclocks) {
 			return 0x01;  /* vblank */
 		} else {
 			/* ~108.7uS per line */
-			long t = (2 * vblanktc - gbhw->vblankctr) % 456;
+			long t = (2 * vblanktc - vblank_cycles(gbhw)) % 456;
 			if (t < 204) {
 				/* 48.6uS in hblank (201-207 clks) */
 				return 0x00;
@@ -207,7 +348,7 @@ static uint32_t io_get(void *priv, uint32_t addr)
 		}
 		return 0x03;  /* both OAM and display RAM busy */
 	case 0xff44: /* LCD Y-coordinate */
-		return ((2 * vblanktc - vblankclocks - gbhw->vblankctr) / 456) % 154;
+		return ((2 * vblanktc - vblankclocks - vblank_cycles(gbhw)) / 456) % 154;
 	case 0xff70:  // CGB ram bank switch
 		WARN_ONCE("ioread from SVBK (CGB mode) ignored.\n");
 		return 0xff;
@@ -320,6 +461,88 @@ static long sweep_check_overflow(struct gbhw *gbhw)
 	return 1;
 }
 
+/*
+ * A channel is audible while it runs with its DAC on, a non-zero
+ * (envelope) volume and at least one output routed in NR51.  Anything
+ * else only puts a constant level on the output.  Channel mutes are a
+ * listener setting and do not count.
+ */
+static long apu_silent(const struct gbhw *gbhw)
+{
+	long i;
+
+	for (i = 0; i < 4; i++) {
+		const struct gbhw_channel *ch = &gbhw->ch[i];
+
+		if (ch->running && ch->master && ch->env_volume &&
+		    (ch->leftgate || ch->rightgate))
+			return 0;
+	}
+	return 1;
+}
+
+/*
+ * Only register writes and the frame sequencer change the state
+ * apu_silent() looks at, both call this with the cycle they happen at.
+ */
+static void apu_update_silence(struct gbhw *gbhw, cycles_t when)
+{
+	if (!apu_silent(gbhw))
+		gbhw->silent_since = GBHW_NEVER;
+	else if (gbhw->silent_since == GBHW_NEVER)
+		gbhw->silent_since = when;
+}
+
+/* move the ring to one twice the size, oldest record first */
+static long evlog_grow(struct gbhw_evlog *log)
+{
+	unsigned long n = log->head - log->tail;
+	unsigned long first = log->mask + 1 - (log->tail & log->mask);
+	struct gbs_event *ev = malloc(2 * (log->mask + 1) * sizeof(*ev));
+
+	if (ev == NULL) {
+		fprintf(stderr, "%s", _("Memory allocation failed!\n"));
+		return 0;
+	}
+	if (first > n)
+		first = n;
+	memcpy(ev, &log->ev[log->tail & log->mask], first * sizeof(*ev));
+	memcpy(ev + first, log->ev, (n - first) * sizeof(*ev));
+	free(log->ev);
+	log->ev = ev;
+	log->mask = 2 * log->mask + 1;
+	log->tail = 0;
+	log->head = n;
+	return 1;
+}
+
+static long evlog_put(struct gbhw_evlog *log, uint32_t delta, uint8_t reg, uint8_t value)
+{
+	struct gbs_event *ev;
+
+	if (log->head - log->tail > log->mask && !evlog_grow(log))
+		return 0;
+	ev = &log->ev[log->head++ & log->mask];
+	ev->delta = delta;
+	ev->reg = reg;
+	ev->value = value;
+	return 1;
+}
+
+/* a dropped record stays in the delta of the next one */
+static void evlog_write(struct gbhw *gbhw, uint32_t addr, uint8_t val)
+{
+	struct gbhw_evlog *log = &gbhw->evlog;
+	cycles_t delta = gbhw->sum_cycles - log->last;
+
+	for (; delta > UINT32_MAX; delta -= UINT32_MAX, log->last += UINT32_MAX) {
+		if (!evlog_put(log, UINT32_MAX, GBS_EVENT_WAIT, 0))
+			return;
+	}
+	if (evlog_put(log, delta, addr & 0xff, val))
+		log->last = gbhw->sum_cycles;
+}
+
 static void io_put(void *priv, uint32_t addr, uint8_t val)
 {
 	struct gbhw *gbhw = priv;
@@ -330,8 +553,10 @@ static void io_put(void *priv, uint32_t addr, uint8_t val)
 		return;
 	}
 
-	gbhw->io_written = 1;
+	cpu_sync(gbhw);
 
+	if (gbhw->evlog.ev)
+		evlog_write(gbhw, addr, val);
 	if (gbhw->iocallback)
 		gbhw->iocallback(gbhw->sum_cycles, addr, val, gbhw->iocallback_priv);
 
@@ -351,13 +576,29 @@ static void io_put(void *priv, uint32_t addr, uint8_t val)
 			gbhw->divoffset = -(gbhw->sum_cycles >> 8);
 			break;
 		case 0xff05:  // TIMA
+			if (timer_running(gbhw)) {
+				gbhw->event[GBHW_EV_TIMER] = gbhw->sum_cycles + timer_next_tick(gbhw) +
+				                             (0xff - val) * gbhw->timertc;
+				gbhw->reschedule = 1;
+			}
+			break;
 		case 0xff06:  // TMA
 			break;
 		case 0xff07:  // TAC
+			if (timer_running(gbhw)) {
+				gbhw->timerctr = timer_next_tick(gbhw);
+				gbhw->ioregs[REG_TIMA] = timer_tima(gbhw);
+			}
 			gbhw->timertc = timertc_from_tac(val);
 			if (gbhw->timerctr > gbhw->timertc) {
 				gbhw->timerctr = 0;
 			}
+			/* a reset period ticks right after this instruction */
+			if (val & 4)
+				gbhw->event[GBHW_EV_TIMER] = gbhw->sum_cycles + gbhw->timerctr +
+				                             (0xff - gbhw->ioregs[REG_TIMA]) * gbhw->timertc;
+			else gbhw->event[GBHW_EV_TIMER] = GBHW_NEVER;
+			gbhw->reschedule = 1;
 			break;
 		case 0xff0f:  // IF
 			break;
@@ -569,6 +810,11 @@ static void io_put(void *priv, uint32_t addr, uint8_t val)
 			WARN_ONCE("iowrite to 0x%04x unimplemented (val=%02x).\n", addr, val);
 			break;
 	}
+	if (addr >= 0xff10 && addr <= 0xff26)
+		apu_update_silence(gbhw, gbhw->sum_cycles);
+	/* moved events and new pending interrupts end a gbcpu_run() */
+	if (gbhw->reschedule || addr == 0xff0f || addr == 0xffff)
+		gbhw->gbcpu.run_break = 1;
 }
 
 static void intram_put(void *priv, uint32_t addr, uint8_t val)
@@ -633,28 +879,18 @@ static void sequencer_step(struct gbhw *gbhw)
 			}
 		}
 	}
-    
-    //YOYOFR, better mngt
-	/*if (gbhw->master_fade) {
-		gbhw->master_volume += gbhw->master_fade;
-		if ((gbhw->master_fade > 0 &&
-		     gbhw->master_volume >= gbhw->master_dstvol) ||
-		    (gbhw->master_fade < 0 &&
-		     gbhw->master_volume <= gbhw->master_dstvol)) {
-			gbhw->master_fade = 0;
-			gbhw->master_volume = gbhw->master_dstvol;
-		}
-	}*/
+	/* the callers already moved the deadline on to the next step */
+	apu_update_silence(gbhw, gbhw->event[GBHW_EV_SEQUENCER] - sequencer_tc);
 }
 
-void gbhw_master_fade(struct gbhw* const gbhw, long speed, long dstvol)
+/*
+ * Fade the output out between the APU cycles start and end.  The
+ * volume falls off quadratically, end <= start turns the fade off.
+ */
+void gbhw_set_fade(struct gbhw* const gbhw, long long start, long long end)
 {
-	if (dstvol < MASTER_VOL_MIN) dstvol = MASTER_VOL_MIN;
-	if (dstvol > MASTER_VOL_MAX) dstvol = MASTER_VOL_MAX;
-	gbhw->master_dstvol = dstvol;
-	if (dstvol > gbhw->master_volume)
-		gbhw->master_fade = speed;
-	else gbhw->master_fade = -speed;
+	gbhw->fade_start = start;
+	gbhw->fade_end = end;
 }
 
 #define GET_NIBBLE(p, n) ({ \
@@ -662,25 +898,25 @@ void gbhw_master_fade(struct gbhw* const gbhw, long speed, long dstvol)
 	long shift = (~(n) & 1) << 2; \
 	(((p)[index] >> shift) & 0xf); })
 
-static void gb_flush_buffer(struct gbhw *gbhw)
+/*
+ * Integrate the first samples stereo impulses of data32 with the
+ * levels kept in buf.  The flushed part of data32 is overwritten with
+ * the output levels.
+ */
+static void gb_integrate(struct gbhw *gbhw, struct gbhw_buffer *buf, int32_t *data32, long samples)
 {
 	long i;
-	long overlap;
 	long l_smpl, r_smpl;
 	long l_cap, r_cap;
 
-	assert(gbhw->soundbuf != NULL);
-	assert(gbhw->impbuf != NULL);
-
-	/* integrate buffer */
-	l_smpl = gbhw->soundbuf->l_lvl;
-	r_smpl = gbhw->soundbuf->r_lvl;
-	l_cap = gbhw->soundbuf->l_cap;
-	r_cap = gbhw->soundbuf->r_cap;
-	for (i=0; i<gbhw->soundbuf->samples; i++) {
+	l_smpl = buf->l_lvl;
+	r_smpl = buf->r_lvl;
+	l_cap = buf->l_cap;
+	r_cap = buf->r_cap;
+	for (i=0; i<samples; i++) {
 		long l_out, r_out;
-		l_smpl = l_smpl + gbhw->impbuf->data32[i*2  ];
-		r_smpl = r_smpl + gbhw->impbuf->data32[i*2+1];
+		l_smpl = l_smpl + data32[i*2  ];
+		r_smpl = r_smpl + data32[i*2+1];
 		if (gbhw->filter_enabled && gbhw->cap_factor <= 0x10000) {
 			/*
 			 * RC High-pass & DC decoupling filter. Gameboy
@@ -698,27 +934,109 @@ static void gb_flush_buffer(struct gbhw *gbhw)
 			l_out = l_smpl >> 16;
 			r_out = r_smpl >> 16;
 		}
-		gbhw->soundbuf->data[i*2  ] = l_out * gbhw->master_volume / MASTER_VOL_MAX;
-		gbhw->soundbuf->data[i*2+1] = r_out * gbhw->master_volume / MASTER_VOL_MAX;
-		if (l_out > gbhw->lmaxval) gbhw->lmaxval = l_out;
-		if (l_out < gbhw->lminval) gbhw->lminval = l_out;
-		if (r_out > gbhw->rmaxval) gbhw->rmaxval = r_out;
-		if (r_out < gbhw->rminval) gbhw->rminval = r_out;
-	}
-	gbhw->soundbuf->pos = gbhw->soundbuf->samples;
-	gbhw->soundbuf->l_lvl = l_smpl;
-	gbhw->soundbuf->r_lvl = r_smpl;
-	gbhw->soundbuf->l_cap = l_cap;
-	gbhw->soundbuf->r_cap = r_cap;
+		data32[i*2  ] = l_out;
+		data32[i*2+1] = r_out;
+	}
+	buf->l_lvl = l_smpl;
+	buf->r_lvl = r_smpl;
+	buf->l_cap = l_cap;
+	buf->r_cap = r_cap;
+}
+
+/*
+ * Volume of the samples about to be flushed.  Returns 0 with a constant
+ * *volume, or 1 if they overlap the fade and fade_gain holds the volume
+ * of each sample.  Only this setup divides, the ramp is a multiply per
+ * sample and the output kernels apply it with a multiply and shift.
+ */
+static long gb_fade_ramp(struct gbhw *gbhw, long samples, int32_t *volume)
+{
+	double dt = (double)gbhw->sound_div_tc / SOUND_DIV_MULT;
+	double len, u0, du;
+	long i;
+
+	*volume = gbhw->master_volume;
+	if (gbhw->fade_end <= gbhw->fade_start ||
+	    gbhw->sound_base + dt * samples <= gbhw->fade_start)
+		return 0;
+	if (gbhw->sound_base >= gbhw->fade_end) {
+		*volume = 0;
+		return 0;
+	}
+	len = gbhw->fade_end - gbhw->fade_start;
+	u0 = (gbhw->fade_end - gbhw->sound_base) / len;
+	du = dt / len;
+	for (i=0; i<samples; i++) {
+		double u = u0 - i * du;
+		if (u > 1) u = 1;
+		if (u < 0) u = 0;
+		gbhw->fade_gain[i] = gbhw->master_volume * u * u;
+	}
+	return 1;
+}
+
+/* samples written by the next flush, see gbhw_render() */
+static inline long gb_flush_samples(const struct gbhw *gbhw)
+{
+	return gbhw->render_out ? gbhw->render_samples : gbhw->soundbuf->samples;
+}
+
+/* impulse buffer samples that must be complete before the next flush */
+static inline long gb_flush_span(const struct gbhw *gbhw)
+{
+	return gb_flush_samples(gbhw) + IMPULSE_WIDTH(gbhw) - IMPULSE_WIDTH(gbhw)/2 + 1;
+}
+
+/* first impbuf->cycles value at which the next flush is due */
+static inline long long gb_flush_at(const struct gbhw *gbhw)
+{
+	return (gbhw->sound_div_tc*gb_flush_span(gbhw) + gbhw->sound_frac + SOUND_DIV_MULT - 1) / SOUND_DIV_MULT;
+}
+
+static void gb_flush_buffer(struct gbhw *gbhw)
+{
+	long samples = gb_flush_samples(gbhw);
+	int16_t *out = gbhw->render_out ? gbhw->render_out : gbhw->soundbuf->data;
+	long i;
+	long overlap;
+	long l_smpl;
+	long l_cap;
+	int32_t minmax[4] = { gbhw->lminval, gbhw->lmaxval, gbhw->rminval, gbhw->rmaxval };
+	int32_t volume;
+	long ramp;
+
+	assert(MASTER_VOL_MAX == GBMIX_UNITY);
+	assert(gbhw->soundbuf != NULL);
+	assert(gbhw->impbuf != NULL);
+
+	ramp = gb_fade_ramp(gbhw, samples, &volume);
+	gb_integrate(gbhw, gbhw->soundbuf, gbhw->impbuf->data32, samples);
+	if (ramp)
+		gbhw->mix->output_ramp(out, gbhw->impbuf->data32, samples, gbhw->fade_gain, minmax);
+	else gbhw->mix->output(out, gbhw->impbuf->data32, samples, volume, minmax);
+	gbhw->lminval = minmax[0];
+	gbhw->lmaxval = minmax[1];
+	gbhw->rminval = minmax[2];
+	gbhw->rmaxval = minmax[3];
+	gbhw->soundbuf->pos = samples;
+
+	for (i=0; gbhw->stembuf[0] && i<4; i++) {
+		int32_t stem_minmax[4] = { 0, 0, 0, 0 };
+		gb_integrate(gbhw, gbhw->stembuf[i], gbhw->stem_imp[i], samples);
+		if (ramp)
+			gbhw->mix->output_ramp(gbhw->stembuf[i]->data, gbhw->stem_imp[i], samples, gbhw->fade_gain, stem_minmax);
+		else gbhw->mix->output(gbhw->stembuf[i]->data, gbhw->stem_imp[i], samples, volume, stem_minmax);
+		gbhw->stembuf[i]->pos = samples;
+	}
     
     //YOYOFR
     /* integrate buffer */
-    for (int ii=0;ii<4;ii++) {
+    for (int ii=0; gbhw->voices && ii<4; ii++) {
         l_smpl = gbhw->soundbuf->lvl_ch[ii];
         l_cap = gbhw->soundbuf->cap_ch[ii];
-        for (i=0; i<gbhw->soundbuf->samples; i++) {
+        for (i=0; i<samples; i++) {
             long l_out;
-            l_smpl = l_smpl + m_voice_buff_accumul_temp[ii][i];
+            l_smpl = l_smpl + gbhw->voice_imp[ii][i];
             if (gbhw->filter_enabled && gbhw->cap_factor <= 0x10000) {
                 /*
                  * RC High-pass & DC decoupling filter. Gameboy
@@ -734,168 +1052,168 @@ static void gb_flush_buffer(struct gbhw *gbhw)
                 l_out = l_smpl >> 16;
             }
             //final rendering in voices idx 0 to 3
-            m_voice_buff[ii][i]=LIMIT8(((l_out * gbhw->master_volume / MASTER_VOL_MAX)>>7));
+            gbhw->voice_out[ii][i]=LIMIT8(((l_out * (ramp ? gbhw->fade_gain[i] : volume)) >> 23));
         }
         gbhw->soundbuf->lvl_ch[ii] = l_smpl;
         gbhw->soundbuf->cap_ch[ii] = l_cap;
     }
     //YOYOFR
 
-	if (gbhw->callback != NULL) gbhw->callback(gbhw->callbackpriv);
+	/* a render goes straight to the caller, see gbhw_render() */
+	if (gbhw->render_out != NULL) gbhw->render_out = NULL;
+	else if (gbhw->callback != NULL) gbhw->callback(gbhw->callbackpriv);
 
-	overlap = gbhw->impbuf->samples - gbhw->soundbuf->samples;
+	overlap = gbhw->impbuf->samples - samples;
     
-	memmove(gbhw->impbuf->data32, gbhw->impbuf->data32+(2*gbhw->soundbuf->samples), 8*overlap);
+	memmove(gbhw->impbuf->data32, gbhw->impbuf->data32+(2*samples), 8*overlap);
     
     //YOYOFR
-    for (int ii=0;ii<4;ii++) {
-        memmove(m_voice_buff_accumul_temp[ii], m_voice_buff_accumul_temp[ii]+(gbhw->soundbuf->samples), 4*overlap);
-        memset(m_voice_buff_accumul_temp[ii] + overlap, 0, gbhw->impbuf->bytes/2 - 4*overlap);
+    for (int ii=0; gbhw->voices && ii<4; ii++) {
+        memmove(gbhw->voice_imp[ii], gbhw->voice_imp[ii]+(samples), 4*overlap);
+        memset(gbhw->voice_imp[ii] + overlap, 0, gbhw->impbuf->bytes/2 - 4*overlap);
     }
     //YOYOFR
     
     
 	memset(gbhw->impbuf->data32 + 2*overlap, 0, gbhw->impbuf->bytes - 8*overlap);
+	/* the output buffers need no clearing, every flush writes them in full */
+	for (i=0; gbhw->stembuf[0] && i<4; i++) {
+		memmove(gbhw->stem_imp[i], gbhw->stem_imp[i]+(2*samples), 8*overlap);
+		memset(gbhw->stem_imp[i] + 2*overlap, 0, gbhw->impbuf->bytes - 8*overlap);
+		gbhw->stembuf[i]->pos = 0;
+	}
 	assert(gbhw->impbuf->bytes == gbhw->impbuf->samples*8);
 	assert(gbhw->soundbuf->bytes == gbhw->soundbuf->samples*4);
-	memset(gbhw->soundbuf->data, 0, gbhw->soundbuf->bytes);
 	gbhw->soundbuf->pos = 0;
 
-	gbhw->impbuf->cycles -= (gbhw->sound_div_tc * gbhw->soundbuf->samples) / SOUND_DIV_MULT;
+	/* keep the fraction, sample positions must not depend on the flush sizes */
+	gbhw->sound_frac += gbhw->sound_div_tc * samples;
+	overlap = gbhw->sound_frac / SOUND_DIV_MULT;
+	gbhw->sound_frac -= overlap * SOUND_DIV_MULT;
+	gbhw->impbuf->cycles -= overlap;
+	gbhw->sound_base += overlap;
 }
 
-static void gb_change_level(struct gbhw *gbhw, long l_ofs, long r_ofs)
+/* impulse for a level change now, *start is its first sample in impbuf */
+static const int32_t *gb_impulse_pos(struct gbhw *gbhw, long *start)
 {
 	long pos;
 	long imp_idx;
-	long imp_l = -IMPULSE_WIDTH/2;
-	long imp_r = IMPULSE_WIDTH/2;
-	long i;
-	const int32_t *ptr = base_impulse;
+	long width = IMPULSE_WIDTH(gbhw);
+	long imp_l = -width/2;
+	long imp_r = width/2;
+	long long t;
 
 	assert(gbhw->impbuf != NULL);
-	pos = (long)(gbhw->impbuf->cycles * SOUND_DIV_MULT / gbhw->sound_div_tc);
-	imp_idx = (long)((gbhw->impbuf->cycles << IMPULSE_N_SHIFT)*SOUND_DIV_MULT / gbhw->sound_div_tc) & IMPULSE_N_MASK;
+	t = (long long)gbhw->impbuf->cycles * SOUND_DIV_MULT - gbhw->sound_frac;
+	pos = (long)(t / gbhw->sound_div_tc);
+	imp_idx = (long)((t << gbhw->impulse->n_shift) / gbhw->sound_div_tc) & ((1L << gbhw->impulse->n_shift) - 1);
 	assert(pos + imp_r < gbhw->impbuf->samples);
 	assert(pos + imp_l >= 0);
 
-	ptr += imp_idx * IMPULSE_WIDTH;
+	*start = pos + imp_l;
+	return gbhw->impulse->tab + imp_idx * width;
+}
 
-	for (i=imp_l; i<imp_r; i++) {
-		long bufi = pos + i;
-		long impi = i + IMPULSE_WIDTH/2;
-		gbhw->impbuf->data32[bufi*2  ] += ptr[impi] * l_ofs;
-		gbhw->impbuf->data32[bufi*2+1] += ptr[impi] * r_ofs;
-	}
+static void gb_change_level(struct gbhw *gbhw, const int32_t *ptr, long start, long l_ofs, long r_ofs)
+{
+	gbhw->mix->add_impulse(&gbhw->impbuf->data32[start*2], ptr, IMPULSE_WIDTH(gbhw), l_ofs, r_ofs);
 
 	gbhw->impbuf->l_lvl += l_ofs*256;
 	gbhw->impbuf->r_lvl += r_ofs*256;
 }
 
-static void gb_change_level_mdz(struct gbhw *gbhw, long l_ofs,signed int *voice_buffer)
+/* like gb_change_level(), for the stem output of channel ch */
+static void gb_change_stem_level(struct gbhw *gbhw, const int32_t *ptr, long start, long ch, long l_ofs, long r_ofs)
 {
-    long pos;
-    long imp_idx;
-    long imp_l = -IMPULSE_WIDTH/2;
-    long imp_r = IMPULSE_WIDTH/2;
-    long i;
-    const int32_t *ptr = base_impulse;
-
-    assert(gbhw->impbuf != NULL);
-    pos = (long)(gbhw->impbuf->cycles * SOUND_DIV_MULT / gbhw->sound_div_tc);
-    imp_idx = (long)((gbhw->impbuf->cycles << IMPULSE_N_SHIFT)*SOUND_DIV_MULT / gbhw->sound_div_tc) & IMPULSE_N_MASK;
-    assert(pos + imp_r < gbhw->impbuf->samples);
-    assert(pos + imp_l >= 0);
-
-    ptr += imp_idx * IMPULSE_WIDTH;
-
-    for (i=imp_l; i<imp_r; i++) {
-        long bufi = pos + i;
-        long impi = i + IMPULSE_WIDTH/2;
-        //gbhw->impbuf->data32[bufi*2  ] += ptr[impi] * l_ofs;
-        //gbhw->impbuf->data32[bufi*2+1] += ptr[impi] * r_ofs;
-        voice_buffer[bufi&(SOUND_BUFFER_SIZE_SAMPLE*2-1)]+=ptr[impi] * l_ofs;
-    }
+	gbhw->mix->add_impulse(&gbhw->stem_imp[ch][start*2], ptr, IMPULSE_WIDTH(gbhw), l_ofs, r_ofs);
+}
 
-    //gbhw->impbuf->l_lvl += l_ofs*256;
-    //gbhw->impbuf->r_lvl += r_ofs*256;
+/* like gb_change_level(), for the per-voice output of channel ch */
+static void gb_change_voice_level(struct gbhw *gbhw, const int32_t *ptr, long start, long ch, long ofs)
+{
+	gbhw->mix->add_impulse_mono(&gbhw->voice_imp[ch][start], ptr, IMPULSE_WIDTH(gbhw), ofs);
 }
 
 
-static void gb_sound(struct gbhw *gbhw, cycles_t cycles)
+/* Run a single APU cycle the hard way. */
+static void gb_sound_cycle(struct gbhw *gbhw)
 {
-	long i, j;
+	long i;
 	long l_lvl = 0, r_lvl = 0;
-    
-    //TODO:  MODIZER changes start / YOYOFR
-    int64_t smplIncr=(int64_t)44100*(1<<MODIZER_OSCILLO_OFFSET_FIXEDPOINT)/GBHW_CLOCK;
-    //TODO:  MODIZER changes end / YOYOFR
-    
-	assert(gbhw->impbuf != NULL);
 
-	for (j=0; j<cycles; j++) {
-		gbhw->main_div++;
-		gbhw->impbuf->cycles++;
-		if (gbhw->impbuf->cycles*SOUND_DIV_MULT >= gbhw->sound_div_tc*(gbhw->impbuf->samples - IMPULSE_WIDTH/2))
-			gb_flush_buffer(gbhw);
+	gbhw->main_div++;
+	gbhw->impbuf->cycles++;
+	if ((long long)gbhw->impbuf->cycles >= gb_flush_at(gbhw))
+		gb_flush_buffer(gbhw);
+
+	if (gbhw->ch[2].running) {
+		gbhw->ch[2].div_ctr--;
+		if (gbhw->ch[2].div_ctr <= 0) {
+			long val = gbhw->ch3_next_nibble;
+			long pos = gbhw->ch3pos++;
+			gbhw->ch3_next_nibble = GET_NIBBLE(&gbhw->ioregs[0x30], pos) * 2;
+			gbhw->ch[2].div_ctr = gbhw->ch[2].div_tc*2;
+			if (gbhw->ch[2].env_volume) {
+				val = val >> (gbhw->ch[2].env_volume-1);
+			} else val = 0;
+			gbhw->ch[2].lvl = val - 15;
+			gbhw->update_level = 1;
+		}
+	}
 
-		if (gbhw->ch[2].running) {
-			gbhw->ch[2].div_ctr--;
-			if (gbhw->ch[2].div_ctr <= 0) {
-				long val = gbhw->ch3_next_nibble;
-				long pos = gbhw->ch3pos++;
-				gbhw->ch3_next_nibble = GET_NIBBLE(&gbhw->ioregs[0x30], pos) * 2;
-				gbhw->ch[2].div_ctr = gbhw->ch[2].div_tc*2;
-				if (gbhw->ch[2].env_volume) {
-					val = val >> (gbhw->ch[2].env_volume-1);
-				} else val = 0;
-				gbhw->ch[2].lvl = val - 15;
-				gbhw->update_level = 1;
-			}
+	if (gbhw->ch[3].running) {
+		gbhw->ch[3].div_ctr--;
+		if (gbhw->ch[3].div_ctr <= 0) {
+			long val;
+			gbhw->ch[3].div_ctr = gbhw->ch[3].div_tc;
+			val = gbhw->ch[3].env_volume * 2 * gblfsr_next_value(&gbhw->lfsr);
+			gbhw->ch[3].lvl = val - 15;
+			gbhw->update_level = 1;
 		}
+	}
 
-		if (gbhw->ch[3].running) {
-			gbhw->ch[3].div_ctr--;
-			if (gbhw->ch[3].div_ctr <= 0) {
-				long val;
-				gbhw->ch[3].div_ctr = gbhw->ch[3].div_tc;
-				val = gbhw->ch[3].env_volume * 2 * gblfsr_next_value(&gbhw->lfsr);
-				gbhw->ch[3].lvl = val - 15;
-				gbhw->update_level = 1;
+	if (gbhw->main_div > main_div_tc) {
+		gbhw->main_div -= main_div_tc;
+
+		for (i=0; i<2; i++) if (gbhw->ch[i].running) {
+			long bit = (gbhw->ch[i].duty_val >> gbhw->ch[i].duty_ctr) & 1;
+			long val = bit * 2 * gbhw->ch[i].env_volume;
+			gbhw->ch[i].lvl = val - 15;
+			gbhw->ch[i].div_ctr--;
+			if (gbhw->ch[i].div_ctr <= 0) {
+				gbhw->ch[i].div_ctr = gbhw->ch[i].div_tc;
+				gbhw->ch[i].duty_ctr++;
+				gbhw->ch[i].duty_ctr &= 7;
 			}
 		}
 
-		if (gbhw->main_div > main_div_tc) {
-			gbhw->main_div -= main_div_tc;
-
-			for (i=0; i<2; i++) if (gbhw->ch[i].running) {
-				long bit = (gbhw->ch[i].duty_val >> gbhw->ch[i].duty_ctr) & 1;
-				long val = bit * 2 * gbhw->ch[i].env_volume;
-				gbhw->ch[i].lvl = val - 15;
-				gbhw->ch[i].div_ctr--;
-				if (gbhw->ch[i].div_ctr <= 0) {
-					gbhw->ch[i].div_ctr = gbhw->ch[i].div_tc;
-					gbhw->ch[i].duty_ctr++;
-					gbhw->ch[i].duty_ctr &= 7;
-				}
-			}
+		gbhw->update_level = 1;
+	}
 
-			gbhw->sweep_div += 1;
-			if (gbhw->sweep_div >= sweep_div_tc) {
-				gbhw->sweep_div = 0;
-				sequencer_step(gbhw);
-			}
-			gbhw->update_level = 1;
-		}
+	if (gbhw->update_level) {
+		/* the mix, voices and stems share one impulse position */
+		const int32_t *imp = NULL;
+		long start = 0;
 
-		if (gbhw->update_level) {
-			gbhw->update_level = 0;
-			l_lvl = 0;
-			r_lvl = 0;
+		gbhw->update_level = 0;
+		l_lvl = 0;
+		r_lvl = 0;
             
-			for (i=0; i<4; i++) {
-				if (gbhw->ch[i].mute)
-					continue;
+		for (i=0; i<4; i++) {
+			/* stems ignore the mute settings */
+			if (gbhw->stembuf[0]) {
+				long l = gbhw->ch[i].leftgate ? gbhw->ch[i].lvl : 0;
+				long r = gbhw->ch[i].rightgate ? gbhw->ch[i].lvl : 0;
+				if (l != gbhw->ch[i].stem_l || r != gbhw->ch[i].stem_r) {
+					if (!imp) imp = gb_impulse_pos(gbhw, &start);
+					gb_change_stem_level(gbhw, imp, start, i, l - gbhw->ch[i].stem_l, r - gbhw->ch[i].stem_r);
+					gbhw->ch[i].stem_l = l;
+					gbhw->ch[i].stem_r = r;
+				}
+			}
+			if (gbhw->ch[i].mute)
+				continue;
                 if (gbhw->ch[i].leftgate) {
                     l_lvl += gbhw->ch[i].lvl;
                 }
@@ -903,45 +1221,244 @@ static void gb_sound(struct gbhw *gbhw, cycles_t cycles)
                     r_lvl += gbhw->ch[i].lvl;
                 }
                 //TODO:  MODIZER changes start / YOYOFR
-                if (seek_needed==-1) {
+                if (gbhw->voices) {
                     long val=0;
                     if (gbhw->ch[i].leftgate || gbhw->ch[i].rightgate ) val=(gbhw->ch[i].lvl);
                     if (gbhw->ch[i].last_lvl!=val) {
-                        gb_change_level_mdz(gbhw,val-gbhw->ch[i].last_lvl,m_voice_buff_accumul_temp[i]);
+                        if (!imp) imp = gb_impulse_pos(gbhw, &start);
+                        gb_change_voice_level(gbhw,imp,start,i,val-gbhw->ch[i].last_lvl);
                         gbhw->ch[i].last_lvl=val;
                     }
                 }
                 //TODO:  MODIZER changes end / YOYOFR
-			}
+		}
 
-			if (l_lvl != gbhw->last_l_value || r_lvl != gbhw->last_r_value) {
-				gb_change_level(gbhw, l_lvl - gbhw->last_l_value, r_lvl - gbhw->last_r_value);
-				gbhw->last_l_value = l_lvl;
-				gbhw->last_r_value = r_lvl;
-			}
-            
+		if (l_lvl != gbhw->last_l_value || r_lvl != gbhw->last_r_value) {
+			if (!imp) imp = gb_impulse_pos(gbhw, &start);
+			gb_change_level(gbhw, imp, start, l_lvl - gbhw->last_l_value, r_lvl - gbhw->last_r_value);
+			gbhw->last_l_value = l_lvl;
+			gbhw->last_r_value = r_lvl;
+		}
+	}
+}
+
+/*
+ * Would a mix at this point change the output?  True after mute, gate
+ * or level changes the cycle loop has not picked up yet.
+ */
+static long gb_mix_stale(const struct gbhw *gbhw)
+{
+	long i;
+	long l_lvl = 0, r_lvl = 0;
+
+	for (i=0; gbhw->stembuf[0] && i<4; i++) {
+		if (gbhw->ch[i].stem_l != (gbhw->ch[i].leftgate ? gbhw->ch[i].lvl : 0) ||
+		    gbhw->ch[i].stem_r != (gbhw->ch[i].rightgate ? gbhw->ch[i].lvl : 0))
+			return 1;
+	}
+	for (i=0; i<4; i++) {
+		if (gbhw->ch[i].mute)
+			continue;
+		if (gbhw->ch[i].leftgate)
+			l_lvl += gbhw->ch[i].lvl;
+		if (gbhw->ch[i].rightgate)
+			r_lvl += gbhw->ch[i].lvl;
+		if (gbhw->voices) {
+			long val = 0;
+			if (gbhw->ch[i].leftgate || gbhw->ch[i].rightgate) val = gbhw->ch[i].lvl;
+			if (gbhw->ch[i].last_lvl != val)
+				return 1;
+		}
+	}
+	return l_lvl != gbhw->last_l_value || r_lvl != gbhw->last_r_value;
+}
+
+/*
+ * Number of main_div ticks until square channel ch outputs a level
+ * other than its current one, -1 if it never does.
+ */
+static long square_change_ticks(const struct gbhw_channel *ch)
+{
+	long i;
+	long ctr = ch->duty_ctr;
+	long ticks = ch->div_ctr > 0 ? ch->div_ctr : 1;
+	long step = ch->div_tc > 0 ? ch->div_tc : 1;
+
+	for (i=0; i<8; i++) {
+		long bit = (ch->duty_val >> ctr) & 1;
+		if (bit * 2 * ch->env_volume - 15 != ch->lvl)
+			return i == 0 ? 1 : ticks + 1;
+		if (i > 0) ticks += step;
+		ctr = (ctr + 1) & 7;
+	}
+	return -1;
+}
+
+/* Advance square channel ch by ticks main_div ticks of constant level. */
+static void square_skip(struct gbhw_channel *ch, long ticks)
+{
+	long first = ch->div_ctr > 0 ? ch->div_ctr : 1;
+	long rest;
+
+	if (ticks < first) {
+		ch->div_ctr -= ticks;
+		return;
+	}
+	rest = ticks - first;
+	if (ch->div_tc > 0) {
+		ch->duty_ctr = (ch->duty_ctr + 1 + rest / ch->div_tc) & 7;
+		ch->div_ctr = ch->div_tc - rest % ch->div_tc;
+	} else {
+		ch->duty_ctr = (ch->duty_ctr + 1 + rest) & 7;
+		ch->div_ctr = ch->div_tc;
+	}
+}
+
+/*
+ * Advance the APU by cycles during which no channel changes its level
+ * and no flush is due, so gb_sound_cycle() would only count.
+ */
+static void gb_sound_skip(struct gbhw *gbhw, long cycles)
+{
+	long i;
+	long ticks;
+
+	if (cycles <= 0)
+		return;
+	ticks = (gbhw->main_div + cycles - 1) / main_div_tc;
+	gbhw->main_div += cycles - ticks * main_div_tc;
+	gbhw->impbuf->cycles += cycles;
+	for (i=0; i<2; i++) if (gbhw->ch[i].running)
+		square_skip(&gbhw->ch[i], ticks);
+	if (gbhw->ch[2].running)
+		gbhw->ch[2].div_ctr -= cycles;
+	if (gbhw->ch[3].running) {
+		/* noise clocks in between leave the level alone, see noise_quiet_clocks() */
+		struct gbhw_channel *ch = &gbhw->ch[3];
+		long first = ch->div_ctr > 0 ? ch->div_ctr : 1;
+		if (cycles >= first) {
+			gblfsr_advance(&gbhw->lfsr, 1 + (cycles - first) / ch->div_tc);
+			ch->div_ctr = ch->div_tc - (cycles - first) % ch->div_tc;
+		} else {
+			ch->div_ctr -= cycles;
+		}
+	}
+}
+
+/* noise clocks from the next one on that keep the level, up to max */
+static long noise_quiet_clocks(struct gbhw *gbhw, long max)
+{
+	const struct gbhw_channel *ch = &gbhw->ch[3];
+	uint32_t bits;
+	long n;
+
+	if (ch->env_volume == 0)
+		return ch->lvl == -15 ? max : 0;
+	if (ch->lvl == -15)
+		bits = ~gblfsr_peek_bits(&gbhw->lfsr, 32);
+	else if (ch->lvl == ch->env_volume * 2 - 15)
+		bits = gblfsr_peek_bits(&gbhw->lfsr, 32);
+	else
+		return 0;
+	/* leading output bits that give the current level */
+	n = ~bits ? __builtin_clz(~bits) : 32;
+	return n < max ? n : max;
+}
+
+/*
+ * Run the APU event by event: find the next cycle at which a channel
+ * level may change (duty edge, wave nibble, LFSR step) or the impulse
+ * buffer needs a flush, skip the quiet cycles before it and run that
+ * one cycle in full.  The mix and gb_change_level() only happen where
+ * a level changes, which keeps the output identical to running every
+ * cycle.
+ */
+static void gb_sound_run(struct gbhw *gbhw, long cycles)
+{
+	long long flush_at;
+
+	assert(gbhw->impbuf != NULL);
+
+	/* first impbuf->cycles value at which gb_sound_cycle() flushes */
+	flush_at = gb_flush_at(gbhw);
+	while (cycles > 0) {
+		long n = cycles + 1;
+		long tick = main_div_tc + 1 - gbhw->main_div;
+		long long flush;
+		long i;
+
+		if (gbhw->update_level) {
+			n = 1;
+		} else if (tick < n && gb_mix_stale(gbhw)) {
+			n = tick;
+		}
+		flush = flush_at - (long long)gbhw->impbuf->cycles;
+		if (flush < n)
+			n = flush > 0 ? flush : 1;
+		for (i=0; i<2; i++) if (gbhw->ch[i].running) {
+			long t = square_change_ticks(&gbhw->ch[i]);
+			if (t > 0 && tick + (t - 1) * main_div_tc < n)
+				n = tick + (t - 1) * main_div_tc;
+		}
+		if (gbhw->ch[2].running) {
+			long t = gbhw->ch[2].div_ctr > 0 ? gbhw->ch[2].div_ctr : 1;
+			if (t < n)
+				n = t;
+		}
+		if (gbhw->ch[3].running) {
+			long t = gbhw->ch[3].div_ctr > 0 ? gbhw->ch[3].div_ctr : 1;
+			/*
+			 * Skip noise clocks that keep the level.  A stale mix
+			 * must still be picked up at the first one.
+			 */
+			if (t < n && !gbhw->update_level && !gb_mix_stale(gbhw))
+				t += noise_quiet_clocks(gbhw, (n - t) / gbhw->ch[3].div_tc + 1) * gbhw->ch[3].div_tc;
+			if (t < n)
+				n = t;
+		}
 
+		if (n > cycles) {
+			gb_sound_skip(gbhw, cycles);
+			break;
+		}
+		gb_sound_skip(gbhw, n - 1);
+		gb_sound_cycle(gbhw);
+		cycles -= n;
+	}
+}
+
+/*
+ * Run the APU for the cycles gbhw_step() just added to sum_cycles.
+ * The frame sequencer only changes state read by later cycles, so it
+ * steps between two runs once its deadline is reached.
+ * Without an output buffer only the sequencer runs: the length
+ * counters, envelopes and sweep are all the CPU can observe (NR52)
+ * or the step callback reports, there is no need to synthesize.
+ */
+static void gb_sound(struct gbhw *gbhw, long cycles)
+{
+	cycles_t now = gbhw->sum_cycles - cycles;
+
+	if (gbhw->impbuf == NULL) {
+		while (gbhw->event[GBHW_EV_SEQUENCER] <= gbhw->sum_cycles) {
+			gbhw->event[GBHW_EV_SEQUENCER] += sequencer_tc;
+			sequencer_step(gbhw);
+		}
+		return;
+	}
+	gbhw->sound_base = (long long)now - (long long)gbhw->impbuf->cycles;
+	while (cycles > 0) {
+		long n = cycles;
+
+		if (gbhw->event[GBHW_EV_SEQUENCER] - now < (cycles_t)n)
+			n = gbhw->event[GBHW_EV_SEQUENCER] - now;
+		gb_sound_run(gbhw, n);
+		now += n;
+		cycles -= n;
+		if (now == gbhw->event[GBHW_EV_SEQUENCER]) {
+			gbhw->event[GBHW_EV_SEQUENCER] += sequencer_tc;
+			sequencer_step(gbhw);
 		}
-        
-        //TODO:  MODIZER changes start / YOYOFR
-//        if (seek_needed==-1)
-//        for (int i=0;i<4;i++) {
-//            int64_t ofs_start=m_voice_current_ptr[i];
-//            int64_t ofs_end=(m_voice_current_ptr[i]+smplIncr);
-//            
-//            long val=0;
-//            if (! (gbhw->ch[i].mute) ) {
-//                if (gbhw->ch[i].leftgate || gbhw->ch[i].rightgate ) val=(gbhw->ch[i].lvl)<<2;
-//            }
-//            for (;;) {
-//                m_voice_buff[i][(ofs_start>>MODIZER_OSCILLO_OFFSET_FIXEDPOINT)&(SOUND_BUFFER_SIZE_SAMPLE*2*4-1)]=LIMIT8(val);
-//                ofs_start+=1<<MODIZER_OSCILLO_OFFSET_FIXEDPOINT;
-//                if (ofs_start>=ofs_end) break;
-//            }
-//            while ((ofs_end>>MODIZER_OSCILLO_OFFSET_FIXEDPOINT)>=SOUND_BUFFER_SIZE_SAMPLE*2*4) ofs_end-=(SOUND_BUFFER_SIZE_SAMPLE*2*4<<MODIZER_OSCILLO_OFFSET_FIXEDPOINT);
-//            m_voice_current_ptr[i]=ofs_end;
-//        }
-        //TODO:  MODIZER changes end / YOYOFR
 	}
 }
 
@@ -963,36 +1480,218 @@ void gbhw_set_step_callback(struct gbhw *gbhw, gbhw_stepcallback_fn fn, void *pr
 	gbhw->stepcallback_priv = priv;
 }
 
+/* restart the stems from silence, the next remix picks up the levels */
+static void gbhw_stems_reset(struct gbhw *gbhw)
+{
+	long i;
+
+	memset(gbhw->stem_imp[0], 0, gbhw->impbuf->bytes * 4);
+	for (i = 0; i < 4; i++) {
+		gbhw->ch[i].stem_l = gbhw->ch[i].stem_r = 0;
+		gbhw->stembuf[i]->l_lvl = gbhw->stembuf[i]->r_lvl = 0;
+		gbhw->stembuf[i]->l_cap = gbhw->stembuf[i]->r_cap = 0;
+		gbhw->stembuf[i]->pos = 0;
+	}
+	gbhw->update_level = 1;
+}
+
 static void gbhw_impbuf_reset(struct gbhw *gbhw)
 {
 	assert(gbhw->sound_div_tc != 0);
-	gbhw->impbuf->cycles = (long)(gbhw->sound_div_tc * IMPULSE_WIDTH/2 / SOUND_DIV_MULT);
+	gbhw->impbuf->cycles = (long)(gbhw->sound_div_tc * IMPULSE_WIDTH(gbhw)/2 / SOUND_DIV_MULT);
+	gbhw->sound_frac = 0;
 	gbhw->impbuf->l_lvl = 0;
 	gbhw->impbuf->r_lvl = 0;
 	memset(gbhw->impbuf->data32, 0, gbhw->impbuf->bytes);
+	if (gbhw->voice_imp[0])
+		memset(gbhw->voice_imp[0], 0, gbhw->impbuf->bytes * 2);
+	if (gbhw->stem_imp[0])
+		gbhw_stems_reset(gbhw);
 }
 
+static void gbhw_free_voices(struct gbhw *gbhw)
+{
+	long i;
+
+	free(gbhw->voice_imp[0]);
+	for (i = 0; i < 4; i++) {
+		gbhw->voice_imp[i] = NULL;
+		gbhw->voice_out[i] = NULL;
+	}
+}
+
+static void gbhw_free_stems(struct gbhw *gbhw)
+{
+	long i;
+
+	free(gbhw->stem_imp[0]);
+	for (i = 0; i < 4; i++)
+		gbhw->stem_imp[i] = NULL;
+}
+
+/* four stereo impulse buffers in one block, stembuf[] must be set */
+static long gbhw_alloc_stems(struct gbhw *gbhw)
+{
+	long samples = gbhw->impbuf->samples;
+	int32_t *imp;
+	long i;
+
+	gbhw_free_stems(gbhw);
+	for (i = 0; i < 4; i++) {
+		if (gbhw->stembuf[i]->bytes != gbhw->soundbuf->bytes)
+			return 0;
+		gbhw->stembuf[i]->samples = gbhw->stembuf[i]->bytes / 4;
+	}
+	imp = malloc(4 * 2 * samples * sizeof(*imp));
+	if (imp == NULL) {
+		fprintf(stderr, "%s", _("Memory allocation failed!\n"));
+		return 0;
+	}
+	for (i = 0; i < 4; i++)
+		gbhw->stem_imp[i] = imp + i * 2 * samples;
+	gbhw_stems_reset(gbhw);
+	return 1;
+}
+
+/* one block: four mono impulse buffers, then four 8 bit output buffers */
+static long gbhw_alloc_voices(struct gbhw *gbhw)
+{
+	long samples = gbhw->impbuf->samples;
+	int32_t *imp;
+	long i;
+
+	gbhw_free_voices(gbhw);
+	imp = calloc(1, 4 * samples * sizeof(*imp) + 4 * gbhw->soundbuf->samples);
+	if (imp == NULL) {
+		fprintf(stderr, "%s", _("Memory allocation failed!\n"));
+		return 0;
+	}
+	for (i = 0; i < 4; i++) {
+		gbhw->voice_imp[i] = imp + i * samples;
+		gbhw->voice_out[i] = (int8_t *)(imp + 4 * samples) + i * gbhw->soundbuf->samples;
+		gbhw->ch[i].last_lvl = 0;
+		gbhw->soundbuf->lvl_ch[i] = 0;
+		gbhw->soundbuf->cap_ch[i] = 0;
+	}
+	/* remix so the voices pick up the current levels */
+	gbhw->update_level = 1;
+	return 1;
+}
+
+/* a NULL buffer turns off synthesis, see gb_sound() */
 void gbhw_set_buffer(struct gbhw* const gbhw, struct gbhw_buffer *buffer)
 {
 	long impbuf_bytes;
 
+	if (gbhw->impbuf) free(gbhw->impbuf);
+	gbhw->impbuf = NULL;
+	gbhw_free_voices(gbhw);
+	gbhw_free_stems(gbhw);
 	gbhw->soundbuf = buffer;
+	if (buffer == NULL)
+		return;
 	gbhw->soundbuf->samples = gbhw->soundbuf->bytes / 4;
 
-	if (gbhw->impbuf) free(gbhw->impbuf);
-	impbuf_bytes = (gbhw->soundbuf->samples + IMPULSE_WIDTH + 1) * 8;
-	gbhw->impbuf = malloc(sizeof(*gbhw->impbuf) + impbuf_bytes);
+	impbuf_bytes = (gbhw->soundbuf->samples + IMPULSE_WIDTH(gbhw) + 1) * 8;
+	/* the fade ramp follows the impulse buffer */
+	gbhw->impbuf = malloc(sizeof(*gbhw->impbuf) + impbuf_bytes + gbhw->soundbuf->samples * sizeof(*gbhw->fade_gain));
 	if (gbhw->impbuf == NULL) {
 		fprintf(stderr, "%s", _("Memory allocation failed!\n"));
 		return;
 	}
 	memset(gbhw->impbuf, 0, sizeof(*gbhw->impbuf));
 	gbhw->impbuf->data32 = (void*)(gbhw->impbuf+1);
+	gbhw->fade_gain = (int32_t *)((char *)gbhw->impbuf->data32 + impbuf_bytes);
 	gbhw->impbuf->bytes = impbuf_bytes;
 	gbhw->impbuf->samples = impbuf_bytes / 8;
+	if (gbhw->voices && !gbhw_alloc_voices(gbhw))
+		gbhw->voices = 0;
+	if (gbhw->stembuf[0] && !gbhw_alloc_stems(gbhw))
+		memset(gbhw->stembuf, 0, sizeof(gbhw->stembuf));
 	gbhw_impbuf_reset(gbhw);
 }
 
+/*
+ * Per-voice output is off by default and costs nothing then.  Without
+ * a buffer the voice buffers are allocated by gbhw_set_buffer().
+ */
+long gbhw_set_voices(struct gbhw* const gbhw, long enable)
+{
+	enable = enable != 0;
+	if (enable == gbhw->voices)
+		return 1;
+	if (!enable) {
+		gbhw->voices = 0;
+		gbhw_free_voices(gbhw);
+		return 1;
+	}
+	if (gbhw->impbuf && !gbhw_alloc_voices(gbhw))
+		return 0;
+	gbhw->voices = 1;
+	return 1;
+}
+
+/*
+ * Render each channel to its own stereo buffer besides the mix.  The
+ * buffers must be as large as the mix buffer and are flushed with it.
+ * NULL turns the stems off.
+ */
+long gbhw_set_stems(struct gbhw* const gbhw, struct gbhw_buffer *bufs[4])
+{
+	long i;
+
+	gbhw_free_stems(gbhw);
+	memset(gbhw->stembuf, 0, sizeof(gbhw->stembuf));
+	if (bufs == NULL)
+		return 1;
+	for (i = 0; i < 4; i++)
+		gbhw->stembuf[i] = bufs[i];
+	if (gbhw->impbuf && !gbhw_alloc_stems(gbhw)) {
+		memset(gbhw->stembuf, 0, sizeof(gbhw->stembuf));
+		return 0;
+	}
+	return 1;
+}
+
+long gbhw_set_event_log(struct gbhw* const gbhw, long capacity)
+{
+	struct gbhw_evlog *log = &gbhw->evlog;
+	unsigned long size = 16;
+
+	free(log->ev);
+	memset(log, 0, sizeof(*log));
+	if (capacity <= 0)
+		return 1;
+	while (size < (unsigned long)capacity)
+		size *= 2;
+	log->ev = malloc(size * sizeof(*log->ev));
+	if (log->ev == NULL) {
+		fprintf(stderr, "%s", _("Memory allocation failed!\n"));
+		return 0;
+	}
+	log->mask = size - 1;
+	log->last = gbhw->sum_cycles;
+	return 1;
+}
+
+long gbhw_read_events(struct gbhw* const gbhw, struct gbs_event *out, long max)
+{
+	struct gbhw_evlog *log = &gbhw->evlog;
+	unsigned long n = log->head - log->tail;
+	unsigned long first = log->mask + 1 - (log->tail & log->mask);
+
+	if (max <= 0)
+		return 0;
+	if (n > (unsigned long)max)
+		n = max;
+	if (first > n)
+		first = n;
+	memcpy(out, &log->ev[log->tail & log->mask], first * sizeof(*out));
+	memcpy(out + first, log->ev, (n - first) * sizeof(*out));
+	log->tail += n;
+	return n;
+}
+
 static void gbhw_update_filter(struct gbhw *gbhw)
 {
 	double cap_constant = pow(gbhw->filter_constant, (double)GBHW_CLOCK / gbhw->sample_rate);
@@ -1026,6 +1725,48 @@ long gbhw_set_filter(struct gbhw* const gbhw, enum gbs_filter_type type)
 	return 1;
 }
 
+void gbhw_set_idle_skip(struct gbhw* const gbhw, enum gbs_idle_skip mode)
+{
+	gbhw->idle_skip = mode;
+	gbhw->spin.state = SPIN_NONE;
+}
+
+static const int32_t *impulse_tab(struct gbhw_impulse *imp)
+{
+	const int32_t *tab = __atomic_load_n(&imp->tab, __ATOMIC_ACQUIRE);
+	int32_t *new;
+
+	if (tab != NULL)
+		return tab;
+	new = gen_impulsetab(imp->w_shift, imp->n_shift, imp->cutoff);
+	if (new == NULL)
+		return NULL;
+	/* another instance may have been quicker */
+	if (__atomic_compare_exchange_n(&imp->tab, &tab, new, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+		return new;
+	free(new);
+	return tab;
+}
+
+/* a new impulse width needs a new impulse buffer, pending output is lost */
+long gbhw_set_quality(struct gbhw* const gbhw, enum gbs_quality quality)
+{
+	if (quality < QUALITY_DRAFT || quality > QUALITY_HIGH)
+		return 0; // invalid
+	if (impulse_tab(&impulses[quality]) == NULL) {
+		fprintf(stderr, "%s", _("Memory allocation failed!\n"));
+		return 0;
+	}
+	if (gbhw->impulse == &impulses[quality])
+		return 1;
+
+	gbhw->impulse = &impulses[quality];
+	if (gbhw->soundbuf)
+		gbhw_set_buffer(gbhw, gbhw->soundbuf);
+
+	return 1;
+}
+
 void gbhw_set_rate(struct gbhw* const gbhw, long rate)
 {
 	gbhw->sample_rate = rate;
@@ -1060,19 +1801,26 @@ void gbhw_init(struct gbhw* const gbhw)
 {
 	long i;
 	gbhw_iocallback_fn saved_callback = gbhw->iocallback;
+	struct gbs_event *saved_log = gbhw->evlog.ev;
+	/* the log deltas run on while sum_cycles restarts */
+	cycles_t since_log = gbhw->sum_cycles - gbhw->evlog.last;
 	/* Disable IO callback to hide memory pokes done in gbhw_init. */
 	gbhw->iocallback = NULL;
+	gbhw->evlog.ev = NULL;
 
-	gbhw->vblankctr = vblanktc;
+	gbhw->event[GBHW_EV_VBLANK] = vblanktc;
+	gbhw->event[GBHW_EV_TIMER] = GBHW_NEVER;
+	/* the sequencer runs on every 2048th main_div tick */
+	gbhw->event[GBHW_EV_SEQUENCER] = 1 + sequencer_tc;
 	gbhw->timerctr = 0;
 	gbhw->divoffset = 0;
+	memset(&gbhw->spin, 0, sizeof(gbhw->spin));
 	gbhw->main_div = 0;
-	gbhw->sweep_div = 0;
 
 	if (gbhw->impbuf)
 		gbhw_impbuf_reset(gbhw);
 	gbhw->master_volume = MASTER_VOL_MAX;
-	gbhw->master_fade = 0;
+	gbhw->fade_start = gbhw->fade_end = 0;
 	gbhw->apu_on = 1;
 	if (gbhw->soundbuf) {
 		gbhw->soundbuf->pos = 0;
@@ -1094,6 +1842,8 @@ void gbhw_init(struct gbhw* const gbhw)
 
 	gbhw->sum_cycles = 0;
 	gbhw->halted_noirq_cycles = 0;
+	gbhw->silent_since = GBHW_NEVER;
+	apu_update_silence(gbhw, 0);
 	gbhw->ch[0].duty_ctr = 0;
 	gbhw->ch[1].duty_ctr = 0;
 	gbhw->ch3pos = 0;
@@ -1104,17 +1854,235 @@ void gbhw_init(struct gbhw* const gbhw)
     //YOYOFR
     for (int ii=0;ii<4;ii++) gbhw->ch[ii].last_lvl=0;
     //YOYOFR
+	for (i=0; i<4; i++)
+		gbhw->ch[i].stem_l = gbhw->ch[i].stem_r = 0;
 
 	gbcpu_init(&gbhw->gbcpu);
 	gbcpu_add_mem(&gbhw->gbcpu, 0xc0, 0xfe, intram_put, intram_get, gbhw);
 	gbcpu_add_mem(&gbhw->gbcpu, 0xff, 0xff, io_put, io_get, gbhw);
+	/* work RAM and its echo; HIRAM shares page 0xff with IO */
+	gbcpu_map_direct(&gbhw->gbcpu, 0xc0, 0xdf, gbhw->intram, gbhw->intram);
+	gbcpu_map_direct(&gbhw->gbcpu, 0xe0, 0xfe, gbhw->intram, gbhw->intram);
 
 	gbhw->iocallback = saved_callback;  /* restore IO callback */
+	gbhw->evlog.ev = saved_log;
+	gbhw->evlog.last = gbhw->sum_cycles - since_log;
+}
+
+static void channel_save_state(const struct gbhw_channel *ch, struct savestate *s)
+{
+	state_put_long(s, ch->running);
+	state_put_long(s, ch->master);
+	state_put_long(s, ch->leftgate);
+	state_put_long(s, ch->rightgate);
+	state_put_long(s, ch->lvl);
+	state_put_long(s, ch->last_lvl);
+	state_put_long(s, ch->volume);
+	state_put_long(s, ch->env_volume);
+	state_put_long(s, ch->env_dir);
+	state_put_long(s, ch->env_tc);
+	state_put_long(s, ch->env_ctr);
+	state_put_long(s, ch->sweep_dir);
+	state_put_long(s, ch->sweep_tc);
+	state_put_long(s, ch->sweep_ctr);
+	state_put_long(s, ch->sweep_shift);
+	state_put_long(s, ch->len);
+	state_put_long(s, ch->len_enable);
+	state_put_long(s, ch->len_gate);
+	state_put_long(s, ch->div_tc);
+	state_put_long(s, ch->div_tc_shadow);
+	state_put_long(s, ch->div_ctr);
+	state_put_long(s, ch->duty_val);
+	state_put_long(s, ch->duty_ctr);
+}
+
+static void channel_load_state(struct gbhw_channel *ch, struct savestate *s)
+{
+	ch->running = state_get_long(s);
+	ch->master = state_get_long(s);
+	ch->leftgate = state_get_long(s);
+	ch->rightgate = state_get_long(s);
+	ch->lvl = state_get_long(s);
+	ch->last_lvl = state_get_long(s);
+	ch->volume = state_get_long(s);
+	ch->env_volume = state_get_long(s);
+	ch->env_dir = state_get_long(s);
+	ch->env_tc = state_get_long(s);
+	ch->env_ctr = state_get_long(s);
+	ch->sweep_dir = state_get_long(s);
+	ch->sweep_tc = state_get_long(s);
+	ch->sweep_ctr = state_get_long(s);
+	ch->sweep_shift = state_get_long(s);
+	ch->len = state_get_long(s);
+	ch->len_enable = state_get_long(s);
+	ch->len_gate = state_get_long(s);
+	ch->div_tc = state_get_long(s);
+	ch->div_tc_shadow = state_get_long(s);
+	ch->div_ctr = state_get_long(s);
+	ch->duty_val = state_get_long(s);
+	ch->duty_ctr = state_get_long(s);
+}
+
+/*
+ * The pending impulses and filter state are only kept if the output
+ * is configured the same way when loading, otherwise the output
+ * starts over as after gbhw_init().  Channel mutes and the idle loop
+ * tracking are not part of the state.
+ */
+void gbhw_save_state(struct gbhw* const gbhw, struct savestate *s)
+{
+	struct gbhw_buffer *impbuf = gbhw->impbuf;
+	struct gbhw_buffer *soundbuf = gbhw->soundbuf;
+	long i;
+
+	state_put(s, gbhw->rom_lockout, 1);
+	gbcpu_save_state(&gbhw->gbcpu, s);
+
+	state_put_s64(s, gbhw->sum_cycles);
+	for (i = 0; i < GBHW_EVENTS; i++)
+		state_put(s, gbhw->event[i], 8);
+	state_put_long(s, gbhw->timertc);
+	state_put_long(s, gbhw->timerctr);
+	state_put_s64(s, gbhw->divoffset);
+	state_put_s64(s, gbhw->halted_noirq_cycles);
+
+	state_put_long(s, gbhw->apu_on);
+	state_put(s, gbhw->silent_since, 8);
+	state_put_long(s, gbhw->update_level);
+	state_put_long(s, gbhw->sequence_ctr);
+	state_put_long(s, gbhw->main_div);
+	state_put_s64(s, gbhw->ch3pos);
+	state_put_long(s, gbhw->ch3_next_nibble);
+	state_put_long(s, gbhw->last_l_value);
+	state_put_long(s, gbhw->last_r_value);
+	state_put(s, gbhw->lfsr.lfsr, 2);
+	state_put(s, gbhw->lfsr.narrow, 1);
+	for (i = 0; i < 4; i++)
+		channel_save_state(&gbhw->ch[i], s);
+
+	state_put_long(s, gbhw->master_volume);
+	state_put_s64(s, gbhw->fade_start);
+	state_put_s64(s, gbhw->fade_end);
+	state_put_long(s, gbhw->lminval);
+	state_put_long(s, gbhw->lmaxval);
+	state_put_long(s, gbhw->rminval);
+	state_put_long(s, gbhw->rmaxval);
+
+	state_put_mem(s, gbhw->ioregs, sizeof(gbhw->ioregs));
+	state_put_mem(s, gbhw->hiram, sizeof(gbhw->hiram));
+	state_put_mem(s, gbhw->intram, sizeof(gbhw->intram));
+
+	if (impbuf == NULL || soundbuf == NULL) {
+		state_put_long(s, 0);
+		return;
+	}
+	state_put_long(s, impbuf->samples);
+	state_put_s64(s, impbuf->cycles);
+	state_put_s64(s, gbhw->sound_frac);
+	state_put_s64(s, soundbuf->l_lvl);
+	state_put_s64(s, soundbuf->r_lvl);
+	state_put_s64(s, soundbuf->l_cap);
+	state_put_s64(s, soundbuf->r_cap);
+	for (i = 0; i < 4; i++) {
+		state_put_s64(s, soundbuf->lvl_ch[i]);
+		state_put_s64(s, soundbuf->cap_ch[i]);
+	}
+	for (i = 0; i < impbuf->samples * 2; i++)
+		state_put_long(s, impbuf->data32[i]);
+}
+
+long gbhw_load_state(struct gbhw* const gbhw, struct savestate *s)
+{
+	struct gbhw_buffer *impbuf = gbhw->impbuf;
+	struct gbhw_buffer *soundbuf = gbhw->soundbuf;
+	cycles_t since_log = gbhw->sum_cycles - gbhw->evlog.last;
+	long i, samples;
+
+	/* the boot ROM can not be mapped back in */
+	if (state_get(s, 1))
+		gbhw->rom_lockout = 1;
+	else if (gbhw->rom_lockout)
+		return 0;
+	gbcpu_load_state(&gbhw->gbcpu, s);
+
+	gbhw->sum_cycles = state_get_s64(s);
+	gbhw->evlog.last = gbhw->sum_cycles - since_log;
+	for (i = 0; i < GBHW_EVENTS; i++)
+		gbhw->event[i] = state_get(s, 8);
+	gbhw->timertc = state_get_long(s);
+	gbhw->timerctr = state_get_long(s);
+	gbhw->divoffset = state_get_s64(s);
+	gbhw->halted_noirq_cycles = state_get_s64(s);
+
+	gbhw->apu_on = state_get_long(s);
+	gbhw->silent_since = state_get(s, 8);
+	gbhw->update_level = state_get_long(s);
+	gbhw->sequence_ctr = state_get_long(s);
+	gbhw->main_div = state_get_long(s);
+	gbhw->ch3pos = state_get_s64(s);
+	gbhw->ch3_next_nibble = state_get_long(s);
+	gbhw->last_l_value = state_get_long(s);
+	gbhw->last_r_value = state_get_long(s);
+	gbhw->lfsr.lfsr = state_get(s, 2);
+	gbhw->lfsr.narrow = state_get(s, 1);
+	for (i = 0; i < 4; i++)
+		channel_load_state(&gbhw->ch[i], s);
+
+	gbhw->master_volume = state_get_long(s);
+	gbhw->fade_start = state_get_s64(s);
+	gbhw->fade_end = state_get_s64(s);
+	gbhw->lminval = state_get_long(s);
+	gbhw->lmaxval = state_get_long(s);
+	gbhw->rminval = state_get_long(s);
+	gbhw->rmaxval = state_get_long(s);
+
+	state_get_mem(s, gbhw->ioregs, sizeof(gbhw->ioregs));
+	state_get_mem(s, gbhw->hiram, sizeof(gbhw->hiram));
+	state_get_mem(s, gbhw->intram, sizeof(gbhw->intram));
+
+	gbhw->spin.state = SPIN_NONE;
+	gbhw->reschedule = 1;
+
+	/* stem output is not part of the state */
+	if (gbhw->stem_imp[0])
+		gbhw_stems_reset(gbhw);
+
+	samples = state_get_long(s);
+	if (impbuf == NULL || soundbuf == NULL || samples != impbuf->samples) {
+		/* 14 levels and counters plus the stereo impulse buffer */
+		if (samples > 0)
+			state_skip(s, 14 * 8 + samples * 2 * 4);
+		if (impbuf)
+			gbhw_impbuf_reset(gbhw);
+		if (soundbuf) {
+			soundbuf->l_lvl = soundbuf->r_lvl = 0;
+			soundbuf->l_cap = soundbuf->r_cap = 0;
+			for (i = 0; i < 4; i++)
+				soundbuf->lvl_ch[i] = soundbuf->cap_ch[i] = 0;
+		}
+		return !s->overrun;
+	}
+	impbuf->cycles = state_get_s64(s);
+	gbhw->sound_frac = state_get_s64(s);
+	soundbuf->l_lvl = state_get_s64(s);
+	soundbuf->r_lvl = state_get_s64(s);
+	soundbuf->l_cap = state_get_s64(s);
+	soundbuf->r_cap = state_get_s64(s);
+	for (i = 0; i < 4; i++) {
+		soundbuf->lvl_ch[i] = state_get_s64(s);
+		soundbuf->cap_ch[i] = state_get_s64(s);
+	}
+	for (i = 0; i < impbuf->samples * 2; i++)
+		impbuf->data32[i] = state_get_long(s);
+	return !s->overrun;
 }
 
 void gbhw_cleanup(struct gbhw* const gbhw)
 {
 	if (gbhw->impbuf) free(gbhw->impbuf);
+	free(gbhw->evlog.ev);
+	gbhw_free_voices(gbhw);
+	gbhw_free_stems(gbhw);
 }
 
 void gbhw_enable_bootrom(struct gbhw* const gbhw, const uint8_t *rombuf)
@@ -1128,6 +2096,7 @@ void gbhw_enable_bootrom(struct gbhw* const gbhw, const uint8_t *rombuf)
 
 /* internal for gbs.c, not exported from libgbs */
 void gbhw_io_put(struct gbhw* const gbhw, uint16_t addr, uint8_t val) {
+	gbhw->spin.state = SPIN_NONE;
 	if (addr != 0xffff && (addr < 0xff00 || addr > 0xff7f))
 		return;
 	io_put(gbhw, addr, val);
@@ -1194,70 +2163,312 @@ static void blargg_debug(struct gbcpu *gbcpu)
 	}
 }
 
+/*
+ * Only an interrupt ends a HALT with IME set, and none is pending
+ * once gbhw_check_if() returned.  Instead of stepping the halted CPU
+ * GBCPU_HALT_CYCLES at a time, skip as many of these steps as it takes
+ * to reach the next event in one go.
+ */
+static long halt_cycles(long maxcycles)
+{
+	long steps = (maxcycles + GBCPU_HALT_CYCLES - 1) / GBCPU_HALT_CYCLES;
+
+	if (steps < 1)
+		steps = 1;
+	return steps * GBCPU_HALT_CYCLES;
+}
+
+/*
+ * Idle loop skipping.  A short backward jump whose loop body only reads
+ * memory and writes registers (gbcpu_idle_loop()) is watched for one
+ * iteration.  If the CPU arrives at the loop head again with the same
+ * registers, the next iterations repeat this one exactly as long as the
+ * memory they read stays the same.  RAM and ROM can only be changed by
+ * an interrupt handler, and interrupts only get raised by events, which
+ * end the slice the skip is bounded by.  Time dependent IO registers bound the skip to
+ * the point where their value changes, see io_stable_cycles().
+ */
+static void spin_probe(struct gbhw *gbhw)
+{
+	struct gbcpu *gbcpu = &gbhw->gbcpu;
+
+	gbcpu_sync_flags(gbcpu);
+	gbhw->spin.regs = gbcpu->regs;
+	gbhw->spin.start = gbhw->sum_cycles;
+	gbhw->spin.stable = ~(cycles_t)0;
+	gbhw->spin.state = SPIN_PROBE;
+}
+
+static long spin_same_state(struct gbhw *gbhw)
+{
+	struct gbcpu *gbcpu = &gbhw->gbcpu;
+
+	gbcpu_sync_flags(gbcpu);
+	return memcmp(&gbcpu->regs, &gbhw->spin.regs, sizeof(gbcpu->regs)) == 0;
+}
+
+/* called after every executed instruction, prev_pc is where it started */
+static void spin_track(struct gbhw *gbhw, uint16_t prev_pc)
+{
+	struct gbcpu *gbcpu = &gbhw->gbcpu;
+	struct gbhw_spin *spin = &gbhw->spin;
+	uint16_t pc = REGS16_R(gbcpu->regs, GBS_PC);
+	long inside = pc >= spin->head && pc <= spin->tail && !gbcpu->halted;
+
+	switch (spin->state) {
+	case SPIN_NONE:
+		if (pc < prev_pc && prev_pc - pc <= SPIN_MAXLEN &&
+		    gbcpu_idle_loop(gbcpu, pc, prev_pc)) {
+			spin->head = pc;
+			spin->tail = prev_pc;
+			spin_probe(gbhw);
+		}
+		break;
+	case SPIN_PROBE:
+		if (!inside) {
+			spin->state = SPIN_NONE;
+		} else if (pc == spin->head) {
+			if (spin_same_state(gbhw)) {
+				spin->period = gbhw->sum_cycles - spin->start;
+				spin->state = SPIN_ARMED;
+			} else {
+				spin_probe(gbhw);
+			}
+		}
+		break;
+	case SPIN_CHECK:
+		if (inside && gbhw->sum_cycles < spin->target)
+			break;
+		if (!inside || gbhw->sum_cycles != spin->target ||
+		    pc != spin->head || !spin_same_state(gbhw)) {
+			spin->mismatches++;
+			WARN_ONCE("Idle loop skip at %04x would have diverged at cycle %llu.\n",
+			          spin->head, (unsigned long long)gbhw->sum_cycles);
+		}
+		spin->state = SPIN_NONE;
+		break;
+	}
+}
+
+/* cycles that can be skipped at the head of an armed idle loop, 0 if none */
+static long spin_cycles(struct gbhw *gbhw, long maxcycles)
+{
+	struct gbcpu *gbcpu = &gbhw->gbcpu;
+	struct gbhw_spin *spin = &gbhw->spin;
+	cycles_t now = gbhw->sum_cycles;
+	cycles_t limit = now + maxcycles;
+	cycles_t iters;
+
+	spin->state = SPIN_NONE;
+	if (REGS16_R(gbcpu->regs, GBS_PC) != spin->head)
+		return 0;
+	if (spin->stable < limit)
+		limit = spin->stable;
+	if (limit <= now)
+		return 0;
+	iters = (limit - now) / spin->period;
+	if (iters == 0)
+		return 0;
+
+	spin->skips++;
+	spin->skipped += iters * spin->period;
+	if (gbhw->idle_skip == IDLE_SKIP_VALIDATE) {
+		spin->target = now + iters * spin->period;
+		spin->state = SPIN_CHECK;
+		return 0;
+	}
+	spin->state = SPIN_ARMED;
+	return iters * spin->period;
+}
+
+/* earliest deadline before end of the events that end a slice */
+static cycles_t next_event(const struct gbhw *gbhw, cycles_t end)
+{
+	if (gbhw->event[GBHW_EV_VBLANK] < end)
+		end = gbhw->event[GBHW_EV_VBLANK];
+	if (gbhw->event[GBHW_EV_TIMER] < end)
+		end = gbhw->event[GBHW_EV_TIMER];
+	return end;
+}
+
+/* raise the interrupts of the events that are due */
+static void run_events(struct gbhw *gbhw)
+{
+	cycles_t now = gbhw->sum_cycles;
+
+	if (gbhw->event[GBHW_EV_VBLANK] <= now) {
+		gbhw->event[GBHW_EV_VBLANK] += vblanktc;
+		gbhw->ioregs[REG_IF] |= 0x01;
+		DPRINTF("vblank_interrupt\n");
+	}
+	while (gbhw->event[GBHW_EV_TIMER] <= now) {
+		/* TIMA reloads from TMA */
+		gbhw->event[GBHW_EV_TIMER] += (0x100 - gbhw->ioregs[REG_TMA]) * gbhw->timertc;
+		gbhw->ioregs[REG_IF] |= 0x04;
+		DPRINTF("timer_interrupt\n");
+	}
+}
+
 /**
- * @param time_to_work  emulated time in milliseconds
- * @return  elapsed cpu cycles
+ * Run until sum_cycles reaches end.  Instructions are not split, so
+ * it may stop up to one instruction later.
+ *
+ * @param end  sum_cycles to run to
+ * @return  elapsed cpu cycles, GBHW_NEVER if the CPU locked up or stopped
  */
-cycles_t gbhw_step(struct gbhw *gbhw, long time_to_work)
+cycles_t gbhw_run(struct gbhw *gbhw, cycles_t end)
 {
 	struct gbcpu *gbcpu = &gbhw->gbcpu;
-	cycles_t cycles_total = 0;
-
-	time_to_work *= msec_cycles;
-	
-	while (cycles_total < time_to_work) {
-		long maxcycles = time_to_work - cycles_total;
-		cycles_t cycles = 0;
-
-		if (gbhw->vblankctr > 0 && gbhw->vblankctr < maxcycles) maxcycles = gbhw->vblankctr;
-		if (gbhw->timerctr > 0 && gbhw->timerctr < maxcycles) maxcycles = gbhw->timerctr;
-
-		gbhw->io_written = 0;
-		while (cycles < maxcycles && !gbhw->io_written) {
-			long step;
-			gbhw_check_if(gbhw);
-			step = gbcpu_step(gbcpu);
+	cycles_t start = gbhw->sum_cycles;
+
+	while (gbhw->sum_cycles < end) {
+		cycles_t next = next_event(gbhw, end);
+
+		gbhw->reschedule = 0;
+		while (gbhw->sum_cycles < next && !gbhw->reschedule) {
+			long left = next - gbhw->sum_cycles;
+			long step = 0, halt, skipped;
+			uint16_t pc;
+			/* nothing to check unless an interrupt is pending */
+			if (gbhw->ioregs[REG_IF] & gbhw->ioregs[REG_IE])
+				gbhw_check_if(gbhw);
+			pc = REGS16_R(gbcpu->regs, GBS_PC);
+			if (gbcpu->halted && gbcpu->ime && !gbcpu->stopped)
+				step = halt_cycles(left);
+			else if (gbhw->spin.state == SPIN_ARMED)
+				step = spin_cycles(gbhw, left);
+			skipped = step;
+			if (step == 0 && !gbcpu->halted && gbhw->stepcallback == NULL &&
+			    gbhw->idle_skip == IDLE_SKIP_OFF) {
+				step = cpu_run(gbhw, left);
+				/* only the last instruction of a run can halt */
+				halt = gbcpu->cycles;
+			} else {
+				if (step == 0)
+					step = gbcpu_step(gbcpu);
+				halt = step;
+			}
 			if (gbcpu->halted) {
-				gbhw->halted_noirq_cycles += step;
+				gbhw->halted_noirq_cycles += halt;
 				if (gbcpu->ime == 0 &&
 				    (gbhw->ioregs[REG_IE] == 0 ||
 				     gbhw->halted_noirq_cycles > GBHW_CLOCK/10)) {
 					fprintf(stderr, "CPU locked up (halt with interrupts disabled).\n");
 					blargg_debug(gbcpu);
-					return -1;
+					return GBHW_NEVER;
 				}
 			} else {
 				gbhw->halted_noirq_cycles = 0;
 			}
-			if (step < 0) return step;
-			cycles += step;
-			gbhw->sum_cycles += step;
-			gbhw->vblankctr -= step;
-			if (gbhw->vblankctr <= 0) {
-				gbhw->vblankctr += vblanktc;
-				gbhw->ioregs[REG_IF] |= 0x01;
-				DPRINTF("vblank_interrupt\n");
-			}
-			gb_sound(gbhw, step);
+			if (step < 0) return GBHW_NEVER;
+			cpu_advance(gbhw, step);
 			if (gbhw->stepcallback)
 			   gbhw->stepcallback(gbhw->sum_cycles, gbhw->ch, gbhw->stepcallback_priv);
+			if (gbhw->idle_skip != IDLE_SKIP_OFF && !skipped)
+				spin_track(gbhw, pc);
 		}
+		run_events(gbhw);
+	}
 
-		if (gbhw->ioregs[REG_TAC] & 4) {
-			if (gbhw->timerctr > 0) gbhw->timerctr -= cycles;
-			while (gbhw->timerctr <= 0) {
-				gbhw->timerctr += gbhw->timertc;
-				gbhw->ioregs[REG_TIMA]++;
-				//DPRINTF("TIMA=%02x\n", ioregs[REG_TIMA]);
-				if (gbhw->ioregs[REG_TIMA] == 0) {
-					gbhw->ioregs[REG_TIMA] = gbhw->ioregs[REG_TMA];
-					gbhw->ioregs[REG_IF] |= 0x04;
-					DPRINTF("timer_interrupt\n");
-				}
-			}
-		}
-		cycles_total += cycles;
+	return gbhw->sum_cycles - start;
+}
+
+/**
+ * @param time_to_work  emulated time in milliseconds
+ * @return  elapsed cpu cycles, GBHW_NEVER if the CPU locked up or stopped
+ */
+cycles_t gbhw_step(struct gbhw *gbhw, long time_to_work)
+{
+	return gbhw_run(gbhw, gbhw->sum_cycles + time_to_work * msec_cycles);
+}
+
+/*
+ * Direct the next flush of samples (at most the buffer size) to out
+ * instead of the sound buffer, without the sound callback.  Returns the
+ * sum_cycles at which that flush is due, the caller runs gbhw_run()
+ * up to it.  A flush already due happens right away.  out == NULL
+ * cancels a pending render.
+ */
+cycles_t gbhw_render(struct gbhw* const gbhw, int16_t *out, long samples)
+{
+	long long due;
+
+	assert(samples <= gbhw->soundbuf->samples);
+	gbhw->render_out = out;
+	gbhw->render_samples = samples;
+	if (out == NULL)
+		return gbhw->sum_cycles;
+
+	due = gb_flush_at(gbhw) - (long long)gbhw->impbuf->cycles;
+	if (due <= 0) {
+		gb_flush_buffer(gbhw);
+		return gbhw->sum_cycles;
+	}
+	return gbhw->sum_cycles + due;
+}
+
+test void test_evlog_grow()
+{
+	static struct gbhw gbhw;
+	struct gbs_event ev[64];
+	long i, n;
+
+	memset(&gbhw, 0, sizeof(gbhw));
+	ASSERT_EQUAL("%ld", gbhw_set_event_log(&gbhw, 16), 1L);
+	for (i = 0; i < 10; i++) {
+		gbhw.sum_cycles += i + 1;
+		evlog_write(&gbhw, 0xff10 + i, i);
+	}
+	ASSERT_EQUAL("%ld", gbhw_read_events(&gbhw, ev, 6), 6L);
+	for (i = 0; i < 6; i++)
+		ASSERT_EQUAL("%d", ev[i].value, (int)i);
+
+	/* 24 pending records with the tail at 6: grows from a wrapped ring */
+	for (i = 10; i < 30; i++) {
+		gbhw.sum_cycles += i + 1;
+		evlog_write(&gbhw, 0xff10 + i, i);
+	}
+	ASSERT_EQUAL("%lu", gbhw.evlog.mask, 31UL);
+	n = gbhw_read_events(&gbhw, ev, 64);
+	ASSERT_EQUAL("%ld", n, 24L);
+	for (i = 0; i < n; i++) {
+		ASSERT_EQUAL("%u", ev[i].delta, (uint32_t)(i + 7));
+		ASSERT_EQUAL("%d", ev[i].reg, (int)(0x10 + i + 6));
+		ASSERT_EQUAL("%d", ev[i].value, (int)(i + 6));
 	}
+	ASSERT_EQUAL("%ld", gbhw_read_events(&gbhw, ev, 64), 0L);
+	gbhw_set_event_log(&gbhw, 0);
+}
 
-	return cycles_total;
+test void test_evlog_wait()
+{
+	static struct gbhw gbhw;
+	const cycles_t gap = 2 * (cycles_t)UINT32_MAX + 5;
+	struct gbs_event ev[8];
+	cycles_t sum = 0;
+	long i, n;
+
+	memset(&gbhw, 0, sizeof(gbhw));
+	gbhw_set_event_log(&gbhw, 16);
+	gbhw.sum_cycles = 100;
+	evlog_write(&gbhw, 0xff24, 0x77);
+	gbhw.sum_cycles += gap;
+	evlog_write(&gbhw, 0xffff, 0x05);
+
+	n = gbhw_read_events(&gbhw, ev, 8);
+	ASSERT_EQUAL("%ld", n, 4L);
+	ASSERT_EQUAL("%u", ev[0].delta, 100U);
+	ASSERT_EQUAL("%d", ev[0].reg, 0x24);
+	for (i = 1; i < 3; i++) {
+		ASSERT_EQUAL("%d", ev[i].reg, GBS_EVENT_WAIT);
+		sum += ev[i].delta;
+	}
+	ASSERT_EQUAL("%d", ev[3].reg, 0xff);
+	ASSERT_EQUAL("%d", ev[3].value, 0x05);
+	sum += ev[3].delta;
+	ASSERT_EQUAL("%llu", (unsigned long long)sum, (unsigned long long)gap);
+	gbhw_set_event_log(&gbhw, 0);
 }
+TEST(test_evlog_grow);
+TEST(test_evlog_wait);
+TEST_EOF;
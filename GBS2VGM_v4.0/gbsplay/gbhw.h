@@ -16,6 +16,7 @@
 #include "libgbs.h"
 #include "gbcpu.h"
 #include "gblfsr.h"
+#include "gbmix.h"
 
 #define GBHW_CLOCK 4194304
 
@@ -45,91 +46,152 @@ struct gbhw_buffer {
 	cycles_t cycles;
 };
 
+struct gbhw_impulse;
+
+/*
+ * Sized to the register ranges so all four channels share a few cache
+ * lines; the fields gb_sound_cycle() uses on every cycle come first.
+ */
 struct gbhw_channel {
-	long mute;
-	long running;
-	long master;
-	long leftgate;
-	long rightgate;
-	long lvl;
-    long last_lvl;//yoyofr
-	long volume;
-	long env_volume;
-	long env_dir;
-	long env_tc;
-	long env_ctr;
-	long sweep_dir;
-	long sweep_tc;
-	long sweep_ctr;
-	long sweep_shift;
-	long len;
-	long len_enable;
-	long len_gate;
-	long div_tc;
-	long div_tc_shadow;
-	long div_ctr;
-	long duty_val;
-	long duty_ctr;
+	int32_t div_ctr;
+	int32_t div_tc;
+	int8_t running;
+	int8_t lvl;
+	int8_t env_volume;
+	int8_t duty_val;
+	int8_t duty_ctr;
+	int8_t leftgate;
+	int8_t rightgate;
+	int8_t mute;
+    int8_t last_lvl;//yoyofr
+	int8_t stem_l, stem_r;	/* levels in the stem output, see gbhw_set_stems() */
+
+	/* register and frame sequencer state */
+	int8_t master;
+	int8_t volume;
+	int8_t env_dir;
+	int8_t env_tc;
+	int8_t env_ctr;
+	int8_t sweep_dir;
+	int8_t sweep_tc;
+	int8_t sweep_ctr;
+	int8_t sweep_shift;
+	int8_t len_enable;
+	int8_t len_gate;
+	int16_t len;
+	int32_t div_tc_shadow;
 };
 
 typedef void (*gbhw_callback_fn)(void *priv);
 typedef void (*gbhw_iocallback_fn)(cycles_t cycles, uint32_t addr, uint8_t value, void *priv);
 typedef void (*gbhw_stepcallback_fn)(const cycles_t cycles, const struct gbhw_channel[], void *priv);
 
+/*
+ * Events scheduled at an absolute sum_cycles deadline, GBHW_NEVER when
+ * idle.  gbhw_step() runs the CPU up to the earliest CPU event, the
+ * APU frame sequencer is handled by gb_sound() on its own.
+ */
+enum gbhw_event {
+	GBHW_EV_VBLANK,
+	GBHW_EV_TIMER,
+	GBHW_EV_SEQUENCER,
+	GBHW_EVENTS
+};
+#define GBHW_NEVER (~(cycles_t)0)
+
+/* idle loop detection, see spin_track() */
+struct gbhw_spin {
+	long state;
+	uint16_t head;		/* loop start, target of the backward jump */
+	uint16_t tail;		/* the backward jump */
+	gbcpu_regs_u regs;	/* registers at head */
+	cycles_t start;		/* sum_cycles at head */
+	cycles_t period;	/* cycles per iteration */
+	cycles_t stable;	/* polled IO values are valid before this */
+	cycles_t target;	/* IDLE_SKIP_VALIDATE: where the skip would land */
+	long skips;
+	cycles_t skipped;
+	long mismatches;
+};
+
+/* register write log, see gbhw_set_event_log() */
+struct gbhw_evlog {
+	struct gbs_event *ev;	/* ring of mask + 1 records, NULL when off */
+	unsigned long mask;
+	unsigned long head;	/* next record to write */
+	unsigned long tail;	/* next record to read */
+	cycles_t last;		/* sum_cycles of the last record */
+};
+
 struct gbhw {
-	long apu_on;
-	long io_written;
+	/* used on every sound cycle, see gb_sound_run() */
+	long main_div;
+	long update_level;
+	long ch3pos;
+	long ch3_next_nibble;
+	long last_l_value, last_r_value;
+	long long sound_div_tc;
+	struct gblfsr lfsr;
+	long voices;                  /* per-voice output, see gbhw_set_voices() */
+	struct gbhw_buffer *impbuf;   /* internal impulse output buffer */
+	const struct gbmix_kernels *mix;
+	const struct gbhw_impulse *impulse;
+	struct gbhw_buffer *stembuf[4]; /* per-channel stereo output, see gbhw_set_stems() */
+	struct gbhw_channel ch[4];
 
-	long lminval, lmaxval, rminval, rmaxval;
-	double filter_constant;
+	/* used on every buffer flush */
+	struct gbhw_buffer *soundbuf; /* externally visible output buffer */
+	int16_t *render_out;          /* destination of the next flush, see gbhw_render() */
+	long render_samples;
 	int filter_enabled;
 	long cap_factor;
-
 	long master_volume;
-	long master_fade;
-	long master_dstvol;
-	long sample_rate;
-	long update_level;
-	long sequence_ctr;
-	cycles_t halted_noirq_cycles;
-
-	long vblankctr;
-	long timertc;
-	long timerctr;
-	long divoffset;
-
-	cycles_t sum_cycles;
-
-	long rom_lockout;
-
+	long long sound_base;         /* APU cycle at impbuf->cycles == 0 */
+	long long sound_frac;         /* impbuf sample 0 is this many 1/SOUND_DIV_MULT cycles later */
+	long long fade_start, fade_end; /* see gbhw_set_fade() */
+	int32_t *fade_gain;           /* per-sample volume during the fade */
+	long lminval, lmaxval, rminval, rmaxval;
+	int32_t *voice_imp[4];        /* per-voice impulse buffers, impbuf->samples each */
+	int8_t *voice_out[4];         /* per-voice output of the last flush */
+	int32_t *stem_imp[4];         /* per-channel impulse buffers, impbuf layout */
 	gbhw_callback_fn callback;
 	void *callbackpriv;
-	struct gbhw_buffer *soundbuf; /* externally visible output buffer */
-	struct gbhw_buffer *impbuf;   /* internal impulse output buffer */
+
+	/* used on every CPU step, see gbhw_step() */
+	cycles_t sum_cycles;
+	cycles_t event[GBHW_EVENTS];
+	long reschedule;	/* an IO write moved an event, see gbhw_step() */
+	long in_run;		/* inside gbcpu_run(), see cpu_sync() */
+	long run_synced;	/* cycles of that run already in sum_cycles */
+	long apu_on;
+	cycles_t silent_since;	/* no channel audible since, GBHW_NEVER while sounding */
+	cycles_t halted_noirq_cycles;
+	enum gbs_idle_skip idle_skip;
 
 	gbhw_iocallback_fn iocallback;
 	void *iocallback_priv;
+	struct gbhw_evlog evlog;
 
 	gbhw_stepcallback_fn stepcallback;
 	void *stepcallback_priv;
 
-	struct gblfsr lfsr;
-
-	long long sound_div_tc;
-	long main_div;
-	long sweep_div;
+	long timertc;
+	long timerctr;		/* cycles left of the TIMA period while stopped */
+	long divoffset;
 
-	long ch3pos;
-	long last_l_value, last_r_value;
-	long ch3_next_nibble;
+	uint8_t ioregs[GBHW_IOREGS_SIZE];
+	uint8_t hiram[GBHW_HIRAM_SIZE];
 
+	struct gbhw_spin spin;
 	struct gbcpu gbcpu;
 
-	struct gbhw_channel ch[4];
+	/* configuration and rarely used state */
+	double filter_constant;
+	long sample_rate;
+	long sequence_ctr;
+	long rom_lockout;
 
-	uint8_t hiram[GBHW_HIRAM_SIZE];
 	uint8_t intram[GBHW_INTRAM_SIZE];
-	uint8_t ioregs[GBHW_IOREGS_SIZE];
 
 	uint8_t boot_rom[GBHW_BOOT_ROM_SIZE];
 	struct get_entry boot_shadow_get;
@@ -140,17 +202,27 @@ void gbhw_set_callback(struct gbhw* const gbhw, gbhw_callback_fn fn, void *priv)
 void gbhw_set_io_callback(struct gbhw* const gbhw, gbhw_iocallback_fn fn, void *priv);
 void gbhw_set_step_callback(struct gbhw* const gbhw, gbhw_stepcallback_fn fn, void *priv);
 long gbhw_set_filter(struct gbhw* const gbhw, enum gbs_filter_type type);
+long gbhw_set_quality(struct gbhw* const gbhw, enum gbs_quality quality);
+long gbhw_set_voices(struct gbhw* const gbhw, long enable);
+long gbhw_set_stems(struct gbhw* const gbhw, struct gbhw_buffer *bufs[4]);
+long gbhw_set_event_log(struct gbhw* const gbhw, long capacity);
+long gbhw_read_events(struct gbhw* const gbhw, struct gbs_event *out, long max);
+void gbhw_set_idle_skip(struct gbhw* const gbhw, enum gbs_idle_skip mode);
 void gbhw_set_rate(struct gbhw* const gbhw, long rate);
 void gbhw_set_buffer(struct gbhw* const gbhw, struct gbhw_buffer *buffer);
 void gbhw_init(struct gbhw* const gbhw);
 void gbhw_init_struct(struct gbhw* const gbhw);
 void gbhw_cleanup(struct gbhw* const gbhw);
 void gbhw_enable_bootrom(struct gbhw* const gbhw, const uint8_t *rombuf);
-void gbhw_master_fade(struct gbhw* const gbhw, long speed, long dstvol);
+void gbhw_set_fade(struct gbhw* const gbhw, long long start, long long end);
 void gbhw_calc_minmax(struct gbhw* const gbhw, int16_t *lmin, int16_t *lmax, int16_t *rmin, int16_t *rmax);
 float gbhw_calc_timer_hz(uint8_t tac, uint8_t tma);
+cycles_t gbhw_run(struct gbhw* const gbhw, cycles_t end);
 cycles_t gbhw_step(struct gbhw* const gbhw, long time_to_work);
+cycles_t gbhw_render(struct gbhw* const gbhw, int16_t *out, long samples);
 uint8_t gbhw_io_peek(const struct gbhw* const gbhw, uint16_t addr);  /* unmasked peek */
 void gbhw_io_put(struct gbhw* const gbhw, uint16_t addr, uint8_t val);
+void gbhw_save_state(struct gbhw* const gbhw, struct savestate *s);
+long gbhw_load_state(struct gbhw* const gbhw, struct savestate *s);
 
 #endif
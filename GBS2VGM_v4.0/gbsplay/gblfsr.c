@@ -7,6 +7,8 @@
  * Licensed under GNU GPL v1 or, at your option, any later version.
  */
 
+#include <stdlib.h>
+
 #include "gblfsr.h"
 #include "test.h"
 
@@ -14,6 +16,25 @@
 #define MASK_FULL	((1 << 15) - 1)
 #define MASK_NARROW	((1 << 7) - 1)
 
+#define PERIOD_WIDE	32767
+#define PERIOD_NARROW	127
+
+/*
+ * Both sequences from reset: state[p] is the register after p steps,
+ * pos[] its inverse and bit p of bits[] (MSB first) the output of the
+ * step to position p, continued past the period for 64 bit reads.  In
+ * narrow mode only the low 7 bits feed back, so they have a cycle of
+ * their own and the upper bits are just the last 8 outputs.
+ */
+struct gblfsr_tables {
+	uint16_t wide_state[PERIOD_WIDE];
+	uint16_t wide_pos[MASK_FULL + 1];
+	uint64_t wide_bits[(PERIOD_WIDE + 64) / 64 + 1];
+	uint8_t narrow_state[PERIOD_NARROW];
+	uint8_t narrow_pos[MASK_NARROW + 1];
+	uint64_t narrow_bits[(PERIOD_NARROW + 64) / 64 + 1];
+};
+
 void gblfsr_reset(struct gblfsr* gblfsr) {
 	gblfsr->lfsr = MASK_FULL;
 	gblfsr->narrow = false;
@@ -38,6 +59,147 @@ int gblfsr_next_value(struct gblfsr* gblfsr) {
 	return new & 1;
 }
 
+static void fill_bits(uint64_t *bits, long words, const void *state, long elem, long period)
+{
+	long p;
+
+	for (p = 0; p < words * 64; p++) {
+		long i = p % period;
+		uint32_t val = elem == 2 ? ((const uint16_t *)state)[i] : ((const uint8_t *)state)[i];
+		if (val & 1)
+			bits[p / 64] |= 1ULL << (63 - p % 64);
+	}
+}
+
+static struct gblfsr_tables *tables_build(void)
+{
+	struct gblfsr_tables *t = calloc(1, sizeof(*t));
+	struct gblfsr l;
+	long p;
+
+	if (t == NULL)
+		return NULL;
+
+	gblfsr_reset(&l);
+	for (p = 0; p < PERIOD_WIDE; p++) {
+		t->wide_state[p] = l.lfsr;
+		t->wide_pos[l.lfsr] = p;
+		gblfsr_next_value(&l);
+	}
+	gblfsr_set_narrow(&l, true);
+	for (p = 0; p < PERIOD_NARROW; p++) {
+		t->narrow_state[p] = l.lfsr & MASK_NARROW;
+		t->narrow_pos[l.lfsr & MASK_NARROW] = p;
+		gblfsr_next_value(&l);
+	}
+	fill_bits(t->wide_bits, ARRAY_SIZE(t->wide_bits), t->wide_state, 2, PERIOD_WIDE);
+	fill_bits(t->narrow_bits, ARRAY_SIZE(t->narrow_bits), t->narrow_state, 1, PERIOD_NARROW);
+	return t;
+}
+
+/* shared by all instances, NULL if out of memory */
+static const struct gblfsr_tables *tables_get(void)
+{
+	static struct gblfsr_tables *tables;
+	struct gblfsr_tables *t = __atomic_load_n(&tables, __ATOMIC_ACQUIRE);
+	struct gblfsr_tables *new;
+
+	if (t != NULL)
+		return t;
+	new = tables_build();
+	if (new == NULL)
+		return NULL;
+	/* another instance may have been quicker */
+	if (__atomic_compare_exchange_n(&tables, &t, new, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+		return new;
+	free(new);
+	return t;
+}
+
+/* 64 bits from position q on, q < period + 1 */
+static uint64_t read_bits(const uint64_t *bits, long q)
+{
+	uint64_t w = bits[q / 64] << (q % 64);
+
+	if (q % 64)
+		w |= bits[q / 64 + 1] >> (64 - q % 64);
+	return w;
+}
+
+int gblfsr_advance(struct gblfsr* gblfsr, long n)
+{
+	const struct gblfsr_tables *t = tables_get();
+	uint32_t low;
+	long i;
+
+	/* registers loaded from outside the sequences settle in one step */
+	while (n > 0 && gblfsr->lfsr > MASK_FULL) {
+		gblfsr_next_value(gblfsr);
+		n--;
+	}
+	if (t == NULL || (gblfsr->narrow && n < 8)) {
+		for (; n > 0; n--)
+			gblfsr_next_value(gblfsr);
+		return gblfsr->lfsr & 1;
+	}
+	if (n <= 0)
+		return gblfsr->lfsr & 1;
+
+	if (!gblfsr->narrow) {
+		/* 0 is a fixed point outside the cycle */
+		if (gblfsr->lfsr != 0)
+			gblfsr->lfsr = t->wide_state[(t->wide_pos[gblfsr->lfsr] + n % PERIOD_WIDE) % PERIOD_WIDE];
+		return gblfsr->lfsr & 1;
+	}
+
+	/* run the low bits up to 8 steps short, the rest refills the upper bits */
+	low = gblfsr->lfsr & MASK_NARROW;
+	if (low != 0)
+		low = t->narrow_state[(t->narrow_pos[low] + (n - 8) % PERIOD_NARROW) % PERIOD_NARROW];
+	gblfsr->lfsr = (gblfsr->lfsr & ~MASK_NARROW) | low;
+	for (i = 0; i < 8; i++)
+		gblfsr_next_value(gblfsr);
+	return gblfsr->lfsr & 1;
+}
+
+uint32_t gblfsr_peek_bits(const struct gblfsr* gblfsr, int n)
+{
+	const struct gblfsr_tables *t;
+	uint32_t low = gblfsr->lfsr & MASK_NARROW;
+	uint64_t w;
+
+	if (n <= 0)
+		return 0;
+	t = tables_get();
+	if (t == NULL || gblfsr->lfsr > MASK_FULL) {
+		struct gblfsr l = *gblfsr;
+		uint32_t x = 0;
+		while (n--)
+			x = (x << 1) | gblfsr_next_value(&l);
+		return x;
+	}
+
+	if (!gblfsr->narrow) {
+		if (gblfsr->lfsr == 0)
+			return 0;
+		w = read_bits(t->wide_bits, t->wide_pos[gblfsr->lfsr] + 1);
+	} else {
+		/* narrow outputs only depend on the low bits */
+		if (low == 0)
+			return 0;
+		w = read_bits(t->narrow_bits, t->narrow_pos[low] + 1);
+	}
+	return w >> (64 - n);
+}
+
+uint32_t gblfsr_next_bits(struct gblfsr* gblfsr, int n)
+{
+	uint32_t x = gblfsr_peek_bits(gblfsr, n);
+
+	gblfsr_advance(gblfsr, n);
+	return x;
+}
+
 test void test_lsfr()
 {
 	struct gblfsr state;
@@ -89,4 +251,57 @@ test void test_lsfr()
 	ASSERT_EQUAL("%08x", x, 0xcbc8b8b3);
 }
 TEST(test_lsfr);
+
+test void test_lsfr_bulk()
+{
+	struct gblfsr a, b;
+	uint32_t x;
+	long i, n;
+	int last;
+
+	/* the test_lsfr vectors via the tables */
+	gblfsr_reset(&a);
+	ASSERT_EQUAL("%08x", gblfsr_next_bits(&a, 32), 0xfffc0008);
+	gblfsr_reset(&a);
+	gblfsr_set_narrow(&a, true);
+	ASSERT_EQUAL("%08x", gblfsr_next_bits(&a, 32), 0xfc0830a3);
+	gblfsr_set_narrow(&a, false);
+	ASSERT_EQUAL("%08x", gblfsr_next_bits(&a, 32), 0xcbc8b8b3);
+
+	/* full periods */
+	gblfsr_reset(&a);
+	gblfsr_advance(&a, 32767);
+	ASSERT_EQUAL("%04x", a.lfsr, MASK_FULL);
+	gblfsr_set_narrow(&a, true);
+	gblfsr_advance(&a, 127);
+	ASSERT_EQUAL("%04x", a.lfsr & MASK_NARROW, MASK_NARROW);
+
+	/* random spans with mode switches mid-sequence, including 0 */
+	gblfsr_reset(&a);
+	gblfsr_reset(&b);
+	srand(1);
+	for (i = 0; i < 2000; i++) {
+		if (rand() % 4 == 0) {
+			bool narrow = rand() & 1;
+			gblfsr_set_narrow(&a, narrow);
+			gblfsr_set_narrow(&b, narrow);
+		}
+		if (i == 1000)
+			a.lfsr = b.lfsr = 0x8000 | (rand() & MASK_FULL);
+		if (i == 1500)
+			a.lfsr = b.lfsr = 0x80;
+		n = rand() % (rand() % 2 ? 40 : 70000);
+		if (n >= 1 && n <= 32) {
+			for (x = 0, last = 0; last < n; last++)
+				x = (x << 1) | gblfsr_next_value(&b);
+			ASSERT_EQUAL("%08x", gblfsr_next_bits(&a, n), x);
+		} else {
+			for (last = b.lfsr & 1, x = n; x > 0; x--)
+				last = gblfsr_next_value(&b);
+			ASSERT_EQUAL("%d", gblfsr_advance(&a, n), last);
+		}
+		ASSERT_EQUAL("%04x", a.lfsr, b.lfsr);
+	}
+}
+TEST(test_lsfr_bulk);
 TEST_EOF;
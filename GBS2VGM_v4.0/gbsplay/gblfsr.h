@@ -25,4 +25,13 @@ void gblfsr_trigger(struct gblfsr* gblfsr);
 void gblfsr_set_narrow(struct gblfsr* gblfsr, bool narrow);
 int gblfsr_next_value(struct gblfsr* gblfsr);
 
+/*
+ * Bulk operations, exact like calling gblfsr_next_value() repeatedly
+ * but O(1) via precomputed period tables.  Bits are returned oldest
+ * first from the MSB down, n <= 32.
+ */
+int gblfsr_advance(struct gblfsr* gblfsr, long n);	/* returns the last bit */
+uint32_t gblfsr_next_bits(struct gblfsr* gblfsr, int n);
+uint32_t gblfsr_peek_bits(const struct gblfsr* gblfsr, int n);
+
 #endif
@@ -0,0 +1,515 @@
+/*
+ * gbsplay is a Gameboy sound player
+ *
+ * Impulse accumulation and output kernels with SIMD variants
+ *
+ * 2026 (C) Licensed under GNU GPL v1 or, at your option, any later version.
+ */
+
+#include <string.h>
+
+#include "gbmix.h"
+#include "test.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__)
+#define GBMIX_SSE2 1
+#define GBMIX_AVX2 1
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define GBMIX_NEON 1
+#include <arm_neon.h>
+#endif
+
+/*
+ * Scalar reference.  Products are formed in long and wrapped into the
+ * 32 bit destination like gb_change_level() always did.
+ */
+
+static void add_impulse_scalar(int32_t *dst, const int32_t *imp, long taps, int32_t l_ofs, int32_t r_ofs)
+{
+	long i;
+
+	for (i=0; i<taps; i++) {
+		dst[i*2  ] += imp[i] * (long)l_ofs;
+		dst[i*2+1] += imp[i] * (long)r_ofs;
+	}
+}
+
+static void add_impulse_mono_scalar(int32_t *dst, const int32_t *imp, long taps, int32_t ofs)
+{
+	long i;
+
+	for (i=0; i<taps; i++) {
+		dst[i] += imp[i] * (long)ofs;
+	}
+}
+
+static void output_scalar(int16_t *dst, const int32_t *src, long samples, int32_t volume, int32_t minmax[4])
+{
+	long i;
+
+	for (i=0; i<samples; i++) {
+		int32_t l = src[i*2];
+		int32_t r = src[i*2+1];
+		dst[i*2  ] = (long)l * volume / GBMIX_UNITY;
+		dst[i*2+1] = (long)r * volume / GBMIX_UNITY;
+		if (l < minmax[0]) minmax[0] = l;
+		if (l > minmax[1]) minmax[1] = l;
+		if (r < minmax[2]) minmax[2] = r;
+		if (r > minmax[3]) minmax[3] = r;
+	}
+}
+
+static void output_ramp_scalar(int16_t *dst, const int32_t *src, long samples, const int32_t *gain, int32_t minmax[4])
+{
+	long i;
+
+	for (i=0; i<samples; i++) {
+		int32_t l = src[i*2];
+		int32_t r = src[i*2+1];
+		dst[i*2  ] = (long)l * gain[i] / GBMIX_UNITY;
+		dst[i*2+1] = (long)r * gain[i] / GBMIX_UNITY;
+		if (l < minmax[0]) minmax[0] = l;
+		if (l > minmax[1]) minmax[1] = l;
+		if (r < minmax[2]) minmax[2] = r;
+		if (r > minmax[3]) minmax[3] = r;
+	}
+}
+
+static const struct gbmix_kernels kernels_scalar = {
+	"scalar", add_impulse_scalar, add_impulse_mono_scalar, output_scalar, output_ramp_scalar
+};
+
+/*
+ * The output kernels only keep the low 32 bits of src * volume.  That
+ * is enough: the result is truncated to 16 bits, which are bits 16-31
+ * of the product once it is biased by 0xffff for rounding towards zero.
+ * A zero volume needs no special case, the bias alone shifts out to 0.
+ */
+
+#ifdef GBMIX_SSE2
+
+/* pmulld is SSE4.1, build it from two 32x32->64 multiplies */
+static inline __m128i mullo_sse2(__m128i a, __m128i b)
+{
+	__m128i even = _mm_mul_epu32(a, b);
+	__m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+	return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+	                          _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+static inline __m128i min_sse2(__m128i a, __m128i b)
+{
+	__m128i gt = _mm_cmpgt_epi32(a, b);
+	return _mm_or_si128(_mm_and_si128(gt, b), _mm_andnot_si128(gt, a));
+}
+
+static inline __m128i max_sse2(__m128i a, __m128i b)
+{
+	__m128i gt = _mm_cmpgt_epi32(a, b);
+	return _mm_or_si128(_mm_and_si128(gt, a), _mm_andnot_si128(gt, b));
+}
+
+static void add_impulse_sse2(int32_t *dst, const int32_t *imp, long taps, int32_t l_ofs, int32_t r_ofs)
+{
+	__m128i lr = _mm_set_epi32(r_ofs, l_ofs, r_ofs, l_ofs);
+	long i;
+
+	for (i=0; i<taps; i+=4) {
+		__m128i t = _mm_loadu_si128((const __m128i *)(imp + i));
+		__m128i *d = (__m128i *)(dst + i*2);
+		__m128i lo = _mm_unpacklo_epi32(t, t);
+		__m128i hi = _mm_unpackhi_epi32(t, t);
+		_mm_storeu_si128(d, _mm_add_epi32(_mm_loadu_si128(d), mullo_sse2(lo, lr)));
+		_mm_storeu_si128(d + 1, _mm_add_epi32(_mm_loadu_si128(d + 1), mullo_sse2(hi, lr)));
+	}
+}
+
+static void add_impulse_mono_sse2(int32_t *dst, const int32_t *imp, long taps, int32_t ofs)
+{
+	__m128i o = _mm_set1_epi32(ofs);
+	long i;
+
+	for (i=0; i<taps; i+=4) {
+		__m128i t = _mm_loadu_si128((const __m128i *)(imp + i));
+		__m128i *d = (__m128i *)(dst + i);
+		_mm_storeu_si128(d, _mm_add_epi32(_mm_loadu_si128(d), mullo_sse2(t, o)));
+	}
+}
+
+static void output_sse2(int16_t *dst, const int32_t *src, long samples, int32_t volume, int32_t minmax[4])
+{
+	__m128i vol = _mm_set1_epi32(volume);
+	__m128i bias = _mm_set1_epi32(volume > 0 ? 0xffff : 0);
+	__m128i mn = _mm_set_epi32(minmax[2], minmax[0], minmax[2], minmax[0]);
+	__m128i mx = _mm_set_epi32(minmax[3], minmax[1], minmax[3], minmax[1]);
+	int32_t lanes[8];
+	long i;
+
+	for (i=0; i+4<=samples; i+=4) {
+		__m128i x0 = _mm_loadu_si128((const __m128i *)(src + i*2));
+		__m128i x1 = _mm_loadu_si128((const __m128i *)(src + i*2 + 4));
+		__m128i q0 = _mm_add_epi32(mullo_sse2(x0, vol), _mm_and_si128(_mm_srai_epi32(x0, 31), bias));
+		__m128i q1 = _mm_add_epi32(mullo_sse2(x1, vol), _mm_and_si128(_mm_srai_epi32(x1, 31), bias));
+		q0 = _mm_srai_epi32(q0, 16);
+		q1 = _mm_srai_epi32(q1, 16);
+		_mm_storeu_si128((__m128i *)(dst + i*2), _mm_packs_epi32(q0, q1));
+		mn = min_sse2(mn, min_sse2(x0, x1));
+		mx = max_sse2(mx, max_sse2(x0, x1));
+	}
+	_mm_storeu_si128((__m128i *)lanes, mn);
+	_mm_storeu_si128((__m128i *)(lanes + 4), mx);
+	output_scalar(dst + i*2, src + i*2, samples - i, volume, minmax);
+	for (i=0; i<4; i+=2) {
+		if (lanes[i  ] < minmax[0]) minmax[0] = lanes[i  ];
+		if (lanes[i+4] > minmax[1]) minmax[1] = lanes[i+4];
+		if (lanes[i+1] < minmax[2]) minmax[2] = lanes[i+1];
+		if (lanes[i+5] > minmax[3]) minmax[3] = lanes[i+5];
+	}
+}
+
+static void output_ramp_sse2(int16_t *dst, const int32_t *src, long samples, const int32_t *gain, int32_t minmax[4])
+{
+	__m128i bias = _mm_set1_epi32(0xffff);
+	__m128i mn = _mm_set_epi32(minmax[2], minmax[0], minmax[2], minmax[0]);
+	__m128i mx = _mm_set_epi32(minmax[3], minmax[1], minmax[3], minmax[1]);
+	int32_t lanes[8];
+	long i;
+
+	for (i=0; i+4<=samples; i+=4) {
+		__m128i g = _mm_loadu_si128((const __m128i *)(gain + i));
+		__m128i x0 = _mm_loadu_si128((const __m128i *)(src + i*2));
+		__m128i x1 = _mm_loadu_si128((const __m128i *)(src + i*2 + 4));
+		__m128i q0 = _mm_add_epi32(mullo_sse2(x0, _mm_unpacklo_epi32(g, g)), _mm_and_si128(_mm_srai_epi32(x0, 31), bias));
+		__m128i q1 = _mm_add_epi32(mullo_sse2(x1, _mm_unpackhi_epi32(g, g)), _mm_and_si128(_mm_srai_epi32(x1, 31), bias));
+		q0 = _mm_srai_epi32(q0, 16);
+		q1 = _mm_srai_epi32(q1, 16);
+		_mm_storeu_si128((__m128i *)(dst + i*2), _mm_packs_epi32(q0, q1));
+		mn = min_sse2(mn, min_sse2(x0, x1));
+		mx = max_sse2(mx, max_sse2(x0, x1));
+	}
+	_mm_storeu_si128((__m128i *)lanes, mn);
+	_mm_storeu_si128((__m128i *)(lanes + 4), mx);
+	output_ramp_scalar(dst + i*2, src + i*2, samples - i, gain + i, minmax);
+	for (i=0; i<4; i+=2) {
+		if (lanes[i  ] < minmax[0]) minmax[0] = lanes[i  ];
+		if (lanes[i+4] > minmax[1]) minmax[1] = lanes[i+4];
+		if (lanes[i+1] < minmax[2]) minmax[2] = lanes[i+1];
+		if (lanes[i+5] > minmax[3]) minmax[3] = lanes[i+5];
+	}
+}
+
+static const struct gbmix_kernels kernels_sse2 = {
+	"sse2", add_impulse_sse2, add_impulse_mono_sse2, output_sse2, output_ramp_sse2
+};
+
+#endif /* GBMIX_SSE2 */
+
+#ifdef GBMIX_AVX2
+
+#define AVX2 __attribute__((target("avx2")))
+
+static AVX2 void add_impulse_avx2(int32_t *dst, const int32_t *imp, long taps, int32_t l_ofs, int32_t r_ofs)
+{
+	__m256i lr = _mm256_set_epi32(r_ofs, l_ofs, r_ofs, l_ofs, r_ofs, l_ofs, r_ofs, l_ofs);
+	__m256i idx_lo = _mm256_set_epi32(3, 3, 2, 2, 1, 1, 0, 0);
+	__m256i idx_hi = _mm256_set_epi32(7, 7, 6, 6, 5, 5, 4, 4);
+	long i;
+
+	for (i=0; i<taps; i+=8) {
+		__m256i t = _mm256_loadu_si256((const __m256i *)(imp + i));
+		__m256i *d = (__m256i *)(dst + i*2);
+		__m256i lo = _mm256_permutevar8x32_epi32(t, idx_lo);
+		__m256i hi = _mm256_permutevar8x32_epi32(t, idx_hi);
+		_mm256_storeu_si256(d, _mm256_add_epi32(_mm256_loadu_si256(d), _mm256_mullo_epi32(lo, lr)));
+		_mm256_storeu_si256(d + 1, _mm256_add_epi32(_mm256_loadu_si256(d + 1), _mm256_mullo_epi32(hi, lr)));
+	}
+}
+
+static AVX2 void add_impulse_mono_avx2(int32_t *dst, const int32_t *imp, long taps, int32_t ofs)
+{
+	__m256i o = _mm256_set1_epi32(ofs);
+	long i;
+
+	for (i=0; i<taps; i+=8) {
+		__m256i t = _mm256_loadu_si256((const __m256i *)(imp + i));
+		__m256i *d = (__m256i *)(dst + i);
+		_mm256_storeu_si256(d, _mm256_add_epi32(_mm256_loadu_si256(d), _mm256_mullo_epi32(t, o)));
+	}
+}
+
+static AVX2 void output_avx2(int16_t *dst, const int32_t *src, long samples, int32_t volume, int32_t minmax[4])
+{
+	__m256i vol = _mm256_set1_epi32(volume);
+	__m256i bias = _mm256_set1_epi32(volume > 0 ? 0xffff : 0);
+	__m256i mn = _mm256_set_epi32(minmax[2], minmax[0], minmax[2], minmax[0],
+	                              minmax[2], minmax[0], minmax[2], minmax[0]);
+	__m256i mx = _mm256_set_epi32(minmax[3], minmax[1], minmax[3], minmax[1],
+	                              minmax[3], minmax[1], minmax[3], minmax[1]);
+	int32_t lanes[16];
+	long i;
+
+	for (i=0; i+8<=samples; i+=8) {
+		__m256i x0 = _mm256_loadu_si256((const __m256i *)(src + i*2));
+		__m256i x1 = _mm256_loadu_si256((const __m256i *)(src + i*2 + 8));
+		__m256i q0 = _mm256_add_epi32(_mm256_mullo_epi32(x0, vol), _mm256_and_si256(_mm256_srai_epi32(x0, 31), bias));
+		__m256i q1 = _mm256_add_epi32(_mm256_mullo_epi32(x1, vol), _mm256_and_si256(_mm256_srai_epi32(x1, 31), bias));
+		__m256i packed = _mm256_packs_epi32(_mm256_srai_epi32(q0, 16), _mm256_srai_epi32(q1, 16));
+		/* packs works per 128 bit lane, restore sample order */
+		_mm256_storeu_si256((__m256i *)(dst + i*2), _mm256_permute4x64_epi64(packed, _MM_SHUFFLE(3, 1, 2, 0)));
+		mn = _mm256_min_epi32(mn, _mm256_min_epi32(x0, x1));
+		mx = _mm256_max_epi32(mx, _mm256_max_epi32(x0, x1));
+	}
+	_mm256_storeu_si256((__m256i *)lanes, mn);
+	_mm256_storeu_si256((__m256i *)(lanes + 8), mx);
+	output_scalar(dst + i*2, src + i*2, samples - i, volume, minmax);
+	for (i=0; i<8; i+=2) {
+		if (lanes[i  ] < minmax[0]) minmax[0] = lanes[i  ];
+		if (lanes[i+8] > minmax[1]) minmax[1] = lanes[i+8];
+		if (lanes[i+1] < minmax[2]) minmax[2] = lanes[i+1];
+		if (lanes[i+9] > minmax[3]) minmax[3] = lanes[i+9];
+	}
+}
+
+static AVX2 void output_ramp_avx2(int16_t *dst, const int32_t *src, long samples, const int32_t *gain, int32_t minmax[4])
+{
+	__m256i bias = _mm256_set1_epi32(0xffff);
+	__m256i lo = _mm256_set_epi32(3, 3, 2, 2, 1, 1, 0, 0);
+	__m256i hi = _mm256_set_epi32(7, 7, 6, 6, 5, 5, 4, 4);
+	__m256i mn = _mm256_set_epi32(minmax[2], minmax[0], minmax[2], minmax[0],
+	                              minmax[2], minmax[0], minmax[2], minmax[0]);
+	__m256i mx = _mm256_set_epi32(minmax[3], minmax[1], minmax[3], minmax[1],
+	                              minmax[3], minmax[1], minmax[3], minmax[1]);
+	int32_t lanes[16];
+	long i;
+
+	for (i=0; i+8<=samples; i+=8) {
+		__m256i g = _mm256_loadu_si256((const __m256i *)(gain + i));
+		__m256i x0 = _mm256_loadu_si256((const __m256i *)(src + i*2));
+		__m256i x1 = _mm256_loadu_si256((const __m256i *)(src + i*2 + 8));
+		__m256i q0 = _mm256_add_epi32(_mm256_mullo_epi32(x0, _mm256_permutevar8x32_epi32(g, lo)),
+		                              _mm256_and_si256(_mm256_srai_epi32(x0, 31), bias));
+		__m256i q1 = _mm256_add_epi32(_mm256_mullo_epi32(x1, _mm256_permutevar8x32_epi32(g, hi)),
+		                              _mm256_and_si256(_mm256_srai_epi32(x1, 31), bias));
+		__m256i packed = _mm256_packs_epi32(_mm256_srai_epi32(q0, 16), _mm256_srai_epi32(q1, 16));
+		_mm256_storeu_si256((__m256i *)(dst + i*2), _mm256_permute4x64_epi64(packed, _MM_SHUFFLE(3, 1, 2, 0)));
+		mn = _mm256_min_epi32(mn, _mm256_min_epi32(x0, x1));
+		mx = _mm256_max_epi32(mx, _mm256_max_epi32(x0, x1));
+	}
+	_mm256_storeu_si256((__m256i *)lanes, mn);
+	_mm256_storeu_si256((__m256i *)(lanes + 8), mx);
+	output_ramp_scalar(dst + i*2, src + i*2, samples - i, gain + i, minmax);
+	for (i=0; i<8; i+=2) {
+		if (lanes[i  ] < minmax[0]) minmax[0] = lanes[i  ];
+		if (lanes[i+8] > minmax[1]) minmax[1] = lanes[i+8];
+		if (lanes[i+1] < minmax[2]) minmax[2] = lanes[i+1];
+		if (lanes[i+9] > minmax[3]) minmax[3] = lanes[i+9];
+	}
+}
+
+static const struct gbmix_kernels kernels_avx2 = {
+	"avx2", add_impulse_avx2, add_impulse_mono_avx2, output_avx2, output_ramp_avx2
+};
+
+#endif /* GBMIX_AVX2 */
+
+#ifdef GBMIX_NEON
+
+static void add_impulse_neon(int32_t *dst, const int32_t *imp, long taps, int32_t l_ofs, int32_t r_ofs)
+{
+	const int32_t ofs[4] = { l_ofs, r_ofs, l_ofs, r_ofs };
+	int32x4_t lr = vld1q_s32(ofs);
+	long i;
+
+	for (i=0; i<taps; i+=4) {
+		int32x4_t t = vld1q_s32(imp + i);
+		int32x4x2_t z = vzipq_s32(t, t);
+		int32_t *d = dst + i*2;
+		vst1q_s32(d, vmlaq_s32(vld1q_s32(d), z.val[0], lr));
+		vst1q_s32(d + 4, vmlaq_s32(vld1q_s32(d + 4), z.val[1], lr));
+	}
+}
+
+static void add_impulse_mono_neon(int32_t *dst, const int32_t *imp, long taps, int32_t ofs)
+{
+	int32x4_t o = vdupq_n_s32(ofs);
+	long i;
+
+	for (i=0; i<taps; i+=4) {
+		vst1q_s32(dst + i, vmlaq_s32(vld1q_s32(dst + i), vld1q_s32(imp + i), o));
+	}
+}
+
+static void output_neon(int16_t *dst, const int32_t *src, long samples, int32_t volume, int32_t minmax[4])
+{
+	const int32_t mn_init[4] = { minmax[0], minmax[2], minmax[0], minmax[2] };
+	const int32_t mx_init[4] = { minmax[1], minmax[3], minmax[1], minmax[3] };
+	int32x4_t vol = vdupq_n_s32(volume);
+	int32x4_t bias = vdupq_n_s32(volume > 0 ? 0xffff : 0);
+	int32x4_t mn = vld1q_s32(mn_init);
+	int32x4_t mx = vld1q_s32(mx_init);
+	int32_t lanes[8];
+	long i;
+
+	for (i=0; i+4<=samples; i+=4) {
+		int32x4_t x0 = vld1q_s32(src + i*2);
+		int32x4_t x1 = vld1q_s32(src + i*2 + 4);
+		int32x4_t q0 = vaddq_s32(vmulq_s32(x0, vol), vandq_s32(vshrq_n_s32(x0, 31), bias));
+		int32x4_t q1 = vaddq_s32(vmulq_s32(x1, vol), vandq_s32(vshrq_n_s32(x1, 31), bias));
+		vst1q_s16(dst + i*2, vcombine_s16(vshrn_n_s32(q0, 16), vshrn_n_s32(q1, 16)));
+		mn = vminq_s32(mn, vminq_s32(x0, x1));
+		mx = vmaxq_s32(mx, vmaxq_s32(x0, x1));
+	}
+	vst1q_s32(lanes, mn);
+	vst1q_s32(lanes + 4, mx);
+	output_scalar(dst + i*2, src + i*2, samples - i, volume, minmax);
+	for (i=0; i<4; i+=2) {
+		if (lanes[i  ] < minmax[0]) minmax[0] = lanes[i  ];
+		if (lanes[i+4] > minmax[1]) minmax[1] = lanes[i+4];
+		if (lanes[i+1] < minmax[2]) minmax[2] = lanes[i+1];
+		if (lanes[i+5] > minmax[3]) minmax[3] = lanes[i+5];
+	}
+}
+
+static void output_ramp_neon(int16_t *dst, const int32_t *src, long samples, const int32_t *gain, int32_t minmax[4])
+{
+	const int32_t mn_init[4] = { minmax[0], minmax[2], minmax[0], minmax[2] };
+	const int32_t mx_init[4] = { minmax[1], minmax[3], minmax[1], minmax[3] };
+	int32x4_t bias = vdupq_n_s32(0xffff);
+	int32x4_t mn = vld1q_s32(mn_init);
+	int32x4_t mx = vld1q_s32(mx_init);
+	int32_t lanes[8];
+	long i;
+
+	for (i=0; i+4<=samples; i+=4) {
+		int32x4_t g = vld1q_s32(gain + i);
+		int32x4x2_t gg = vzipq_s32(g, g);
+		int32x4_t x0 = vld1q_s32(src + i*2);
+		int32x4_t x1 = vld1q_s32(src + i*2 + 4);
+		int32x4_t q0 = vaddq_s32(vmulq_s32(x0, gg.val[0]), vandq_s32(vshrq_n_s32(x0, 31), bias));
+		int32x4_t q1 = vaddq_s32(vmulq_s32(x1, gg.val[1]), vandq_s32(vshrq_n_s32(x1, 31), bias));
+		vst1q_s16(dst + i*2, vcombine_s16(vshrn_n_s32(q0, 16), vshrn_n_s32(q1, 16)));
+		mn = vminq_s32(mn, vminq_s32(x0, x1));
+		mx = vmaxq_s32(mx, vmaxq_s32(x0, x1));
+	}
+	vst1q_s32(lanes, mn);
+	vst1q_s32(lanes + 4, mx);
+	output_ramp_scalar(dst + i*2, src + i*2, samples - i, gain + i, minmax);
+	for (i=0; i<4; i+=2) {
+		if (lanes[i  ] < minmax[0]) minmax[0] = lanes[i  ];
+		if (lanes[i+4] > minmax[1]) minmax[1] = lanes[i+4];
+		if (lanes[i+1] < minmax[2]) minmax[2] = lanes[i+1];
+		if (lanes[i+5] > minmax[3]) minmax[3] = lanes[i+5];
+	}
+}
+
+static const struct gbmix_kernels kernels_neon = {
+	"neon", add_impulse_neon, add_impulse_mono_neon, output_neon, output_ramp_neon
+};
+
+#endif /* GBMIX_NEON */
+
+/* in order of preference */
+static const struct gbmix_kernels *const kernels[] = {
+#ifdef GBMIX_AVX2
+	&kernels_avx2,
+#endif
+#ifdef GBMIX_SSE2
+	&kernels_sse2,
+#endif
+#ifdef GBMIX_NEON
+	&kernels_neon,
+#endif
+	&kernels_scalar,
+};
+
+static long kernels_supported(const struct gbmix_kernels *k)
+{
+#ifdef GBMIX_AVX2
+	if (k == &kernels_avx2) {
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("avx2");
+	}
+#endif
+	return 1;
+}
+
+const struct gbmix_kernels *gbmix_find(const char *name)
+{
+	long i;
+
+	for (i=0; i<(long)(sizeof(kernels)/sizeof(*kernels)); i++) {
+		if (strcmp(kernels[i]->name, name) == 0)
+			return kernels_supported(kernels[i]) ? kernels[i] : NULL;
+	}
+	return NULL;
+}
+
+const struct gbmix_kernels *gbmix_get(void)
+{
+	static const struct gbmix_kernels *best;
+	const struct gbmix_kernels *k = __atomic_load_n(&best, __ATOMIC_RELAXED);
+	long i;
+
+	if (k)
+		return k;
+	/* racing callers all pick the same entry */
+	for (i=0; !kernels_supported(kernels[i]); i++);
+	__atomic_store_n(&best, kernels[i], __ATOMIC_RELAXED);
+	return kernels[i];
+}
+
+test void test_gbmix_kernels()
+{
+	static const char *const names[] = { "sse2", "avx2", "neon" };
+	const struct gbmix_kernels *ref = gbmix_find("scalar");
+	uint32_t seed = 1;
+	long n, i, j;
+
+#define RND() (seed = seed * 1103515245 + 12345, (int32_t)seed)
+
+	ASSERT_EQUAL("%p", (void *)ref, (void *)&kernels_scalar);
+	for (n=0; n<(long)(sizeof(names)/sizeof(*names)); n++) {
+		const struct gbmix_kernels *k = gbmix_find(names[n]);
+		if (!k)
+			continue;
+		for (j=0; j<64; j++) {
+			int32_t imp[32], a[64], b[64];
+			int16_t out_a[2*37], out_b[2*37];
+			int32_t mm_a[4] = { 0, 0, 0, 0 }, mm_b[4] = { 0, 0, 0, 0 };
+			int32_t src[2*37], gain[37];
+			int32_t l_ofs = RND() % 121, r_ofs = RND() % 121;
+			int32_t volume = j == 0 ? GBMIX_UNITY : j == 1 ? 0 : (RND() & 0x3ffff);
+			long samples = j % 38;
+
+			for (i=0; i<32; i++) imp[i] = RND() >> (j & 7);
+			for (i=0; i<64; i++) a[i] = b[i] = RND();
+			for (i=0; i<2*37; i++) src[i] = RND() >> (j & 15);
+			for (i=0; i<37; i++) gain[i] = j & 1 ? volume : RND() & 0x1ffff;
+
+			ref->add_impulse(a, imp, 32, l_ofs, r_ofs);
+			k->add_impulse(b, imp, 32, l_ofs, r_ofs);
+			for (i=0; i<64; i++) ASSERT_EQUAL("%d", a[i], b[i]);
+			ref->add_impulse_mono(a, imp, 32, l_ofs);
+			k->add_impulse_mono(b, imp, 32, l_ofs);
+			for (i=0; i<64; i++) ASSERT_EQUAL("%d", a[i], b[i]);
+			ref->output(out_a, src, samples, volume, mm_a);
+			k->output(out_b, src, samples, volume, mm_b);
+			for (i=0; i<samples*2; i++) ASSERT_EQUAL("%d", out_a[i], out_b[i]);
+			for (i=0; i<4; i++) ASSERT_EQUAL("%d", mm_a[i], mm_b[i]);
+			k->output_ramp(out_b, src, samples, gain, mm_b);
+			if (j & 1) {
+				/* a flat ramp is the same as output */
+				for (i=0; i<samples*2; i++) ASSERT_EQUAL("%d", out_a[i], out_b[i]);
+			}
+			ref->output_ramp(out_a, src, samples, gain, mm_a);
+			for (i=0; i<samples*2; i++) ASSERT_EQUAL("%d", out_a[i], out_b[i]);
+			for (i=0; i<4; i++) ASSERT_EQUAL("%d", mm_a[i], mm_b[i]);
+		}
+	}
+#undef RND
+}
+TEST(test_gbmix_kernels);
+TEST_EOF;
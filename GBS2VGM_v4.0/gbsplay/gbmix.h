@@ -0,0 +1,44 @@
+/*
+ * gbsplay is a Gameboy sound player
+ *
+ * Impulse accumulation and output kernels with SIMD variants
+ *
+ * 2026 (C) Licensed under GNU GPL v1 or, at your option, any later version.
+ */
+
+#ifndef _GBMIX_H_
+#define _GBMIX_H_
+
+#include <inttypes.h>
+
+#include "common.h"
+
+/* output volume that passes samples through unchanged */
+#define GBMIX_UNITY 0x10000
+
+/*
+ * All variants produce bit-identical results to the scalar one, with
+ * 32 bit wrap-around arithmetic.  taps must be a multiple of 8.
+ */
+struct gbmix_kernels {
+	const char *name;
+	/* dst[2*i] += imp[i] * l_ofs, dst[2*i+1] += imp[i] * r_ofs */
+	void (*add_impulse)(int32_t *dst, const int32_t *imp, long taps, int32_t l_ofs, int32_t r_ofs);
+	/* dst[i] += imp[i] * ofs */
+	void (*add_impulse_mono)(int32_t *dst, const int32_t *imp, long taps, int32_t ofs);
+	/*
+	 * dst[i] = src[i] * volume / GBMIX_UNITY for samples stereo pairs
+	 * (truncated to 16 bits), volume >= 0.  Lowers/raises minmax[]
+	 * (lmin, lmax, rmin, rmax) to the extremes of src.
+	 */
+	void (*output)(int16_t *dst, const int32_t *src, long samples, int32_t volume, int32_t minmax[4]);
+	/* like output, with a volume gain[i] >= 0 per stereo pair */
+	void (*output_ramp)(int16_t *dst, const int32_t *src, long samples, const int32_t *gain, int32_t minmax[4]);
+};
+
+/* fastest variant this CPU supports */
+const struct gbmix_kernels *gbmix_get(void);
+/* named variant ("scalar", "sse2", "avx2", "neon"), NULL if unavailable */
+const struct gbmix_kernels *gbmix_find(const char *name);
+
+#endif
@@ -24,11 +24,17 @@
 #include "libgbs.h"
 #include "gbs_internal.h"
 #include "crc32.h"
+#include "savestate.h"
 
 #ifdef USE_ZLIB
 #include <zlib.h>
 #endif
 
+#ifndef _WIN32
+#define USE_MMAP 1
+#include <sys/mman.h>
+#endif
+
 /* Max GB rom size is 4MiB (mapper with 256 banks) */
 #define GB_MAX_ROM_SIZE (256 * 0x4000)
 
@@ -58,9 +64,16 @@ struct gbs_subsong_info {
 	char *title;
 };
 
-struct gbs {
+/*
+ * Everything parsed from a file.  Read-only once its loader returns,
+ * so any number of gbs instances, also on different threads, can
+ * share one image, see gbs_open_image().
+ */
+struct gbs_image {
+	long refs;
 	char *buf;
 	int buf_owned;
+	size_t buf_mapped;  /* length of the mmap()ed file, 0 if not mapped */
 	uint8_t version;
 	uint8_t songs;
 	uint8_t defaultsong;
@@ -79,19 +92,30 @@ struct gbs {
 	size_t filesize;
 	uint32_t crc;
 	uint32_t crcnow;
-	struct gbs_subsong_info *subsong_info;
-	char *strings;
+	struct gbs_subsong_info *subsong_info;  /* copied by every instance */
+	char *strings;  /* GD3 tags */
 	char v1strings[33*3];
 	uint8_t *rom;
 	unsigned long romsize;
+	const uint8_t *bootrom;
+
+	enum filetype filetype;
+	uint8_t mapper_args[3];  /* see image_mapper() */
+};
+
+struct gbs {
+	struct gbs_image *image;
+	struct gbs_subsong_info *subsong_info;
 
 	long long ticks;
+	cycles_t run_over;  /* cycles the last run went past its end, see gbs_run_cycles() */
 	int16_t lmin, lmax, lvol, rmin, rmax, rvol;
 	long subsong_timeout, silence_timeout, fadeout, gap;
-	long long silence_start;
 	int subsong;
 
 	struct gbs_output_buffer *buffer;
+	struct gbs_output_buffer *stems[4];
+	struct gbs_output_buffer stem_mix;  /* owned scratch output, see gbs_configure_stem_output() and gbs_clone() */
 
 	gbs_io_cb io_cb;
 	void *io_cb_priv;
@@ -109,17 +133,16 @@ struct gbs {
 	struct gbs_channel_status step_cb_channels[4];
 	struct gbs_status status; // note: this contains a separate gbs_channel_status[] to not interfere with the step callback
 	struct gbhw_buffer gbhw_buf;
+	struct gbhw_buffer gbhw_stembuf[4];
 	struct gbhw gbhw;
 	struct mapper *mapper;
-
-	enum filetype filetype;
 };
 
 const struct gbs_metadata *gbs_get_metadata(struct gbs* const gbs)
 {
-	gbs->metadata.title = gbs->title;
-	gbs->metadata.author = gbs->author;
-	gbs->metadata.copyright = gbs->copyright;
+	gbs->metadata.title = gbs->image->title;
+	gbs->metadata.author = gbs->image->author;
+	gbs->metadata.copyright = gbs->image->copyright;
 	return &gbs->metadata;
 }
 
@@ -130,7 +153,7 @@ void gbs_configure(struct gbs* const gbs, long subsong, long subsong_timeout, lo
 	gbs->subsong = subsong;
 	update_status_on_subsong_change(gbs);
 	if (silence_timeout) {
-		if (gbs->filetype == FILETYPE_GB && silence_timeout < 10) {
+		if (gbs->image->filetype == FILETYPE_GB && silence_timeout < 10) {
 			/* GB ROMs usually have a fairly long silence in the beginning,
 			   enforce a minimum timeout for convenience. */
 			silence_timeout = 10;
@@ -229,18 +252,23 @@ static int gbs_midi_note(const struct gbs* const gbs, long div_tc, int ch)
 }
 
 void gbs_configure_channels(struct gbs* const gbs, long mute_0, long mute_1, long mute_2, long mute_3) {
-	gbs->gbhw.ch[0].mute = mute_0;
-	gbs->gbhw.ch[1].mute = mute_1;
-	gbs->gbhw.ch[2].mute = mute_2;
-	gbs->gbhw.ch[3].mute = mute_3;
+	gbs->gbhw.ch[0].mute = mute_0 != 0;
+	gbs->gbhw.ch[1].mute = mute_1 != 0;
+	gbs->gbhw.ch[2].mute = mute_2 != 0;
+	gbs->gbhw.ch[3].mute = mute_3 != 0;
 }
 
 void gbs_configure_output(struct gbs* const gbs, struct gbs_output_buffer *gbs_buf, long rate) {
 	struct gbhw_buffer *gbhw_buf = &gbs->gbhw_buf;
 
-	gbhw_set_rate(&gbs->gbhw, rate);
-
 	gbs->buffer = gbs_buf;
+	if (gbs_buf == NULL) {
+		/* register capture only */
+		gbhw_set_buffer(&gbs->gbhw, NULL);
+		return;
+	}
+
+	gbhw_set_rate(&gbs->gbhw, rate);
 
 	gbhw_buf->data = gbs_buf->data;
 	gbhw_buf->bytes = gbs_buf->bytes;
@@ -249,27 +277,72 @@ void gbs_configure_output(struct gbs* const gbs, struct gbs_output_buffer *gbs_b
 	gbhw_set_buffer(&gbs->gbhw, gbhw_buf);
 }
 
+long gbs_configure_stem_output(struct gbs* const gbs, struct gbs_output_buffer *bufs[4], long rate) {
+	struct gbhw_buffer *gbhw_bufs[4];
+	long i;
+
+	if (bufs == NULL) {
+		memset(gbs->stems, 0, sizeof(gbs->stems));
+		return gbhw_set_stems(&gbs->gbhw, NULL);
+	}
+	for (i = 0; i < 4; i++) {
+		if (bufs[i]->bytes != bufs[0]->bytes)
+			return 0;
+	}
+
+	if (gbs->buffer == NULL || gbs->buffer == &gbs->stem_mix) {
+		/* the mix drives the flushes, render it to scratch */
+		int16_t *data = realloc(gbs->stem_mix.data, bufs[0]->bytes);
+		if (data == NULL) {
+			fprintf(stderr, "%s", _("Memory allocation failed!\n"));
+			return 0;
+		}
+		gbs->stem_mix.data = data;
+		gbs->stem_mix.bytes = bufs[0]->bytes;
+		gbs->stem_mix.pos = 0;
+		gbs_configure_output(gbs, &gbs->stem_mix, rate);
+	} else if (gbs->buffer->bytes != bufs[0]->bytes) {
+		return 0;
+	} else {
+		gbs_configure_output(gbs, gbs->buffer, rate);
+	}
+
+	for (i = 0; i < 4; i++) {
+		gbs->stems[i] = bufs[i];
+		gbs->gbhw_stembuf[i].data = bufs[i]->data;
+		gbs->gbhw_stembuf[i].bytes = bufs[i]->bytes;
+		gbs->gbhw_stembuf[i].pos = bufs[i]->pos;
+		gbhw_bufs[i] = &gbs->gbhw_stembuf[i];
+	}
+	if (!gbhw_set_stems(&gbs->gbhw, gbhw_bufs)) {
+		memset(gbs->stems, 0, sizeof(gbs->stems));
+		return 0;
+	}
+	return 1;
+}
+
 long gbs_init(struct gbs* const gbs, long subsong)
 {
 	struct gbhw *gbhw = &gbs->gbhw;
 	struct gbcpu *gbcpu = &gbhw->gbcpu;
+	const struct gbs_image *img = gbs->image;
 
 	gbhw_init(gbhw);
 
-	if (subsong == -1) subsong = gbs->defaultsong - 1;
-	if (subsong >= gbs->songs) {
-		fprintf(stderr, _("Subsong number out of range (min=0, max=%d).\n"), (int)gbs->songs - 1);
+	if (subsong == -1) subsong = img->defaultsong - 1;
+	if (subsong >= img->songs) {
+		fprintf(stderr, _("Subsong number out of range (min=0, max=%d).\n"), (int)img->songs - 1);
 		return 0;
 	}
 
-	if (gbs->defaultbank != 1) {
-		gbcpu_mem_put(gbcpu, 0x2000, gbs->defaultbank);
+	if (img->defaultbank != 1) {
+		gbcpu_mem_put(gbcpu, 0x2000, img->defaultbank);
 	}
-	gbhw_io_put(gbhw, 0xff06, gbs->tma);
-	gbhw_io_put(gbhw, 0xff07, gbs->tac);
+	gbhw_io_put(gbhw, 0xff06, img->tma);
+	gbhw_io_put(gbhw, 0xff07, img->tac);
 	gbhw_io_put(gbhw, 0xffff, 0x05);
 
-	REGS16_W(gbcpu->regs, SP, gbs->stack);
+	REGS16_W(gbcpu->regs, SP, img->stack);
 
 	/* put halt breakpoint PC on stack */
 	gbcpu->halt_at_pc = 0xffff;
@@ -281,10 +354,11 @@ long gbs_init(struct gbs* const gbs, long subsong)
 	REGS16_W(gbcpu->regs, HL, 0x0000);
 	gbcpu_mem_put(gbcpu, 0xff80, 0x00);
 
-	REGS16_W(gbcpu->regs, GBS_PC, gbs->init);
+	REGS16_W(gbcpu->regs, GBS_PC, img->init);
 	gbcpu->regs.rn.a = subsong;
 
 	gbs->ticks = 0;
+	gbs->run_over = 0;
 	gbs->subsong = subsong;
 
 	update_status_on_subsong_change(gbs);
@@ -342,6 +416,16 @@ void gbs_set_io_callback(struct gbs* const gbs, gbs_io_cb fn, void *priv)
 	gbhw_set_io_callback(&gbs->gbhw, wrap_io_callback, gbs);
 }
 
+long gbs_set_event_log(struct gbs* const gbs, long capacity)
+{
+	return gbhw_set_event_log(&gbs->gbhw, capacity);
+}
+
+long gbs_read_events(struct gbs* const gbs, struct gbs_event *out, long max)
+{
+	return gbhw_read_events(&gbs->gbhw, out, max);
+}
+
 static void wrap_step_callback(const cycles_t cycles, const struct gbhw_channel ch[], void *priv)
 {
 	struct gbs* gbs = priv;
@@ -359,7 +443,11 @@ void gbs_set_step_callback(struct gbs* const gbs, gbs_step_cb fn, void *priv)
 static void wrap_sound_callback(void *priv)
 {
 	struct gbs* gbs = priv;
+	long i;
+
 	gbs->buffer->pos = gbs->gbhw_buf.pos;
+	for (i = 0; gbs->gbhw.stembuf[0] && i < 4; i++)
+		gbs->stems[i]->pos = gbs->gbhw_stembuf[i].pos;
 	gbs->sound_cb(gbs, gbs->buffer, gbs->sound_cb_priv);
 }
 
@@ -373,45 +461,87 @@ void gbs_set_sound_callback(struct gbs* const gbs, gbs_sound_cb fn, void *priv)
 long gbs_set_filter(struct gbs* const gbs, enum gbs_filter_type type) {
 	return gbhw_set_filter(&gbs->gbhw, type);
 }
+
+long gbs_set_quality(struct gbs* const gbs, enum gbs_quality quality) {
+	return gbhw_set_quality(&gbs->gbhw, quality);
+}
+
+long gbs_set_voices(struct gbs* const gbs, long enable) {
+	return gbhw_set_voices(&gbs->gbhw, enable);
+}
+
+const int8_t *gbs_get_voice(const struct gbs* const gbs, long channel) {
+	if (channel < 0 || channel > 3)
+		return NULL;
+	return gbs->gbhw.voice_out[channel];
+}
+
+void gbs_set_idle_skip(struct gbs* const gbs, enum gbs_idle_skip mode) {
+	gbhw_set_idle_skip(&gbs->gbhw, mode);
+}
+long long gbs_get_silence_start(const struct gbs* const gbs) {
+	const struct gbhw *gbhw = &gbs->gbhw;
+
+	if (gbhw->silent_since == GBHW_NEVER)
+		return -1;
+	return gbs->ticks - (long long)(gbhw->sum_cycles - gbhw->silent_since);
+}
+
 static long gbs_nextsubsong(struct gbs* const gbs)
 {
 	if (gbs->nextsubsong_cb != NULL) {
 		return gbs->nextsubsong_cb(gbs, gbs->nextsubsong_cb_priv);
 	} else {
 		gbs->subsong++;
-		if (gbs->subsong >= gbs->songs)
+		if (gbs->subsong >= gbs->image->songs)
 			return false;
 		gbs_init(gbs, gbs->subsong);
 	}
 	return true;
 }
 
-long gbs_step(struct gbs* const gbs, long time_to_work)
+/*
+ * The fade ends with the subsong.  gbhw ramps the volume per sample,
+ * so it must know before it renders the next step.
+ */
+static void gbs_update_fade(struct gbs* const gbs)
+{
+	struct gbhw *gbhw = &gbs->gbhw;
+
+	if (gbs->subsong_timeout && gbs->fadeout && gbs->status.loop_mode != LOOP_SINGLE) {
+		long long start = (long long)gbhw->sum_cycles - gbs->ticks;
+		gbhw_set_fade(gbhw, start + (long long)(gbs->subsong_timeout - gbs->fadeout - gbs->gap) * GBHW_CLOCK,
+		              start + (long long)gbs->subsong_timeout * GBHW_CLOCK);
+	} else gbhw_set_fade(gbhw, 0, 0);
+}
+
+/* run to sum_cycles end, then handle the silence and subsong timeouts */
+static long gbs_run_to(struct gbs* const gbs, cycles_t end)
 {
 	struct gbhw *gbhw = &gbs->gbhw;
+	cycles_t cycles;
 
-	cycles_t cycles = gbhw_step(gbhw, time_to_work);
-	double time;//yoyofr
+	gbs_update_fade(gbs);
 
-	if (cycles < 0) {
+	cycles = gbhw_run(gbhw, end);
+
+	if (cycles == GBHW_NEVER) {
 		return false;
 	}
 
 	gbs->ticks += cycles;
+	gbs->run_over = gbhw->sum_cycles > end ? gbhw->sum_cycles - end : 0;
 
 	gbhw_calc_minmax(gbhw, &gbs->lmin, &gbs->lmax, &gbs->rmin, &gbs->rmax);
 	gbs->lvol = -gbs->lmin > gbs->lmax ? -gbs->lmin : gbs->lmax;
 	gbs->rvol = -gbs->rmin > gbs->rmax ? -gbs->rmin : gbs->rmax;
 
-	time = (double)gbs->ticks / GBHW_CLOCK;
+	/* silence is detected on the channel state, see gbs_get_silence_start() */
 	if (gbs->silence_timeout) {
-		if (gbs->lmin == gbs->lmax && gbs->rmin == gbs->rmax) {
-			if (gbs->silence_start == 0)
-				gbs->silence_start = gbs->ticks;
-		} else gbs->silence_start = 0;
-        
-        if (gbs->silence_start &&
-            (gbs->ticks - gbs->silence_start) / GBHW_CLOCK >= gbs->silence_timeout) {
+		long long silence_start = gbs_get_silence_start(gbs);
+
+        if (silence_start >= 0 &&
+            (gbs->ticks - silence_start) / GBHW_CLOCK >= gbs->silence_timeout) {
             if (gbs->subsong_info[gbs->subsong].len == 0) {
                 gbs->subsong_info[gbs->subsong].len = gbs->ticks * GBS_LEN_DIV / GBHW_CLOCK;
             }
@@ -419,33 +549,133 @@ long gbs_step(struct gbs* const gbs, long time_to_work)
         }
 	}
 
-    
-	
-
-    //YOYOFR, some changes / fadeout
-	if (gbs->subsong_timeout && gbs->status.loop_mode != LOOP_SINGLE) {
-        //printf("time %f/%d  fade %d\n",time,gbs->subsong_timeout,gbs->fadeout);
-        if (gbs->fadeout && (time >= (gbs->subsong_timeout - gbs->fadeout - gbs->gap))) {
-            //printf("will stop soon: %f %d\n",time,gbs->subsong_timeout);
-            //gbhw_master_fade(gbhw, 128*4/gbs->fadeout, 0);
-            double volume=(1.0f-(time-(double)(gbs->subsong_timeout - gbs->fadeout - gbs->gap) )/(double)(gbs->fadeout+ gbs->gap));
-            if (volume<0) volume=0;
-            volume=volume*volume; //sounds better, logarithmic scale
-            gbhw->master_volume=(256*256)*volume;
-            if (gbhw->master_volume<0) gbhw->master_volume=0;
-        }
-        if (time >= (gbs->subsong_timeout - gbs->gap)) {
-            //gbhw_master_fade(gbhw, 128*16, 0);
-        }
-		if (time >= gbs->subsong_timeout)
-			return gbs_nextsubsong(gbs);
-	}
+	if (gbs->subsong_timeout && gbs->status.loop_mode != LOOP_SINGLE &&
+	    gbs->ticks >= (long long)gbs->subsong_timeout * GBHW_CLOCK)
+		return gbs_nextsubsong(gbs);
 
 	return true;
 }
 
+long gbs_step(struct gbs* const gbs, long time_to_work)
+{
+	return gbs_run_to(gbs, gbs->gbhw.sum_cycles + time_to_work * (GBHW_CLOCK/1000));
+}
+
+long gbs_run_cycles(struct gbs* const gbs, cycles_t cycles)
+{
+	/* the last run already covered run_over cycles of this one */
+	if (cycles <= gbs->run_over) {
+		gbs->run_over -= cycles;
+		return true;
+	}
+	return gbs_run_to(gbs, gbs->gbhw.sum_cycles + (cycles - gbs->run_over));
+}
+
+size_t gbs_render(struct gbs* const gbs, int16_t *out, size_t frames)
+{
+	struct gbhw *gbhw = &gbs->gbhw;
+	size_t done = 0;
+
+	if (gbs->buffer == NULL)
+		return 0;
+
+	/* one flush per chunk, straight into out */
+	while (done < frames) {
+		long n = gbs->gbhw_buf.samples;
+		cycles_t end;
+		long cont;
+
+		if (frames - done < (size_t)n)
+			n = frames - done;
+		gbs_update_fade(gbs);
+		end = gbhw_render(gbhw, out + 2*done, n);
+		cont = gbs_run_to(gbs, end);
+		/* playback can end after the flush, or before it on a lockup */
+		if (gbhw->render_out == NULL)
+			done += n;
+		if (!cont)
+			break;
+	}
+	gbhw_render(gbhw, NULL, 0);
+	return done;
+}
+
+/* the header holds magic, version, CRC32 of the file and the size */
+#define STATE_SIZE_OFS 10
+
+long gbs_save_state(struct gbs* const gbs, void *buf, long len)
+{
+	struct savestate s = { .out = buf, .len = buf ? len : 0 };
+	long size;
+
+	state_put_mem(&s, GBS_STATE_MAGIC, 4);
+	state_put(&s, GBS_STATE_VERSION, 2);
+	state_put(&s, gbs->image->crcnow, 4);
+	state_put(&s, 0, 4);  /* size, filled in below */
+
+	state_put_s64(&s, gbs->ticks);
+	state_put_long(&s, gbs->subsong);
+	state_put(&s, (uint16_t)gbs->lmin, 2);
+	state_put(&s, (uint16_t)gbs->lmax, 2);
+	state_put(&s, (uint16_t)gbs->rmin, 2);
+	state_put(&s, (uint16_t)gbs->rmax, 2);
+	state_put(&s, (uint16_t)gbs->lvol, 2);
+	state_put(&s, (uint16_t)gbs->rvol, 2);
+
+	gbhw_save_state(&gbs->gbhw, &s);
+	if (gbs->mapper)
+		mapper_save_state(gbs->mapper, &s);
+
+	size = s.pos;
+	s.pos = STATE_SIZE_OFS;
+	state_put(&s, size, 4);
+	return size;
+}
+
+long gbs_load_state(struct gbs* const gbs, const void *buf, long len)
+{
+	struct savestate s = { .in = buf, .len = len };
+	char magic[4];
+
+	state_get_mem(&s, magic, 4);
+	if (memcmp(magic, GBS_STATE_MAGIC, 4) != 0 ||
+	    state_get(&s, 2) != GBS_STATE_VERSION) {
+		fprintf(stderr, "%s", _("Not a libgbs state or unsupported version.\n"));
+		return 0;
+	}
+	if (state_get(&s, 4) != gbs->image->crcnow) {
+		fprintf(stderr, "%s", _("State was saved from a different file.\n"));
+		return 0;
+	}
+	if (state_get(&s, 4) != len) {
+		fprintf(stderr, "%s", _("State is truncated.\n"));
+		return 0;
+	}
+
+	gbs->ticks = state_get_s64(&s);
+	gbs->run_over = 0;
+	gbs->subsong = state_get_long(&s);
+	gbs->lmin = state_get(&s, 2);
+	gbs->lmax = state_get(&s, 2);
+	gbs->rmin = state_get(&s, 2);
+	gbs->rmax = state_get(&s, 2);
+	gbs->lvol = state_get(&s, 2);
+	gbs->rvol = state_get(&s, 2);
+
+	if (!gbhw_load_state(&gbs->gbhw, &s) ||
+	    (gbs->mapper && !mapper_load_state(gbs->mapper, &s)) ||
+	    s.overrun || s.pos != len) {
+		fprintf(stderr, "%s", _("Could not restore state.\n"));
+		return 0;
+	}
+	update_status_on_subsong_change(gbs);
+	return 1;
+}
+
 void gbs_print_info(const struct gbs* const gbs, long verbose)
 {
+	const struct gbs_image *img = gbs->image;
+
 	printf(_("GBSVersion:       %u\n"
 	         "Title:            \"%s\"\n"
 	         "Author:           \"%s\"\n"
@@ -458,31 +688,31 @@ void gbs_print_info(const struct gbs* const gbs, long verbose)
 	         "ROM size:         0x%08lx (%ld banks)\n"
 	         "Subsongs:         %u\n"
 	         "Default subsong:  %u\n"),
-	       gbs->version,
-	       gbs->title,
-	       gbs->author,
-	       gbs->copyright,
-	       gbs->load,
-	       gbs->init,
-	       gbs->play,
-	       gbs->stack,
-	       (unsigned int)gbs->filesize,
-	       gbs->romsize,
-	       gbs->romsize/0x4000,
-	       gbs->songs,
-	       gbs->defaultsong);
-	if (gbs->tac & 0x04) {
+	       img->version,
+	       img->title,
+	       img->author,
+	       img->copyright,
+	       img->load,
+	       img->init,
+	       img->play,
+	       img->stack,
+	       (unsigned int)img->filesize,
+	       img->romsize,
+	       img->romsize/0x4000,
+	       img->songs,
+	       img->defaultsong);
+	if (img->tac & 0x04) {
 		printf(_("Timing:           %2.2fHz timer%s\n"),
-		       gbhw_calc_timer_hz(gbs->tac, gbs->tma),
-		       (gbs->tac & 0x78) == 0x40 ? _(" + VBlank (ugetab)") : "");
+		       gbhw_calc_timer_hz(img->tac, img->tma),
+		       (img->tac & 0x78) == 0x40 ? _(" + VBlank (ugetab)") : "");
 	} else {
 		printf(_("Timing:           %s\n"),
 		       _("59.7Hz VBlank\n"));
 	}
-	if (gbs->defaultbank != 1) {
-		printf(_("Bank @0x4000:     %d\n"), gbs->defaultbank);
+	if (img->defaultbank != 1) {
+		printf(_("Bank @0x4000:     %d\n"), img->defaultbank);
 	}
-	printf(_("CRC32:            0x%08lx\n"), (unsigned long)gbs->crcnow);
+	printf(_("CRC32:            0x%08lx\n"), (unsigned long)img->crcnow);
 }
 
 static void update_status_on_subsong_change(struct gbs* const gbs) {
@@ -519,24 +749,51 @@ long gbs_toggle_mute(struct gbs* const gbs, long channel) {
 
 //YOYOFR
 long gbs_toggle_setmute(struct gbs* const gbs, long channel,long muteval) {
-    return (gbs->gbhw.ch[channel].mute = muteval);
+    return (gbs->gbhw.ch[channel].mute = muteval != 0);
 }
 void gbs_set_default_length(struct gbs* const gbs, long length) {
     gbs->subsong_timeout=length;
 }
 //YOYOFR
 
+static void image_free(struct gbs_image* const img)
+{
+#ifdef USE_MMAP
+	if (img->buf_mapped)
+		munmap(img->buf, img->buf_mapped);
+#endif
+	if (img->buf && img->buf_owned)
+		free(img->buf);
+	if (img->rom)
+		free(img->rom);
+	if (img->subsong_info)
+		free(img->subsong_info);
+	free(img->strings);
+	free(img);
+}
+
+struct gbs_image* gbs_image_ref(struct gbs_image* const img)
+{
+	__atomic_add_fetch(&img->refs, 1, __ATOMIC_RELAXED);
+	return img;
+}
+
+void gbs_image_unref(struct gbs_image* const img)
+{
+	if (__atomic_sub_fetch(&img->refs, 1, __ATOMIC_ACQ_REL) == 0)
+		image_free(img);
+}
+
 static void gbs_free(struct gbs* const gbs)
 {
 	gbhw_cleanup(&gbs->gbhw);
 	if (gbs->mapper)
 		mapper_free(gbs->mapper);
-	if (gbs->buf && gbs->buf_owned)
-		free(gbs->buf);
-	if (gbs->rom)
-		free(gbs->rom);
 	if (gbs->subsong_info)
 		free(gbs->subsong_info);
+	if (gbs->image)
+		gbs_image_unref(gbs->image);
+	free(gbs->stem_mix.data);
 	free(gbs);
 }
 
@@ -563,7 +820,7 @@ long gbs_write(const struct gbs* const gbs, const char* const name)
 {
 	long fd;
 	char pad[16];
-	long newlen = gbs->filesize;
+	long newlen = gbs->image->filesize;
 	long namelen = strlen(name);
 	char *tmpname = malloc(namelen + sizeof(".tmp\0"));
 
@@ -576,7 +833,7 @@ long gbs_write(const struct gbs* const gbs, const char* const name)
 		return 0;
 	}
 
-	if (write(fd, gbs->buf, newlen) == newlen) {
+	if (write(fd, gbs->image->buf, newlen) == newlen) {
 		int ret = 1;
 		close(fd);
 		if (rename(tmpname, name) == -1) {
@@ -592,8 +849,17 @@ long gbs_write(const struct gbs* const gbs, const char* const name)
 
 void gbs_write_rom(const struct gbs* const gbs, FILE *out, const uint8_t* const logo_data)
 {
-	if (gbs->rom[0x104] != 0xce) {
-		unsigned long tmp = gbs->romsize;
+	const struct gbs_image *img = gbs->image;
+	uint8_t *rom = malloc(img->romsize);
+
+	if (rom == NULL) {
+		fprintf(stderr, "%s", _("Memory allocation failed!\n"));
+		return;
+	}
+	/* the image is shared, patch the header on a copy */
+	memcpy(rom, img->rom, img->romsize);
+	if (rom[0x104] != 0xce) {
+		unsigned long tmp = img->romsize;
 		int i;
 		uint8_t rom_size = 0;
 		uint8_t chksum = 0x19;
@@ -605,36 +871,33 @@ void gbs_write_rom(const struct gbs* const gbs, FILE *out, const uint8_t* const
 		if (rom_size > 8) {
 			fputs(_("ROM size above limit (8 MiB)!"), stderr);
 		}
-		memcpy(&gbs->rom[0x104], logo_data, 0x30);
-		snprintf((char*)&gbs->rom[0x134], 16, "%s", gbs->title);
-		gbs->rom[0x147] = 0x02;  /* MBC1+RAM */
-		gbs->rom[0x148] = rom_size;
-		gbs->rom[0x149] = 0x02;  /* 8KiB of RAM */
+		memcpy(&rom[0x104], logo_data, 0x30);
+		snprintf((char*)&rom[0x134], 16, "%s", img->title);
+		rom[0x147] = 0x02;  /* MBC1+RAM */
+		rom[0x148] = rom_size;
+		rom[0x149] = 0x02;  /* 8KiB of RAM */
 
 		for (i = 0x134; i < 0x14c; i++) {
-			chksum += gbs->rom[i];
+			chksum += rom[i];
 		}
-		gbs->rom[0x14d] = -chksum;
+		rom[0x14d] = -chksum;
 	}
-	fwrite(gbs->rom, 1, gbs->romsize, out);
+	fwrite(rom, 1, img->romsize, out);
+	free(rom);
 }
 
-static struct gbs* gbs_new(char *buf)
+static struct gbs_image* image_new(char *buf)
 {
-	struct gbs* gbs = calloc(sizeof(struct gbs), 1);
-	gbhw_init_struct(&gbs->gbhw);
-	gbs->silence_timeout = 2*60;
-	gbs->subsong_timeout = 2*60;
-	gbs->gap = 2;
-	gbs->fadeout = 3;
-	gbs->songs = 1;
-	gbs->defaultsong = 1;
-	gbs->defaultbank = 1;
-	gbs->init = 0x100;
-	gbs->play = 0x100;
-	gbs->stack = 0xfffe;
-	gbs->buf = buf;
-	return gbs;
+	struct gbs_image* img = calloc(sizeof(struct gbs_image), 1);
+	img->refs = 1;
+	img->songs = 1;
+	img->defaultsong = 1;
+	img->defaultbank = 1;
+	img->init = 0x100;
+	img->play = 0x100;
+	img->stack = 0xfffe;
+	img->buf = buf;
+	return img;
 }
 
 const uint8_t *gbs_get_bootrom()
@@ -661,10 +924,10 @@ const uint8_t *gbs_get_bootrom()
 	return bootrom;
 }
 
-static struct gbs *gb_open(const char* const name, char *buf, size_t size)
+static struct gbs_image *gb_open(const char* const name, char *buf, size_t size)
 {
 	long i;
-	struct gbs* gbs = gbs_new(buf);
+	struct gbs_image* img = image_new(buf);
 	char *na_str = _("gb / not available");
 	const uint8_t *bootrom = gbs_get_bootrom();
 
@@ -677,72 +940,73 @@ static struct gbs *gb_open(const char* const name, char *buf, size_t size)
 	}
 	if (buf[i] == 0) {
 		/* Title looks valid and is zero-terminated. */
-		gbs->title = &buf[0x0134];
+		img->title = &buf[0x0134];
 	} else {
-		gbs->title = na_str;
-	}
-	gbs->filetype = FILETYPE_GB;
-	gbs->author = na_str;
-	gbs->copyright = na_str;
-	gbs->code = buf;
-	gbs->filesize = size;
-
-	gbs->subsong_info = calloc(sizeof(struct gbs_subsong_info), gbs->songs);
-	gbs->codelen = size - 0x20;
-	gbs->crcnow = gbs_crc32(0, buf, gbs->filesize);
-	gbs->romsize = (gbs->codelen + 0x3fff) & ~0x3fff;
-
-	gbs->rom = calloc(1, gbs->romsize);
-	memcpy(gbs->rom, buf, gbs->codelen);
-
-	gbs->mapper = mapper_gb(&gbs->gbhw.gbcpu, gbs->rom, gbs->romsize, buf[0x147], buf[0x148], buf[0x149]);
-	if (!gbs->mapper) {
+		img->title = na_str;
+	}
+	img->filetype = FILETYPE_GB;
+	img->author = na_str;
+	img->copyright = na_str;
+	img->code = buf;
+	img->filesize = size;
+
+	img->subsong_info = calloc(sizeof(struct gbs_subsong_info), img->songs);
+	img->codelen = size - 0x20;
+	img->crcnow = gbs_crc32(0, buf, img->filesize);
+	img->romsize = (img->codelen + 0x3fff) & ~0x3fff;
+
+	img->rom = calloc(1, img->romsize);
+	memcpy(img->rom, buf, img->codelen);
+
+	img->mapper_args[0] = buf[0x147];
+	img->mapper_args[1] = buf[0x148];
+	img->mapper_args[2] = buf[0x149];
+	if (!mapper_gb_supported(buf[0x147])) {
 		fprintf(stderr, _("Unsupported cartridge type: 0x%02x\n"), buf[0x147]);
-		gbs_free(gbs);
+		image_free(img);
 		return NULL;
 	}
 
 	/* For accuracy testing purposes, support boot rom. */
 	if (bootrom != NULL) {
-		gbhw_enable_bootrom(&gbs->gbhw, bootrom);
-		gbs->init = 0;
+		img->bootrom = bootrom;
+		img->init = 0;
 	}
-	gbs->buf_owned = 1;
-	return gbs;
+	return img;
 }
 
-static struct gbs *gbr_open(const char* const name, char *buf, size_t size)
+static struct gbs_image *gbr_open(const char* const name, char *buf, size_t size)
 {
 	long i;
-	struct gbs* gbs = gbs_new(buf);
+	struct gbs_image* img = image_new(buf);
 	char *na_str = _("gbr / not available");
 	uint16_t vsync_addr;
 	uint16_t timer_addr;
 
 	if (strncmp(buf, GBR_MAGIC, 4) != 0) {
 		fprintf(stderr, _("Not a GBR-File: %s\n"), name);
-		gbs_free(gbs);
+		image_free(img);
 		return NULL;
 	}
 	if (buf[0x07] < 1 || buf[0x07] > 3) {
 		fprintf(stderr, _("Unsupported timerflag value: %d\n"), buf[0x07]);
-		gbs_free(gbs);
+		image_free(img);
 		return NULL;
 	}
-	gbs->filetype = FILETYPE_GBR;
-	gbs->songs = 255;
-	gbs->defaultbank = buf[0x06];
-	gbs->init  = readint(&buf[0x08], 2);
+	img->filetype = FILETYPE_GBR;
+	img->songs = 255;
+	img->defaultbank = buf[0x06];
+	img->init  = readint(&buf[0x08], 2);
 	vsync_addr = readint(&buf[0x0a], 2);
 	timer_addr = readint(&buf[0x0c], 2);
 
 	if (buf[0x07] == 1) {
-		gbs->play = vsync_addr;
+		img->play = vsync_addr;
 	} else {
-		gbs->play = timer_addr;
+		img->play = timer_addr;
 	}
-	gbs->tma = buf[0x0e];
-	gbs->tac = buf[0x0f];
+	img->tma = buf[0x0e];
+	img->tac = buf[0x0f];
 
 	/* Test if this looks like a valid rom header title */
 	for (i=0x0154; i<0x0163; i++) {
@@ -751,44 +1015,44 @@ static struct gbs *gbr_open(const char* const name, char *buf, size_t size)
 	}
 	if (buf[i] == 0) {
 		/* Title looks valid and is zero-terminated. */
-		gbs->title = &buf[0x0154];
+		img->title = &buf[0x0154];
 	} else {
-		gbs->title = na_str;
+		img->title = na_str;
 	}
-	gbs->author = na_str;
-	gbs->copyright = na_str;
-	gbs->code = &buf[0x20];
-	gbs->filesize = size;
+	img->author = na_str;
+	img->copyright = na_str;
+	img->code = &buf[0x20];
+	img->filesize = size;
 
-	gbs->subsong_info = calloc(sizeof(struct gbs_subsong_info), gbs->songs);
-	gbs->codelen = size - 0x20;
-	gbs->crcnow = gbs_crc32(0, buf, gbs->filesize);
-	gbs->romsize = (gbs->codelen + 0x3fff) & ~0x3fff;
+	img->subsong_info = calloc(sizeof(struct gbs_subsong_info), img->songs);
+	img->codelen = size - 0x20;
+	img->crcnow = gbs_crc32(0, buf, img->filesize);
+	img->romsize = (img->codelen + 0x3fff) & ~0x3fff;
 
-	gbs->rom = calloc(1, gbs->romsize);
-	memcpy(gbs->rom, &buf[0x20], gbs->codelen);
+	img->rom = calloc(1, img->romsize);
+	memcpy(img->rom, &buf[0x20], img->codelen);
 
-	gbs->mapper = mapper_gbr(&gbs->gbhw.gbcpu, gbs->rom, gbs->romsize, buf[5], buf[6]);
+	img->mapper_args[0] = buf[5];
+	img->mapper_args[1] = buf[6];
 
-	gbs->rom[0x40] = 0xd9; /* reti */
-	gbs->rom[0x50] = 0xd9; /* reti */
+	img->rom[0x40] = 0xd9; /* reti */
+	img->rom[0x50] = 0xd9; /* reti */
 	if (buf[0x07] & 1) {
 		/* V-Blank */
-		gbs->rom[0x40] = 0xcd; /* call imm16 */
-		gbs->rom[0x41] = vsync_addr & 0xff;
-		gbs->rom[0x42] = vsync_addr >> 8;
-		gbs->rom[0x43] = 0xd9; /* reti */
+		img->rom[0x40] = 0xcd; /* call imm16 */
+		img->rom[0x41] = vsync_addr & 0xff;
+		img->rom[0x42] = vsync_addr >> 8;
+		img->rom[0x43] = 0xd9; /* reti */
 	}
 	if (buf[0x07] & 2) {
 		/* Timer */
-		gbs->rom[0x50] = 0xcd; /* call imm16 */
-		gbs->rom[0x51] = timer_addr & 0xff;
-		gbs->rom[0x52] = timer_addr >> 8;
-		gbs->rom[0x53] = 0xd9; /* reti */
+		img->rom[0x50] = 0xcd; /* call imm16 */
+		img->rom[0x51] = timer_addr & 0xff;
+		img->rom[0x52] = timer_addr >> 8;
+		img->rom[0x53] = 0xd9; /* reti */
 	}
 
-	gbs->buf_owned = 1;
-	return gbs;
+	return img;
 }
 
 static uint32_t le32(const char* const buf)
@@ -803,24 +1067,24 @@ static uint16_t le16(const char* const buf)
 	return b[0] | (b[1] << 8);
 }
 
-static void emit(struct gbs* const gbs, long* const code_used, uint8_t data, long reserve)
+static void emit(struct gbs_image* const img, long* const code_used, uint8_t data, long reserve)
 {
-	long remain = gbs->codelen - *code_used;
-	uint8_t *code = (uint8_t*) &gbs->code[*code_used];
+	long remain = img->codelen - *code_used;
+	uint8_t *code = (uint8_t*) &img->code[*code_used];
 	if (reserve + 1 > remain) {
 		while (remain-- > 0) {
 			*(code++) = 0xc9;  /* RET */
 			(*code_used)++;
 		}
-		gbs->code = realloc(gbs->code, gbs->codelen + 0x4000);
-		gbs->codelen += 0x4000;
-		code = (uint8_t*) &gbs->code[*code_used];
+		img->code = realloc(img->code, img->codelen + 0x4000);
+		img->codelen += 0x4000;
+		code = (uint8_t*) &img->code[*code_used];
 	}
 	*(code++) = data;
 	(*code_used)++;
 }
 
-static void gd3_parse(struct gbs **gbs, const char* const gd3, long gd3_len)
+static void gd3_parse(struct gbs_image* const img, const char* const gd3, long gd3_len)
 {
 	char *buf;
 	char *s;
@@ -838,16 +1102,15 @@ static void gd3_parse(struct gbs **gbs, const char* const gd3, long gd3_len)
 	if (le32(&gd3[8]) != gd3_len - ofs) {
 		return;
 	}
-	*gbs = realloc(*gbs, sizeof(struct gbs) + gd3_len);
-	s = buf = (char *)&(*gbs)[1];
+	s = buf = img->strings = malloc(gd3_len);
 	while (ofs < gd3_len) {
 		uint16_t val = le16(&gd3[ofs]);
 		if (val == 0) {
 			*(buf++) = 0;
 			switch (idx) {
-			case 0: (*gbs)->subsong_info[0].title = s; break;
-			case 2: (*gbs)->title = s; break;
-			case 6: (*gbs)->author = s; break;
+			case 0: img->subsong_info[0].title = s; break;
+			case 2: img->title = s; break;
+			case 6: img->author = s; break;
 			default: break;
 			}
 			s = buf;
@@ -861,9 +1124,9 @@ static void gd3_parse(struct gbs **gbs, const char* const gd3, long gd3_len)
 	}
 }
 
-static struct gbs *vgm_open(const char* const name, char* const buf, size_t size)
+static struct gbs_image *vgm_open(const char* const name, char* const buf, size_t size)
 {
-	struct gbs* gbs = gbs_new(buf);
+	struct gbs_image* img = image_new(buf);
 	char *na_str = _("vgm / not available");
 	char *gd3 = NULL;
 	char *data;
@@ -882,24 +1145,24 @@ static struct gbs *vgm_open(const char* const name, char* const buf, size_t size
 
 	if (strncmp(buf, VGM_MAGIC, 4) != 0) {
 		fprintf(stderr, _("Not a VGM-File: %s\n"), name);
-		gbs_free(gbs);
+		image_free(img);
 		return NULL;
 	}
 	if (buf[0x09] != 1 || buf[0x08] < 0x61) {
 		fprintf(stderr, _("Unsupported VGM version: %d.%02x\n"), buf[0x09], buf[0x08]);
-		gbs_free(gbs);
+		image_free(img);
 		return NULL;
 	}
 	dmg_clock = le32(&buf[0x80]);
 	if (dmg_clock != 4194304) {
 		fprintf(stderr, _("Unsupported DMG clock: %ldHz\n"), dmg_clock);
-		gbs_free(gbs);
+		image_free(img);
 		return NULL;
 	}
 	eof_ofs = le32(&buf[0x4]) + 0x4;
 	if (eof_ofs > size) {
 		fprintf(stderr, _("Bad file size in header: %ld\n"), eof_ofs);
-		gbs_free(gbs);
+		image_free(img);
 		return NULL;
 	}
 	gd3_ofs = le32(&buf[0x14]) + 0x14;
@@ -911,7 +1174,7 @@ static struct gbs *vgm_open(const char* const name, char* const buf, size_t size
 		gd3 = &buf[gd3_ofs];
 		if (gd3_len < 4 || strncmp(gd3, GD3_MAGIC, 4) != 0) {
 			fprintf(stderr, _("Bad GD3 offset: %08lx\n"), gd3_ofs);
-			gbs_free(gbs);
+			image_free(img);
 			return NULL;
 		}
 	}
@@ -920,13 +1183,13 @@ static struct gbs *vgm_open(const char* const name, char* const buf, size_t size
 	data = &buf[data_ofs];
 	if (data_len < 0) {
 		fprintf(stderr, _("Bad data length: %ld\n"), data_len);
-		gbs_free(gbs);
+		image_free(img);
 		return NULL;
 	}
 
-	gbs->filetype = FILETYPE_VGM;
-	gbs->codelen = 0x4000;
-	gbs->code = calloc(1, gbs->codelen);
+	img->filetype = FILETYPE_VGM;
+	img->codelen = 0x4000;
+	img->code = calloc(1, img->codelen);
 	code_used = 0;
 
 	total_wait = total_clocks = 0;
@@ -934,7 +1197,7 @@ static struct gbs *vgm_open(const char* const name, char* const buf, size_t size
 		switch ((uint8_t)*data) {
 		default:
 			fprintf(stderr, _("Unsupported VGM opcode: 0x%02x\n"), *data);
-			gbs_free(gbs);
+			image_free(img);
 			return NULL;
 		case 0x61:  /* Wait n samples */
 			total_wait += le16(&data[1]);
@@ -977,18 +1240,18 @@ static struct gbs *vgm_open(const char* const name, char* const buf, size_t size
 
 				while (units > 0) {
 					long d = units > 0x10000 ?  0x10000 : units;
-					emit(gbs, &code_used, 0xcf, 3); // RST 0x08
-					emit(gbs, &code_used, (d - 1) & 0xff, 0);
-					emit(gbs, &code_used, (d - 1) >> 8, 0);
+					emit(img, &code_used, 0xcf, 3); // RST 0x08
+					emit(img, &code_used, (d - 1) & 0xff, 0);
+					emit(img, &code_used, (d - 1) >> 8, 0);
 					units -= d;
 					total_clocks += d * 64;
 				}
 				/* LD a, imm8 */
-				emit(gbs, &code_used, 0x3e, 4);
-				emit(gbs, &code_used, val, 0);
+				emit(img, &code_used, 0x3e, 4);
+				emit(img, &code_used, val, 0);
 				/* LDH (a8), A */
-				emit(gbs, &code_used, 0xe0, 0);
-				emit(gbs, &code_used, reg, 0);
+				emit(img, &code_used, 0xe0, 0);
+				emit(img, &code_used, reg, 0);
 			}
 			data += 2;
 			break;
@@ -996,273 +1259,270 @@ static struct gbs *vgm_open(const char* const name, char* const buf, size_t size
 		data++;
 	}
 	/* RST 0x38 */
-	emit(gbs, &code_used, 0xff, 1);
-
-	gbs->load = 0x0400;
-	gbs->init = 0x0440;
-	gbs->play = 0x0404;
-	gbs->tma = 0;
-	gbs->tac = 0;
-	gbs->title = na_str;
-	gbs->author = na_str;
-	gbs->copyright = na_str;
-	gbs->filesize = size;
-	gbs->crcnow = gbs_crc32(0, buf, gbs->filesize);
-
-	gbs->subsong_info = calloc(sizeof(struct gbs_subsong_info), gbs->songs);
-	gbs->subsong_info[0].len = total_clocks / (GBHW_CLOCK / GBS_LEN_DIV);
+	emit(img, &code_used, 0xff, 1);
+
+	img->load = 0x0400;
+	img->init = 0x0440;
+	img->play = 0x0404;
+	img->tma = 0;
+	img->tac = 0;
+	img->title = na_str;
+	img->author = na_str;
+	img->copyright = na_str;
+	img->filesize = size;
+	img->crcnow = gbs_crc32(0, buf, img->filesize);
+
+	img->subsong_info = calloc(sizeof(struct gbs_subsong_info), img->songs);
+	img->subsong_info[0].len = total_clocks / (GBHW_CLOCK / GBS_LEN_DIV);
 
 	if (gd3_len > 0) {
-		gd3_parse(&gbs, gd3, gd3_len);
+		gd3_parse(img, gd3, gd3_len);
 	}
 
-	gbs->romsize = gbs->codelen + 0x4000;
-	gbs->rom = calloc(1, gbs->romsize);
-	memcpy(&gbs->rom[0x4000], gbs->code, gbs->codelen);
+	img->romsize = img->codelen + 0x4000;
+	img->rom = calloc(1, img->romsize);
+	memcpy(&img->rom[0x4000], img->code, img->codelen);
 
-	gbs->mapper = mapper_gbs(&gbs->gbhw.gbcpu, gbs->rom, gbs->romsize);
+	free(img->code);
+	img->code = NULL;
 
 	/* 16 + 52 for RST + setup */
 	addr = 0x8;
-	gbs->rom[addr++] = 0xe1; /* 12: pop hl */
-	gbs->rom[addr++] = 0x2a; /*  8: ld a, (hl+) */
-	gbs->rom[addr++] = 0x5f; /*  4: ld e, a */
-	gbs->rom[addr++] = 0x2a; /*  8: ld a, (hl+) */
-	gbs->rom[addr++] = 0x57; /*  4: ld d, a */
-	gbs->rom[addr++] = 0xe5; /* 16: push hl */
+	img->rom[addr++] = 0xe1; /* 12: pop hl */
+	img->rom[addr++] = 0x2a; /*  8: ld a, (hl+) */
+	img->rom[addr++] = 0x5f; /*  4: ld e, a */
+	img->rom[addr++] = 0x2a; /*  8: ld a, (hl+) */
+	img->rom[addr++] = 0x57; /*  4: ld d, a */
+	img->rom[addr++] = 0xe5; /* 16: push hl */
 
 	/* 64 cycles for loop */
 	jpaddr = addr;
-	gbs->rom[addr++] = 0x7a; /*  4: ld a, d */
-	gbs->rom[addr++] = 0xb3; /*  4: or e */
-	gbs->rom[addr++] = 0xc8; /*  8: ret z */
-	gbs->rom[addr++] = 0x1b; /*  8: dec de */
-	gbs->rom[addr++] = 0x23; /*  8: inc hl */
-	gbs->rom[addr++] = 0x23; /*  8: inc hl */
-	gbs->rom[addr++] = 0x23; /*  8: inc hl */
-	gbs->rom[addr++] = 0xc3; /* 16: jp @loop */
-	gbs->rom[addr++] = jpaddr & 0xff;
-	gbs->rom[addr++] = jpaddr >> 8;
+	img->rom[addr++] = 0x7a; /*  4: ld a, d */
+	img->rom[addr++] = 0xb3; /*  4: or e */
+	img->rom[addr++] = 0xc8; /*  8: ret z */
+	img->rom[addr++] = 0x1b; /*  8: dec de */
+	img->rom[addr++] = 0x23; /*  8: inc hl */
+	img->rom[addr++] = 0x23; /*  8: inc hl */
+	img->rom[addr++] = 0x23; /*  8: inc hl */
+	img->rom[addr++] = 0xc3; /* 16: jp @loop */
+	img->rom[addr++] = jpaddr & 0xff;
+	img->rom[addr++] = jpaddr >> 8;
 
 	/* Trap opcode 0xff (rst 0x38) execution */
 	jpaddr = addr = 0x38;
-	gbs->rom[addr++] = 0xf3; /* di */
-	gbs->rom[addr++] = 0x76; /* halt */
-	gbs->rom[addr++] = 0xc3; /* jp $ */
-	gbs->rom[addr++] = jpaddr & 0xff;
-	gbs->rom[addr++] = jpaddr >> 8;
-
-	gbs->rom[0x0040] = 0xd9; /* reti */
-	gbs->rom[0x0050] = 0xd9; /* reti */
-
-	gbs->rom[0x0100] = 0x00; /* nop */
-	gbs->rom[0x0101] = 0xc3; /* jp */
-	gbs->rom[0x0102] = gbs->init & 0xff;
-	gbs->rom[0x0103] = gbs->init >> 8;
-
-	addr = gbs->init;
-	gbs->rom[addr++] = 0xf3; /* di */
-	gbs->rom[addr++] = 0x3e; /* ld a, 1 */
-	gbs->rom[addr++] = 0x01;
+	img->rom[addr++] = 0xf3; /* di */
+	img->rom[addr++] = 0x76; /* halt */
+	img->rom[addr++] = 0xc3; /* jp $ */
+	img->rom[addr++] = jpaddr & 0xff;
+	img->rom[addr++] = jpaddr >> 8;
+
+	img->rom[0x0040] = 0xd9; /* reti */
+	img->rom[0x0050] = 0xd9; /* reti */
+
+	img->rom[0x0100] = 0x00; /* nop */
+	img->rom[0x0101] = 0xc3; /* jp */
+	img->rom[0x0102] = img->init & 0xff;
+	img->rom[0x0103] = img->init >> 8;
+
+	addr = img->init;
+	img->rom[addr++] = 0xf3; /* di */
+	img->rom[addr++] = 0x3e; /* ld a, 1 */
+	img->rom[addr++] = 0x01;
 	jpaddr = addr;
-	gbs->rom[addr++] = 0xe0; /* ldh (0x80), a */
-	gbs->rom[addr++] = 0x80;
-	gbs->rom[addr++] = 0x21; /* ld hl, 0x2000 */
-	gbs->rom[addr++] = 0x00;
-	gbs->rom[addr++] = 0x20;
-	gbs->rom[addr++] = 0x77; /* ld (hl), a */
-	gbs->rom[addr++] = 0xcd; /* call 0x4000 */
-	gbs->rom[addr++] = 0x00;
-	gbs->rom[addr++] = 0x40;
-	gbs->rom[addr++] = 0xf0; /* ldh a, (0x80) */
-	gbs->rom[addr++] = 0x80;
-	gbs->rom[addr++] = 0x3c; /* inc a */
-	gbs->rom[addr++] = 0xc3; /* jp @loop */
-	gbs->rom[addr++] = jpaddr & 0xff;
-	gbs->rom[addr++] = jpaddr >> 8;
-
-	gbs->buf_owned = 1;
-	return gbs;
+	img->rom[addr++] = 0xe0; /* ldh (0x80), a */
+	img->rom[addr++] = 0x80;
+	img->rom[addr++] = 0x21; /* ld hl, 0x2000 */
+	img->rom[addr++] = 0x00;
+	img->rom[addr++] = 0x20;
+	img->rom[addr++] = 0x77; /* ld (hl), a */
+	img->rom[addr++] = 0xcd; /* call 0x4000 */
+	img->rom[addr++] = 0x00;
+	img->rom[addr++] = 0x40;
+	img->rom[addr++] = 0xf0; /* ldh a, (0x80) */
+	img->rom[addr++] = 0x80;
+	img->rom[addr++] = 0x3c; /* inc a */
+	img->rom[addr++] = 0xc3; /* jp @loop */
+	img->rom[addr++] = jpaddr & 0xff;
+	img->rom[addr++] = jpaddr >> 8;
+
+	return img;
 }
 
-static struct gbs* gbs_open_internal(const char* const name, char* const buf, size_t size)
+static struct gbs_image *gbs_open_internal(const char* const name, char* const buf, size_t size)
 {
-	struct gbs* const gbs = gbs_new(buf);
+	struct gbs_image* const img = image_new(buf);
 	long i, addr, jpaddr;
 
 	UNUSED(name);
 
-	gbs->version = buf[0x03];
-	if (gbs->version != 1) {
-		fprintf(stderr, _("GBS Version %d unsupported.\n"), gbs->version);
-		gbs_free(gbs);
+	img->version = buf[0x03];
+	if (img->version != 1) {
+		fprintf(stderr, _("GBS Version %d unsupported.\n"), img->version);
+		image_free(img);
 		return NULL;
 	}
 
-	gbs->songs = buf[0x04];
-	if (gbs->songs < 1) {
-		fprintf(stderr, _("Number of subsongs = %d is unreasonable.\n"), gbs->songs);
-		gbs_free(gbs);
+	img->songs = buf[0x04];
+	if (img->songs < 1) {
+		fprintf(stderr, _("Number of subsongs = %d is unreasonable.\n"), img->songs);
+		image_free(img);
 		return NULL;
 	}
 
-	gbs->defaultsong = buf[0x05];
-	if (gbs->defaultsong < 1 || gbs->defaultsong > gbs->songs) {
-		fprintf(stderr, _("Default subsong %d is out of range [1..%d].\n"), gbs->defaultsong, gbs->songs);
-		gbs_free(gbs);
+	img->defaultsong = buf[0x05];
+	if (img->defaultsong < 1 || img->defaultsong > img->songs) {
+		fprintf(stderr, _("Default subsong %d is out of range [1..%d].\n"), img->defaultsong, img->songs);
+		image_free(img);
 		return NULL;
 	}
 
-	gbs->load  = readint(&buf[0x06], 2);
-	gbs->init  = readint(&buf[0x08], 2);
-	gbs->play  = readint(&buf[0x0a], 2);
-	gbs->stack = readint(&buf[0x0c], 2);
-	gbs->tma = buf[0x0e];
-	gbs->tac = buf[0x0f];
+	img->load  = readint(&buf[0x06], 2);
+	img->init  = readint(&buf[0x08], 2);
+	img->play  = readint(&buf[0x0a], 2);
+	img->stack = readint(&buf[0x0c], 2);
+	img->tma = buf[0x0e];
+	img->tac = buf[0x0f];
 
-	memcpy(gbs->v1strings, &buf[0x10], 32);
-	memcpy(gbs->v1strings+33, &buf[0x30], 32);
-	memcpy(gbs->v1strings+66, &buf[0x50], 32);
-	gbs->title = gbs->v1strings;
-	gbs->author = gbs->v1strings+33;
-	gbs->copyright = gbs->v1strings+66;
-	gbs->code = &buf[0x70];
-	gbs->filesize = size;
+	memcpy(img->v1strings, &buf[0x10], 32);
+	memcpy(img->v1strings+33, &buf[0x30], 32);
+	memcpy(img->v1strings+66, &buf[0x50], 32);
+	img->title = img->v1strings;
+	img->author = img->v1strings+33;
+	img->copyright = img->v1strings+66;
+	img->code = &buf[0x70];
+	img->filesize = size;
 
-	gbs->subsong_info = calloc(sizeof(struct gbs_subsong_info), gbs->songs);
-	gbs->codelen = size - HDR_LEN_GBS;
-	gbs->crcnow = gbs_crc32(0, buf, gbs->filesize);
+	img->subsong_info = calloc(sizeof(struct gbs_subsong_info), img->songs);
+	img->codelen = size - HDR_LEN_GBS;
+	img->crcnow = gbs_crc32(0, buf, img->filesize);
 
 	/* Calculate ROM size: round up (codelen + load) to next 16KB boundary */
 	/* Then add one more 16KB bank for replayer code to avoid conflicts */
-	gbs->romsize = ((gbs->codelen + gbs->load + 0x3fff) & ~0x3fff) + 0x4000;
+	img->romsize = ((img->codelen + img->load + 0x3fff) & ~0x3fff) + 0x4000;
 
-	gbs->rom = calloc(1, gbs->romsize);
-	memcpy(&gbs->rom[gbs->load], gbs->code, gbs->codelen);
-
-	gbs->mapper = mapper_gbs(&gbs->gbhw.gbcpu, gbs->rom, gbs->romsize);
+	img->rom = calloc(1, img->romsize);
+	memcpy(&img->rom[img->load], img->code, img->codelen);
 
 	for (i=0; i<8; i++) {
-		long addr = gbs->load + 8*i; /* jump address */
-		gbs->rom[8*i]   = 0xc3; /* jp imm16 */
-		gbs->rom[8*i+1] = addr & 0xff;
-		gbs->rom[8*i+2] = addr >> 8;
+		long addr = img->load + 8*i; /* jump address */
+		img->rom[8*i]   = 0xc3; /* jp imm16 */
+		img->rom[8*i+1] = addr & 0xff;
+		img->rom[8*i+2] = addr >> 8;
 	}
-	if ((gbs->tac & 0x78) == 0x40) { /* ugetab int vector extension */
+	if ((img->tac & 0x78) == 0x40) { /* ugetab int vector extension */
 		/* V-Blank */
-		gbs->rom[0x40] = 0xcd; /* call imm16 */
-		gbs->rom[0x41] = (gbs->load + 0x40) & 0xff;
-		gbs->rom[0x42] = (gbs->load + 0x40) >> 8;
+		img->rom[0x40] = 0xcd; /* call imm16 */
+		img->rom[0x41] = (img->load + 0x40) & 0xff;
+		img->rom[0x42] = (img->load + 0x40) >> 8;
 		/*
 		 * ugetab is not well-spec'd, it is unclear where you
 		 * have to call play from. Calling it from vblank
 		 * seems to work.
 		 */
-		gbs->rom[0x43] = 0xcd; /* call imm16 */
-		gbs->rom[0x44] = gbs->play & 0xff;
-		gbs->rom[0x45] = gbs->play >> 8;
-		gbs->rom[0x46] = 0xd9; /* reti */
+		img->rom[0x43] = 0xcd; /* call imm16 */
+		img->rom[0x44] = img->play & 0xff;
+		img->rom[0x45] = img->play >> 8;
+		img->rom[0x46] = 0xd9; /* reti */
 		/* Timer */
-		gbs->rom[0x50] = 0xcd; /* call imm16 */
-		gbs->rom[0x51] = (gbs->load + 0x48) & 0xff;
-		gbs->rom[0x52] = (gbs->load + 0x48) >> 8;
-		gbs->rom[0x53] = 0xd9; /* reti */
-	} else if (gbs->tac & 0x04) { /* timer enabled */
+		img->rom[0x50] = 0xcd; /* call imm16 */
+		img->rom[0x51] = (img->load + 0x48) & 0xff;
+		img->rom[0x52] = (img->load + 0x48) >> 8;
+		img->rom[0x53] = 0xd9; /* reti */
+	} else if (img->tac & 0x04) { /* timer enabled */
 		/* V-Blank */
-		gbs->rom[0x40] = 0xd9; /* reti */
+		img->rom[0x40] = 0xd9; /* reti */
 		/* Timer */
-		gbs->rom[0x50] = 0xcd; /* call imm16 */
-		gbs->rom[0x51] = gbs->play & 0xff;
-		gbs->rom[0x52] = gbs->play >> 8;
-		gbs->rom[0x53] = 0xd9; /* reti */
+		img->rom[0x50] = 0xcd; /* call imm16 */
+		img->rom[0x51] = img->play & 0xff;
+		img->rom[0x52] = img->play >> 8;
+		img->rom[0x53] = 0xd9; /* reti */
 	} else {
 		/* V-Blank */
-		gbs->rom[0x40] = 0xcd; /* call imm16 */
-		gbs->rom[0x41] = gbs->play & 0xff;
-		gbs->rom[0x42] = gbs->play >> 8;
-		gbs->rom[0x43] = 0xd9; /* reti */
+		img->rom[0x40] = 0xcd; /* call imm16 */
+		img->rom[0x41] = img->play & 0xff;
+		img->rom[0x42] = img->play >> 8;
+		img->rom[0x43] = 0xd9; /* reti */
 		/* Timer */
-		gbs->rom[0x50] = 0xd9; /* reti */
+		img->rom[0x50] = 0xd9; /* reti */
 	}
-	gbs->rom[0x48] = 0xd9; /* reti (LCD Stat) */
-	gbs->rom[0x58] = 0xd9; /* reti (Serial) */
-	gbs->rom[0x60] = 0xd9; /* reti (Joypad) */
+	img->rom[0x48] = 0xd9; /* reti (LCD Stat) */
+	img->rom[0x58] = 0xd9; /* reti (Serial) */
+	img->rom[0x60] = 0xd9; /* reti (Joypad) */
 
 	/* In case this is dumped as a ROM */
-	gbs->rom[0x0100] = 0x00; /* nop */
-	gbs->rom[0x0101] = 0xc3; /* jp */
+	img->rom[0x0100] = 0x00; /* nop */
+	img->rom[0x0101] = 0xc3; /* jp */
 
 	/* Place replayer code after GBS code, rounded up to next 256-byte boundary */
 	/* This ensures it never conflicts with GBS driver code */
-	uint32_t code_end = gbs->load + gbs->codelen;
+	uint32_t code_end = img->load + img->codelen;
 	uint32_t replayer_addr = (code_end + 0xff) & ~0xff;
 
-	gbs->rom[0x0102] = replayer_addr & 0xff;
-	gbs->rom[0x0103] = replayer_addr >> 8;
+	img->rom[0x0102] = replayer_addr & 0xff;
+	img->rom[0x0103] = replayer_addr >> 8;
 
 	addr = replayer_addr;
-	gbs->rom[addr++] = 0x21;  /* LD hl */
-	gbs->rom[addr++] = gbs->stack & 0xff;
-	gbs->rom[addr++] = gbs->stack >> 8;
-	gbs->rom[addr++] = 0xf9;  /* LD sp, hl */
-
-	gbs->rom[addr++] = 0x3e;  /* LD a, imm8 */
-	gbs->rom[addr++] = gbs->tma;
-	gbs->rom[addr++] = 0xe0;  /* LDH (a8), A */
-	gbs->rom[addr++] = 0x06;  /* TMA reg */
-
-	gbs->rom[addr++] = 0x3e;  /* LD a, imm8 */
-	gbs->rom[addr++] = gbs->tac;
-	gbs->rom[addr++] = 0xe0;  /* LDH (a8), A */
-	gbs->rom[addr++] = 0x07;  /* TAC reg */
-
-	gbs->rom[addr++] = 0x26;  /* LD h, imm8 */
-	gbs->rom[addr++] = 0x20;
-	gbs->rom[addr++] = 0x36;  /* LD (HL), imm8 */
-	gbs->rom[addr++] = gbs->defaultbank;
+	img->rom[addr++] = 0x21;  /* LD hl */
+	img->rom[addr++] = img->stack & 0xff;
+	img->rom[addr++] = img->stack >> 8;
+	img->rom[addr++] = 0xf9;  /* LD sp, hl */
+
+	img->rom[addr++] = 0x3e;  /* LD a, imm8 */
+	img->rom[addr++] = img->tma;
+	img->rom[addr++] = 0xe0;  /* LDH (a8), A */
+	img->rom[addr++] = 0x06;  /* TMA reg */
+
+	img->rom[addr++] = 0x3e;  /* LD a, imm8 */
+	img->rom[addr++] = img->tac;
+	img->rom[addr++] = 0xe0;  /* LDH (a8), A */
+	img->rom[addr++] = 0x07;  /* TAC reg */
+
+	img->rom[addr++] = 0x26;  /* LD h, imm8 */
+	img->rom[addr++] = 0x20;
+	img->rom[addr++] = 0x36;  /* LD (HL), imm8 */
+	img->rom[addr++] = img->defaultbank;
 
 	/*
 	 * Call init function while interrupts are still disabled,
 	 * otherwise nightmode.gbs breaks. This is per spec:
 	 * "PLAY - Begins after INIT process is complete"
 	 */
-	gbs->rom[addr++] = 0x3e; /* LD a, imm8 */
-	gbs->rom[addr++] = 0x00; /* first song */
-	gbs->rom[addr++] = 0xcd; /* call imm16 */
-	gbs->rom[addr++] = gbs->init & 0xff;
-	gbs->rom[addr++] = gbs->init >> 8;
+	img->rom[addr++] = 0x3e; /* LD a, imm8 */
+	img->rom[addr++] = 0x00; /* first song */
+	img->rom[addr++] = 0xcd; /* call imm16 */
+	img->rom[addr++] = img->init & 0xff;
+	img->rom[addr++] = img->init >> 8;
 	/* Enable interrupts now */
-	gbs->rom[addr++] = 0x3e;  /* LD a, imm8 */
-	gbs->rom[addr++] = 0x05;  /* enable vblank + timer */
-	gbs->rom[addr++] = 0xe0;  /* LDH (a8), A */
-	gbs->rom[addr++] = 0xff;  /* IE reg */
+	img->rom[addr++] = 0x3e;  /* LD a, imm8 */
+	img->rom[addr++] = 0x05;  /* enable vblank + timer */
+	img->rom[addr++] = 0xe0;  /* LDH (a8), A */
+	img->rom[addr++] = 0xff;  /* IE reg */
 
 	jpaddr = addr;
-	gbs->rom[addr++] = 0x76; /* halt */
-	gbs->rom[addr++] = 0xc3; /* jp @loop */
-	gbs->rom[addr++] = jpaddr & 0xff;
-	gbs->rom[addr++] = jpaddr >> 8;
+	img->rom[addr++] = 0x76; /* halt */
+	img->rom[addr++] = 0xc3; /* jp @loop */
+	img->rom[addr++] = jpaddr & 0xff;
+	img->rom[addr++] = jpaddr >> 8;
 
 	/* Check for overlap between GBS code and replayer code */
-	uint32_t gbs_code_end = gbs->load + gbs->codelen;
+	uint32_t gbs_code_end = img->load + img->codelen;
 	uint32_t replayer_end = addr;
 
-	if (replayer_addr < gbs_code_end && gbs->load < replayer_end) {
+	if (replayer_addr < gbs_code_end && img->load < replayer_end) {
 		fprintf(stderr, _("Warning: GBS code [%04x-%04x) overlaps with replayer [%04x-%04x).\n"),
-			gbs->load, gbs_code_end, replayer_addr, replayer_end);
+			img->load, gbs_code_end, replayer_addr, replayer_end);
 		/* Continue anyway - some GBS files may still work */
 	}
 
-	gbs->buf_owned = 1;
-	return gbs;
+	return img;
 }
 
-static struct gbs* gbs_open_mem(const char* const name, char* const buf, size_t size);
+static struct gbs_image *gbs_open_buf(const char* const name, char* const buf, size_t size);
 
 #ifdef USE_ZLIB
-static struct gbs *gzip_open(const char* const name, char* const buf, size_t size)
+static struct gbs_image *gzip_open(const char* const name, char* const buf, size_t size)
 {
-	struct gbs* gbs = NULL;
+	struct gbs_image* img = NULL;
 	int ret;
 	char *out = malloc(GB_MAX_ROM_SIZE);
 	z_stream strm;
@@ -1288,23 +1548,24 @@ static struct gbs *gzip_open(const char* const name, char* const buf, size_t siz
 		goto exit_free;
 	}
 	inflateEnd(&strm);
-	gbs = gbs_open_mem(name, out, GB_MAX_ROM_SIZE - strm.avail_out);
+	img = gbs_open_buf(name, out, GB_MAX_ROM_SIZE - strm.avail_out);
 
 exit_free:
-	if (gbs == NULL || gbs->buf != out) {
+	if (img == NULL || img->buf != out) {
 		free(out);
-	}
-	return gbs;
+	} else img->buf_owned = 1;
+	return img;
 }
 #else
-static struct gbs *gzip_open(const char* const name, char* const buf, size_t size)
+static struct gbs_image *gzip_open(const char* const name, char* const buf, size_t size)
 {
 	fprintf(stderr, _("Could not open %s: %s\n"), name, _("Not compiled with zlib support"));
 	return NULL;
 }
 #endif
 
-static struct gbs* gbs_open_mem(const char* const name, char* const buf, size_t size)
+/* buf is kept by the returned image, the caller decides who frees it */
+static struct gbs_image *gbs_open_buf(const char* const name, char* const buf, size_t size)
 {
 	if (size > HDR_LEN_GZIP && strncmp(buf, GZIP_MAGIC, 3) == 0) {
 		return gzip_open(name, buf, size);
@@ -1325,9 +1586,19 @@ static struct gbs* gbs_open_mem(const char* const name, char* const buf, size_t
 	return NULL;
 }
 
-struct gbs* gbs_open(const char* const name)
+struct gbs_image* gbs_image_open_mem(const char* const name, const void* const buf, size_t size)
+{
+	if (size > GB_MAX_ROM_SIZE) {
+		fprintf(stderr, _("Could not read %s: %s\n"), name, _("Bigger than allowed maximum (4MiB)"));
+		return NULL;
+	}
+	/* the loaders only read buf, all patching is done on img->rom */
+	return gbs_open_buf(name, (char *)buf, size);
+}
+
+struct gbs_image* gbs_image_open(const char* const name)
 {
-	struct gbs* gbs = NULL;
+	struct gbs_image* img = NULL;
 	FILE *f;
 	struct stat st;
 	char *buf;
@@ -1344,27 +1615,193 @@ struct gbs* gbs_open(const char* const name)
 		fprintf(stderr, _("Could not read %s: %s\n"), name, _("Bigger than allowed maximum (4MiB)"));
 		goto exit_close;
 	}
+#ifdef USE_MMAP
+	/* pages are only read in as the ROM is built from them */
+	if (st.st_size > 0) {
+		buf = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fileno(f), 0);
+		if (buf != MAP_FAILED) {
+			img = gbs_image_open_mem(name, buf, st.st_size);
+			if (img != NULL && img->buf == buf)
+				img->buf_mapped = st.st_size;
+			else munmap(buf, st.st_size);
+			goto exit_close;
+		}
+	}
+#endif
 	buf = malloc(st.st_size);
 	if (fread(buf, 1, st.st_size, f) != st.st_size) {
 		fprintf(stderr, _("Could not read %s: %s\n"), name, strerror(errno));
 		goto exit_free;
 	}
 
-	gbs = gbs_open_mem(name, buf, st.st_size);
-	if (gbs != NULL) {
-		gbs->status.songs = gbs->songs;
-		gbs->status.defaultsong = gbs->defaultsong;
-		gbs->status.subsong = gbs->defaultsong - 1;
-	}
+	img = gbs_image_open_mem(name, buf, st.st_size);
+	if (img != NULL && img->buf == buf)
+		img->buf_owned = 1;
 
 exit_free:
-	if (gbs == NULL || gbs->buf != buf)
+	if (img == NULL || img->buf != buf)
 		free(buf);
 exit_close:
 	fclose(f);
+	return img;
+}
+
+/* every instance gets its own mapper, the bank registers are per playback */
+static struct mapper *image_mapper(const struct gbs_image* const img, struct gbcpu *gbcpu)
+{
+	const uint8_t *args = img->mapper_args;
+
+	switch (img->filetype) {
+	case FILETYPE_GBR:
+		return mapper_gbr(gbcpu, img->rom, img->romsize, args[0], args[1]);
+	case FILETYPE_GB:
+		return mapper_gb(gbcpu, img->rom, img->romsize, args[0], args[1], args[2]);
+	default:
+		return mapper_gbs(gbcpu, img->rom, img->romsize);
+	}
+}
+
+struct gbs* gbs_open_image(struct gbs_image* const img)
+{
+	struct gbs* gbs = calloc(sizeof(struct gbs), 1);
+	size_t info_size = sizeof(struct gbs_subsong_info) * img->songs;
+
+	if (gbs == NULL || (gbs->subsong_info = malloc(info_size)) == NULL) {
+		fprintf(stderr, "%s", _("Memory allocation failed!\n"));
+		free(gbs);
+		return NULL;
+	}
+	/* the silence timeout fills in lengths, keep that to this instance */
+	memcpy(gbs->subsong_info, img->subsong_info, info_size);
+	gbs->image = gbs_image_ref(img);
+
+	gbhw_init_struct(&gbs->gbhw);
+	gbs->silence_timeout = 2*60;
+	gbs->subsong_timeout = 2*60;
+	gbs->gap = 2;
+	gbs->fadeout = 3;
+
+	gbs->mapper = image_mapper(img, &gbs->gbhw.gbcpu);
+	/* see gb_open() */
+	if (img->bootrom != NULL)
+		gbhw_enable_bootrom(&gbs->gbhw, img->bootrom);
+
+	gbs->status.songs = img->songs;
+	gbs->status.defaultsong = img->defaultsong;
+	gbs->status.subsong = img->defaultsong - 1;
 	return gbs;
 }
 
+struct gbs* gbs_open_mem(const char* const name, const void* const buf, size_t size)
+{
+	struct gbs_image* img = gbs_image_open_mem(name, buf, size);
+	struct gbs* gbs;
+
+	if (img == NULL)
+		return NULL;
+	gbs = gbs_open_image(img);
+	gbs_image_unref(img);
+	return gbs;
+}
+
+struct gbs* gbs_open(const char* const name)
+{
+	struct gbs_image* img = gbs_image_open(name);
+	struct gbs* gbs;
+
+	if (img == NULL)
+		return NULL;
+	gbs = gbs_open_image(img);
+	gbs_image_unref(img);
+	return gbs;
+}
+
+struct gbs* gbs_clone(struct gbs* const gbs)
+{
+	const struct gbhw *src = &gbs->gbhw;
+	struct gbs* clone;
+	struct gbhw *gbhw;
+	long size = gbs_save_state(gbs, NULL, 0);
+	char *state = malloc(size);
+	long i;
+
+	if (state == NULL) {
+		fprintf(stderr, "%s", _("Memory allocation failed!\n"));
+		return NULL;
+	}
+	clone = gbs_open_image(gbs->image);
+	if (clone == NULL) {
+		free(state);
+		return NULL;
+	}
+	gbhw = &clone->gbhw;
+
+	memcpy(clone->subsong_info, gbs->subsong_info, sizeof(struct gbs_subsong_info) * gbs->image->songs);
+	clone->subsong_timeout = gbs->subsong_timeout;
+	clone->silence_timeout = gbs->silence_timeout;
+	clone->gap = gbs->gap;
+	clone->fadeout = gbs->fadeout;
+	clone->status.loop_mode = gbs->status.loop_mode;
+	for (i = 0; i < 4; i++)
+		gbhw->ch[i].mute = src->ch[i].mute;
+
+	/* the output setup decides whether the pending output is restored */
+	gbhw->filter_enabled = src->filter_enabled;
+	gbhw->filter_constant = src->filter_constant;
+	gbhw->impulse = src->impulse;
+	gbhw->idle_skip = src->idle_skip;
+	if (src->voices && !gbhw_set_voices(gbhw, 1))
+		goto exit_free;
+	if (gbs->buffer != NULL) {
+		/* render into a buffer of our own until the caller sets one */
+		clone->stem_mix.data = malloc(gbs->buffer->bytes);
+		if (clone->stem_mix.data == NULL) {
+			fprintf(stderr, "%s", _("Memory allocation failed!\n"));
+			goto exit_free;
+		}
+		memcpy(clone->stem_mix.data, gbs->buffer->data, gbs->buffer->bytes);
+		clone->stem_mix.bytes = gbs->buffer->bytes;
+		gbs_configure_output(clone, &clone->stem_mix, src->sample_rate);
+	}
+
+	/* maps RAM and IO, then the state overwrites everything gbs_init() did */
+	gbhw_init(gbhw);
+	gbs_save_state(gbs, state, size);
+	if (!gbs_load_state(clone, state, size))
+		goto exit_free;
+	free(state);
+	/* the output position and run overshoot are not part of the state */
+	if (gbs->buffer != NULL)
+		clone->stem_mix.pos = clone->gbhw_buf.pos = gbs->gbhw_buf.pos;
+	clone->run_over = gbs->run_over;
+	/* neither are the pending per-voice impulses, see gbhw_alloc_voices() */
+	if (src->voice_imp[0] && gbhw->voice_imp[0])
+		memcpy(gbhw->voice_imp[0], src->voice_imp[0],
+		       4 * src->impbuf->samples * sizeof(int32_t) + 4 * src->soundbuf->samples);
+
+	/* the clone logs its own writes, continuing the deltas */
+	if (src->evlog.ev) {
+		if (!gbhw_set_event_log(gbhw, src->evlog.mask + 1)) {
+			gbs_free(clone);
+			return NULL;
+		}
+		gbhw->evlog.last = src->evlog.last;
+	}
+	if (gbs->io_cb)
+		gbs_set_io_callback(clone, gbs->io_cb, gbs->io_cb_priv);
+	if (gbs->step_cb)
+		gbs_set_step_callback(clone, gbs->step_cb, gbs->step_cb_priv);
+	if (gbs->sound_cb)
+		gbs_set_sound_callback(clone, gbs->sound_cb, gbs->sound_cb_priv);
+	gbs_set_nextsubsong_cb(clone, gbs->nextsubsong_cb, gbs->nextsubsong_cb_priv);
+	return clone;
+
+exit_free:
+	free(state);
+	gbs_free(clone);
+	return NULL;
+}
+
 struct gbs_internal_api gbs_internal_api = {
 	.version = GBS_VERSION,
 	.get_bootrom = gbs_get_bootrom,
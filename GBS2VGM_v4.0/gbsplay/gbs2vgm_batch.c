@@ -35,6 +35,7 @@
 static long rate = 44100;
 static long fadeout = 3;
 static long silence_timeout = 0;  /* 0 = disabled, no silence detection */
+static enum gbs_idle_skip idle_skip = IDLE_SKIP_OFF;
 
 /* Debug mode */
 static int debug_mode = 0;
@@ -44,13 +45,11 @@ static int register_write_count = 0;
 /* Track NR52 state to avoid redundant writes */
 static int nr52_initialized = 0;
 
-/* Required by gbhw.c */
-int seek_needed = 0;
-
 /* VGM writer */
 static vgm_writer_t *vgm = NULL;
 static uint32_t samples_since_last_write = 0;
 static cycles_t last_write_cycles = 0;  /* Track cycles at last register write */
+static cycles_t event_cycles = 0;  /* Cycle of the last record read from the event log */
 
 /* Game Boy hardware clock */
 #define GB_CLOCK 4194304
@@ -68,11 +67,8 @@ static void sanitize_filename(char *filename) {
 	}
 }
 
-/* IO callback - captures Game Boy register writes with cycle-accurate timing */
-static void io_callback(struct gbs *gbs, cycles_t cycles, uint32_t addr, uint8_t value, void *priv) {
-	(void)gbs;
-	(void)priv;
-
+/* Capture one Game Boy register write with cycle-accurate timing */
+static void capture_write(cycles_t cycles, uint32_t addr, uint8_t value) {
 	if (!vgm)
 		return;
 
@@ -136,6 +132,20 @@ static void io_callback(struct gbs *gbs, cycles_t cycles, uint32_t addr, uint8_t
 	}
 }
 
+/* Capture the register writes logged since the last call, a block at a time */
+static void drain_events(struct gbs *gbs) {
+	struct gbs_event events[1024];
+	long count, i;
+
+	while ((count = gbs_read_events(gbs, events, 1024)) > 0) {
+		for (i = 0; i < count; i++) {
+			event_cycles += events[i].delta;
+			if (events[i].reg != GBS_EVENT_WAIT)
+				capture_write(event_cycles, 0xFF00 | events[i].reg, events[i].value);
+		}
+	}
+}
+
 /* Find file with extension in directory */
 static int find_file_with_ext(const char *dir, const char *ext, char *output, size_t output_size) {
 #ifdef _WIN32
@@ -206,7 +216,7 @@ static int find_file_with_ext(const char *dir, const char *ext, char *output, si
 }
 
 /* Convert track */
-static int convert_track(const char *gbs_filename, struct m3u_entry *entry, int track_num,
+static int convert_track(struct gbs_image *image, const char *gbs_filename, struct m3u_entry *entry, int track_num,
                          const char *game_name, const char *release_date,
                          const char *ripper, const char *notes, const char *output_dir) {
 	struct gbs *gbs;
@@ -216,14 +226,8 @@ static int convert_track(const char *gbs_filename, struct m3u_entry *entry, int
 	const char *author_name = "Unknown";
 	cycles_t total_cycles = 0;
 	cycles_t target_cycles, loop_cycles;
-	long refresh_delay = 33;
-	struct gbs_output_buffer buf;
 	int has_loop = (entry->loop_count > 1);
 
-	buf.data = NULL;
-	buf.bytes = 8192;
-	buf.pos = 0;
-
 	/* Create output filename */
 	snprintf(track_title, sizeof(track_title), "%02d %s", track_num, entry->title);
 	sanitize_filename(track_title);
@@ -231,13 +235,19 @@ static int convert_track(const char *gbs_filename, struct m3u_entry *entry, int
 
 	printf("Converting: %s (subsong %d) -> %s\n", gbs_filename, entry->subsong, track_title);
 
-	/* Open GBS file */
-	gbs = gbs_open(gbs_filename);
+	/* A fresh emulator per track, the ROM and header come from the shared image */
+	gbs = gbs_open_image(image);
 	if (!gbs) {
 		fprintf(stderr, "Failed to open GBS file: %s\n", gbs_filename);
 		return -1;
 	}
 
+	/* Log register writes, they are drained after each run */
+	if (!gbs_set_event_log(gbs, 4096)) {
+		gbs_close(gbs);
+		return -1;
+	}
+
 	/* Get metadata from GBS file */
 	metadata = gbs_get_metadata(gbs);
 	if (metadata && metadata->author && metadata->author[0]) {
@@ -257,6 +267,7 @@ static int convert_track(const char *gbs_filename, struct m3u_entry *entry, int
 
 	samples_since_last_write = 0;
 	last_write_cycles = 0;  /* Reset cycle counter for new track */
+	event_cycles = 0;
 	register_write_count = 0;
 	nr52_initialized = 0;  /* Reset NR52 tracking for new track */
 
@@ -271,19 +282,9 @@ static int convert_track(const char *gbs_filename, struct m3u_entry *entry, int
 		}
 	}
 
-	/* Configure output buffer */
-	buf.data = malloc(buf.bytes);
-	if (!buf.data) {
-		fprintf(stderr, "Failed to allocate output buffer\n");
-		vgm_writer_close(vgm);
-		vgm = NULL;
-		gbs_close(gbs);
-		return -1;
-	}
-	gbs_configure_output(gbs, &buf, rate);
-
-	/* Set up callbacks */
-	gbs_set_io_callback(gbs, io_callback, NULL);
+	/* Only the register writes are needed, skip sound synthesis */
+	gbs_configure_output(gbs, NULL, 0);
+	gbs_set_idle_skip(gbs, idle_skip);
 
 	/* Calculate target duration based on loop_count */
 	/* Strategy:
@@ -306,6 +307,7 @@ static int convert_track(const char *gbs_filename, struct m3u_entry *entry, int
 	long subsong_timeout = (target_cycles / GB_CLOCK) + 5;
 	gbs_configure(gbs, entry->subsong, subsong_timeout, silence_timeout, 0, fadeout);
 	gbs_init(gbs, entry->subsong);
+	drain_events(gbs);
 
 	/* Initialize audio hardware registers at the start of VGM */
 	/* This ensures all channels are enabled even if the GBS doesn't explicitly set them */
@@ -320,14 +322,17 @@ static int convert_track(const char *gbs_filename, struct m3u_entry *entry, int
 	int loop_marked = 0;
 	(void)loop_marked;  /* Suppress unused variable warning */
 
-	/* Render - step through emulation with smaller time steps for better timing precision */
-	/* Use 16.67ms steps (60 Hz) instead of 33ms for more accurate register capture timing */
-	refresh_delay = 17; /* ~60 Hz refresh rate, closer to Game Boy's actual frame rate */
-
+	/* Render - capture only, so run in frames and stop on the exact target cycle */
 	while (total_cycles < target_cycles) {
-		if (!gbs_step(gbs, refresh_delay)) {
+		cycles_t cycles = GB_CLOCK / 60;
+
+		if (cycles > target_cycles - total_cycles)
+			cycles = target_cycles - total_cycles;
+		if (!gbs_run_cycles(gbs, cycles)) {
+			drain_events(gbs);
 			break;
 		}
+		drain_events(gbs);
 
 		/* Get actual cycles from GBS status */
 		const struct gbs_status *status = gbs_get_status(gbs);
@@ -354,7 +359,6 @@ static int convert_track(const char *gbs_filename, struct m3u_entry *entry, int
 	}
 
 	/* Close files */
-	free(buf.data);
 	vgm_writer_close(vgm);
 	vgm = NULL;
 	gbs_close(gbs);
@@ -379,6 +383,8 @@ static void print_usage(const char *progname) {
 	        "\n"
 	        "Options:\n"
 	        "  -d           Enable debug mode (logs all register writes)\n"
+	        "  -i           Fast-forward busy-wait loops of the sound driver\n"
+	        "  -I           Run busy-wait loops, but check that -i would be exact\n"
 	        "  output_dir   Output directory (default: auto-generated)\n"
 	        "\n"
 	        "Examples:\n"
@@ -410,6 +416,12 @@ int main(int argc, char **argv) {
 			debug_mode = 1;
 			printf("Debug mode enabled\n");
 			arg_idx++;
+		} else if (strcmp(argv[arg_idx], "-i") == 0) {
+			idle_skip = IDLE_SKIP_ON;
+			arg_idx++;
+		} else if (strcmp(argv[arg_idx], "-I") == 0) {
+			idle_skip = IDLE_SKIP_VALIDATE;
+			arg_idx++;
 		} else {
 			fprintf(stderr, "Unknown option: %s\n", argv[arg_idx]);
 			print_usage(argv[0]);
@@ -507,6 +519,8 @@ int main(int argc, char **argv) {
 	}
 
 	/* Convert each track */
+	struct gbs_image *image = NULL;
+	char image_path[1024] = "";
 	int max_tracks = debug_mode ? 1 : m3u->entry_count;  /* In debug mode, only convert first track */
 	for (i = 0; i < max_tracks; i++) {
 		struct m3u_entry *entry = &m3u->entries[i];
@@ -514,6 +528,19 @@ int main(int argc, char **argv) {
 		/* Build full GBS path */
 		snprintf(gbs_path, sizeof(gbs_path), "%s%s", m3u_dir, entry->filename);
 
+		/* An M3U normally lists one GBS for all tracks, reopen only when it changes */
+		if (image == NULL || strcmp(gbs_path, image_path) != 0) {
+			if (image)
+				gbs_image_unref(image);
+			image = gbs_image_open(gbs_path);
+			snprintf(image_path, sizeof(image_path), "%s", gbs_path);
+		}
+		if (!image) {
+			fprintf(stderr, "Failed to open GBS file: %s\n", gbs_path);
+			fprintf(stderr, "Failed to convert track %d\n", i + 1);
+			continue;
+		}
+
 		/* Use metadata from filename or M3U */
 		const char *game_name = file_metadata.game_name[0] ? file_metadata.game_name :
 		                        (m3u->title ? m3u->title : "Unknown Game");
@@ -523,11 +550,13 @@ int main(int argc, char **argv) {
 		const char *notes = "gbs2vgm by Claude & Denjhang";
 
 		/* Author name will be read from GBS file in convert_track */
-		if (convert_track(gbs_path, entry, i + 1, game_name, release_date,
+		if (convert_track(image, gbs_path, entry, i + 1, game_name, release_date,
 		                  ripper, notes, output_dir) < 0) {
 			fprintf(stderr, "Failed to convert track %d\n", i + 1);
 		}
 	}
+	if (image)
+		gbs_image_unref(image);
 
 	m3u_free(m3u);
 
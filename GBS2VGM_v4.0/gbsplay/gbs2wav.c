@@ -8,6 +8,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include <getopt.h>
 #include <sys/stat.h>
 
 #include "common.h"
@@ -21,10 +22,9 @@ static long rate = 44100;
 static long fadeout = 3;
 static long silence_timeout = 5;
 static char *filter_type = "dmg";
+static enum gbs_quality quality = QUALITY_DEFAULT;
 static char *output_dir = NULL;
-
-/* Required by gbhw.c */
-int seek_needed = 0;
+static long stems = 0;
 
 /* Output buffer */
 static struct gbs_output_buffer buf = {
@@ -33,13 +33,17 @@ static struct gbs_output_buffer buf = {
 	.pos = 0,
 };
 
+/* Per-channel output for --stems */
+static struct gbs_output_buffer stem_buf[4];
+
 /* WAV file writing */
 static FILE *wav_file = NULL;
+static FILE *stem_file[4];
 static long sample_rate = 44100;
 
 static const uint8_t blank_hdr[44];
 
-static int wav_write_header() {
+static int wav_write_header(FILE *wav_file) {
 	const uint32_t fmt_subchunk_length = 16;
 	const uint16_t audio_format_uncompressed_pcm = 1;
 	const uint16_t num_channels = 2;
@@ -78,41 +82,54 @@ static void sanitize_filename(char *filename) {
 	}
 }
 
-static int open_wav_file(const char *filename) {
-	wav_file = fopen(filename, "wb");
+static FILE *open_wav_file(const char *filename) {
+	FILE *wav_file = fopen(filename, "wb");
 	if (!wav_file) {
 		fprintf(stderr, "Failed to create WAV file: %s\n", filename);
-		return -1;
+		return NULL;
 	}
 
 	/* Write blank header (will be updated later) */
 	fwrite(blank_hdr, sizeof(blank_hdr), 1, wav_file);
-	return 0;
+	return wav_file;
 }
 
-static int close_wav_file() {
+static int close_wav_file(FILE *wav_file) {
 	if (!wav_file)
 		return -1;
 
-	if (wav_write_header()) {
+	if (wav_write_header(wav_file)) {
 		fclose(wav_file);
-		wav_file = NULL;
 		return -1;
 	}
 
 	fclose(wav_file);
-	wav_file = NULL;
 	return 0;
 }
 
-static void audio_callback(struct gbs *gbs, struct gbs_output_buffer *buf, void *priv) {
-	(void)gbs;
-	(void)priv;
+static void close_wav_files(void) {
+	int i;
+
+	close_wav_file(wav_file);
+	wav_file = NULL;
+	for (i = 0; i < 4; i++) {
+		close_wav_file(stem_file[i]);
+		stem_file[i] = NULL;
+	}
+}
+
+/* write the frames the last gbs_render() left in buf and the stems */
+static void write_frames(size_t frames) {
+	int i;
 
 	if (wav_file) {
-		fwrite(buf->data, buf->pos * 2 * sizeof(int16_t), 1, wav_file);
+		fwrite(buf.data, frames * 2 * sizeof(int16_t), 1, wav_file);
+	}
+
+	for (i = 0; stems && i < 4; i++) {
+		if (stem_file[i])
+			fwrite(stem_buf[i].data, frames * 2 * sizeof(int16_t), 1, stem_file[i]);
 	}
-	buf->pos = 0;
 }
 
 static void usage(const char *progname) {
@@ -123,6 +140,8 @@ static void usage(const char *progname) {
 	        "  -r <rate>     Sample rate (default: 44100)\n"
 	        "  -f <seconds>  Fadeout duration (default: 3)\n"
 	        "  -o <dir>      Output directory (default: current directory)\n"
+	        "  -q <quality>  Synthesis quality: draft, default or high (default: default)\n"
+	        "  -s, --stems   Also write one WAV per channel (_ch1.wav to _ch4.wav)\n"
 	        "  -h            Show this help\n"
 	        "\n",
 	        progname);
@@ -130,9 +149,14 @@ static void usage(const char *progname) {
 }
 
 static void parse_args(int argc, char **argv) {
+	static const struct option long_opts[] = {
+		{ "stems", no_argument, NULL, 's' },
+		{ "help",  no_argument, NULL, 'h' },
+		{ NULL, 0, NULL, 0 },
+	};
 	int opt;
 
-	while ((opt = getopt(argc, argv, "r:f:o:h")) != -1) {
+	while ((opt = getopt_long(argc, argv, "r:f:o:q:sh", long_opts, NULL)) != -1) {
 		switch (opt) {
 		case 'r':
 			rate = atol(optarg);
@@ -144,6 +168,19 @@ static void parse_args(int argc, char **argv) {
 		case 'o':
 			output_dir = optarg;
 			break;
+		case 'q':
+			if (strcasecmp(optarg, "draft") == 0)
+				quality = QUALITY_DRAFT;
+			else if (strcasecmp(optarg, "default") == 0)
+				quality = QUALITY_DEFAULT;
+			else if (strcasecmp(optarg, "high") == 0)
+				quality = QUALITY_HIGH;
+			else
+				usage(argv[0]);
+			break;
+		case 's':
+			stems = 1;
+			break;
 		case 'h':
 		default:
 			usage(argv[0]);
@@ -161,12 +198,15 @@ static enum gbs_filter_type parse_filter(const char *filter_name) {
 	return FILTER_DMG;
 }
 
-static int convert_track(const char *gbs_filename, struct m3u_entry *entry, int track_num) {
+static int convert_track(struct gbs_image *image, const char *gbs_filename, struct m3u_entry *entry, int track_num) {
 	struct gbs *gbs;
 	char output_filename[512];
+	char stem_filename[4][512];
 	char track_title[256];
+	struct gbs_output_buffer *stem_bufs[4];
 	long total_samples = 0;
 	long target_samples;
+	int i;
 
 	/* Create output filename */
 	snprintf(track_title, sizeof(track_title), "%02d %s", track_num, entry->title);
@@ -177,11 +217,15 @@ static int convert_track(const char *gbs_filename, struct m3u_entry *entry, int
 	} else {
 		snprintf(output_filename, sizeof(output_filename), "%s.wav", track_title);
 	}
+	for (i = 0; i < 4; i++) {
+		snprintf(stem_filename[i], sizeof(stem_filename[i]), "%.*s_ch%d.wav",
+		         (int)strlen(output_filename) - 4, output_filename, i + 1);
+	}
 
 	printf("Converting: %s (subsong %d) -> %s\n", gbs_filename, entry->subsong, output_filename);
 
-	/* Open GBS file */
-	gbs = gbs_open(gbs_filename);
+	/* New player instance, the parsed file is shared by all tracks */
+	gbs = gbs_open_image(image);
 	if (!gbs) {
 		fprintf(stderr, "Failed to open GBS file: %s\n", gbs_filename);
 		return -1;
@@ -189,9 +233,23 @@ static int convert_track(const char *gbs_filename, struct m3u_entry *entry, int
 
 	/* Configure GBS */
 	buf.data = malloc(buf.bytes);
-	gbs_set_sound_callback(gbs, audio_callback, NULL);
+	gbs_set_quality(gbs, quality);
 	gbs_configure_output(gbs, &buf, rate);
 	gbs_set_filter(gbs, parse_filter(filter_type));
+	for (i = 0; stems && i < 4; i++) {
+		stem_buf[i].data = malloc(buf.bytes);
+		stem_buf[i].bytes = buf.bytes;
+		stem_buf[i].pos = 0;
+		stem_bufs[i] = &stem_buf[i];
+	}
+	if (stems && !gbs_configure_stem_output(gbs, stem_bufs, rate)) {
+		fprintf(stderr, "Failed to configure stem output\n");
+		for (i = 0; i < 4; i++)
+			free(stem_buf[i].data);
+		free(buf.data);
+		gbs_close(gbs);
+		return -1;
+	}
 
 	/* Calculate target duration */
 	target_samples = (entry->duration_sec * rate) + ((entry->duration_ms * rate) / 1000);
@@ -202,24 +260,43 @@ static int convert_track(const char *gbs_filename, struct m3u_entry *entry, int
 	gbs_configure(gbs, entry->subsong, subsong_timeout, silence_timeout, 0, fadeout);
 	gbs_init(gbs, entry->subsong);
 
-	/* Open output WAV file */
-	if (open_wav_file(output_filename) < 0) {
+	/* Open output WAV files */
+	wav_file = open_wav_file(output_filename);
+	for (i = 0; wav_file && stems && i < 4; i++) {
+		stem_file[i] = open_wav_file(stem_filename[i]);
+		if (!stem_file[i]) {
+			close_wav_files();
+			break;
+		}
+	}
+	if (!wav_file) {
+		for (i = 0; stems && i < 4; i++)
+			free(stem_buf[i].data);
 		free(buf.data);
 		gbs_close(gbs);
 		return -1;
 	}
 
-	/* Render audio */
+	/* Render audio, one buffer at a time so the stems hold the same frames */
 	while (total_samples < target_samples) {
-		if (!gbs_step(gbs, 33)) {
+		size_t frames = buf.bytes / (2 * sizeof(int16_t));
+		size_t done;
+
+		if ((long)frames > target_samples - total_samples)
+			frames = target_samples - total_samples;
+		done = gbs_render(gbs, buf.data, frames);
+		write_frames(done);
+		total_samples += done;
+		if (done < frames) {
 			/* Playback ended */
 			break;
 		}
-		total_samples += buf.bytes / (2 * sizeof(int16_t));
 	}
 
 	/* Close files */
-	close_wav_file();
+	close_wav_files();
+	for (i = 0; stems && i < 4; i++)
+		free(stem_buf[i].data);
 	free(buf.data);
 	gbs_close(gbs);
 
@@ -230,6 +307,8 @@ static int convert_track(const char *gbs_filename, struct m3u_entry *entry, int
 int main(int argc, char **argv) {
 	struct m3u_info *m3u;
 	char gbs_path[512];
+	char image_path[512] = "";
+	struct gbs_image *image = NULL;
 	char *m3u_dir;
 	char *m3u_filename;
 	int i;
@@ -282,10 +361,20 @@ int main(int argc, char **argv) {
 		/* Build full GBS path */
 		snprintf(gbs_path, sizeof(gbs_path), "%s/%s", m3u_dir, entry->filename);
 
-		if (convert_track(gbs_path, entry, i + 1) < 0) {
+		/* Keep the parsed image while consecutive tracks use the same file */
+		if (image == NULL || strcmp(gbs_path, image_path) != 0) {
+			if (image)
+				gbs_image_unref(image);
+			image = gbs_image_open(gbs_path);
+			snprintf(image_path, sizeof(image_path), "%s", gbs_path);
+		}
+
+		if (!image || convert_track(image, gbs_path, entry, i + 1) < 0) {
 			fprintf(stderr, "Failed to convert track %d\n", i + 1);
 		}
 	}
+	if (image)
+		gbs_image_unref(image);
 
 	free(m3u_dir);
 	m3u_free(m3u);
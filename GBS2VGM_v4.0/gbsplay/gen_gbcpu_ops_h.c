@@ -0,0 +1,387 @@
+/*
+ * gbsplay is a Gameboy sound player
+ *
+ * gen_gbcpu_ops_h - writes gbcpu_ops.h, one handler per opcode and
+ * per CB opcode with all register and condition operands resolved
+ *
+ * 2026 (C) Licensed under GNU GPL v1 or, at your option, any later version.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "gbcpu_optable.h"
+
+struct opdesc {
+	const char *name;
+	const char *fn;
+};
+
+#define OPDESC(opc, name, fn, cycles_1, cycles_2) { name, #fn },
+
+static const struct opdesc ops[256] = { OPTABLE(OPDESC) };
+
+static const char *r8names[8] = { "B", "C", "D", "E", "H", "L", "[HL]", "A" };
+static const char *r8fields[8] = { "b", "c", "d", "e", "h", "l", NULL, "a" };
+static const char *r16names[4] = { "BC", "DE", "HL", "SP" };
+static const char *condnames[4] = { "NZ", "Z", "NC", "C" };
+/* condition under which a conditional jump/call/ret is NOT taken */
+static const char *condskip[4] = {
+	"flag_z(gbcpu)",
+	"!flag_z(gbcpu)",
+	"flag_c(gbcpu)",
+	"!flag_c(gbcpu)",
+};
+
+static const char *get8(int r)
+{
+	static char buf[8][64];
+
+	if (r == 6)
+		return "mem_get(gbcpu, REGS16_R(gbcpu->regs, HL))";
+	snprintf(buf[r], sizeof(buf[r]), "gbcpu->regs.rn.%s", r8fields[r]);
+	return buf[r];
+}
+
+static void put8(int r, const char *val)
+{
+	if (r == 6)
+		printf("\tmem_put(gbcpu, REGS16_R(gbcpu->regs, HL), %s);\n", val);
+	else
+		printf("\tgbcpu->regs.rn.%s = %s;\n", r8fields[r], val);
+}
+
+static void begin(const char *prefix, int op, const char *name, const char *args)
+{
+	printf("/* %s%02x %s%s%s */\n", prefix[0] == 'c' ? "cb" : "", op,
+	       name, args[0] ? " " : "", args);
+	printf("static inline void gen_%s_%02x(struct gbcpu* const gbcpu)\n{\n", prefix, op);
+}
+
+static void end(void)
+{
+	printf("}\n\n");
+}
+
+static void gen_alu(const char *fn, const char *val)
+{
+	const char *op = NULL, *n = "0", *carry = "";
+
+	if (strcmp(fn, "op_add") == 0 || strcmp(fn, "op_add_imm") == 0) {
+		op = "+";
+	} else if (strcmp(fn, "op_adc") == 0 || strcmp(fn, "op_adc_imm") == 0) {
+		op = "+";
+		carry = " + flag_c(gbcpu)";
+	} else if (strncmp(fn, "op_sub", 6) == 0 || strncmp(fn, "op_cp", 5) == 0) {
+		op = "-";
+		n = "NF";
+	} else if (strncmp(fn, "op_sbc", 6) == 0) {
+		op = "-";
+		n = "NF";
+		carry = " - flag_c(gbcpu)";
+	}
+
+	printf("\tuint8_t val = %s;\n", val);
+	if (op) {
+		/* bit 8 of res is the carry/borrow, bit 4 of a ^ val ^ res the half carry */
+		printf("\tuint32_t res = gbcpu->regs.rn.a %s val%s;\n\n", op, carry);
+		printf("\tflags_alu(gbcpu, res, gbcpu->regs.rn.a ^ val ^ res, %s);\n", n);
+		if (strncmp(fn, "op_cp", 5) != 0)
+			printf("\tgbcpu->regs.rn.a = res;\n");
+	} else {
+		const char *alu = "&";
+		if (strncmp(fn, "op_or", 5) == 0)
+			alu = "|";
+		else if (strncmp(fn, "op_xor", 6) == 0)
+			alu = "^";
+		printf("\n\tgbcpu->regs.rn.a %s= val;\n", alu);
+		printf("\tflags_alu(gbcpu, gbcpu->regs.rn.a, %s, 0);\n", alu[0] == '&' ? "HF >> 1" : "0");
+	}
+}
+
+static int is_alu(const char *fn, int imm)
+{
+	static const char *alu[] = {
+		"op_add", "op_adc", "op_sub", "op_sbc",
+		"op_and", "op_xor", "op_or", "op_cp", NULL
+	};
+	int i;
+
+	for (i = 0; alu[i]; i++) {
+		size_t len = strlen(alu[i]);
+		if (strncmp(fn, alu[i], len) == 0 &&
+		    strcmp(fn + len, imm ? "_imm" : "") == 0)
+			return 1;
+	}
+	return 0;
+}
+
+/* table handlers that read or write F and need it materialized */
+static int uses_f(const char *fn)
+{
+	static const char *f[] = {
+		"op_rlca", "op_rrca", "op_rla", "op_rra", "op_daa",
+		"op_cpl", "op_ccf", "op_scf", "op_push_af", "op_pop_af",
+		"op_ld_hlsp", "op_add_sp_imm", NULL
+	};
+	int i;
+
+	for (i = 0; f[i]; i++)
+		if (strcmp(fn, f[i]) == 0)
+			return 1;
+	return 0;
+}
+
+static void gen_op(int op)
+{
+	const char *name = ops[op].name;
+	const char *fn = ops[op].fn;
+	int r8 = (op >> 3) & 7;
+	int src = op & 7;
+	int r16 = (op >> 4) & 3;
+	int cond = (op >> 3) & 3;
+	char args[32];
+
+	if (strcmp(fn, "op_cbprefix") == 0) {
+		int i;
+
+		/* computed goto keeps this one out of line */
+		printf("/* %02x %s */\n", op, name);
+		printf("static void gen_op_%02x(struct gbcpu* const gbcpu)\n{\n", op);
+		printf("\tuint8_t op = get_imm8(gbcpu);\n\n");
+		printf("\tDISPATCH_BEGIN(cbdispatch,");
+		for (i = 0; i < 256; i++)
+			printf("%sDISPATCH_ADDR(cb_%02x)", (i & 7) ? " " : "\n\t\t", i);
+		printf(", op)\n");
+		for (i = 0; i < 256; i++)
+			printf("\tDISPATCH_TARGET(cb_%02x, 0x%02x): gen_cb_%02x(gbcpu); return;\n", i, i, i);
+		printf("\tDISPATCH_END\n");
+		end();
+		return;
+	}
+
+	if (strcmp(fn, "op_ld") == 0) {
+		snprintf(args, sizeof(args), "%s, %s", r8names[r8], r8names[src]);
+		begin("op", op, name, args);
+		if (r8 == src)
+			printf("\tUNUSED(gbcpu);\n");
+		else
+			put8(r8, get8(src));
+	} else if (strcmp(fn, "op_ld_reg8_imm") == 0) {
+		snprintf(args, sizeof(args), "%s, imm8", r8names[r8]);
+		begin("op", op, name, args);
+		printf("\tuint8_t val = get_imm8(gbcpu);\n\n");
+		put8(r8, "val");
+	} else if (strcmp(fn, "op_inc") == 0 || strcmp(fn, "op_dec") == 0) {
+		int inc = strcmp(fn, "op_inc") == 0;
+		begin("op", op, name, r8names[r8]);
+		printf("\tuint8_t old = %s;\n", get8(r8));
+		printf("\tuint8_t res = old %s 1;\n\n", inc ? "+" : "-");
+		put8(r8, "res");
+		printf("\tflags_keep_c(gbcpu, res, old ^ 1 ^ res, %s);\n", inc ? "0" : "NF");
+	} else if (is_alu(fn, 0)) {
+		snprintf(args, sizeof(args), "A, %s", r8names[src]);
+		begin("op", op, name, args);
+		gen_alu(fn, get8(src));
+	} else if (is_alu(fn, 1)) {
+		begin("op", op, name, "A, imm8");
+		gen_alu(fn, "get_imm8(gbcpu)");
+	} else if (strcmp(fn, "op_inc16") == 0 || strcmp(fn, "op_dec16") == 0) {
+		begin("op", op, name, r16names[r16]);
+		printf("\tREGS16_W(gbcpu->regs, %s, REGS16_R(gbcpu->regs, %s) %s 1);\n",
+		       r16names[r16], r16names[r16], strcmp(fn, "op_inc16") == 0 ? "+" : "-");
+		printf("\tgbcpu->cycles += 4;\n");
+	} else if (strcmp(fn, "op_add_hl") == 0) {
+		snprintf(args, sizeof(args), "HL, %s", r16names[r16]);
+		begin("op", op, name, args);
+		printf("\tuint16_t old = REGS16_R(gbcpu->regs, HL);\n");
+		printf("\tuint16_t new = old + REGS16_R(gbcpu->regs, %s);\n\n", r16names[r16]);
+		printf("\tREGS16_W(gbcpu->regs, HL, new);\n");
+		printf("\tflags_sync(gbcpu);\n");
+		printf("\tgbcpu->regs.rn.f &= ~(NF | CF | HF);\n");
+		printf("\tif (old > new) gbcpu->regs.rn.f |= CF;\n");
+		printf("\tif ((old & 0xfff) > (new & 0xfff)) gbcpu->regs.rn.f |= HF;\n");
+		printf("\tgbcpu->cycles += 4;\n");
+	} else if (strcmp(fn, "op_ld_reg16_imm") == 0) {
+		snprintf(args, sizeof(args), "%s, imm16", r16names[r16]);
+		begin("op", op, name, args);
+		printf("\tREGS16_W(gbcpu->regs, %s, get_imm16(gbcpu));\n", r16names[r16]);
+	} else if (strcmp(fn, "op_ld_reg16_a") == 0) {
+		const char *reg = r16names[r16 - (r16 > 2)];
+		if (op & 8)
+			snprintf(args, sizeof(args), "A, [%s]", reg);
+		else
+			snprintf(args, sizeof(args), "[%s], A", reg);
+		begin("op", op, name, args);
+		printf("\tuint16_t addr = REGS16_R(gbcpu->regs, %s);\n\n", reg);
+		if (op & 8)
+			printf("\tgbcpu->regs.rn.a = mem_get(gbcpu, addr);\n");
+		else
+			printf("\tmem_put(gbcpu, addr, gbcpu->regs.rn.a);\n");
+		if (r16 >= 2)
+			printf("\tREGS16_W(gbcpu->regs, HL, addr %s 1);\n", r16 == 2 ? "+" : "-");
+	} else if (strcmp(fn, "op_ldh") == 0) {
+		const char *ofs = op & 2 ? "gbcpu->regs.rn.c" : "get_imm8(gbcpu)";
+		if (op & 0x10)
+			snprintf(args, sizeof(args), "A, [%s]", op & 2 ? "C" : "imm8");
+		else
+			snprintf(args, sizeof(args), "[%s], A", op & 2 ? "C" : "imm8");
+		begin("op", op, name, args);
+		printf("\tuint32_t ofs = %s;\n\n", ofs);
+		if (op & 0x10)
+			printf("\tgbcpu->regs.rn.a = mem_get(gbcpu, 0xff00 + ofs);\n");
+		else
+			printf("\tmem_put(gbcpu, 0xff00 + ofs, gbcpu->regs.rn.a);\n");
+	} else if (strcmp(fn, "op_push") == 0 || strcmp(fn, "op_pop") == 0) {
+		begin("op", op, name, r16names[r16]);
+		if (strcmp(fn, "op_push") == 0) {
+			printf("\tpush(gbcpu, REGS16_R(gbcpu->regs, %s));\n", r16names[r16]);
+			printf("\tgbcpu->cycles += 4;\n");
+		} else {
+			printf("\tREGS16_W(gbcpu->regs, %s, pop(gbcpu));\n", r16names[r16]);
+		}
+	} else if (strcmp(fn, "op_jr_cond") == 0) {
+		begin("op", op, name, condnames[cond]);
+		printf("\tint16_t ofs = (int8_t) get_imm8(gbcpu);\n\n");
+		printf("\tif (%s) return;\n", condskip[cond]);
+		printf("\tgbcpu->cycles += 4;\n");
+		printf("\tREGS16_W(gbcpu->regs, GBS_PC, REGS16_R(gbcpu->regs, GBS_PC) + ofs);\n");
+	} else if (strcmp(fn, "op_jp_cond") == 0 || strcmp(fn, "op_call_cond") == 0) {
+		begin("op", op, name, condnames[cond]);
+		printf("\tuint16_t ofs = get_imm16(gbcpu);\n\n");
+		printf("\tif (%s) return;\n", condskip[cond]);
+		printf("\tgbcpu->cycles += 4;\n");
+		if (strcmp(fn, "op_call_cond") == 0)
+			printf("\tpush(gbcpu, REGS16_R(gbcpu->regs, GBS_PC));\n");
+		printf("\tREGS16_W(gbcpu->regs, GBS_PC, ofs);\n");
+	} else if (strcmp(fn, "op_ret_cond") == 0) {
+		begin("op", op, name, condnames[cond]);
+		printf("\tgbcpu->cycles += 4;\n");
+		printf("\tif (%s) return;\n", condskip[cond]);
+		printf("\tgbcpu->cycles += 4;\n");
+		printf("\tREGS16_W(gbcpu->regs, GBS_PC, pop(gbcpu));\n");
+	} else if (strcmp(fn, "op_rst") == 0) {
+		snprintf(args, sizeof(args), "0x%02x", op & 0x38);
+		begin("op", op, name, args);
+		printf("\tpush(gbcpu, REGS16_R(gbcpu->regs, GBS_PC));\n");
+		printf("\tREGS16_W(gbcpu->regs, GBS_PC, 0x%02x);\n", op & 0x38);
+		printf("\tgbcpu->cycles += 4;\n");
+	} else {
+		/* no operands encoded in the opcode, reuse the table handler */
+		begin("op", op, name, "");
+		if (uses_f(fn))
+			printf("\tflags_sync(gbcpu);\n");
+		printf("\t%s(gbcpu, 0x%02x, &ops[0x%02x]);\n", fn, op, op);
+	}
+	end();
+}
+
+static void gen_cb(int op)
+{
+	static const char *rotnames[8] = {
+		"RLC", "RRC", "RL", "RR", "SLA", "SRA", "SWAP", "SRL"
+	};
+	static const char *rotres[8] = {
+		"(val << 1) | (val >> 7)",
+		"(val >> 1) | (val << 7)",
+		"(val << 1) | flag_c(gbcpu)",
+		"(val >> 1) | (flag_c(gbcpu) << 7)",
+		"val << 1",
+		"(val >> 1) | (val & 0x80)",
+		"(val >> 4) | (val << 4)",
+		"val >> 1",
+	};
+	/* carry out, becomes bit 8 of the flags_alu result */
+	static const char *rotcarry[8] = {
+		"val >> 7",
+		"val & 1",
+		"val >> 7",
+		"val & 1",
+		"val >> 7",
+		"val & 1",
+		NULL,
+		"val & 1",
+	};
+	int reg = op & 7;
+	int bit = (op >> 3) & 7;
+	char args[32];
+
+	switch (op >> 6) {
+	case 0:
+		begin("cb", op, rotnames[bit], r8names[reg]);
+		printf("\tuint8_t val = %s;\n", get8(reg));
+		printf("\tuint8_t res = %s;\n\n", rotres[bit]);
+		if (rotcarry[bit])
+			printf("\tflags_alu(gbcpu, res | (%s) << 8, 0, 0);\n", rotcarry[bit]);
+		else
+			printf("\tflags_alu(gbcpu, res, 0, 0);\n");
+		put8(reg, "res");
+		break;
+	case 1:
+		snprintf(args, sizeof(args), "%d, %s", bit, r8names[reg]);
+		begin("cb", op, "BIT", args);
+		printf("\tflags_keep_c(gbcpu, %s & 0x%02x, HF >> 1, 0);\n", get8(reg), 1 << bit);
+		break;
+	case 2:
+	case 3:
+		snprintf(args, sizeof(args), "%d, %s", bit, r8names[reg]);
+		begin("cb", op, op & 0x40 ? "SET" : "RES", args);
+		if (reg == 6) {
+			printf("\tuint16_t hl = REGS16_R(gbcpu->regs, HL);\n\n");
+			printf("\tmem_put(gbcpu, hl, mem_get(gbcpu, hl) %s 0x%02x);\n",
+			       op & 0x40 ? "|" : "&",
+			       op & 0x40 ? 1 << bit : ~(1 << bit) & 0xff);
+		} else {
+			printf("\tgbcpu->regs.rn.%s %s= 0x%02x;\n", r8fields[reg],
+			       op & 0x40 ? "|" : "&",
+			       op & 0x40 ? 1 << bit : ~(1 << bit) & 0xff);
+		}
+		break;
+	}
+	end();
+}
+
+/* instruction length in bytes, for the decoded instruction cache */
+static int oplen(int op)
+{
+	static const char *imm8[] = {
+		"op_ld_reg8_imm", "op_add_imm", "op_adc_imm", "op_sub_imm",
+		"op_sbc_imm", "op_and_imm", "op_xor_imm", "op_or_imm",
+		"op_cp_imm", "op_jr", "op_jr_cond", "op_ld_hlsp",
+		"op_add_sp_imm", "op_cbprefix", NULL
+	};
+	static const char *imm16[] = {
+		"op_ld_reg16_imm", "op_ld_imm", "op_ld_ind16_a",
+		"op_ld_ind16_sp", "op_jp", "op_jp_cond", "op_call",
+		"op_call_cond", NULL
+	};
+	const char *fn = ops[op].fn;
+	int i;
+
+	if (strcmp(fn, "op_ldh") == 0)
+		return op & 2 ? 1 : 2;
+	for (i = 0; imm8[i]; i++)
+		if (strcmp(fn, imm8[i]) == 0)
+			return 2;
+	for (i = 0; imm16[i]; i++)
+		if (strcmp(fn, imm16[i]) == 0)
+			return 3;
+	return 1;
+}
+
+int main(int argc, char **argv)
+{
+	int i;
+
+	printf("/* Generated by gen_gbcpu_ops_h, do not edit. */\n\n");
+	printf("static const uint8_t gen_oplen[256] = {");
+	for (i = 0; i < 256; i++)
+		printf("%s%d,", (i & 15) ? " " : "\n\t", oplen(i));
+	printf("\n};\n\n");
+	for (i = 0; i < 256; i++)
+		gen_cb(i);
+	for (i = 0; i < 256; i++)
+		gen_op(i);
+
+	return 0;
+}
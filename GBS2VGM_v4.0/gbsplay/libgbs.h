@@ -46,6 +46,15 @@
  */
 struct gbs;
 
+/**
+ * @struct gbs_image
+ * A parsed GBS file: header, ROM contents, mapper layout and metadata.
+ * Immutable and reference counted, so any number of
+ * @link struct gbs @endlink instances, also on different threads, can
+ * play from one image without reading the file again.
+ */
+struct gbs_image;
+
 /**
  * GBS metadata.  Contains static information about the GBS file like
  * title and copyright.
@@ -67,6 +76,19 @@ struct gbs_output_buffer {
 	long pos;
 };
 
+/**
+ * Register write in the event log, see gbs_set_event_log().  reg is
+ * the IO address minus 0xff00, so 0xff for IE.  A gap of more than
+ * UINT32_MAX cycles is split with GBS_EVENT_WAIT records, which only
+ * carry their delta.
+ */
+struct gbs_event {
+	uint32_t delta;  /* cycles since the previous record */
+	uint8_t reg;
+	uint8_t value;
+};
+#define GBS_EVENT_WAIT 0x80
+
 /**
  * Channel status.  Contains information about the current state of
  * one of the four emulated sound channels.
@@ -118,6 +140,27 @@ enum gbs_filter_type {
 	FILTER_CGB, /**< Gameboy Color high-pass filter */
 };
 
+/**
+ * Idle loop skipping.  Busy-wait loops that only poll memory (e.g. LY
+ * or a flag set by an interrupt handler) can be fast-forwarded to the
+ * point where the polled values may change.
+ */
+enum gbs_idle_skip {
+	IDLE_SKIP_OFF,      /**< run every instruction */
+	IDLE_SKIP_ON,       /**< fast-forward idle loops */
+	IDLE_SKIP_VALIDATE, /**< run idle loops, but check that skipping them would have been exact */
+};
+
+/**
+ * Synthesis quality.  Selects the band-limited impulse used for every
+ * level change, wider impulses cost more per change.
+ */
+enum gbs_quality {
+	QUALITY_DRAFT,   /**< 8 taps, 32 phases: previews and loop checks */
+	QUALITY_DEFAULT, /**< 32 taps, 128 phases */
+	QUALITY_HIGH,    /**< 64 taps, 256 phases: final renders */
+};
+
 //
 //////  typedefs
 //
@@ -188,25 +231,265 @@ typedef long (*gbs_nextsubsong_cb)(struct gbs* const gbs, void *priv);
  * @return an opaque @link struct gbs @endlink to be passed to other functions or NULL on error
  */
 struct gbs *gbs_open(const char* const name);
+/**
+ * Open a GBS file that is already in memory, in any format gbs_open()
+ * supports.  The buffer is borrowed, not copied: it must stay valid
+ * and unchanged until gbs_close().  libgbs never writes to it.
+ *
+ * On error returns NULL.
+ *
+ * @param name  name used in error messages
+ * @param buf   file contents
+ * @param size  size of buf in bytes
+ * @return an opaque @link struct gbs @endlink to be passed to other functions or NULL on error
+ */
+struct gbs *gbs_open_mem(const char* const name, const void* const buf, size_t size);
+/**
+ * Read and parse a file once, for opening several instances with
+ * gbs_open_image().  Supports the same formats as gbs_open().  The
+ * caller holds one reference.
+ *
+ * On error returns NULL.
+ *
+ * @param name  filename to open (optionally including a path)
+ * @return an opaque @link struct gbs_image @endlink or NULL on error
+ */
+struct gbs_image *gbs_image_open(const char* const name);
+/**
+ * Like gbs_image_open() for a file that is already in memory.  The
+ * buffer is borrowed as with gbs_open_mem(), it must stay valid until
+ * the last reference to the image is gone.
+ *
+ * @param name  name used in error messages
+ * @param buf   file contents
+ * @param size  size of buf in bytes
+ * @return an opaque @link struct gbs_image @endlink or NULL on error
+ */
+struct gbs_image *gbs_image_open_mem(const char* const name, const void* const buf, size_t size);
+/**
+ * Take another reference to an image.  Safe to call from any thread.
+ *
+ * @param img  the image
+ * @return img
+ */
+struct gbs_image *gbs_image_ref(struct gbs_image* const img);
+/**
+ * Drop a reference to an image.  The image is freed with the last
+ * reference.  Safe to call from any thread.
+ *
+ * @param img  the image
+ */
+void gbs_image_unref(struct gbs_image* const img);
+/**
+ * Create a player instance for an image, as gbs_open() does for a
+ * file.  The instance holds its own reference until gbs_close(), so
+ * the caller may drop its reference right away.  Only the per-playback
+ * state is allocated, the ROM is shared.
+ *
+ * On error returns NULL.
+ *
+ * @param img  the image to play
+ * @return an opaque @link struct gbs @endlink to be passed to other functions or NULL on error
+ */
+struct gbs *gbs_open_image(struct gbs_image* const img);
 
 void gbs_configure(struct gbs* const gbs, long subsong, long subsong_timeout, long silence_timeout, long subsong_gap, long fadeout);
 void gbs_configure_channels(struct gbs* const gbs, long mute_0, long mute_1, long mute_2, long mute_3);
+/**
+ * Configure sound output.  Sound is rendered into buf at the given
+ * sample rate and passed to the sound callback whenever it is full.
+ * With buf == NULL no sound is synthesized at all, for users that only
+ * need the IO or step callbacks.  Register writes, the channel
+ * status and silence detection are the same as with sound output.
+ *
+ * @param gbs   the gbs instance to configure
+ * @param buf   output buffer or NULL for register capture only
+ * @param rate  sample rate in Hz, ignored without buf
+ */
 void gbs_configure_output(struct gbs* const gbs, struct gbs_output_buffer *buf, long rate);
+/**
+ * Configure stem output.  Each channel is additionally rendered as
+ * its own stereo stream into bufs[channel], in the same pass as the
+ * mix.  A stem sounds like the mix with the other three channels
+ * muted, channel mutes only apply to the mix.  The stems are full
+ * whenever the sound callback runs.
+ *
+ * All four buffers must have the size of the output buffer.  Without
+ * an output buffer the mix is rendered to an internal one, which is
+ * then what the sound callback receives.
+ *
+ * @param gbs   the gbs instance to configure
+ * @param bufs  four stem buffers or NULL to turn stem output off
+ * @param rate  sample rate in Hz for the mix and the stems
+ * @return 1 on success, 0 on mismatched buffer sizes or allocation failure
+ */
+long gbs_configure_stem_output(struct gbs* const gbs, struct gbs_output_buffer *bufs[4], long rate);
 const struct gbs_metadata *gbs_get_metadata(struct gbs* const gbs);
 long gbs_init(struct gbs* const gbs, long subsong);
 uint8_t gbs_io_peek(const struct gbs* const gbs, uint16_t addr);
 const struct gbs_status* gbs_get_status(struct gbs* const gbs);
 long gbs_step(struct gbs* const gbs, long time_to_work);
+/**
+ * Run the emulation for a number of CPU cycles, e.g. to capture
+ * register writes with the output unconfigured.  An instruction that
+ * straddles the end completes and the overshoot is taken off the next
+ * call, so consecutive calls add up to the cycles requested.
+ *
+ * @param gbs     the gbs instance to run
+ * @param cycles  CPU cycles to run, at GBHW_CLOCK Hz
+ * @return false once playback has ended, like gbs_step()
+ */
+long gbs_run_cycles(struct gbs* const gbs, cycles_t cycles);
+/**
+ * Render exactly the given number of stereo frames into out.  Unlike
+ * gbs_step() the sound callback is not called: the samples go straight
+ * to out, in chunks of at most the buffer passed to
+ * gbs_configure_output(), which also sets the rate.  The samples do
+ * not depend on how the frames are split into calls, they match what
+ * gbs_step() passes to the callback.  Stem and per-voice output hold
+ * the last chunk when it returns.
+ *
+ * @param gbs     the gbs instance to render
+ * @param out     room for frames interleaved left/right samples
+ * @param frames  number of frames to render
+ * @return frames rendered, fewer than requested only if playback ended
+ *         or no output is configured
+ */
+size_t gbs_render(struct gbs* const gbs, int16_t *out, size_t frames);
 void gbs_set_nextsubsong_cb(struct gbs* const gbs, gbs_nextsubsong_cb cb, void *priv);
 void gbs_set_io_callback(struct gbs* const gbs, gbs_io_cb fn, void *priv);
+/**
+ * Log IO register writes to a ring buffer instead of, or as well as,
+ * the IO callback.  The records are delta coded in emulated cycles,
+ * starting when the log is enabled.  Unlike the cycles the IO callback
+ * sees they do not restart with gbs_init(), and gbs_load_state() does
+ * not count as time passing.  The ring grows when a step writes more
+ * than it holds, read it with gbs_read_events() after each gbs_step()
+ * or gbs_run_cycles().  Off by default.
+ *
+ * @param gbs       the gbs instance to configure
+ * @param capacity  initial number of records, 0 to stop logging
+ * @return 1 on success, 0 if the log could not be allocated
+ */
+long gbs_set_event_log(struct gbs* const gbs, long capacity);
+/**
+ * Move the oldest logged register writes out of the event log.
+ *
+ * @param gbs  the gbs instance to read from
+ * @param out  room for max records
+ * @param max  maximum number of records to read
+ * @return number of records read, 0 once the log is empty
+ */
+long gbs_read_events(struct gbs* const gbs, struct gbs_event *out, long max);
 void gbs_set_step_callback(struct gbs* const gbs, gbs_step_cb fn, void *priv);
 void gbs_set_sound_callback(struct gbs* const gbs, gbs_sound_cb fn, void *priv);
 long gbs_set_filter(struct gbs* const gbs, enum gbs_filter_type type);
+/**
+ * Select the synthesis quality, see enum gbs_quality.  A different
+ * impulse width needs a new impulse buffer, so changing the quality
+ * drops the output still pending in it: samples not yet passed to the
+ * sound callback and the stem and per-voice output.  Selecting the
+ * current quality again does nothing.  QUALITY_DEFAULT initially.
+ *
+ * @param gbs      the gbs instance to configure
+ * @param quality  the quality to synthesize at
+ * @return 1 on success, 0 if quality is invalid or its impulse table
+ *         could not be allocated
+ */
+long gbs_set_quality(struct gbs* const gbs, enum gbs_quality quality);
+/**
+ * Enable per-voice output.  Besides the mix, each of the 4 channels
+ * is then rendered on its own as 8 bit mono, e.g. for oscilloscope
+ * views.  Off by default.
+ *
+ * @param gbs     the gbs instance to configure
+ * @param enable  1 to render per-voice output, 0 to stop
+ * @return 1 on success, 0 if the voice buffers could not be allocated
+ */
+long gbs_set_voices(struct gbs* const gbs, long enable);
+/**
+ * Per-voice output of the last full sound buffer, valid inside the
+ * sound callback until the next one.  Holds as many samples as the
+ * output buffer has stereo frames.
+ *
+ * @param gbs      the gbs instance
+ * @param channel  channel 0-3
+ * @return the samples or NULL if per-voice output is disabled
+ */
+const int8_t *gbs_get_voice(const struct gbs* const gbs, long channel);
+/**
+ * Fast-forward idle loops.  A loop that waits for an interrupt and
+ * returns to the same registers on every pass is run once to measure
+ * it, then skipped up to the next event.  Register writes and samples
+ * stay the same as with IDLE_SKIP_OFF.  IDLE_SKIP_VALIDATE runs the
+ * loops anyway and warns once on stderr if a skip would have ended in
+ * a different state.  IDLE_SKIP_OFF by default.
+ *
+ * @param gbs   the gbs instance to configure
+ * @param mode  see enum gbs_idle_skip
+ */
+void gbs_set_idle_skip(struct gbs* const gbs, enum gbs_idle_skip mode);
+/**
+ * Start of the current silence.  The APU is silent while no channel
+ * is running with its DAC on, a non-zero volume and an output routed
+ * in NR51.  This follows the channel state, so it is exact to the
+ * cycle and works without sound output as well.  Channel mutes do not
+ * count.  Used for the silence timeout of gbs_configure().
+ *
+ * @param gbs  the gbs instance
+ * @return ticks (see gbs_status) at which the silence began or -1
+ *         while a channel is audible
+ */
+long long gbs_get_silence_start(const struct gbs* const gbs);
 void gbs_set_loop_mode(struct gbs* const gbs, enum gbs_loop_mode mode);
 void gbs_cycle_loop_mode(struct gbs* const gbs);
 long gbs_toggle_mute(struct gbs* const gbs, long channel);
 void gbs_close(struct gbs* const gbs);
 long gbs_write(const struct gbs* const gbs, const char* const name);
+
+/**
+ * Save machine state.  Serializes CPU, memory, sound hardware, mapper
+ * and the pending output of a running gbs into a versioned binary
+ * blob that gbs_load_state() can restore on the same GBS file.
+ * Like snprintf(), the full size is returned even if buf is too
+ * small, so gbs_save_state(gbs, NULL, 0) queries the size.
+ *
+ * @param gbs  the gbs instance to snapshot
+ * @param buf  buffer to store the state in or NULL
+ * @param len  size of buf in bytes
+ * @return size of the state in bytes, the state is complete if this is <= len
+ */
+long gbs_save_state(struct gbs* const gbs, void *buf, long len);
+
+/**
+ * Restore machine state.  Playback continues exactly where
+ * gbs_save_state() was called.  Configuration like the output buffer,
+ * callbacks, timeouts and channel mutes is kept.  Pending output is
+ * only restored if the output is configured the same way.
+ *
+ * @param gbs  the gbs instance to restore, opened from the same file
+ * @param buf  state returned by gbs_save_state()
+ * @param len  size of the state in bytes
+ * @return 1 on success, 0 if the state does not fit this instance
+ */
+long gbs_load_state(struct gbs* const gbs, const void *buf, long len);
+
+/**
+ * Fork an instance.  The clone shares the image and starts with an
+ * identical CPU, sound hardware and mapper state, configuration,
+ * channel mutes and callbacks, so it plays on exactly as gbs would.
+ * Only the mutable machine state is copied.  If gbs has an output
+ * buffer, the clone renders into a private one of the same size and
+ * rate until gbs_configure_output() sets another.  Stem output is not
+ * cloned.
+ *
+ * On error returns NULL.
+ *
+ * @param gbs  the gbs instance to fork
+ * @return an independent @link struct gbs @endlink or NULL on error
+ */
+struct gbs *gbs_clone(struct gbs* const gbs);
+
 //YOYOFR
 long gbs_toggle_setmute(struct gbs* const gbs, long channel,long muteval);
 void gbs_set_default_length(struct gbs* const gbs, long length);
@@ -4,6 +4,7 @@
 #include "common.h"
 #include "gbcpu.h"
 #include "mapper.h"
+#include "savestate.h"
 
 #define MAPPER_ROMBANK_SIZE 0x4000
 #define MAPPER_ROMBANK_MASK (MAPPER_ROMBANK_SIZE - 1)
@@ -17,6 +18,9 @@ struct bank {
 	uint32_t mask;
 	uint32_t banksize;
 	long enable;
+	long writable;
+	long bank;
+	uint32_t page;
 	struct mapper *mapper;
 };
 
@@ -25,6 +29,7 @@ struct mbc1_regs {
 };
 
 struct mapper {
+	struct gbcpu *gbcpu;
 	const uint8_t *rom;
 	size_t rom_size;
 	size_t ram_size;
@@ -55,6 +60,9 @@ static struct mapper *mapper_new(const uint8_t *rom, size_t rom_size, size_t ram
 	bank_init(&m->rom_lower, m, MAPPER_ROMBANK_SIZE);
 	bank_init(&m->rom_upper, m, MAPPER_ROMBANK_SIZE);
 	bank_init(&m->extram, m, MAPPER_RAMBANK_SIZE);
+	m->rom_upper.page = 0x40;
+	m->extram.page = 0xa0;
+	m->extram.writable = 1;
 	m->extram.enable = 0;
 	return m;
 }
@@ -73,16 +81,48 @@ static void mapper_map(struct bank *b, uint8_t *data, size_t size, long bank)
 	b->size = size - ofs;
 }
 
+/*
+ * Point the CPU pages of the bank at its current data, so that plain
+ * loads and stores skip bank_get/bank_put, and tell it which ROM bank
+ * its code pages hold.  Pages that are disabled, only partially backed
+ * or taken over by someone else (e.g. the boot ROM) keep the callbacks.
+ */
+static void bank_update_pages(struct bank *b)
+{
+	struct mapper *m = b->mapper;
+	struct gbcpu *gbcpu = m->gbcpu;
+	uint32_t ofs;
+
+	if (gbcpu == NULL)
+		return;
+	for (ofs = 0; ofs < b->banksize; ofs += 0x100) {
+		uint32_t page = b->page + (ofs >> 8);
+		uint8_t *mem = NULL;
+
+		if (gbcpu->getlookup[page].priv != b)
+			continue;
+		if (b->data != NULL && b->enable && ofs + 0x100 <= b->size)
+			mem = b->data + ofs;
+		gbcpu_map_direct(gbcpu, page, page, mem, b->writable ? mem : NULL);
+		gbcpu_set_codebank(gbcpu, page, page,
+		                   b->data && !b->writable ? b->bank : -1);
+	}
+}
+
 static void mapper_map_rom(struct bank *b, long bank)
 {
 	struct mapper *m = b->mapper;
 	mapper_map(b, (uint8_t*)m->rom, m->rom_size, bank);
+	b->bank = bank;
+	bank_update_pages(b);
 }
 
 static void mapper_map_ram(struct bank *b, long bank)
 {
 	struct mapper *m = b->mapper;
 	mapper_map(b, m->ram, m->ram_size, bank);
+	b->bank = bank;
+	bank_update_pages(b);
 }
 
 static uint32_t bank_get(void *priv, uint32_t addr)
@@ -179,15 +219,29 @@ static void mbc3_rom_put(void *priv, uint32_t addr, uint8_t val)
 	mapper_map_ram(&m->extram, rambank);
 }
 
+static void mapper_add_rom(struct mapper *m, struct gbcpu *gbcpu, gbcpu_put_fn rom_put)
+{
+	gbcpu_add_mem(gbcpu, 0x00, 0x3f, rom_put, bank_get, &m->rom_lower);
+	gbcpu_add_mem(gbcpu, 0x40, 0x7f, rom_put, bank_get, &m->rom_upper);
+	m->gbcpu = gbcpu;
+	bank_update_pages(&m->rom_lower);
+	bank_update_pages(&m->rom_upper);
+}
+
+static void mapper_add_ram(struct mapper *m, struct gbcpu *gbcpu)
+{
+	gbcpu_add_mem(gbcpu, 0xa0, 0xbf, bank_put, bank_get, &m->extram);
+	bank_update_pages(&m->extram);
+}
+
 struct mapper *mapper_gbs(struct gbcpu *gbcpu, const uint8_t *rom, size_t size) {
 	struct mapper *m = mapper_new(rom, size, MAPPER_RAMBANK_SIZE);
 	m->extram.enable = 1;
 	mapper_map_rom(&m->rom_lower, 0);
 	mapper_map_rom(&m->rom_upper, 1);
 	mapper_map_ram(&m->extram, 0);
-	gbcpu_add_mem(gbcpu, 0x00, 0x3f, gbs_rom_put, bank_get, &m->rom_lower);
-	gbcpu_add_mem(gbcpu, 0x40, 0x7f, gbs_rom_put, bank_get, &m->rom_upper);
-	gbcpu_add_mem(gbcpu, 0xa0, 0xbf, bank_put, bank_get, &m->extram);
+	mapper_add_rom(m, gbcpu, gbs_rom_put);
+	mapper_add_ram(m, gbcpu);
 	return m;
 }
 
@@ -196,17 +250,13 @@ struct mapper *mapper_gbr(struct gbcpu *gbcpu, const uint8_t *rom, size_t size,
 	mapper_map_rom(&m->rom_lower, bank_lower);
 	mapper_map_rom(&m->rom_upper, bank_upper);
 	mapper_map_ram(&m->extram, 0);
-	gbcpu_add_mem(gbcpu, 0x00, 0x3f, gbs_rom_put, bank_get, &m->rom_lower);
-	gbcpu_add_mem(gbcpu, 0x40, 0x7f, gbs_rom_put, bank_get, &m->rom_upper);
-	gbcpu_add_mem(gbcpu, 0xa0, 0xbf, bank_put, bank_get, &m->extram);
+	mapper_add_rom(m, gbcpu, gbs_rom_put);
+	mapper_add_ram(m, gbcpu);
 	return m;
 }
 
-struct mapper *mapper_gb(struct gbcpu *gbcpu, const uint8_t *rom, size_t size, uint8_t cart_type, uint8_t rom_type, uint8_t ram_type) {
-	struct mapper *m;
-	size_t ram_size = 0;
-	gbcpu_put_fn rom_put = mbc1_rom_put;
-
+static gbcpu_put_fn mbc_rom_put(uint8_t cart_type)
+{
 	switch (cart_type) {
 	case 0x00:  /* ROM only */
 	case 0x01:  /* MBC1 */
@@ -214,15 +264,27 @@ struct mapper *mapper_gb(struct gbcpu *gbcpu, const uint8_t *rom, size_t size, u
 	case 0x03:  /* MBC1+RAM+BAT */
 	case 0x08:  /* ROM+RAM */
 	case 0x09:  /* ROM+RAM+BAT */
-		break;
+		return mbc1_rom_put;
 	case 0x11:  /* MBC3 */
 	case 0x12:  /* MBC3+RAM */
 	case 0x13:  /* MBC3+RAM+BAT (e.g. Pokemon) */
-		rom_put = mbc3_rom_put;
-		break;
+		return mbc3_rom_put;
 	/* TODO: Implement more mappers */
 	default: return NULL;
 	}
+}
+
+long mapper_gb_supported(uint8_t cart_type) {
+	return mbc_rom_put(cart_type) != NULL;
+}
+
+struct mapper *mapper_gb(struct gbcpu *gbcpu, const uint8_t *rom, size_t size, uint8_t cart_type, uint8_t rom_type, uint8_t ram_type) {
+	struct mapper *m;
+	size_t ram_size = 0;
+	gbcpu_put_fn rom_put = mbc_rom_put(cart_type);
+
+	if (rom_put == NULL)
+		return NULL;
 
 	switch (ram_type) {
 	default: break;  /* No RAM */
@@ -236,17 +298,45 @@ struct mapper *mapper_gb(struct gbcpu *gbcpu, const uint8_t *rom, size_t size, u
 
 	mapper_map_rom(&m->rom_lower, 0);
 	mapper_map_rom(&m->rom_upper, 1);
-	gbcpu_add_mem(gbcpu, 0x00, 0x3f, rom_put, bank_get, &m->rom_lower);
-	gbcpu_add_mem(gbcpu, 0x40, 0x7f, rom_put, bank_get, &m->rom_upper);
+	mapper_add_rom(m, gbcpu, rom_put);
 
 	if (ram_size > 0) {
 		mapper_map_ram(&m->extram, 0);
-		gbcpu_add_mem(gbcpu, 0xa0, 0xbf, bank_put, bank_get, &m->extram);
+		mapper_add_ram(m, gbcpu);
 	}
 
 	return m;
 }
 
+void mapper_save_state(const struct mapper *m, struct savestate *s) {
+	state_put_mem(s, m->mbc1.reg, sizeof(m->mbc1.reg));
+	state_put_long(s, m->rom_lower.bank);
+	state_put_long(s, m->rom_upper.bank);
+	state_put_long(s, m->extram.bank);
+	state_put(s, m->extram.enable, 1);
+	state_put(s, m->ram_size, 4);
+	state_put_mem(s, m->ram, m->ram_size);
+}
+
+long mapper_load_state(struct mapper *m, struct savestate *s) {
+	long lower, upper, ram;
+
+	state_get_mem(s, m->mbc1.reg, sizeof(m->mbc1.reg));
+	lower = state_get_long(s);
+	upper = state_get_long(s);
+	ram = state_get_long(s);
+	m->extram.enable = state_get(s, 1);
+	if (state_get(s, 4) != m->ram_size)
+		return 0;
+	state_get_mem(s, m->ram, m->ram_size);
+
+	mapper_map_rom(&m->rom_lower, lower);
+	mapper_map_rom(&m->rom_upper, upper);
+	if (m->ram_size > 0)
+		mapper_map_ram(&m->extram, ram);
+	return 1;
+}
+
 void mapper_free(struct mapper *m) {
 	free(m);
 }
@@ -13,11 +13,15 @@
 
 struct gbcpu;
 struct mapper;
+struct savestate;
 
 struct mapper *mapper_gbs(struct gbcpu *gbcpu, const uint8_t *rom, size_t size);
 struct mapper *mapper_gbr(struct gbcpu *gbcpu, const uint8_t *rom, size_t size, uint8_t bank_lower, uint8_t bank_upper);
 struct mapper *mapper_gb(struct gbcpu *gbcpu, const uint8_t *rom, size_t size, uint8_t cart_type, uint8_t rom_type, uint8_t ram_type);
+long mapper_gb_supported(uint8_t cart_type);
 void mapper_lockout(struct mapper *m);
+void mapper_save_state(const struct mapper *m, struct savestate *s);
+long mapper_load_state(struct mapper *m, struct savestate *s);
 void mapper_free(struct mapper *m);
 
 #endif
@@ -0,0 +1,108 @@
+/*
+ * gbsplay is a Gameboy sound player
+ *
+ * Helpers to (de)serialize the machine state, see gbs_save_state()
+ *
+ * 2026 (C) Licensed under GNU GPL v1 or, at your option, any later version.
+ */
+
+#ifndef _SAVESTATE_H_
+#define _SAVESTATE_H_
+
+#include <inttypes.h>
+#include <string.h>
+
+#define GBS_STATE_MAGIC   "GBSS"
+#define GBS_STATE_VERSION 4
+
+/*
+ * Values are stored little endian with a fixed width.  Writes beyond
+ * len only advance pos, so a pass with a NULL buffer yields the size.
+ * Reads beyond len return zeroes and set overrun.
+ */
+struct savestate {
+	uint8_t *out;
+	const uint8_t *in;
+	long len;
+	long pos;
+	long overrun;
+};
+
+static inline void state_put(struct savestate *s, uint64_t val, long bytes)
+{
+	long i;
+
+	for (i = 0; i < bytes; i++, val >>= 8) {
+		if (s->out && s->pos + i < s->len)
+			s->out[s->pos + i] = val & 0xff;
+	}
+	s->pos += bytes;
+}
+
+static inline uint64_t state_get(struct savestate *s, long bytes)
+{
+	uint64_t val = 0;
+	long i;
+
+	if (s->pos + bytes > s->len) {
+		s->overrun = 1;
+		s->pos = s->len;
+		return 0;
+	}
+	for (i = bytes - 1; i >= 0; i--)
+		val = val << 8 | s->in[s->pos + i];
+	s->pos += bytes;
+	return val;
+}
+
+static inline void state_put_mem(struct savestate *s, const void *mem, long bytes)
+{
+	if (s->out && s->pos + bytes <= s->len)
+		memcpy(s->out + s->pos, mem, bytes);
+	s->pos += bytes;
+}
+
+static inline void state_get_mem(struct savestate *s, void *mem, long bytes)
+{
+	if (s->pos + bytes > s->len) {
+		s->overrun = 1;
+		s->pos = s->len;
+		memset(mem, 0, bytes);
+		return;
+	}
+	memcpy(mem, s->in + s->pos, bytes);
+	s->pos += bytes;
+}
+
+static inline void state_skip(struct savestate *s, long bytes)
+{
+	if (s->pos + bytes > s->len) {
+		s->overrun = 1;
+		s->pos = s->len;
+		return;
+	}
+	s->pos += bytes;
+}
+
+/* counters and levels that fit 32 bits, stored as two's complement */
+static inline void state_put_long(struct savestate *s, long val)
+{
+	state_put(s, (uint32_t)val, 4);
+}
+
+static inline long state_get_long(struct savestate *s)
+{
+	return (int32_t)state_get(s, 4);
+}
+
+static inline void state_put_s64(struct savestate *s, int64_t val)
+{
+	state_put(s, (uint64_t)val, 8);
+}
+
+static inline int64_t state_get_s64(struct savestate *s)
+{
+	return (int64_t)state_get(s, 8);
+}
+
+#endif
@@ -0,0 +1,167 @@
+/*
+ * gbsplay is a Gameboy sound player
+ *
+ * Checks that gbs_render() produces the same samples as gbs_step()
+ * whatever the chunk sizes it is called with, and that the cycles
+ * passed to gbs_run_cycles() add up to the ticks in gbs_status.
+ *
+ * 2026 (C) Licensed under GNU GPL v1 or, at your option, any later version.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common.h"
+#include "libgbs.h"
+
+#define RATE    44100
+#define SECONDS 4
+
+/* a conditional CALL is the longest instruction */
+#define MAX_INSN_CYCLES 24
+
+struct run {
+	struct gbs *gbs;
+	struct gbs_output_buffer buf;
+	int16_t data[2048];
+	long frames;
+	uint64_t hash;
+};
+
+static uint64_t fnv1a(uint64_t hash, const void *data, long bytes)
+{
+	const uint8_t *p = data;
+
+	while (bytes--) {
+		hash ^= *p++;
+		hash *= 0x100000001b3ULL;
+	}
+	return hash;
+}
+
+static void sound_cb(struct gbs* const gbs, struct gbs_output_buffer *buf, void *priv)
+{
+	struct run *run = priv;
+
+	run->hash = fnv1a(run->hash, buf->data, buf->pos * 2 * sizeof(int16_t));
+	run->frames += buf->pos;
+	buf->pos = 0;
+}
+
+static long start(struct run *run, struct gbs_image *image, long subsong, long output)
+{
+	run->frames = 0;
+	run->hash = 0xcbf29ce484222325ULL;
+	run->gbs = gbs_open_image(image);
+	if (run->gbs == NULL)
+		return 0;
+	run->buf.data = run->data;
+	run->buf.bytes = sizeof(run->data);
+	run->buf.pos = 0;
+	gbs_set_sound_callback(run->gbs, sound_cb, run);
+	if (output)
+		gbs_configure_output(run->gbs, &run->buf, RATE);
+	else
+		gbs_configure_output(run->gbs, NULL, 0);
+	gbs_configure(run->gbs, subsong, SECONDS * 2, 0, 0, 0);
+	return gbs_init(run->gbs, subsong);
+}
+
+/* render the frames gbs_step() produced, in chunks of varying odd size */
+static long render_matches(struct run *ref, struct run *run)
+{
+	static const size_t chunks[] = { 1, 7, 333, 2047, 4099, 15 };
+	int16_t *out = malloc(4099 * 2 * sizeof(int16_t));
+	uint64_t hash = 0xcbf29ce484222325ULL;
+	long left = ref->frames;
+	long i = 0;
+
+	while (left > 0) {
+		size_t n = chunks[i++ % (sizeof(chunks) / sizeof(chunks[0]))];
+		size_t done;
+
+		if (n > (size_t)left)
+			n = left;
+		done = gbs_render(run->gbs, out, n);
+		hash = fnv1a(hash, out, done * 2 * sizeof(int16_t));
+		left -= done;
+		if (done != n)
+			break;
+	}
+	free(out);
+	if (left != 0) {
+		fprintf(stderr, "gbs_render stopped %ld frames early\n", left);
+		return 0;
+	}
+	return hash == ref->hash;
+}
+
+/* odd cycle counts, so that most calls end inside an instruction */
+static long cycles_match(struct run *run)
+{
+	long long sum = 0;
+	long i;
+
+	for (i = 0; sum < SECONDS * 4194304LL; i++) {
+		cycles_t cycles = 1 + (i * 7919) % 20011;
+		long long ticks;
+
+		if (!gbs_run_cycles(run->gbs, cycles)) {
+			fprintf(stderr, "playback ended after %lld cycles\n", sum);
+			return 0;
+		}
+		sum += cycles;
+		ticks = gbs_get_status(run->gbs)->ticks;
+		if (ticks < sum || ticks - sum >= MAX_INSN_CYCLES) {
+			fprintf(stderr, "%lld ticks after %lld cycles\n", ticks, sum);
+			return 0;
+		}
+	}
+	return 1;
+}
+
+int main(int argc, char **argv)
+{
+	const char *filename = "examples/nightmode.gbs";
+	struct run ref, a, b;
+	struct gbs_image *image;
+	long failed = 0;
+
+	if (argc > 1)
+		filename = argv[1];
+
+	image = gbs_image_open(filename);
+	if (image == NULL) {
+		fprintf(stderr, "%s: gbs_image_open failed\n", argv[0]);
+		exit(2);
+	}
+	if (!start(&ref, image, 0, 1) || !start(&a, image, 0, 1) ||
+	    !start(&b, image, 0, 0)) {
+		fprintf(stderr, "%s: gbs_init failed\n", argv[0]);
+		exit(2);
+	}
+
+	while (ref.frames < SECONDS * RATE && gbs_step(ref.gbs, 16));
+	if (ref.frames == 0) {
+		fprintf(stderr, "%s: no output from gbs_step\n", argv[0]);
+		failed = 1;
+	}
+	if (!render_matches(&ref, &a)) {
+		fprintf(stderr, "%s: gbs_render samples differ from gbs_step\n", argv[0]);
+		failed = 1;
+	}
+	if (!cycles_match(&b)) {
+		fprintf(stderr, "%s: gbs_run_cycles does not add up to ticks\n", argv[0]);
+		failed = 1;
+	}
+
+	gbs_close(ref.gbs);
+	gbs_close(a.gbs);
+	gbs_close(b.gbs);
+	gbs_image_unref(image);
+	if (failed)
+		exit(1);
+	printf("render and cycle counts ok\n");
+	return 0;
+}
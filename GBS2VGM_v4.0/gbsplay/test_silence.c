@@ -0,0 +1,149 @@
+/*
+ * gbsplay is a Gameboy sound player
+ *
+ * Plays a note that ends after its length counter runs out, once with
+ * sound output and once with gbs_configure_output(gbs, NULL, 0), and
+ * checks that the silence timeout fires at the same tick in both.
+ *
+ * 2026 (C) Licensed under GNU GPL v1 or, at your option, any later version.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common.h"
+#include "libgbs.h"
+
+#define RATE    44100
+#define CLOCK   4194304
+#define TIMEOUT 1
+#define LOAD    0x400
+
+/* NR52, NR50, NR51 on, then channel 1 for 64 length counter ticks */
+static const uint8_t regs[][2] = {
+	{ 0x26, 0x80 }, { 0x24, 0x77 }, { 0x25, 0xff },
+	{ 0x10, 0x00 }, { 0x11, 0x80 }, { 0x12, 0xf0 }, { 0x13, 0xd6 }, { 0x14, 0xc6 },
+};
+
+struct run {
+	struct gbs *gbs;
+	struct gbs_output_buffer buf;
+	int16_t data[2048];
+	long long silence_start;
+	long long ticks;
+};
+
+static void put16(uint8_t *p, long v)
+{
+	p[0] = v & 0xff;
+	p[1] = v >> 8;
+}
+
+/* GBS header, then an init routine of LDH writes and a play routine */
+static long make_gbs(uint8_t *gbs)
+{
+	long pos = 0x70;
+	long i;
+
+	memset(gbs, 0, pos);
+	memcpy(gbs, "GBS", 3);
+	gbs[3] = 1;  /* version */
+	gbs[4] = 1;  /* songs */
+	gbs[5] = 1;  /* first song */
+	put16(&gbs[6], LOAD);
+	put16(&gbs[8], LOAD);
+	put16(&gbs[12], 0xfffe);
+	for (i = 0; i < (long)(sizeof(regs) / sizeof(regs[0])); i++) {
+		gbs[pos++] = 0x3e;  /* LD A,n */
+		gbs[pos++] = regs[i][1];
+		gbs[pos++] = 0xe0;  /* LDH (n),A */
+		gbs[pos++] = regs[i][0];
+	}
+	gbs[pos++] = 0xc9;  /* RET from init */
+	put16(&gbs[10], LOAD + pos - 0x70);
+	gbs[pos++] = 0xc9;  /* RET from play */
+	return pos;
+}
+
+static void sound_cb(struct gbs* const gbs, struct gbs_output_buffer *buf, void *priv)
+{
+	buf->pos = 0;
+}
+
+static long nextsubsong_cb(struct gbs* const gbs, void *priv)
+{
+	struct run *run = priv;
+
+	run->silence_start = gbs_get_silence_start(gbs);
+	run->ticks = gbs_get_status(gbs)->ticks;
+	return false;
+}
+
+static long play(struct run *run, struct gbs_image *image, long output)
+{
+	run->silence_start = -1;
+	run->ticks = -1;
+	run->gbs = gbs_open_image(image);
+	if (run->gbs == NULL)
+		return 0;
+	run->buf.data = run->data;
+	run->buf.bytes = sizeof(run->data);
+	run->buf.pos = 0;
+	gbs_set_sound_callback(run->gbs, sound_cb, run);
+	gbs_set_nextsubsong_cb(run->gbs, nextsubsong_cb, run);
+	if (output)
+		gbs_configure_output(run->gbs, &run->buf, RATE);
+	else
+		gbs_configure_output(run->gbs, NULL, 0);
+	gbs_configure(run->gbs, 0, 0, TIMEOUT, 0, 0);
+	if (!gbs_init(run->gbs, 0))
+		return 0;
+	/* short steps, so that the tick the timeout fires at is exact */
+	while (gbs_step(run->gbs, 1) && gbs_get_status(run->gbs)->ticks < 4LL * CLOCK);
+	gbs_close(run->gbs);
+	return 1;
+}
+
+int main(int argc, char **argv)
+{
+	uint8_t gbs[0x100];
+	struct gbs_image *image;
+	struct run a, b;
+	long size = make_gbs(gbs);
+	long failed = 0;
+
+	image = gbs_image_open_mem("silence", gbs, size);
+	if (image == NULL) {
+		fprintf(stderr, "%s: gbs_image_open_mem failed\n", argv[0]);
+		exit(2);
+	}
+	if (!play(&a, image, 1) || !play(&b, image, 0)) {
+		fprintf(stderr, "%s: gbs_init failed\n", argv[0]);
+		exit(2);
+	}
+	gbs_image_unref(image);
+
+	/* the note lasts 64 length counter ticks, a quarter second */
+	if (a.silence_start < CLOCK / 5 || a.silence_start > CLOCK / 3) {
+		fprintf(stderr, "%s: silence started at %lld\n", argv[0], a.silence_start);
+		failed = 1;
+	}
+	if (a.ticks < a.silence_start + TIMEOUT * CLOCK ||
+	    a.ticks > a.silence_start + TIMEOUT * CLOCK + CLOCK / 1000 + 24) {
+		fprintf(stderr, "%s: timeout at %lld, silence started at %lld\n",
+		        argv[0], a.ticks, a.silence_start);
+		failed = 1;
+	}
+	if (b.silence_start != a.silence_start || b.ticks != a.ticks) {
+		fprintf(stderr, "%s: without output silence started at %lld and timed out at %lld, "
+		        "with output at %lld and %lld\n", argv[0],
+		        b.silence_start, b.ticks, a.silence_start, a.ticks);
+		failed = 1;
+	}
+
+	if (failed)
+		exit(1);
+	printf("silence timeout ok\n");
+	return 0;
+}
@@ -0,0 +1,193 @@
+/*
+ * gbsplay is a Gameboy sound player
+ *
+ * Saves the state of a playing gbs instance, restores it into a second
+ * instance opened from the same image and checks that both continue
+ * with the same register writes and samples.  Also checks that
+ * truncated or corrupted states are rejected.
+ *
+ * 2026 (C) Licensed under GNU GPL v1 or, at your option, any later version.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common.h"
+#include "libgbs.h"
+
+#define RATE    44100
+#define SECONDS 4
+
+struct run {
+	struct gbs *gbs;
+	struct gbs_output_buffer buf;
+	int16_t data[2048];
+	long frames;
+	long writes;
+	uint64_t io_hash;
+	uint64_t hash;
+};
+
+static uint64_t fnv1a(uint64_t hash, const void *data, long bytes)
+{
+	const uint8_t *p = data;
+
+	while (bytes--) {
+		hash ^= *p++;
+		hash *= 0x100000001b3ULL;
+	}
+	return hash;
+}
+
+static void io_cb(struct gbs* const gbs, cycles_t cycles, uint32_t addr, uint8_t value, void *priv)
+{
+	struct run *run = priv;
+
+	run->io_hash = fnv1a(run->io_hash, &cycles, sizeof(cycles));
+	run->io_hash = fnv1a(run->io_hash, &addr, sizeof(addr));
+	run->io_hash = fnv1a(run->io_hash, &value, sizeof(value));
+	run->writes++;
+}
+
+static void sound_cb(struct gbs* const gbs, struct gbs_output_buffer *buf, void *priv)
+{
+	struct run *run = priv;
+
+	run->hash = fnv1a(run->hash, buf->data, buf->pos * 2 * sizeof(int16_t));
+	run->frames += buf->pos;
+	buf->pos = 0;
+}
+
+static void reset(struct run *run)
+{
+	run->frames = 0;
+	run->writes = 0;
+	run->io_hash = 0xcbf29ce484222325ULL;
+	run->hash = 0xcbf29ce484222325ULL;
+}
+
+static long start(struct run *run, struct gbs_image *image, long subsong)
+{
+	reset(run);
+	run->gbs = gbs_open_image(image);
+	if (run->gbs == NULL)
+		return 0;
+	run->buf.data = run->data;
+	run->buf.bytes = sizeof(run->data);
+	run->buf.pos = 0;
+	gbs_set_io_callback(run->gbs, io_cb, run);
+	gbs_set_sound_callback(run->gbs, sound_cb, run);
+	gbs_configure_output(run->gbs, &run->buf, RATE);
+	gbs_configure(run->gbs, subsong, SECONDS * 2, 0, 0, 0);
+	return gbs_init(run->gbs, subsong);
+}
+
+static void play(struct run *run, long seconds)
+{
+	long end = run->frames + seconds * RATE;
+
+	while (run->frames < end && gbs_step(run->gbs, 16));
+}
+
+static void put_size(uint8_t *state, long size)
+{
+	long i;
+
+	for (i = 0; i < 4; i++, size >>= 8)
+		state[10 + i] = size & 0xff;
+}
+
+static long rejects(struct gbs* const gbs, const uint8_t *state, long size,
+                    long ofs, long len)
+{
+	uint8_t *bad = malloc(size);
+	long ret;
+
+	memcpy(bad, state, size);
+	if (ofs >= 0)
+		bad[ofs] ^= 0x5a;
+	ret = !gbs_load_state(gbs, bad, len);
+	free(bad);
+	return ret;
+}
+
+int main(int argc, char **argv)
+{
+	const char *filename = "examples/nightmode.gbs";
+	struct run a, b;
+	struct gbs_image *image;
+	uint8_t *state;
+	long size, failed = 0;
+
+	if (argc > 1)
+		filename = argv[1];
+
+	image = gbs_image_open(filename);
+	if (image == NULL) {
+		fprintf(stderr, "%s: gbs_image_open failed\n", argv[0]);
+		exit(2);
+	}
+	if (!start(&a, image, 0) || !start(&b, image, 0)) {
+		fprintf(stderr, "%s: gbs_init failed\n", argv[0]);
+		exit(2);
+	}
+
+	/* save in the middle of a step so that pending output is restored too */
+	play(&a, 1);
+	gbs_step(a.gbs, 7);
+	size = gbs_save_state(a.gbs, NULL, 0);
+	state = malloc(size);
+	if (state == NULL || gbs_save_state(a.gbs, state, size) != size) {
+		fprintf(stderr, "%s: gbs_save_state failed\n", argv[0]);
+		exit(2);
+	}
+
+	/* the header is magic, version, file CRC32 and size */
+	if (!rejects(b.gbs, state, size, -1, size - 1) ||
+	    !rejects(b.gbs, state, size, 0, size) ||
+	    !rejects(b.gbs, state, size, 4, size) ||
+	    !rejects(b.gbs, state, size, 6, size) ||
+	    !rejects(b.gbs, state, size, 10, size)) {
+		fprintf(stderr, "%s: corrupt state was accepted\n", argv[0]);
+		failed = 1;
+	}
+	/* consistent header on truncated data */
+	put_size(state, size - 1);
+	if (!rejects(b.gbs, state, size, -1, size - 1)) {
+		fprintf(stderr, "%s: truncated state was accepted\n", argv[0]);
+		failed = 1;
+	}
+	put_size(state, size);
+
+	if (!gbs_load_state(b.gbs, state, size)) {
+		fprintf(stderr, "%s: gbs_load_state failed\n", argv[0]);
+		exit(1);
+	}
+	free(state);
+
+	reset(&a);
+	reset(&b);
+	play(&a, SECONDS - 1);
+	play(&b, SECONDS - 1);
+	if (a.writes == 0 || a.frames == 0) {
+		fprintf(stderr, "%s: no output after the save\n", argv[0]);
+		failed = 1;
+	}
+	if (b.writes != a.writes || b.io_hash != a.io_hash) {
+		fprintf(stderr, "%s: register writes differ after gbs_load_state\n", argv[0]);
+		failed = 1;
+	}
+	if (b.frames != a.frames || b.hash != a.hash) {
+		fprintf(stderr, "%s: samples differ after gbs_load_state\n", argv[0]);
+		failed = 1;
+	}
+
+	gbs_close(a.gbs);
+	gbs_close(b.gbs);
+	gbs_image_unref(image);
+	if (failed)
+		exit(1);
+	printf("state round trip ok\n");
+	return 0;
+}
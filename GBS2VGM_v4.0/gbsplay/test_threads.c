@@ -0,0 +1,168 @@
+/*
+ * gbsplay is a Gameboy sound player
+ *
+ * Renders several gbs instances concurrently from one shared image and
+ * checks that each one sounds exactly as when rendered alone from its
+ * own file.  Some of them continue on a gbs_clone() after the first
+ * second.  Build with -fsanitize=thread to also catch state shared
+ * between instances.
+ *
+ * 2026 (C) Licensed under GNU GPL v1 or, at your option, any later version.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "common.h"
+#include "libgbs.h"
+
+#define JOBS    4
+#define RATE    44100
+#define SECONDS 10
+
+struct job {
+	const char *filename;
+	struct gbs_image *image;	/* shared, NULL to open filename */
+	long subsong;
+	long voices;
+	long fork;	/* switch to a clone after one second */
+	long frames;
+	uint64_t hash;
+	long ok;
+};
+
+static uint64_t fnv1a(uint64_t hash, const void *data, long bytes)
+{
+	const uint8_t *p = data;
+
+	while (bytes--) {
+		hash ^= *p++;
+		hash *= 0x100000001b3ULL;
+	}
+	return hash;
+}
+
+static void sound_cb(struct gbs* const gbs, struct gbs_output_buffer *buf, void *priv)
+{
+	struct job *job = priv;
+	long ch;
+
+	job->hash = fnv1a(job->hash, buf->data, buf->pos * 2 * sizeof(int16_t));
+	for (ch = 0; job->voices && ch < 4; ch++)
+		job->hash = fnv1a(job->hash, gbs_get_voice(gbs, ch), buf->pos);
+	job->frames += buf->pos;
+	buf->pos = 0;
+}
+
+static void *render(void *priv)
+{
+	struct job *job = priv;
+	struct gbs_output_buffer buf;
+	int16_t data[2048];
+	struct gbs *gbs;
+
+	job->hash = 0xcbf29ce484222325ULL;
+	job->frames = 0;
+	job->ok = 0;
+
+	gbs = job->image ? gbs_open_image(job->image) : gbs_open(job->filename);
+	if (gbs == NULL)
+		return NULL;
+	buf.data = data;
+	buf.bytes = sizeof(data);
+	buf.pos = 0;
+	gbs_set_sound_callback(gbs, sound_cb, job);
+	if (job->voices && !gbs_set_voices(gbs, 1)) {
+		gbs_close(gbs);
+		return NULL;
+	}
+	gbs_configure_output(gbs, &buf, RATE);
+	gbs_configure(gbs, job->subsong, SECONDS * 2, 0, 0, 0);
+	if (!gbs_init(gbs, job->subsong)) {
+		gbs_close(gbs);
+		return NULL;
+	}
+	while (job->frames < SECONDS * RATE && gbs_step(gbs, 16)) {
+		if (job->fork && job->frames >= RATE) {
+			struct gbs *clone = gbs_clone(gbs);
+
+			gbs_close(gbs);
+			if (clone == NULL)
+				return NULL;
+			gbs = clone;
+			job->fork = 0;
+		}
+	}
+	gbs_close(gbs);
+	job->ok = 1;
+	return NULL;
+}
+
+int main(int argc, char **argv)
+{
+	const char *filename = "examples/nightmode.gbs";
+	struct job ref[JOBS], job[JOBS];
+	pthread_t thread[JOBS];
+	const struct gbs_status *status;
+	struct gbs_image *image;
+	struct gbs *gbs;
+	long songs, i, failed = 0;
+
+	if (argc > 1)
+		filename = argv[1];
+
+	gbs = gbs_open(filename);
+	if (gbs == NULL) {
+		fprintf(stderr, "%s: gbs_open failed\n", argv[0]);
+		exit(2);
+	}
+	status = gbs_get_status(gbs);
+	songs = status->songs;
+	gbs_close(gbs);
+
+	/* odd jobs also render per-voice output, the last ones fork */
+	image = gbs_image_open(filename);
+	if (image == NULL) {
+		fprintf(stderr, "%s: gbs_image_open failed\n", argv[0]);
+		exit(2);
+	}
+	for (i = 0; i < JOBS; i++) {
+		ref[i].filename = filename;
+		ref[i].image = NULL;
+		ref[i].subsong = i % songs;
+		ref[i].voices = i & 1;
+		ref[i].fork = 0;
+		render(&ref[i]);
+		if (!ref[i].ok) {
+			fprintf(stderr, "%s: rendering subsong %ld failed\n", argv[0], ref[i].subsong);
+			exit(2);
+		}
+		job[i] = ref[i];
+		job[i].image = image;
+		job[i].fork = i >= JOBS / 2;
+	}
+
+	for (i = 0; i < JOBS; i++) {
+		if (pthread_create(&thread[i], NULL, render, &job[i]) != 0) {
+			fprintf(stderr, "%s: pthread_create failed\n", argv[0]);
+			exit(2);
+		}
+	}
+	for (i = 0; i < JOBS; i++)
+		pthread_join(thread[i], NULL);
+	gbs_image_unref(image);
+
+	for (i = 0; i < JOBS; i++) {
+		if (!job[i].ok || job[i].frames != ref[i].frames || job[i].hash != ref[i].hash) {
+			fprintf(stderr, "%s: job %ld (subsong %ld) differs when run concurrently\n",
+				argv[0], i, job[i].subsong);
+			failed = 1;
+		}
+	}
+	if (failed)
+		exit(1);
+	printf("%d concurrent instances of one image ok\n", JOBS);
+	return 0;
+}